@@ -633,6 +633,7 @@ Error ProjectSettings::setup(const String &p_path, const String &p_main_pack, bo
 	Compression::zstd_long_distance_matching = GLOBAL_GET("compression/formats/zstd/long_distance_matching");
 	Compression::zstd_level = GLOBAL_GET("compression/formats/zstd/compression_level");
 	Compression::zstd_window_log_size = GLOBAL_GET("compression/formats/zstd/window_log_size");
+	Compression::zstd_multithreaded = GLOBAL_GET("compression/formats/zstd/multithreaded");
 
 	Compression::zlib_level = GLOBAL_GET("compression/formats/zlib/compression_level");
 
@@ -1285,6 +1286,7 @@ ProjectSettings::ProjectSettings() {
 	custom_prop_info["compression/formats/zstd/compression_level"] = PropertyInfo(Variant::INT, "compression/formats/zstd/compression_level", PROPERTY_HINT_RANGE, "1,22,1");
 	GLOBAL_DEF("compression/formats/zstd/window_log_size", Compression::zstd_window_log_size);
 	custom_prop_info["compression/formats/zstd/window_log_size"] = PropertyInfo(Variant::INT, "compression/formats/zstd/window_log_size", PROPERTY_HINT_RANGE, "10,30,1");
+	GLOBAL_DEF("compression/formats/zstd/multithreaded", Compression::zstd_multithreaded);
 
 	GLOBAL_DEF("compression/formats/zlib/compression_level", Compression::zlib_level);
 	custom_prop_info["compression/formats/zlib/compression_level"] = PropertyInfo(Variant::INT, "compression/formats/zlib/compression_level", PROPERTY_HINT_RANGE, "-1,9,1");
@@ -0,0 +1,185 @@
+/*************************************************************************/
+/*  frame_profiler.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "frame_profiler.h"
+
+#include "core/io/file_access.h"
+#include "core/os/os.h"
+#include "core/os/spin_lock.h"
+#include "core/os/thread.h"
+
+struct FrameProfiler::ThreadTimeline {
+	String name;
+	SpinLock lock; // Only contended while exporting.
+	LocalVector<Event> events;
+	uint32_t write_index = 0;
+};
+
+SafeFlag FrameProfiler::capturing;
+uint64_t FrameProfiler::capture_begin = 0;
+thread_local FrameProfiler::ThreadTimeline *FrameProfiler::thread_timeline = nullptr;
+BinaryMutex FrameProfiler::timelines_mutex;
+LocalVector<FrameProfiler::ThreadTimeline *> FrameProfiler::timelines;
+BinaryMutex FrameProfiler::names_mutex;
+HashMap<String, CharString> FrameProfiler::names;
+
+FrameProfiler::ThreadTimeline *FrameProfiler::_get_thread_timeline() {
+	if (likely(thread_timeline)) {
+		return thread_timeline;
+	}
+
+	thread_timeline = memnew(ThreadTimeline);
+	if (Thread::get_caller_id() == Thread::get_main_id()) {
+		thread_timeline->name = "Main";
+	} else {
+		thread_timeline->name = "Thread " + itos(Thread::get_caller_id());
+	}
+
+	MutexLock lock(timelines_mutex);
+	timelines.push_back(thread_timeline);
+	return thread_timeline;
+}
+
+void FrameProfiler::Zone::_begin() {
+	begin = OS::get_singleton()->get_ticks_usec();
+	active = true;
+}
+
+void FrameProfiler::_record(const char *p_name, uint64_t p_begin) {
+	uint64_t end = OS::get_singleton()->get_ticks_usec();
+	ThreadTimeline *timeline = _get_thread_timeline();
+
+	timeline->lock.lock();
+	Event *event;
+	if (timeline->events.size() < MAX_EVENTS_PER_THREAD) {
+		// Grow lazily, short lived threads only record a few events.
+		timeline->events.push_back(Event());
+		event = &timeline->events[timeline->events.size() - 1];
+	} else {
+		event = &timeline->events[timeline->write_index];
+		timeline->write_index = (timeline->write_index + 1) % MAX_EVENTS_PER_THREAD;
+	}
+	event->name = p_name;
+	event->begin = p_begin;
+	event->end = end;
+	timeline->lock.unlock();
+}
+
+void FrameProfiler::begin_capture() {
+	clear();
+	capture_begin = OS::get_singleton()->get_ticks_usec();
+	capturing.set();
+}
+
+void FrameProfiler::end_capture() {
+	capturing.clear();
+}
+
+void FrameProfiler::set_thread_name(const String &p_name) {
+	ThreadTimeline *timeline = _get_thread_timeline();
+	timeline->lock.lock();
+	timeline->name = p_name;
+	timeline->lock.unlock();
+}
+
+void FrameProfiler::clear() {
+	MutexLock lock(timelines_mutex);
+	for (uint32_t i = 0; i < timelines.size(); i++) {
+		ThreadTimeline *timeline = timelines[i];
+		timeline->lock.lock();
+		timeline->events.clear();
+		timeline->write_index = 0;
+		timeline->lock.unlock();
+	}
+}
+
+void FrameProfiler::finish() {
+	capturing.clear();
+
+	{
+		MutexLock lock(timelines_mutex);
+		for (uint32_t i = 0; i < timelines.size(); i++) {
+			memdelete(timelines[i]);
+		}
+		timelines.reset();
+		thread_timeline = nullptr;
+	}
+
+	MutexLock lock(names_mutex);
+	names.clear();
+}
+
+const char *FrameProfiler::get_name(const String &p_name) {
+	MutexLock lock(names_mutex);
+	HashMap<String, CharString>::Iterator E = names.find(p_name);
+	if (!E) {
+		E = names.insert(p_name, p_name.utf8());
+	}
+	// HashMap never moves its elements, so the buffer stays where it is until finish().
+	return E->value.get_data();
+}
+
+Error FrameProfiler::save_chrome_trace(const String &p_path) {
+	Error err;
+	Ref<FileAccess> f = FileAccess::open(p_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(err != OK, err, "Cannot open file '" + p_path + "' to save the frame profile.");
+
+	f->store_line("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+	MutexLock lock(timelines_mutex);
+	bool first = true;
+	for (uint32_t i = 0; i < timelines.size(); i++) {
+		ThreadTimeline *timeline = timelines[i];
+		timeline->lock.lock();
+
+		if (timeline->events.size()) {
+			f->store_line(vformat("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", first ? "" : ",", i, timeline->name.json_escape()));
+			first = false;
+		}
+
+		// Oldest first, in case the ring buffer wrapped around.
+		for (uint32_t j = 0; j < timeline->events.size(); j++) {
+			const Event &event = timeline->events[(timeline->write_index + j) % timeline->events.size()];
+			if (event.begin < capture_begin) {
+				continue; // Zone was open when capture began.
+			}
+			String name = event.name;
+			if (name.is_empty()) {
+				name = "(unnamed)";
+			}
+			f->store_line(vformat(",{\"name\":\"%s\",\"cat\":\"godot\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%d,\"dur\":%d}", name.json_escape(), i, event.begin - capture_begin, event.end - event.begin));
+		}
+
+		timeline->lock.unlock();
+	}
+
+	f->store_line("]}");
+	return OK;
+}
@@ -0,0 +1,118 @@
+/*************************************************************************/
+/*  frame_profiler.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include "core/os/mutex.h"
+#include "core/string/ustring.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/safe_refcount.h"
+
+// Low overhead instrumentation of engine code, exported as a Chrome trace (also readable by Perfetto).
+// Zones record their begin and end time to a ring buffer owned by the calling thread, and cost a
+// single flag check while nothing is being captured.
+
+class FrameProfiler {
+public:
+	enum {
+		MAX_EVENTS_PER_THREAD = 1 << 16, // Older events are overwritten once full.
+	};
+
+	// Names must be static strings (or come from get_name()), nothing is copied or interned while recording.
+	class Zone {
+		const char *name = nullptr;
+		uint64_t begin = 0;
+		bool active = false;
+
+		void _begin();
+
+	public:
+		_FORCE_INLINE_ Zone(const char *p_name) {
+			if (unlikely(capturing.is_set())) {
+				name = p_name;
+				_begin();
+			}
+		}
+		_FORCE_INLINE_ ~Zone() {
+			if (unlikely(active)) {
+				_record(name, begin);
+			}
+		}
+	};
+
+private:
+	struct Event {
+		const char *name = nullptr;
+		uint64_t begin = 0;
+		uint64_t end = 0;
+	};
+
+	struct ThreadTimeline;
+
+	static SafeFlag capturing;
+	static uint64_t capture_begin;
+
+	static thread_local ThreadTimeline *thread_timeline;
+	static BinaryMutex timelines_mutex;
+	static LocalVector<ThreadTimeline *> timelines; // Kept after threads exit, so their events can be exported.
+
+	static BinaryMutex names_mutex;
+	static HashMap<String, CharString> names;
+
+	static ThreadTimeline *_get_thread_timeline();
+	static void _record(const char *p_name, uint64_t p_begin);
+
+public:
+	static void begin_capture();
+	static void end_capture();
+	_FORCE_INLINE_ static bool is_capturing() { return capturing.is_set(); }
+
+	// Shown as the thread name in the trace.
+	static void set_thread_name(const String &p_name);
+
+	// A copy of a name built at runtime that can be used by zones, valid until finish().
+	// Takes a lock, so it should be called once up front rather than when each zone begins.
+	static const char *get_name(const String &p_name);
+
+	static Error save_chrome_trace(const String &p_path);
+	static void clear();
+	// Frees the timelines of all threads, which must have exited (except the calling one), and the names.
+	static void finish();
+};
+
+#define _FRAME_PROFILE_ZONE_NAME_CONCAT(m_a, m_b) m_a##m_b
+#define _FRAME_PROFILE_ZONE_NAME(m_line) _FRAME_PROFILE_ZONE_NAME_CONCAT(_frame_profile_zone_, m_line)
+
+// Records the time spent until the end of the current scope.
+#define FRAME_PROFILE_ZONE(m_name) FrameProfiler::Zone _FRAME_PROFILE_ZONE_NAME(__LINE__)(m_name)
+
+#endif // FRAME_PROFILER_H
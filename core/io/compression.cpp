@@ -32,13 +32,93 @@
 
 #include "core/config/project_settings.h"
 #include "core/io/zip_io.h"
+#include "core/os/parallel_for.h"
+#include "core/templates/safe_refcount.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/hashfuncs.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/sort_array.h"
 
 #include "thirdparty/misc/fastlz.h"
 
 #include <zlib.h>
 #include <zstd.h>
 
-int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode) {
+// Large payloads are split in jobs of this size when compressing in parallel.
+static const int ZSTD_JOB_SIZE = 1 << 21;
+
+// Contexts are kept per thread and reused, allocating them is expensive next to compressing small payloads.
+struct ZSTDContexts {
+	ZSTD_CCtx *cctx = nullptr;
+	ZSTD_DCtx *dctx = nullptr;
+
+	~ZSTDContexts() {
+		if (cctx) {
+			ZSTD_freeCCtx(cctx);
+		}
+		if (dctx) {
+			ZSTD_freeDCtx(dctx);
+		}
+	}
+};
+
+static thread_local ZSTDContexts zstd_contexts;
+
+int Compression::_get_zstd_job_count(int p_src_size) {
+	// Long distance matching is pointless if the payload is split.
+	if (!zstd_multithreaded || zstd_long_distance_matching || p_src_size < ZSTD_JOB_SIZE * 2) {
+		return 1;
+	}
+	return (p_src_size + ZSTD_JOB_SIZE - 1) / ZSTD_JOB_SIZE;
+}
+
+int Compression::_zstd_compress_frame(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, const CompressionDictionary *p_dictionary) {
+	if (!zstd_contexts.cctx) {
+		zstd_contexts.cctx = ZSTD_createCCtx();
+		ERR_FAIL_NULL_V(zstd_contexts.cctx, -1);
+	} else {
+		ZSTD_CCtx_reset(zstd_contexts.cctx, ZSTD_reset_session_and_parameters);
+	}
+	ZSTD_CCtx *cctx = zstd_contexts.cctx;
+
+	size_t ret;
+	if (p_dictionary) {
+		ret = ZSTD_compress_usingCDict(cctx, p_dst, p_dst_max_size, p_src, p_src_size, (const ZSTD_CDict *)p_dictionary->get_zstd_cdict(zstd_level));
+	} else {
+		ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, zstd_level);
+		if (zstd_long_distance_matching) {
+			ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, 1);
+			ZSTD_CCtx_setParameter(cctx, ZSTD_c_windowLog, zstd_window_log_size);
+		}
+		ret = ZSTD_compressCCtx(cctx, p_dst, p_dst_max_size, p_src, p_src_size, zstd_level);
+	}
+	return ZSTD_isError(ret) ? -1 : (int)ret;
+}
+
+int Compression::_zstd_decompress_frames(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, const CompressionDictionary *p_dictionary) {
+	if (!zstd_contexts.dctx) {
+		zstd_contexts.dctx = ZSTD_createDCtx();
+		ERR_FAIL_NULL_V(zstd_contexts.dctx, -1);
+	} else {
+		ZSTD_DCtx_reset(zstd_contexts.dctx, ZSTD_reset_session_and_parameters);
+	}
+	ZSTD_DCtx *dctx = zstd_contexts.dctx;
+
+	if (zstd_long_distance_matching) {
+		ZSTD_DCtx_setParameter(dctx, ZSTD_d_windowLogMax, zstd_window_log_size);
+	}
+	size_t ret;
+	if (p_dictionary) {
+		ret = ZSTD_decompress_usingDDict(dctx, p_dst, p_dst_max_size, p_src, p_src_size, (const ZSTD_DDict *)p_dictionary->get_zstd_ddict());
+	} else {
+		ret = ZSTD_decompressDCtx(dctx, p_dst, p_dst_max_size, p_src, p_src_size);
+	}
+	return ZSTD_isError(ret) ? -1 : (int)ret;
+}
+
+int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode, const CompressionDictionary *p_dictionary) {
+	ERR_FAIL_COND_V_MSG(p_dictionary && p_mode != MODE_ZSTD, -1, "Compression dictionaries are only supported by MODE_ZSTD.");
+
 	switch (p_mode) {
 		case MODE_FASTLZ: {
 			if (p_src_size < 16) {
@@ -77,16 +157,35 @@ int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size,
 
 		} break;
 		case MODE_ZSTD: {
-			ZSTD_CCtx *cctx = ZSTD_createCCtx();
-			ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, zstd_level);
-			if (zstd_long_distance_matching) {
-				ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, 1);
-				ZSTD_CCtx_setParameter(cctx, ZSTD_c_windowLog, zstd_window_log_size);
+			const int jobs = _get_zstd_job_count(p_src_size);
+			if (jobs == 1) {
+				return _zstd_compress_frame(p_dst, get_max_compressed_buffer_size(p_src_size, MODE_ZSTD), p_src, p_src_size, p_dictionary);
 			}
-			int max_dst_size = get_max_compressed_buffer_size(p_src_size, MODE_ZSTD);
-			int ret = ZSTD_compressCCtx(cctx, p_dst, max_dst_size, p_src, p_src_size, zstd_level);
-			ZSTD_freeCCtx(cctx);
-			return ret;
+
+			// Each job is compressed in place as its own frame, then they are packed together.
+			const int job_bound = ZSTD_compressBound(ZSTD_JOB_SIZE);
+			LocalVector<int> sizes;
+			sizes.resize(jobs);
+			parallel_for(
+					0, jobs, [&](uint32_t p_begin, uint32_t p_end) {
+						for (uint32_t i = p_begin; i < p_end; i++) {
+							const int size = i == (uint32_t)jobs - 1 ? p_src_size - i * ZSTD_JOB_SIZE : ZSTD_JOB_SIZE;
+							sizes[i] = _zstd_compress_frame(p_dst + i * job_bound, ZSTD_compressBound(size), p_src + i * ZSTD_JOB_SIZE, size, p_dictionary);
+						}
+					},
+					1, "Compression::compress");
+
+			int total = 0;
+			for (int i = 0; i < jobs; i++) {
+				if (sizes[i] < 0) {
+					return -1;
+				}
+				if (i > 0) {
+					memmove(p_dst + total, p_dst + i * job_bound, sizes[i]);
+				}
+				total += sizes[i];
+			}
+			return total;
 		} break;
 	}
 
@@ -120,14 +219,20 @@ int Compression::get_max_compressed_buffer_size(int p_src_size, Mode p_mode) {
 			return aout;
 		} break;
 		case MODE_ZSTD: {
-			return ZSTD_compressBound(p_src_size);
+			const int jobs = _get_zstd_job_count(p_src_size);
+			if (jobs == 1) {
+				return ZSTD_compressBound(p_src_size);
+			}
+			return (jobs - 1) * ZSTD_compressBound(ZSTD_JOB_SIZE) + ZSTD_compressBound(p_src_size - (jobs - 1) * ZSTD_JOB_SIZE);
 		} break;
 	}
 
 	ERR_FAIL_V(-1);
 }
 
-int Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, Mode p_mode) {
+int Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, Mode p_mode, const CompressionDictionary *p_dictionary) {
+	ERR_FAIL_COND_V_MSG(p_dictionary && p_mode != MODE_ZSTD, -1, "Compression dictionaries are only supported by MODE_ZSTD.");
+
 	switch (p_mode) {
 		case MODE_FASTLZ: {
 			int ret_size = 0;
@@ -167,13 +272,50 @@ int Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p
 			return total;
 		} break;
 		case MODE_ZSTD: {
-			ZSTD_DCtx *dctx = ZSTD_createDCtx();
-			if (zstd_long_distance_matching) {
-				ZSTD_DCtx_setParameter(dctx, ZSTD_d_windowLogMax, zstd_window_log_size);
+			struct Frame {
+				int src_ofs = 0;
+				int src_size = 0;
+				int dst_ofs = 0;
+				int dst_size = 0;
+			};
+
+			// Frames compressed in parallel are decompressed in parallel too, if their sizes are known.
+			LocalVector<Frame> frames;
+			int src_ofs = 0;
+			int dst_ofs = 0;
+			while (src_ofs < p_src_size) {
+				Frame frame;
+				frame.src_ofs = src_ofs;
+				size_t size = ZSTD_findFrameCompressedSize(p_src + src_ofs, p_src_size - src_ofs);
+				unsigned long long content_size = ZSTD_getFrameContentSize(p_src + src_ofs, p_src_size - src_ofs);
+				if (ZSTD_isError(size) || content_size == ZSTD_CONTENTSIZE_UNKNOWN || content_size == ZSTD_CONTENTSIZE_ERROR || content_size > (unsigned long long)(p_dst_max_size - dst_ofs)) {
+					frames.clear();
+					break;
+				}
+				frame.src_size = size;
+				frame.dst_ofs = dst_ofs;
+				frame.dst_size = content_size;
+				frames.push_back(frame);
+				src_ofs += size;
+				dst_ofs += content_size;
 			}
-			int ret = ZSTD_decompressDCtx(dctx, p_dst, p_dst_max_size, p_src, p_src_size);
-			ZSTD_freeDCtx(dctx);
-			return ret;
+
+			if (frames.size() <= 1) {
+				return _zstd_decompress_frames(p_dst, p_dst_max_size, p_src, p_src_size, p_dictionary);
+			}
+
+			SafeFlag failed;
+			parallel_for(
+					0, frames.size(), [&](uint32_t p_begin, uint32_t p_end) {
+						for (uint32_t i = p_begin; i < p_end; i++) {
+							const Frame &frame = frames[i];
+							if (_zstd_decompress_frames(p_dst + frame.dst_ofs, frame.dst_size, p_src + frame.src_ofs, frame.src_size, p_dictionary) != frame.dst_size) {
+								failed.set();
+							}
+						}
+					},
+					1, "Compression::decompress");
+			return failed.is_set() ? -1 : dst_ofs;
 		} break;
 	}
 
@@ -273,5 +415,230 @@ int Compression::zlib_level = Z_DEFAULT_COMPRESSION;
 int Compression::gzip_level = Z_DEFAULT_COMPRESSION;
 int Compression::zstd_level = 3;
 bool Compression::zstd_long_distance_matching = false;
+bool Compression::zstd_multithreaded = true;
 int Compression::zstd_window_log_size = 27; // ZSTD_WINDOWLOG_LIMIT_DEFAULT
 int Compression::gzip_chunk = 16384;
+
+/* CompressionDictionary */
+
+void CompressionDictionary::_bind_methods() {
+	ClassDB::bind_static_method("CompressionDictionary", D_METHOD("create_from_samples", "samples", "max_size"), &CompressionDictionary::_create_from_samples_bind, DEFVAL(112640));
+
+	ClassDB::bind_method(D_METHOD("set_data", "data"), &CompressionDictionary::set_data);
+	ClassDB::bind_method(D_METHOD("get_data"), &CompressionDictionary::get_data);
+	ClassDB::bind_method(D_METHOD("compress", "data"), &CompressionDictionary::compress);
+	ClassDB::bind_method(D_METHOD("decompress", "data", "buffer_size"), &CompressionDictionary::decompress);
+
+	ADD_PROPERTY(PropertyInfo(Variant::PACKED_BYTE_ARRAY, "data"), "set_data", "get_data");
+}
+
+Ref<CompressionDictionary> CompressionDictionary::_create_from_samples_bind(const TypedArray<PackedByteArray> &p_samples, int p_max_size) {
+	Vector<Vector<uint8_t>> samples;
+	samples.resize(p_samples.size());
+	for (int i = 0; i < p_samples.size(); i++) {
+		samples.write[i] = p_samples[i];
+	}
+	return create_from_samples(samples, p_max_size);
+}
+
+Vector<uint8_t> CompressionDictionary::compress(const Vector<uint8_t> &p_data) const {
+	Vector<uint8_t> compressed;
+	compressed.resize(Compression::get_max_compressed_buffer_size(p_data.size(), Compression::MODE_ZSTD));
+	int result = Compression::compress(compressed.ptrw(), p_data.ptr(), p_data.size(), Compression::MODE_ZSTD, this);
+	ERR_FAIL_COND_V_MSG(result < 0, Vector<uint8_t>(), "Compression failed.");
+	compressed.resize(result);
+	return compressed;
+}
+
+Vector<uint8_t> CompressionDictionary::decompress(const Vector<uint8_t> &p_data, int64_t p_buffer_size) const {
+	ERR_FAIL_COND_V_MSG(p_buffer_size <= 0 || p_buffer_size > INT32_MAX, Vector<uint8_t>(), "Decompression buffer size must be greater than zero, and fit in 32 bits.");
+	Vector<uint8_t> decompressed;
+	decompressed.resize(p_buffer_size);
+	int result = Compression::decompress(decompressed.ptrw(), p_buffer_size, p_data.ptr(), p_data.size(), Compression::MODE_ZSTD, this);
+	ERR_FAIL_COND_V_MSG(result < 0, Vector<uint8_t>(), "Decompression failed, the data is corrupt or was compressed with another dictionary.");
+	decompressed.resize(result);
+	return decompressed;
+}
+
+// Segments are cut at content defined anchors, so that the same content is
+// cut the same way wherever it is located in each sample.
+static const int DICT_SEGMENT_SIZE = 64;
+static const uint64_t DICT_ANCHOR_MASK = (1 << 4) - 1; // One anchor every 16 bytes, on average.
+
+static const uint64_t *_get_gear_table() {
+	struct GearTable {
+		uint64_t values[256];
+
+		GearTable() {
+			uint64_t state = 0x9E3779B97F4A7C15; // SplitMix64, so the table (and the dictionaries) are reproducible.
+			for (int i = 0; i < 256; i++) {
+				state += 0x9E3779B97F4A7C15;
+				uint64_t z = state;
+				z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+				z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+				values[i] = z ^ (z >> 31);
+			}
+		}
+	};
+	static const GearTable table;
+	return table.values;
+}
+
+static uint64_t _hash_segment(const uint8_t *p_segment) {
+	uint32_t a = HASH_MURMUR3_SEED;
+	uint32_t b = 0x5bd1e995;
+	for (int i = 0; i < DICT_SEGMENT_SIZE; i += 8) {
+		uint64_t word;
+		memcpy(&word, p_segment + i, 8); // Samples are not aligned.
+		a = hash_murmur3_one_64(word, a);
+		b = hash_murmur3_one_64(word, b);
+	}
+	return (uint64_t(hash_fmix32(a)) << 32) | hash_fmix32(b);
+}
+
+Ref<CompressionDictionary> CompressionDictionary::create_from_samples(const Vector<Vector<uint8_t>> &p_samples, int p_max_size) {
+	ERR_FAIL_COND_V(p_max_size <= 0, Ref<CompressionDictionary>());
+
+	struct Segment {
+		uint32_t sample = 0;
+		uint32_t offset = 0;
+		uint32_t samples_seen = 0;
+		uint32_t last_sample = 0;
+	};
+
+	struct SegmentSort {
+		const Segment *segments = nullptr;
+		_FORCE_INLINE_ bool operator()(uint32_t p_a, uint32_t p_b) const {
+			if (segments[p_a].samples_seen != segments[p_b].samples_seen) {
+				return segments[p_a].samples_seen > segments[p_b].samples_seen;
+			}
+			return p_a < p_b; // Keep it deterministic.
+		}
+	};
+
+	// Like ZSTD's own trainer, there is no point in looking at more than about a hundred times the dictionary size.
+	uint64_t total_size = 0;
+	for (int i = 0; i < p_samples.size(); i++) {
+		total_size += p_samples[i].size();
+	}
+	const uint64_t budget = (uint64_t)p_max_size * 100;
+	uint64_t per_sample_limit = UINT64_MAX;
+	if (total_size > budget && p_samples.size() > 0) {
+		per_sample_limit = MAX(budget / p_samples.size(), (uint64_t)DICT_SEGMENT_SIZE * 4);
+	}
+
+	const uint64_t *gear = _get_gear_table();
+	LocalVector<Segment> segments;
+	HashMap<uint64_t, uint32_t> segment_indices;
+
+	for (int i = 0; i < p_samples.size(); i++) {
+		const uint8_t *r = p_samples[i].ptr();
+		const uint64_t limit = MIN((uint64_t)p_samples[i].size(), per_sample_limit);
+
+		uint64_t h = 0;
+		uint64_t ofs = 0;
+		while (ofs + DICT_SEGMENT_SIZE <= limit) {
+			h = (h << 1) + gear[r[ofs]];
+			if ((h & DICT_ANCHOR_MASK) != 0) {
+				ofs++;
+				continue;
+			}
+
+			const uint64_t key = _hash_segment(r + ofs);
+			uint32_t *index = segment_indices.getptr(key);
+			if (!index) {
+				Segment s;
+				s.sample = i;
+				s.offset = ofs;
+				s.samples_seen = 1;
+				s.last_sample = i;
+				segment_indices.insert(key, segments.size());
+				segments.push_back(s);
+			} else if (segments[*index].last_sample != (uint32_t)i) {
+				segments[*index].samples_seen++;
+				segments[*index].last_sample = i;
+			}
+
+			// Segments taken from a sample don't overlap, the next anchor is found after this one.
+			ofs += DICT_SEGMENT_SIZE;
+			h = 0;
+		}
+	}
+
+	LocalVector<uint32_t> candidates;
+	for (uint32_t i = 0; i < segments.size(); i++) {
+		if (segments[i].samples_seen >= 2) {
+			candidates.push_back(i);
+		}
+	}
+	if (candidates.is_empty()) {
+		return Ref<CompressionDictionary>();
+	}
+
+	SortArray<uint32_t, SegmentSort> sorter;
+	sorter.compare.segments = segments.ptr();
+	sorter.sort(candidates.ptr(), candidates.size());
+
+	int count = MIN((int)candidates.size(), p_max_size / DICT_SEGMENT_SIZE);
+	count = MAX(count, 1);
+	const int dict_size = MIN(count * DICT_SEGMENT_SIZE, p_max_size);
+
+	// ZSTD finds matches more cheaply close to the end of the dictionary, so the most common segments go last.
+	Vector<uint8_t> data;
+	data.resize(dict_size);
+	uint8_t *w = data.ptrw();
+	int pos = dict_size;
+	for (int i = 0; i < count; i++) {
+		const Segment &s = segments[candidates[i]];
+		const int len = MIN(DICT_SEGMENT_SIZE, pos);
+		pos -= len;
+		memcpy(w + pos, p_samples[s.sample].ptr() + s.offset, len);
+	}
+
+	Ref<CompressionDictionary> dictionary;
+	dictionary.instantiate();
+	dictionary->set_data(data);
+	return dictionary;
+}
+
+void CompressionDictionary::_free_digested() {
+	for (const KeyValue<int, void *> &E : cdicts) {
+		ZSTD_freeCDict((ZSTD_CDict *)E.value);
+	}
+	cdicts.clear();
+	if (ddict) {
+		ZSTD_freeDDict((ZSTD_DDict *)ddict);
+		ddict = nullptr;
+	}
+}
+
+void CompressionDictionary::set_data(const Vector<uint8_t> &p_data) {
+	MutexLock lock(mutex);
+	// Other threads may still be compressing with the digested dictionary, so it can't be freed here.
+	ERR_FAIL_COND_MSG(ddict || !cdicts.is_empty(), "The data of a CompressionDictionary can't be changed once it was used, create a new one instead.");
+	data = p_data;
+}
+
+void *CompressionDictionary::get_zstd_cdict(int p_level) const {
+	MutexLock lock(mutex);
+	void **cdict = cdicts.getptr(p_level);
+	if (cdict) {
+		return *cdict;
+	}
+	// Always loaded as raw content, even if the samples happened to start with a ZSTD dictionary header.
+	void *created = ZSTD_createCDict_advanced(data.ptr(), data.size(), ZSTD_dlm_byCopy, ZSTD_dct_rawContent, ZSTD_getCParams(p_level, 0, data.size()), ZSTD_defaultCMem);
+	cdicts.insert(p_level, created);
+	return created;
+}
+
+void *CompressionDictionary::get_zstd_ddict() const {
+	MutexLock lock(mutex);
+	if (!ddict) {
+		ddict = ZSTD_createDDict_advanced(data.ptr(), data.size(), ZSTD_dlm_byCopy, ZSTD_dct_rawContent, ZSTD_defaultCMem);
+	}
+	return ddict;
+}
+
+CompressionDictionary::~CompressionDictionary() {
+	_free_digested();
+}
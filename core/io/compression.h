@@ -31,9 +31,15 @@
 #ifndef COMPRESSION_H
 #define COMPRESSION_H
 
+#include "core/object/ref_counted.h"
+#include "core/os/mutex.h"
+#include "core/templates/hash_map.h"
 #include "core/templates/vector.h"
+#include "core/variant/typed_array.h"
 #include "core/typedefs.h"
 
+class CompressionDictionary;
+
 class Compression {
 public:
 	static int zlib_level;
@@ -41,6 +47,7 @@ public:
 	static int zstd_level;
 	static bool zstd_long_distance_matching;
 	static int zstd_window_log_size;
+	static bool zstd_multithreaded;
 	static int gzip_chunk;
 
 	enum Mode {
@@ -50,10 +57,55 @@ public:
 		MODE_GZIP
 	};
 
-	static int compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD);
+	// A dictionary can only be used with MODE_ZSTD, and data compressed with one must be decompressed with the same one.
+	// Large ZSTD payloads are split in frames compressed (and later decompressed) in parallel when zstd_multithreaded is set,
+	// the result can still be decompressed by any ZSTD decoder.
+	static int compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD, const CompressionDictionary *p_dictionary = nullptr);
 	static int get_max_compressed_buffer_size(int p_src_size, Mode p_mode = MODE_ZSTD);
-	static int decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD);
+	static int decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD, const CompressionDictionary *p_dictionary = nullptr);
 	static int decompress_dynamic(Vector<uint8_t> *p_dst_vect, int p_max_dst_size, const uint8_t *p_src, int p_src_size, Mode p_mode);
+
+private:
+	static int _get_zstd_job_count(int p_src_size);
+	static int _zstd_compress_frame(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, const CompressionDictionary *p_dictionary);
+	static int _zstd_decompress_frames(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, const CompressionDictionary *p_dictionary);
+};
+
+// Content shared by many small, similar payloads, which ZSTD uses as history
+// for all of them. It is digested once and can be used from several threads,
+// its data can't be changed after that.
+class CompressionDictionary : public RefCounted {
+	GDCLASS(CompressionDictionary, RefCounted);
+
+	Vector<uint8_t> data;
+
+	mutable BinaryMutex mutex;
+	mutable HashMap<int, void *> cdicts; // ZSTD_CDict, per compression level.
+	mutable void *ddict = nullptr; // ZSTD_DDict.
+
+	void _free_digested();
+
+	static Ref<CompressionDictionary> _create_from_samples_bind(const TypedArray<PackedByteArray> &p_samples, int p_max_size);
+
+protected:
+	static void _bind_methods();
+
+public:
+	// Builds a raw content dictionary from the segments that recur the most across samples.
+	// Returns null if the samples have nothing in common.
+	static Ref<CompressionDictionary> create_from_samples(const Vector<Vector<uint8_t>> &p_samples, int p_max_size = 112640);
+
+	void set_data(const Vector<uint8_t> &p_data);
+	const Vector<uint8_t> &get_data() const { return data; }
+
+	Vector<uint8_t> compress(const Vector<uint8_t> &p_data) const;
+	Vector<uint8_t> decompress(const Vector<uint8_t> &p_data, int64_t p_buffer_size) const;
+
+	void *get_zstd_cdict(int p_level) const;
+	void *get_zstd_ddict() const;
+
+	CompressionDictionary() {}
+	~CompressionDictionary();
 };
 
 #endif // COMPRESSION_H
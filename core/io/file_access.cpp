@@ -469,6 +469,42 @@ uint64_t FileAccess::get_buffer(uint8_t *p_dst, uint64_t p_length) const {
 	return i;
 }
 
+FileAccess::AsyncReadID FileAccess::read_async(uint64_t p_position, uint8_t *p_dst, uint64_t p_length) {
+	ERR_FAIL_COND_V(!p_dst && p_length > 0, INVALID_ASYNC_READ_ID);
+
+	// No asynchronous I/O in this backend, so read right away, leaving the cursor where it was.
+	uint64_t position = get_position();
+	seek(p_position);
+	uint64_t read = get_buffer(p_dst, p_length);
+	seek(position);
+
+	AsyncReadID id = last_async_read_id++;
+	finished_async_reads.insert(id, read);
+	return id;
+}
+
+bool FileAccess::is_async_read_completed(AsyncReadID p_id) const {
+	ERR_FAIL_COND_V_MSG(!finished_async_reads.has(p_id), false, "Invalid asynchronous read ID.");
+	return true;
+}
+
+uint64_t FileAccess::wait_async_read(AsyncReadID p_id, Error *r_error) {
+	HashMap<AsyncReadID, uint64_t>::Iterator E = finished_async_reads.find(p_id);
+	if (!E) {
+		if (r_error) {
+			*r_error = ERR_INVALID_PARAMETER;
+		}
+		ERR_FAIL_V_MSG(0, "Invalid asynchronous read ID.");
+	}
+
+	uint64_t read = E->value;
+	finished_async_reads.remove(E);
+	if (r_error) {
+		*r_error = OK;
+	}
+	return read;
+}
+
 Vector<uint8_t> FileAccess::_get_buffer(int64_t p_length) const {
 	Vector<uint8_t> data;
 
@@ -36,6 +36,7 @@
 #include "core/object/ref_counted.h"
 #include "core/os/memory.h"
 #include "core/string/ustring.h"
+#include "core/templates/hash_map.h"
 #include "core/typedefs.h"
 
 /**
@@ -69,6 +70,11 @@ public:
 
 	typedef void (*FileCloseFailNotify)(const String &);
 
+	typedef int64_t AsyncReadID;
+	enum {
+		INVALID_ASYNC_READ_ID = -1
+	};
+
 	typedef Ref<FileAccess> (*CreateFunc)();
 	bool big_endian = false;
 	bool real_is_double = false;
@@ -92,6 +98,8 @@ private:
 	thread_local static Error last_file_open_error;
 
 	AccessType _access_type = ACCESS_FILESYSTEM;
+	HashMap<AsyncReadID, uint64_t> finished_async_reads; // Reads done right away by backends without asynchronous I/O.
+	AsyncReadID last_async_read_id = 0;
 	static CreateFunc create_func[ACCESS_MAX]; /** default file access creation function for a platform */
 	template <class T>
 	static Ref<FileAccess> _create_builtin() {
@@ -128,6 +136,11 @@ public:
 
 	virtual uint64_t get_buffer(uint8_t *p_dst, uint64_t p_length) const; ///< get an array of bytes
 	Vector<uint8_t> _get_buffer(int64_t p_length) const;
+	virtual const uint8_t *get_buffer_view(uint64_t p_length) const { return nullptr; } ///< get the next p_length bytes without copying, valid while the file is open; nullptr if not available in memory
+	virtual const uint8_t *map_contents(uint64_t &r_length) { return nullptr; } ///< map the whole file read-only, valid until it's closed; nullptr if not supported
+	virtual AsyncReadID read_async(uint64_t p_position, uint8_t *p_dst, uint64_t p_length); ///< start reading p_length bytes at p_position into p_dst without moving the cursor; p_dst must stay valid until waited for
+	virtual bool is_async_read_completed(AsyncReadID p_id) const; ///< true when the asynchronous read is done and waiting for it won't block
+	virtual uint64_t wait_async_read(AsyncReadID p_id, Error *r_error = nullptr); ///< wait for an asynchronous read to finish and return the amount of bytes read; every read must be waited for
 	virtual String get_line() const;
 	virtual String get_token() const;
 	virtual Vector<String> get_csv_line(const String &p_delim = ",") const;
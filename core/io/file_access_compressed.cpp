@@ -30,7 +30,9 @@
 
 #include "file_access_compressed.h"
 
+#include "core/os/parallel_for.h"
 #include "core/string/print_string.h"
+#include "core/templates/safe_refcount.h"
 
 void FileAccessCompressed::configure(const String &p_magic, Compression::Mode p_mode, uint32_t p_block_size) {
 	magic = p_magic.ascii().get_data();
@@ -46,6 +48,11 @@ void FileAccessCompressed::configure(const String &p_magic, Compression::Mode p_
 	block_size = p_block_size;
 }
 
+void FileAccessCompressed::set_dictionary(const Ref<CompressionDictionary> &p_dictionary) {
+	ERR_FAIL_COND_MSG(f.is_valid(), "The dictionary must be set before opening the file.");
+	dictionary = p_dictionary;
+}
+
 #define WRITE_FIT(m_bytes)                                  \
 	{                                                       \
 		if (write_pos + (m_bytes) > write_max) {            \
@@ -66,33 +73,33 @@ Error FileAccessCompressed::open_after_magic(Ref<FileAccess> p_base) {
 		f.unref();
 		ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't open compressed file '" + p_base->get_path() + "' with block size 0, it is corrupted.");
 	}
+	if (dictionary.is_valid() && cmode != Compression::MODE_ZSTD) {
+		f.unref();
+		ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't open compressed file '" + p_base->get_path() + "' with a dictionary, it doesn't use ZSTD.");
+	}
 	read_total = f->get_32();
 	uint32_t bc = (read_total / block_size) + 1;
 	uint64_t acc_ofs = f->get_position() + bc * 4;
-	uint32_t max_bs = 0;
+	read_blocks.resize(bc);
+	ReadBlock *rbw = read_blocks.ptrw();
 	for (uint32_t i = 0; i < bc; i++) {
-		ReadBlock rb;
-		rb.offset = acc_ofs;
-		rb.csize = f->get_32();
-		acc_ofs += rb.csize;
-		max_bs = MAX(max_bs, rb.csize);
-		read_blocks.push_back(rb);
+		rbw[i].offset = acc_ofs;
+		rbw[i].csize = f->get_32();
+		acc_ofs += rbw[i].csize;
+	}
+	if (acc_ofs > f->get_length()) {
+		f.unref();
+		read_blocks.clear();
+		ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't open compressed file '" + p_base->get_path() + "', it is truncated.");
 	}
 
-	comp_buffer.resize(max_bs);
 	buffer.resize(block_size);
-	read_ptr = buffer.ptrw();
-	f->get_buffer(comp_buffer.ptrw(), read_blocks[0].csize);
-	at_end = false;
-	read_eof = false;
 	read_block_count = bc;
-	read_block_size = read_blocks.size() == 1 ? read_total : block_size;
-
-	int ret = Compression::decompress(buffer.ptrw(), read_block_size, comp_buffer.ptr(), read_blocks[0].csize, cmode);
-	read_block = 0;
+	cached_block = -1;
 	read_pos = 0;
+	read_eof = false;
 
-	return ret == -1 ? ERR_FILE_CORRUPT : OK;
+	return OK;
 }
 
 Error FileAccessCompressed::open_internal(const String &p_path, int p_mode_flags) {
@@ -137,49 +144,59 @@ void FileAccessCompressed::_close() {
 	}
 
 	if (writing) {
-		//save block table and all compressed blocks
-
-		CharString mgc = magic.utf8();
-		f->store_buffer((const uint8_t *)mgc.get_data(), mgc.length()); //write header 4
-		f->store_32(cmode); //write compression mode 4
-		f->store_32(block_size); //write block size 4
-		f->store_32(write_max); //max amount of data written 4
-		uint32_t bc = (write_max / block_size) + 1;
-
-		for (uint32_t i = 0; i < bc; i++) {
-			f->store_32(0); //compressed sizes, will update later
-		}
-
-		Vector<int> block_sizes;
-		for (uint32_t i = 0; i < bc; i++) {
-			uint32_t bl = i == (bc - 1) ? write_max % block_size : block_size;
-			uint8_t *bp = &write_ptr[i * block_size];
-
-			Vector<uint8_t> cblock;
-			cblock.resize(Compression::get_max_compressed_buffer_size(bl, cmode));
-			int s = Compression::compress(cblock.ptrw(), bp, bl, cmode);
-
-			f->store_buffer(cblock.ptr(), s);
-			block_sizes.push_back(s);
-		}
-
-		f->seek(16); //ok write block sizes
-		for (uint32_t i = 0; i < bc; i++) {
-			f->store_32(block_sizes[i]);
-		}
-		f->seek_end();
-		f->store_buffer((const uint8_t *)mgc.get_data(), mgc.length()); //magic at the end too
-
+		store_blocks(f, magic, write_ptr, write_max, cmode, block_size, dictionary);
 		buffer.clear();
 
 	} else {
 		comp_buffer.clear();
 		buffer.clear();
 		read_blocks.clear();
+		cached_block = -1;
 	}
 	f.unref();
 }
 
+Error FileAccessCompressed::store_blocks(Ref<FileAccess> p_dst, const String &p_magic, const uint8_t *p_src, uint64_t p_size, Compression::Mode p_mode, uint32_t p_block_size, const Ref<CompressionDictionary> &p_dictionary) {
+	ERR_FAIL_COND_V(p_dst.is_null(), ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V(p_block_size == 0, ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V_MSG(p_size > UINT32_MAX, ERR_OUT_OF_MEMORY, "Compressed files are limited to 4 GiB.");
+	ERR_FAIL_COND_V_MSG(p_dictionary.is_valid() && p_mode != Compression::MODE_ZSTD, ERR_INVALID_PARAMETER, "Compression dictionaries are only supported by MODE_ZSTD.");
+
+	const uint32_t bc = (p_size / p_block_size) + 1;
+	const int max_csize = Compression::get_max_compressed_buffer_size(p_block_size, p_mode);
+
+	// Compress all blocks at once, then write them in order.
+	Vector<uint8_t> cblocks;
+	cblocks.resize((int64_t)bc * max_csize);
+	LocalVector<int> block_sizes;
+	block_sizes.resize(bc);
+	uint8_t *cw = cblocks.ptrw();
+	parallel_for(
+			0, bc, [&](uint32_t p_begin, uint32_t p_end) {
+				for (uint32_t i = p_begin; i < p_end; i++) {
+					uint32_t bl = i == (bc - 1) ? p_size % p_block_size : p_block_size;
+					block_sizes[i] = Compression::compress(cw + (uint64_t)i * max_csize, p_src + (uint64_t)i * p_block_size, bl, p_mode, p_dictionary.ptr());
+				}
+			},
+			1, "FileAccessCompressed::store_blocks");
+
+	CharString mgc = p_magic.utf8();
+	p_dst->store_buffer((const uint8_t *)mgc.get_data(), mgc.length()); //write header 4
+	p_dst->store_32(p_mode); //write compression mode 4
+	p_dst->store_32(p_block_size); //write block size 4
+	p_dst->store_32(p_size); //max amount of data written 4
+	for (uint32_t i = 0; i < bc; i++) {
+		ERR_FAIL_COND_V_MSG(block_sizes[i] < 0, ERR_BUG, "Failed to compress block.");
+		p_dst->store_32(block_sizes[i]); //compressed sizes
+	}
+	for (uint32_t i = 0; i < bc; i++) {
+		p_dst->store_buffer(cw + (uint64_t)i * max_csize, block_sizes[i]);
+	}
+	p_dst->store_buffer((const uint8_t *)mgc.get_data(), mgc.length()); //magic at the end too
+
+	return p_dst->get_error();
+}
+
 bool FileAccessCompressed::is_open() const {
 	return f.is_valid();
 }
@@ -194,23 +211,9 @@ void FileAccessCompressed::seek(uint64_t p_position) {
 
 	} else {
 		ERR_FAIL_COND(p_position > read_total);
-		if (p_position == read_total) {
-			at_end = true;
-		} else {
-			at_end = false;
-			read_eof = false;
-			uint32_t block_idx = p_position / block_size;
-			if (block_idx != read_block) {
-				read_block = block_idx;
-				f->seek(read_blocks[read_block].offset);
-				f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-				int ret = Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-				ERR_FAIL_COND_MSG(ret == -1, "Compressed file is corrupt.");
-				read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-			}
-
-			read_pos = p_position % block_size;
-		}
+		// The block is decompressed when it's actually read from.
+		read_pos = p_position;
+		read_eof = false;
 	}
 }
 
@@ -228,7 +231,7 @@ uint64_t FileAccessCompressed::get_position() const {
 	if (writing) {
 		return write_pos;
 	} else {
-		return (uint64_t)read_block * block_size + read_pos;
+		return read_pos;
 	}
 }
 
@@ -250,36 +253,75 @@ bool FileAccessCompressed::eof_reached() const {
 	}
 }
 
+const uint8_t *FileAccessCompressed::_read_compressed(uint32_t p_from_block, uint32_t p_to_block) const {
+	const uint64_t ofs = read_blocks[p_from_block].offset;
+	const uint64_t len = read_blocks[p_to_block - 1].offset + read_blocks[p_to_block - 1].csize - ofs;
+	const_cast<FileAccess *>(f.ptr())->seek(ofs); // Reading moves the base file anyway.
+	const uint8_t *src = f->get_buffer_view(len);
+	if (!src) {
+		if ((uint64_t)comp_buffer.size() < len) {
+			comp_buffer.resize(len);
+		}
+		if (f->get_buffer(comp_buffer.ptrw(), len) != len) {
+			return nullptr;
+		}
+		src = comp_buffer.ptr();
+	}
+	return src;
+}
+
+bool FileAccessCompressed::_load_block(uint32_t p_block) const {
+	if ((int64_t)p_block == cached_block) {
+		return true;
+	}
+	cached_block = -1;
+
+	const uint8_t *src = _read_compressed(p_block, p_block + 1);
+	ERR_FAIL_NULL_V_MSG(src, false, "Compressed file is truncated.");
+	const uint32_t len = _get_block_length(p_block);
+	int ret = Compression::decompress(buffer.ptrw(), len, src, read_blocks[p_block].csize, cmode, dictionary.ptr());
+	ERR_FAIL_COND_V_MSG(ret != (int)len, false, "Compressed file is corrupt.");
+
+	cached_block = p_block;
+	return true;
+}
+
+uint64_t FileAccessCompressed::_decompress_blocks(uint8_t *p_dst, uint32_t p_from_block, uint32_t p_to_block) const {
+	const uint8_t *src = _read_compressed(p_from_block, p_to_block);
+	ERR_FAIL_NULL_V_MSG(src, 0, "Compressed file is truncated.");
+
+	const uint64_t base = read_blocks[p_from_block].offset;
+	SafeFlag failed;
+	parallel_for(
+			p_from_block, p_to_block, [&](uint32_t p_begin, uint32_t p_end) {
+				for (uint32_t i = p_begin; i < p_end; i++) {
+					const uint32_t len = _get_block_length(i);
+					int ret = Compression::decompress(p_dst + (uint64_t)(i - p_from_block) * block_size, len, src + (read_blocks[i].offset - base), read_blocks[i].csize, cmode, dictionary.ptr());
+					if (ret != (int)len) {
+						failed.set();
+					}
+				}
+			},
+			1, "FileAccessCompressed::get_buffer");
+	ERR_FAIL_COND_V_MSG(failed.is_set(), 0, "Compressed file is corrupt.");
+
+	return (uint64_t)(p_to_block - 1 - p_from_block) * block_size + _get_block_length(p_to_block - 1);
+}
+
 uint8_t FileAccessCompressed::get_8() const {
 	ERR_FAIL_COND_V_MSG(f.is_null(), 0, "File must be opened before use.");
 	ERR_FAIL_COND_V_MSG(writing, 0, "File has not been opened in read mode.");
 
-	if (at_end) {
+	if (read_pos >= read_total) {
 		read_eof = true;
 		return 0;
 	}
 
-	uint8_t ret = read_ptr[read_pos];
-
-	read_pos++;
-	if (read_pos >= read_block_size) {
-		read_block++;
-
-		if (read_block < read_block_count) {
-			//read another block of compressed data
-			f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-			int total = Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-			ERR_FAIL_COND_V_MSG(total == -1, 0, "Compressed file is corrupt.");
-			read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-			read_pos = 0;
-
-		} else {
-			read_block--;
-			at_end = true;
-		}
+	const uint32_t block = read_pos / block_size;
+	if (!_load_block(block)) {
+		return 0;
 	}
-
-	return ret;
+	return buffer[read_pos++ - (uint64_t)block * block_size];
 }
 
 uint64_t FileAccessCompressed::get_buffer(uint8_t *p_dst, uint64_t p_length) const {
@@ -287,37 +329,50 @@ uint64_t FileAccessCompressed::get_buffer(uint8_t *p_dst, uint64_t p_length) con
 	ERR_FAIL_COND_V_MSG(f.is_null(), -1, "File must be opened before use.");
 	ERR_FAIL_COND_V_MSG(writing, -1, "File has not been opened in read mode.");
 
-	if (at_end) {
+	if (read_pos >= read_total) {
 		read_eof = true;
 		return 0;
 	}
 
-	for (uint64_t i = 0; i < p_length; i++) {
-		p_dst[i] = read_ptr[read_pos];
-		read_pos++;
-		if (read_pos >= read_block_size) {
-			read_block++;
-
-			if (read_block < read_block_count) {
-				//read another block of compressed data
-				f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-				int ret = Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-				ERR_FAIL_COND_V_MSG(ret == -1, -1, "Compressed file is corrupt.");
-				read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-				read_pos = 0;
-
-			} else {
-				read_block--;
-				at_end = true;
-				if (i + 1 < p_length) {
-					read_eof = true;
+	uint64_t end = read_pos + p_length;
+	if (end > read_total) {
+		end = read_total;
+		read_eof = true;
+	}
+
+	uint8_t *dst = p_dst;
+	while (read_pos < end) {
+		const uint32_t block = read_pos / block_size;
+		const uint64_t block_start = (uint64_t)block * block_size;
+
+		if (read_pos == block_start && (int64_t)block != cached_block) {
+			// Whole blocks are decompressed straight into the destination, several at a time.
+			uint32_t to_block = block;
+			while (to_block < read_block_count && (uint64_t)to_block * block_size < end && (uint64_t)to_block * block_size + _get_block_length(to_block) <= end) {
+				to_block++;
+			}
+			if (to_block > block) {
+				uint64_t amount = _decompress_blocks(dst, block, to_block);
+				if (amount == 0) {
+					break;
 				}
-				return i + 1;
+				read_pos += amount;
+				dst += amount;
+				continue;
 			}
 		}
+
+		if (!_load_block(block)) {
+			break;
+		}
+		const uint64_t ofs = read_pos - block_start;
+		const uint64_t amount = MIN(end - read_pos, _get_block_length(block) - ofs);
+		memcpy(dst, buffer.ptr() + ofs, amount);
+		read_pos += amount;
+		dst += amount;
 	}
 
-	return p_length;
+	return dst - p_dst;
 }
 
 Error FileAccessCompressed::get_error() const {
@@ -339,6 +394,16 @@ void FileAccessCompressed::store_8(uint8_t p_dest) {
 	write_ptr[write_pos++] = p_dest;
 }
 
+void FileAccessCompressed::store_buffer(const uint8_t *p_src, uint64_t p_length) {
+	ERR_FAIL_COND_MSG(f.is_null(), "File must be opened before use.");
+	ERR_FAIL_COND_MSG(!writing, "File has not been opened in write mode.");
+	ERR_FAIL_COND(!p_src && p_length > 0);
+
+	WRITE_FIT(p_length);
+	memcpy(write_ptr + write_pos, p_src, p_length);
+	write_pos += p_length;
+}
+
 bool FileAccessCompressed::file_exists(const String &p_name) {
 	Ref<FileAccess> fa = FileAccess::open(p_name, FileAccess::READ);
 	if (fa.is_null()) {
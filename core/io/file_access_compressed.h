@@ -36,6 +36,7 @@
 
 class FileAccessCompressed : public FileAccess {
 	Compression::Mode cmode = Compression::MODE_ZSTD;
+	Ref<CompressionDictionary> dictionary;
 	bool writing = false;
 	uint64_t write_pos = 0;
 	uint8_t *write_ptr = nullptr;
@@ -43,18 +44,16 @@ class FileAccessCompressed : public FileAccess {
 	uint64_t write_max = 0;
 	uint32_t block_size = 0;
 	mutable bool read_eof = false;
-	mutable bool at_end = false;
 
 	struct ReadBlock {
 		uint32_t csize;
 		uint64_t offset;
 	};
 
+	// Blocks are only decompressed when read from, so seeking is cheap.
 	mutable Vector<uint8_t> comp_buffer;
-	uint8_t *read_ptr = nullptr;
-	mutable uint32_t read_block = 0;
+	mutable int64_t cached_block = -1;
 	uint32_t read_block_count = 0;
-	mutable uint32_t read_block_size = 0;
 	mutable uint64_t read_pos = 0;
 	Vector<ReadBlock> read_blocks;
 	uint64_t read_total = 0;
@@ -63,10 +62,23 @@ class FileAccessCompressed : public FileAccess {
 	mutable Vector<uint8_t> buffer;
 	Ref<FileAccess> f;
 
+	_FORCE_INLINE_ uint32_t _get_block_length(uint32_t p_block) const {
+		return p_block == read_block_count - 1 ? read_total - (uint64_t)p_block * block_size : block_size;
+	}
+	const uint8_t *_read_compressed(uint32_t p_from_block, uint32_t p_to_block) const;
+	bool _load_block(uint32_t p_block) const;
+	uint64_t _decompress_blocks(uint8_t *p_dst, uint32_t p_from_block, uint32_t p_to_block) const;
+
 	void _close();
 
 public:
 	void configure(const String &p_magic, Compression::Mode p_mode = Compression::MODE_ZSTD, uint32_t p_block_size = 4096);
+	// Must be the same when writing and reading, it's not stored in the file. Only supported with MODE_ZSTD.
+	void set_dictionary(const Ref<CompressionDictionary> &p_dictionary);
+
+	// Writes p_src as a complete compressed file (including both magics) at the current position of p_dst.
+	// Blocks are compressed in parallel.
+	static Error store_blocks(Ref<FileAccess> p_dst, const String &p_magic, const uint8_t *p_src, uint64_t p_size, Compression::Mode p_mode, uint32_t p_block_size, const Ref<CompressionDictionary> &p_dictionary = Ref<CompressionDictionary>());
 
 	Error open_after_magic(Ref<FileAccess> p_base);
 
@@ -87,6 +99,7 @@ public:
 
 	virtual void flush() override;
 	virtual void store_8(uint8_t p_dest) override; ///< store a byte
+	virtual void store_buffer(const uint8_t *p_src, uint64_t p_length) override; ///< store an array of bytes
 
 	virtual bool file_exists(const String &p_name) override; ///< return true if a file exists
 
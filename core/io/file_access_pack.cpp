@@ -30,9 +30,11 @@
 
 #include "file_access_pack.h"
 
+#include "core/io/file_access_compressed.h"
 #include "core/io/file_access_encrypted.h"
 #include "core/object/script_language.h"
 #include "core/os/os.h"
+#include "core/templates/local_vector.h"
 #include "core/version.h"
 
 #include <stdio.h>
@@ -47,13 +49,14 @@ Error PackedData::add_pack(const String &p_path, bool p_replace_files, uint64_t
 	return ERR_FILE_UNRECOGNIZED;
 }
 
-void PackedData::add_path(const String &p_pkg_path, const String &p_path, uint64_t p_ofs, uint64_t p_size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, bool p_encrypted) {
+void PackedData::add_path(const String &p_pkg_path, const String &p_path, uint64_t p_ofs, uint64_t p_size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, bool p_encrypted, bool p_compressed) {
 	PathMD5 pmd5(p_path.md5_buffer());
 
 	bool exists = files.has(pmd5);
 
 	PackedFile pf;
 	pf.encrypted = p_encrypted;
+	pf.compressed = p_compressed;
 	pf.pack = p_pkg_path;
 	pf.offset = p_ofs;
 	pf.size = p_size;
@@ -200,20 +203,37 @@ bool PackedSourcePCK::try_open_pack(const String &p_path, bool p_replace_files,
 	uint32_t ver_minor = f->get_32();
 	f->get_32(); // patch number, not used for validation.
 
-	ERR_FAIL_COND_V_MSG(version != PACK_FORMAT_VERSION, false, "Pack version unsupported: " + itos(version) + ".");
+	ERR_FAIL_COND_V_MSG(version < PACK_FORMAT_VERSION_MIN || version > PACK_FORMAT_VERSION, false, "Pack version unsupported: " + itos(version) + ".");
 	ERR_FAIL_COND_V_MSG(ver_major > VERSION_MAJOR || (ver_major == VERSION_MAJOR && ver_minor > VERSION_MINOR), false, "Pack created with a newer version of the engine: " + itos(ver_major) + "." + itos(ver_minor) + ".");
 
 	uint32_t pack_flags = f->get_32();
 	uint64_t file_base = f->get_64();
+	ERR_FAIL_COND_V_MSG(pack_flags & ~PACK_FLAGS_SUPPORTED, false, "Pack uses unsupported features (flags " + itos(pack_flags) + "): " + p_path + ".");
 
 	bool enc_directory = (pack_flags & PACK_DIR_ENCRYPTED);
 
-	for (int i = 0; i < 16; i++) {
+	uint64_t dictionary_ofs = f->get_64();
+	uint32_t dictionary_size = f->get_32();
+	for (int i = 3; i < 16; i++) {
 		//reserved
 		f->get_32();
 	}
 
 	int file_count = f->get_32();
+	ERR_FAIL_COND_V_MSG(file_count < 0, false, "Invalid file count in pack: " + p_path + ".");
+
+	Ref<CompressionDictionary> dictionary;
+	if (pack_flags & PACK_COMPRESSION_DICTIONARY) {
+		uint64_t directory_pos = f->get_position();
+		Vector<uint8_t> dictionary_data;
+		dictionary_data.resize(dictionary_size);
+		f->seek(file_base + dictionary_ofs + p_offset);
+		ERR_FAIL_COND_V_MSG(f->get_buffer(dictionary_data.ptrw(), dictionary_size) != dictionary_size, false, "Can't read the compression dictionary of pack: " + p_path + ".");
+		f->seek(directory_pos);
+
+		dictionary.instantiate();
+		dictionary->set_data(dictionary_data);
+	}
 
 	if (enc_directory) {
 		Ref<FileAccessEncrypted> fae;
@@ -231,30 +251,99 @@ bool PackedSourcePCK::try_open_pack(const String &p_path, bool p_replace_files,
 		f = fae;
 	}
 
+	struct Entry {
+		String path;
+		uint64_t ofs = 0;
+		uint64_t size = 0;
+		uint8_t md5[16] = {};
+		uint32_t flags = 0;
+	};
+	LocalVector<Entry> entries;
+	entries.resize(file_count);
+
 	for (int i = 0; i < file_count; i++) {
+		Entry &entry = entries[i];
 		uint32_t sl = f->get_32();
 		CharString cs;
 		cs.resize(sl + 1);
 		f->get_buffer((uint8_t *)cs.ptr(), sl);
 		cs[sl] = 0;
 
-		String path;
-		path.parse_utf8(cs.ptr());
-
-		uint64_t ofs = file_base + f->get_64();
-		uint64_t size = f->get_64();
-		uint8_t md5[16];
-		f->get_buffer(md5, 16);
-		uint32_t flags = f->get_32();
-
-		PackedData::get_singleton()->add_path(p_path, path, ofs + p_offset, size, md5, this, p_replace_files, (flags & PACK_FILE_ENCRYPTED));
+		entry.path.parse_utf8(cs.ptr());
+		entry.ofs = file_base + f->get_64();
+		entry.size = f->get_64();
+		f->get_buffer(entry.md5, 16);
+		entry.flags = f->get_32();
+		// Reading such a file would silently return data in a format this version doesn't know.
+		// The whole pack is rejected before any of its files is added.
+		ERR_FAIL_COND_V_MSG(entry.flags & ~PACK_FILE_FLAGS_SUPPORTED, false, "Pack file '" + entry.path + "' uses unsupported features (flags " + itos(entry.flags) + ").");
+	}
+
+	if (dictionary.is_valid()) {
+		MutexLock lock(mutex);
+		dictionaries[p_path] = dictionary;
+	}
+	for (uint32_t i = 0; i < entries.size(); i++) {
+		const Entry &entry = entries[i];
+		PackedData::get_singleton()->add_path(p_path, entry.path, entry.ofs + p_offset, entry.size, entry.md5, this, p_replace_files, (entry.flags & PACK_FILE_ENCRYPTED), (entry.flags & PACK_FILE_COMPRESSED));
+	}
+
+	MutexLock lock(mutex);
+	if (!mapped_packs.has(p_path)) {
+		Ref<FileAccess> mf = FileAccess::open(p_path, FileAccess::READ);
+		MappedPack mapped;
+		mapped.data = mf.is_valid() ? mf->map_contents(mapped.length) : nullptr;
+		if (mapped.data) {
+			mapped.file = mf;
+			mapped_packs[p_path] = mapped;
+		}
 	}
 
 	return true;
 }
 
 Ref<FileAccess> PackedSourcePCK::get_file(const String &p_path, PackedData::PackedFile *p_file) {
-	return memnew(FileAccessPack(p_path, *p_file));
+	MappedPack mapped;
+	Ref<CompressionDictionary> dictionary;
+	{
+		MutexLock lock(mutex);
+		// Encrypted files still need to be decrypted through a regular file.
+		const MappedPack *mapped_pack = p_file->encrypted ? nullptr : mapped_packs.getptr(p_file->pack);
+		if (mapped_pack) {
+			mapped = *mapped_pack;
+		}
+		if (p_file->compressed) {
+			const Ref<CompressionDictionary> *pack_dictionary = dictionaries.getptr(p_file->pack);
+			if (pack_dictionary) {
+				dictionary = *pack_dictionary;
+			}
+		}
+	}
+
+	Ref<FileAccess> fa;
+	if (mapped.data && p_file->offset <= mapped.length && p_file->size <= mapped.length - p_file->offset) {
+		fa = Ref<FileAccess>(memnew(FileAccessPack(p_path, *p_file, mapped.file, mapped.data + p_file->offset)));
+	} else {
+		fa = Ref<FileAccess>(memnew(FileAccessPack(p_path, *p_file)));
+	}
+
+	if (!p_file->compressed) {
+		return fa;
+	}
+
+	// Blocks are only decompressed when read, so seeking in large files stays cheap.
+	uint8_t magic[4] = { 0, 0, 0, 0 };
+	fa->get_buffer(magic, 4);
+	ERR_FAIL_COND_V_MSG(memcmp(magic, PACK_COMPRESSED_FILE_MAGIC, 4) != 0, Ref<FileAccess>(), "Compressed pack-referenced file '" + p_path + "' is corrupt.");
+
+	Ref<FileAccessCompressed> fac;
+	fac.instantiate();
+	if (dictionary.is_valid()) {
+		fac->set_dictionary(dictionary);
+	}
+	Error err = fac->open_after_magic(fa);
+	ERR_FAIL_COND_V_MSG(err != OK, Ref<FileAccess>(), "Can't open compressed pack-referenced file '" + p_path + "'.");
+	return fac;
 }
 
 //////////////////////////////////////////////////////////////////
@@ -281,7 +370,9 @@ void FileAccessPack::seek(uint64_t p_position) {
 		eof = false;
 	}
 
-	f->seek(off + p_position);
+	if (!mapped) {
+		f->seek(off + p_position);
+	}
 	pos = p_position;
 }
 
@@ -308,6 +399,9 @@ uint8_t FileAccessPack::get_8() const {
 		return 0;
 	}
 
+	if (mapped) {
+		return mapped[pos++];
+	}
 	pos++;
 	return f->get_8();
 }
@@ -326,21 +420,65 @@ uint64_t FileAccessPack::get_buffer(uint8_t *p_dst, uint64_t p_length) const {
 		to_read = (int64_t)pf.size - (int64_t)pos;
 	}
 
-	pos += p_length;
-
 	if (to_read <= 0) {
+		pos += p_length;
 		return 0;
 	}
-	f->get_buffer(p_dst, to_read);
+	if (mapped) {
+		memcpy(p_dst, mapped + pos, to_read);
+	} else {
+		f->get_buffer(p_dst, to_read);
+	}
+	pos += p_length;
 
 	return to_read;
 }
 
+const uint8_t *FileAccessPack::get_buffer_view(uint64_t p_length) const {
+	ERR_FAIL_COND_V_MSG(f.is_null(), nullptr, "File must be opened before use.");
+	if (!mapped || eof || pos > pf.size || p_length > pf.size - pos) {
+		return nullptr;
+	}
+
+	const uint8_t *view = mapped + pos;
+	pos += p_length;
+	return view;
+}
+
+FileAccess::AsyncReadID FileAccessPack::read_async(uint64_t p_position, uint8_t *p_dst, uint64_t p_length) {
+	ERR_FAIL_COND_V_MSG(f.is_null(), INVALID_ASYNC_READ_ID, "File must be opened before use.");
+	if (mapped) {
+		return FileAccess::read_async(p_position, p_dst, p_length); // Just a copy, f is shared with the other mapped files.
+	}
+
+	// Read straight from the pack file (or the decrypted data), clamped to this file.
+	uint64_t length = p_position < pf.size ? MIN(p_length, pf.size - p_position) : 0;
+	return f->read_async(off + p_position, p_dst, length);
+}
+
+bool FileAccessPack::is_async_read_completed(AsyncReadID p_id) const {
+	ERR_FAIL_COND_V_MSG(f.is_null(), false, "File must be opened before use.");
+	if (mapped) {
+		return FileAccess::is_async_read_completed(p_id);
+	}
+	return f->is_async_read_completed(p_id);
+}
+
+uint64_t FileAccessPack::wait_async_read(AsyncReadID p_id, Error *r_error) {
+	ERR_FAIL_COND_V_MSG(f.is_null(), 0, "File must be opened before use.");
+	if (mapped) {
+		return FileAccess::wait_async_read(p_id, r_error);
+	}
+	return f->wait_async_read(p_id, r_error);
+}
+
 void FileAccessPack::set_big_endian(bool p_big_endian) {
 	ERR_FAIL_COND_MSG(f.is_null(), "File must be opened before use.");
 
 	FileAccess::set_big_endian(p_big_endian);
-	f->set_big_endian(p_big_endian);
+	if (!mapped) {
+		f->set_big_endian(p_big_endian);
+	}
 }
 
 Error FileAccessPack::get_error() const {
@@ -394,6 +532,15 @@ FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFil
 	eof = false;
 }
 
+FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file, const Ref<FileAccess> &p_pack, const uint8_t *p_data) :
+		pf(p_file),
+		pos(0),
+		eof(false),
+		off(0),
+		f(p_pack),
+		mapped(p_data) {
+}
+
 //////////////////////////////////////////////////////////////////////////////////
 // DIR ACCESS
 //////////////////////////////////////////////////////////////////////////////////
@@ -31,8 +31,10 @@
 #ifndef FILE_ACCESS_PACK_H
 #define FILE_ACCESS_PACK_H
 
+#include "core/io/compression.h"
 #include "core/io/dir_access.h"
 #include "core/io/file_access.h"
+#include "core/os/mutex.h"
 #include "core/string/print_string.h"
 #include "core/templates/hash_set.h"
 #include "core/templates/list.h"
@@ -41,14 +43,25 @@
 // Godot's packed file magic header ("GDPC" in ASCII).
 #define PACK_HEADER_MAGIC 0x43504447
 // The current packed file format version number.
-#define PACK_FORMAT_VERSION 2
+// Version 3 added compressed files and the shared compression dictionary, version 2 packs can still be read.
+#define PACK_FORMAT_VERSION 3
+#define PACK_FORMAT_VERSION_MIN 2
+
+// Magic of the files stored compressed in a pack, in the FileAccessCompressed format.
+#define PACK_COMPRESSED_FILE_MAGIC "GCPF"
 
 enum PackFlags {
-	PACK_DIR_ENCRYPTED = 1 << 0
+	PACK_DIR_ENCRYPTED = 1 << 0,
+	// The pack stores a ZSTD dictionary shared by its compressed files. Its offset (relative to the files base)
+	// and size are stored in the first reserved fields of the header.
+	PACK_COMPRESSION_DICTIONARY = 1 << 1,
+	PACK_FLAGS_SUPPORTED = PACK_DIR_ENCRYPTED | PACK_COMPRESSION_DICTIONARY, // Packs with other flags are rejected.
 };
 
 enum PackFileFlags {
-	PACK_FILE_ENCRYPTED = 1 << 0
+	PACK_FILE_ENCRYPTED = 1 << 0,
+	PACK_FILE_COMPRESSED = 1 << 1,
+	PACK_FILE_FLAGS_SUPPORTED = PACK_FILE_ENCRYPTED | PACK_FILE_COMPRESSED,
 };
 
 class PackSource;
@@ -66,6 +79,7 @@ public:
 		uint8_t md5[16];
 		PackSource *src = nullptr;
 		bool encrypted;
+		bool compressed = false; // Size is the compressed size then.
 	};
 
 private:
@@ -109,7 +123,7 @@ private:
 
 public:
 	void add_pack_source(PackSource *p_source);
-	void add_path(const String &p_pkg_path, const String &p_path, uint64_t p_ofs, uint64_t p_size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, bool p_encrypted = false); // for PackSource
+	void add_path(const String &p_pkg_path, const String &p_path, uint64_t p_ofs, uint64_t p_size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, bool p_encrypted = false, bool p_compressed = false); // for PackSource
 
 	void set_disabled(bool p_disabled) { disabled = p_disabled; }
 	_FORCE_INLINE_ bool is_disabled() const { return disabled; }
@@ -135,6 +149,19 @@ public:
 };
 
 class PackedSourcePCK : public PackSource {
+	// Packs mapped in memory, when the platform supports it. Files are then
+	// served straight from the mapping, without opening the pack again.
+	struct MappedPack {
+		Ref<FileAccess> file;
+		const uint8_t *data = nullptr;
+		uint64_t length = 0;
+	};
+
+	// Packs can be opened while files are being loaded on other threads.
+	Mutex mutex;
+	HashMap<String, MappedPack> mapped_packs;
+	HashMap<String, Ref<CompressionDictionary>> dictionaries;
+
 public:
 	virtual bool try_open_pack(const String &p_path, bool p_replace_files, uint64_t p_offset) override;
 	virtual Ref<FileAccess> get_file(const String &p_path, PackedData::PackedFile *p_file) override;
@@ -148,6 +175,8 @@ class FileAccessPack : public FileAccess {
 	uint64_t off;
 
 	Ref<FileAccess> f;
+	// Start of the file inside a mapped pack, f only keeps the mapping alive then.
+	const uint8_t *mapped = nullptr;
 	virtual Error open_internal(const String &p_path, int p_mode_flags) override;
 	virtual uint64_t _get_modified_time(const String &p_file) override { return 0; }
 	virtual uint32_t _get_unix_permissions(const String &p_file) override { return 0; }
@@ -166,6 +195,10 @@ public:
 	virtual uint8_t get_8() const override;
 
 	virtual uint64_t get_buffer(uint8_t *p_dst, uint64_t p_length) const override;
+	virtual const uint8_t *get_buffer_view(uint64_t p_length) const override;
+	virtual AsyncReadID read_async(uint64_t p_position, uint8_t *p_dst, uint64_t p_length) override;
+	virtual bool is_async_read_completed(AsyncReadID p_id) const override;
+	virtual uint64_t wait_async_read(AsyncReadID p_id, Error *r_error = nullptr) override;
 
 	virtual void set_big_endian(bool p_big_endian) override;
 
@@ -179,6 +212,7 @@ public:
 	virtual bool file_exists(const String &p_name) override;
 
 	FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file);
+	FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file, const Ref<FileAccess> &p_pack, const uint8_t *p_data);
 };
 
 Ref<FileAccess> PackedData::try_open_path(const String &p_path) {
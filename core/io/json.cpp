@@ -30,6 +30,7 @@
 
 #include "json.h"
 
+#include "core/io/json_stream.h"
 #include "core/string/print_string.h"
 
 const char *JSON::tk_name[TK_MAX] = {
@@ -589,18 +590,25 @@ Ref<Resource> ResourceFormatLoaderJSON::load(const String &p_path, const String
 		return Ref<Resource>();
 	}
 
-	Ref<JSON> json;
-	json.instantiate();
+	Ref<FileAccess> file = FileAccess::open(p_path, FileAccess::READ);
+	ERR_FAIL_COND_V_MSG(file.is_null(), Ref<Resource>(), "Cannot open JSON file '" + p_path + "'.");
 
-	Error err = json->parse(FileAccess::get_file_as_string(p_path));
+	// Parse straight from the file, without decoding it into a String first.
+	JSONReader reader;
+	Variant data;
+	Error err = reader.parse_variant(file, data);
 	if (err != OK) {
 		if (r_error) {
 			*r_error = err;
 		}
-		ERR_PRINT("Error parsing JSON file at '" + p_path + "', on line " + itos(json->get_error_line()) + ": " + json->get_error_message());
+		ERR_PRINT("Error parsing JSON file at '" + p_path + "', on line " + itos(reader.get_error_line()) + ": " + reader.get_error_message());
 		return Ref<Resource>();
 	}
 
+	Ref<JSON> json;
+	json.instantiate();
+	json->set_data(data);
+
 	if (r_error) {
 		*r_error = OK;
 	}
@@ -628,15 +636,14 @@ Error ResourceFormatSaverJSON::save(const Ref<Resource> &p_resource, const Strin
 	Ref<JSON> json = p_resource;
 	ERR_FAIL_COND_V(json.is_null(), ERR_INVALID_PARAMETER);
 
-	String source = JSON::stringify(json->get_data(), "\t", false, true);
-
 	Error err;
 	Ref<FileAccess> file = FileAccess::open(p_path, FileAccess::WRITE, &err);
 
 	ERR_FAIL_COND_V_MSG(err, err, "Cannot save json '" + p_path + "'.");
 
-	file->store_string(source);
-	if (file->get_error() != OK && file->get_error() != ERR_FILE_EOF) {
+	JSONWriter writer(file, "\t", true);
+	writer.write_variant(json->get_data(), false);
+	if (writer.flush() != OK) {
 		return ERR_CANT_CREATE;
 	}
 
@@ -0,0 +1,883 @@
+/*************************************************************************/
+/*  json_stream.cpp                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "json_stream.h"
+
+/////////////////////////////////////////////////////////////////////////////
+// JSONReader
+
+namespace {
+
+// Builds the Variant tree JSON::parse() returns: all numbers become floats.
+class JSONVariantBuilder : public JSONStreamHandler {
+	struct Container {
+		Array array;
+		Dictionary dictionary;
+		bool is_array = false;
+	};
+
+	LocalVector<Container> stack;
+	String key;
+
+	void _add(const Variant &p_value) {
+		if (stack.is_empty()) {
+			result = p_value;
+		} else if (stack[stack.size() - 1].is_array) {
+			stack[stack.size() - 1].array.push_back(p_value);
+		} else {
+			stack[stack.size() - 1].dictionary[key] = p_value;
+		}
+	}
+
+public:
+	Variant result;
+
+	virtual Error on_null() override {
+		_add(Variant());
+		return OK;
+	}
+	virtual Error on_bool(bool p_value) override {
+		_add(p_value);
+		return OK;
+	}
+	virtual Error on_float(double p_value) override {
+		_add(p_value);
+		return OK;
+	}
+	virtual Error on_string(const char *p_utf8, int p_length) override {
+		_add(String::utf8(p_utf8, p_length));
+		return OK;
+	}
+	virtual Error on_key(const char *p_utf8, int p_length) override {
+		key = String::utf8(p_utf8, p_length);
+		return OK;
+	}
+	virtual Error on_array_begin() override {
+		Container container;
+		container.is_array = true;
+		// Containers are shared, so they can be added before being filled.
+		_add(container.array);
+		stack.push_back(container);
+		return OK;
+	}
+	virtual Error on_array_end() override {
+		stack.resize(stack.size() - 1);
+		return OK;
+	}
+	virtual Error on_object_begin() override {
+		Container container;
+		_add(container.dictionary);
+		stack.push_back(container);
+		return OK;
+	}
+	virtual Error on_object_end() override {
+		stack.resize(stack.size() - 1);
+		return OK;
+	}
+};
+
+} // namespace
+
+static _FORCE_INLINE_ bool _is_number_char(uint8_t p_char) {
+	return is_digit(p_char) || p_char == '-' || p_char == '+' || p_char == '.' || p_char == 'e' || p_char == 'E';
+}
+
+// Checks the JSON number grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+static bool _is_valid_number(const char *p_str, int p_len) {
+	int i = 0;
+	if (i < p_len && p_str[i] == '-') {
+		i++;
+	}
+	if (i == p_len || !is_digit(p_str[i])) {
+		return false;
+	}
+	if (p_str[i] == '0') {
+		i++;
+	} else {
+		while (i < p_len && is_digit(p_str[i])) {
+			i++;
+		}
+	}
+	if (i < p_len && p_str[i] == '.') {
+		i++;
+		if (i == p_len || !is_digit(p_str[i])) {
+			return false;
+		}
+		while (i < p_len && is_digit(p_str[i])) {
+			i++;
+		}
+	}
+	if (i < p_len && (p_str[i] == 'e' || p_str[i] == 'E')) {
+		i++;
+		if (i < p_len && (p_str[i] == '+' || p_str[i] == '-')) {
+			i++;
+		}
+		if (i == p_len || !is_digit(p_str[i])) {
+			return false;
+		}
+		while (i < p_len && is_digit(p_str[i])) {
+			i++;
+		}
+	}
+	return i == p_len;
+}
+
+static void _append_utf8(LocalVector<char> &r_buffer, uint32_t p_char) {
+	if (p_char <= 0x7f) {
+		r_buffer.push_back(char(p_char));
+	} else if (p_char <= 0x7ff) {
+		r_buffer.push_back(char(0xc0 | (p_char >> 6)));
+		r_buffer.push_back(char(0x80 | (p_char & 0x3f)));
+	} else if (p_char <= 0xffff) {
+		r_buffer.push_back(char(0xe0 | (p_char >> 12)));
+		r_buffer.push_back(char(0x80 | ((p_char >> 6) & 0x3f)));
+		r_buffer.push_back(char(0x80 | (p_char & 0x3f)));
+	} else {
+		r_buffer.push_back(char(0xf0 | (p_char >> 18)));
+		r_buffer.push_back(char(0x80 | ((p_char >> 12) & 0x3f)));
+		r_buffer.push_back(char(0x80 | ((p_char >> 6) & 0x3f)));
+		r_buffer.push_back(char(0x80 | (p_char & 0x3f)));
+	}
+}
+
+bool JSONReader::_refill() {
+	if (file.is_null()) {
+		return false;
+	}
+	uint64_t read = file->get_buffer(chunk.ptr(), CHUNK_SIZE);
+	ptr = chunk.ptr();
+	end = ptr + read;
+	return read > 0;
+}
+
+Error JSONReader::_set_error(Error p_error, const String &p_message) {
+	err_str = p_message;
+	err_line = line;
+	return p_error;
+}
+
+// Skips whitespace and returns the next character without consuming it, or -1 at the end.
+int JSONReader::_peek_token() {
+	while (_has_data()) {
+		uint8_t c = *ptr;
+		if (c > 32) {
+			return c;
+		}
+		if (c == 0) {
+			return -1;
+		}
+		if (c == '\n') {
+			line++;
+		}
+		ptr++;
+	}
+	return -1;
+}
+
+Error JSONReader::_read_hex(uint32_t &r_value) {
+	r_value = 0;
+	for (int i = 0; i < 4; i++) {
+		if (!_has_data() || *ptr == 0) {
+			return _set_error(ERR_PARSE_ERROR, "Unterminated String");
+		}
+		uint8_t c = *(ptr++);
+		uint32_t v;
+		if (is_digit(c)) {
+			v = c - '0';
+		} else if (c >= 'a' && c <= 'f') {
+			v = c - 'a' + 10;
+		} else if (c >= 'A' && c <= 'F') {
+			v = c - 'A' + 10;
+		} else {
+			return _set_error(ERR_PARSE_ERROR, "Malformed hex constant in string");
+		}
+		r_value = (r_value << 4) | v;
+	}
+	return OK;
+}
+
+// Reads a string after its opening quote. Strings without escapes that don't
+// cross a chunk boundary are returned in place, everything else is
+// assembled in the scratch buffer.
+Error JSONReader::_read_string(const char *&r_str, int &r_len) {
+	scratch.clear();
+	bool copied = false;
+
+	while (true) {
+		const uint8_t *p = ptr;
+		while (p != end && *p != '"' && *p != '\\' && *p != '\n' && *p != 0) {
+			p++;
+		}
+
+		if (p == end) {
+			for (; ptr != end; ptr++) {
+				scratch.push_back(char(*ptr));
+			}
+			copied = true;
+			if (!_refill()) {
+				return _set_error(ERR_PARSE_ERROR, "Unterminated String");
+			}
+			continue;
+		}
+
+		const uint8_t c = *p;
+		if (c == '"' && !copied) {
+			r_str = (const char *)ptr;
+			r_len = p - ptr;
+			ptr = p + 1;
+			return OK;
+		}
+
+		for (; ptr != p; ptr++) {
+			scratch.push_back(char(*ptr));
+		}
+		copied = true;
+		ptr++;
+
+		if (c == '"') {
+			r_str = scratch.ptr();
+			r_len = scratch.size();
+			return OK;
+		} else if (c == '\n') {
+			line++;
+			scratch.push_back('\n');
+			continue;
+		} else if (c == 0) {
+			return _set_error(ERR_PARSE_ERROR, "Unterminated String");
+		}
+
+		// Escaped characters.
+		if (!_has_data() || *ptr == 0) {
+			return _set_error(ERR_PARSE_ERROR, "Unterminated String");
+		}
+		const uint8_t next = *(ptr++);
+		switch (next) {
+			case 'b':
+				scratch.push_back(8);
+				break;
+			case 't':
+				scratch.push_back(9);
+				break;
+			case 'n':
+				scratch.push_back(10);
+				break;
+			case 'f':
+				scratch.push_back(12);
+				break;
+			case 'r':
+				scratch.push_back(13);
+				break;
+			case 'u': {
+				uint32_t res;
+				Error err = _read_hex(res);
+				if (err) {
+					return err;
+				}
+				if ((res & 0xfffffc00) == 0xd800) {
+					if (!_has_data() || *(ptr++) != '\\' || !_has_data() || *(ptr++) != 'u') {
+						return _set_error(ERR_PARSE_ERROR, "Invalid UTF-16 sequence in string, unpaired lead surrogate");
+					}
+					uint32_t trail;
+					err = _read_hex(trail);
+					if (err) {
+						return err;
+					}
+					if ((trail & 0xfffffc00) != 0xdc00) {
+						return _set_error(ERR_PARSE_ERROR, "Invalid UTF-16 sequence in string, unpaired lead surrogate");
+					}
+					res = (res << 10UL) + trail - ((0xd800 << 10UL) + 0xdc00 - 0x10000);
+				} else if ((res & 0xfffffc00) == 0xdc00) {
+					return _set_error(ERR_PARSE_ERROR, "Invalid UTF-16 sequence in string, unpaired trail surrogate");
+				}
+				_append_utf8(scratch, res);
+			} break;
+			default: {
+				scratch.push_back(char(next));
+			} break;
+		}
+	}
+}
+
+Error JSONReader::_read_number(JSONStreamHandler *p_handler) {
+	scratch.clear();
+	while (_has_data() && _is_number_char(*ptr)) {
+		scratch.push_back(char(*(ptr++)));
+	}
+
+	const char *str = scratch.ptr();
+	int len = scratch.size();
+	if (!_is_valid_number(str, len)) {
+		return _set_error(ERR_PARSE_ERROR, "Malformed number '" + String::utf8(str, len) + "'.");
+	}
+
+	// Plain integers are reported exactly, as long as they fit.
+	bool negative = str[0] == '-';
+	int digits = len - (negative ? 1 : 0);
+	if (digits > 0 && digits <= 18) {
+		int64_t value = 0;
+		int i = negative ? 1 : 0;
+		for (; i < len && is_digit(str[i]); i++) {
+			value = value * 10 + (str[i] - '0');
+		}
+		if (i == len) {
+			return p_handler->on_int(negative ? -value : value);
+		}
+	}
+
+	scratch.push_back(0);
+	return p_handler->on_float(String::to_float(scratch.ptr()));
+}
+
+Error JSONReader::_read_identifier(JSONStreamHandler *p_handler) {
+	scratch.clear();
+	while (_has_data() && is_ascii_char(*ptr)) {
+		scratch.push_back(char(*(ptr++)));
+	}
+
+	const char *id = scratch.ptr();
+	int len = scratch.size();
+	if (len == 4 && memcmp(id, "true", 4) == 0) {
+		return p_handler->on_bool(true);
+	} else if (len == 5 && memcmp(id, "false", 5) == 0) {
+		return p_handler->on_bool(false);
+	} else if (len == 4 && memcmp(id, "null", 4) == 0) {
+		return p_handler->on_null();
+	}
+	return _set_error(ERR_PARSE_ERROR, "Expected 'true','false' or 'null', got '" + String::utf8(id, len) + "'.");
+}
+
+Error JSONReader::_parse_value(int p_char, JSONStreamHandler *p_handler) {
+	Error err = OK;
+	if (p_char == '{' || p_char == '[') {
+		if (stack.size() >= Variant::MAX_RECURSION_DEPTH) {
+			return _set_error(ERR_OUT_OF_MEMORY, "JSON structure is too deep. Bailing.");
+		}
+		ptr++;
+		if (p_char == '{') {
+			stack.push_back(CONTAINER_OBJECT);
+			state = STATE_KEY;
+			return p_handler->on_object_begin();
+		}
+		stack.push_back(CONTAINER_ARRAY);
+		state = STATE_VALUE;
+		return p_handler->on_array_begin();
+	} else if (p_char == '"') {
+		ptr++;
+		const char *str;
+		int len;
+		err = _read_string(str, len);
+		if (err) {
+			return err;
+		}
+		err = p_handler->on_string(str, len);
+	} else if (p_char == '-' || is_digit(p_char)) {
+		err = _read_number(p_handler);
+	} else if (is_ascii_char(p_char)) {
+		err = _read_identifier(p_handler);
+	} else if (p_char == '}' || p_char == ']' || p_char == ':' || p_char == ',') {
+		const char *name = p_char == '}' ? "'}'" : (p_char == ']' ? "']'" : (p_char == ':' ? "':'" : "','"));
+		return _set_error(ERR_PARSE_ERROR, "Expected value, got " + String(name) + ".");
+	} else {
+		return _set_error(ERR_PARSE_ERROR, "Unexpected character.");
+	}
+
+	state = stack.is_empty() ? STATE_DONE : STATE_AFTER_VALUE;
+	return err;
+}
+
+Error JSONReader::_close_container(JSONStreamHandler *p_handler) {
+	ptr++;
+	Container container = stack[stack.size() - 1];
+	stack.resize(stack.size() - 1);
+	state = stack.is_empty() ? STATE_DONE : STATE_AFTER_VALUE;
+	return container == CONTAINER_ARRAY ? p_handler->on_array_end() : p_handler->on_object_end();
+}
+
+Error JSONReader::_parse(JSONStreamHandler *p_handler) {
+	ERR_FAIL_NULL_V(p_handler, ERR_INVALID_PARAMETER);
+
+	err_str = String();
+	err_line = 0;
+	line = 0;
+	stack.clear();
+	state = STATE_VALUE;
+
+	// Skip the UTF-8 BOM, like String::parse_utf8() does.
+	if (_has_data() && *ptr == 0xef) {
+		ptr++;
+		if (!_has_data() || *(ptr++) != 0xbb || !_has_data() || *(ptr++) != 0xbf) {
+			return _set_error(ERR_PARSE_ERROR, "Unexpected character.");
+		}
+	}
+
+	while (true) {
+		const int c = _peek_token();
+		if (state == STATE_DONE) {
+			return c < 0 ? OK : _set_error(ERR_PARSE_ERROR, "Expected 'EOF'");
+		}
+		if (c < 0) {
+			if (stack.is_empty()) {
+				return _set_error(ERR_PARSE_ERROR, "Expected value, got EOF.");
+			}
+			return _set_error(ERR_PARSE_ERROR, stack[stack.size() - 1] == CONTAINER_ARRAY ? "Expected ']'" : "Expected '}'");
+		}
+
+		Error err = OK;
+		switch (state) {
+			case STATE_VALUE: {
+				// Empty arrays, and trailing commas like JSON::parse() allows.
+				if (c == ']' && !stack.is_empty() && stack[stack.size() - 1] == CONTAINER_ARRAY) {
+					err = _close_container(p_handler);
+				} else {
+					err = _parse_value(c, p_handler);
+				}
+			} break;
+			case STATE_KEY: {
+				if (c == '}') {
+					err = _close_container(p_handler);
+					break;
+				}
+				if (c != '"') {
+					return _set_error(ERR_PARSE_ERROR, "Expected key");
+				}
+				ptr++;
+				const char *str;
+				int len;
+				err = _read_string(str, len);
+				if (err) {
+					return err;
+				}
+				state = STATE_COLON;
+				err = p_handler->on_key(str, len);
+			} break;
+			case STATE_COLON: {
+				if (c != ':') {
+					return _set_error(ERR_PARSE_ERROR, "Expected ':'");
+				}
+				ptr++;
+				state = STATE_VALUE;
+			} break;
+			case STATE_AFTER_VALUE: {
+				const bool array = stack[stack.size() - 1] == CONTAINER_ARRAY;
+				if (c == ',') {
+					ptr++;
+					state = array ? STATE_VALUE : STATE_KEY;
+				} else if (c == (array ? ']' : '}')) {
+					err = _close_container(p_handler);
+				} else {
+					return _set_error(ERR_PARSE_ERROR, array ? "Expected ','" : "Expected '}' or ','");
+				}
+			} break;
+			case STATE_DONE: {
+			} break;
+		}
+
+		if (err != OK) {
+			if (err_str.is_empty()) {
+				_set_error(err, "Parsing stopped by the handler.");
+			}
+			return err;
+		}
+	}
+}
+
+Error JSONReader::parse(const uint8_t *p_data, int64_t p_length, JSONStreamHandler *p_handler) {
+	ERR_FAIL_COND_V(!p_data && p_length > 0, ERR_INVALID_PARAMETER);
+	file.unref();
+	ptr = p_data;
+	end = p_data + p_length;
+	return _parse(p_handler);
+}
+
+Error JSONReader::parse(const Ref<FileAccess> &p_file, JSONStreamHandler *p_handler) {
+	ERR_FAIL_COND_V(p_file.is_null(), ERR_INVALID_PARAMETER);
+	file = p_file;
+	chunk.resize(CHUNK_SIZE);
+	ptr = end = nullptr;
+	Error err = _parse(p_handler);
+	file.unref();
+	return err;
+}
+
+Error JSONReader::parse_variant(const uint8_t *p_data, int64_t p_length, Variant &r_ret) {
+	JSONVariantBuilder builder;
+	Error err = parse(p_data, p_length, &builder);
+	r_ret = err == OK ? builder.result : Variant();
+	return err;
+}
+
+Error JSONReader::parse_variant(const Ref<FileAccess> &p_file, Variant &r_ret) {
+	JSONVariantBuilder builder;
+	Error err = parse(p_file, &builder);
+	r_ret = err == OK ? builder.result : Variant();
+	return err;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JSONWriter
+
+void JSONWriter::_put(const char *p_data, uint32_t p_length) {
+	while (p_length) {
+		if (used == BUFFER_SIZE) {
+			flush();
+		}
+		uint32_t n = MIN(p_length, uint32_t(BUFFER_SIZE) - used);
+		memcpy(buffer + used, p_data, n);
+		used += n;
+		p_data += n;
+		p_length -= n;
+	}
+}
+
+void JSONWriter::_put_indent(int p_depth) {
+	for (int i = 0; i < p_depth; i++) {
+		for (int j = 0; j < indent.length(); j++) {
+			_put_char(char(indent[j]));
+		}
+	}
+}
+
+// Same escapes as String::json_escape().
+static _FORCE_INLINE_ const char *_json_escape(uint32_t p_char) {
+	switch (p_char) {
+		case '\\':
+			return "\\\\";
+		case '\b':
+			return "\\b";
+		case '\f':
+			return "\\f";
+		case '\n':
+			return "\\n";
+		case '\r':
+			return "\\r";
+		case '\t':
+			return "\\t";
+		case '\v':
+			return "\\v";
+		case '"':
+			return "\\\"";
+		default:
+			return nullptr;
+	}
+}
+
+void JSONWriter::_put_escaped(const String &p_string) {
+	const char32_t *str = p_string.ptr();
+	const int len = p_string.length();
+	_put_char('"');
+	for (int i = 0; i < len; i++) {
+		const uint32_t c = str[i];
+		if (c <= 0x7f) {
+			const char *escape = _json_escape(c);
+			if (escape) {
+				_put(escape, 2);
+			} else {
+				_put_char(char(c));
+			}
+		} else if (c <= 0x7ff) {
+			_put_char(char(0xc0 | (c >> 6)));
+			_put_char(char(0x80 | (c & 0x3f)));
+		} else if (c <= 0xffff) {
+			_put_char(char(0xe0 | (c >> 12)));
+			_put_char(char(0x80 | ((c >> 6) & 0x3f)));
+			_put_char(char(0x80 | (c & 0x3f)));
+		} else if (c <= 0x10ffff) {
+			_put_char(char(0xf0 | (c >> 18)));
+			_put_char(char(0x80 | ((c >> 12) & 0x3f)));
+			_put_char(char(0x80 | ((c >> 6) & 0x3f)));
+			_put_char(char(0x80 | (c & 0x3f)));
+		} else {
+			// Not valid Unicode, let String report it the usual way.
+			CharString utf8 = String::chr(c).utf8();
+			_put(utf8.get_data(), utf8.length());
+		}
+	}
+	_put_char('"');
+}
+
+void JSONWriter::_put_escaped(const char *p_utf8, int p_length) {
+	_put_char('"');
+	for (int i = 0; i < p_length; i++) {
+		const char *escape = _json_escape(uint8_t(p_utf8[i]));
+		if (escape) {
+			_put(escape, 2);
+		} else {
+			_put_char(p_utf8[i]);
+		}
+	}
+	_put_char('"');
+}
+
+void JSONWriter::_begin_value() {
+	if (levels.is_empty()) {
+		return;
+	}
+	Level &level = levels[levels.size() - 1];
+	if (level.object) {
+		ERR_FAIL_COND_MSG(!level.has_key, "A key must be written before each value of a JSON object.");
+		level.has_key = false;
+		return;
+	}
+	if (level.count > 0) {
+		_put_char(',');
+		if (!indent.is_empty()) {
+			_put_char('\n');
+		}
+	}
+	_put_indent(levels.size());
+	level.count++;
+}
+
+void JSONWriter::_begin_container(bool p_object, char p_char) {
+	_begin_value();
+	_put_char(p_char);
+	if (!indent.is_empty()) {
+		_put_char('\n');
+	}
+	Level level;
+	level.object = p_object;
+	levels.push_back(level);
+}
+
+void JSONWriter::_end_container(bool p_object, char p_char) {
+	ERR_FAIL_COND_MSG(levels.is_empty() || levels[levels.size() - 1].object != p_object, "Mismatched end of JSON array or object.");
+	levels.resize(levels.size() - 1);
+	if (!indent.is_empty()) {
+		_put_char('\n');
+	}
+	_put_indent(levels.size());
+	_put_char(p_char);
+}
+
+void JSONWriter::begin_array() {
+	_begin_container(false, '[');
+}
+
+void JSONWriter::end_array() {
+	_end_container(false, ']');
+}
+
+void JSONWriter::begin_object() {
+	_begin_container(true, '{');
+}
+
+void JSONWriter::end_object() {
+	_end_container(true, '}');
+}
+
+void JSONWriter::write_key(const String &p_key) {
+	ERR_FAIL_COND_MSG(levels.is_empty() || !levels[levels.size() - 1].object || levels[levels.size() - 1].has_key, "Keys can only be written inside JSON objects, once per value.");
+	Level &level = levels[levels.size() - 1];
+	if (level.count > 0) {
+		_put_char(',');
+		if (!indent.is_empty()) {
+			_put_char('\n');
+		}
+	}
+	_put_indent(levels.size());
+	_put_escaped(p_key);
+	_put_char(':');
+	if (!indent.is_empty()) {
+		_put_char(' ');
+	}
+	level.count++;
+	level.has_key = true;
+}
+
+void JSONWriter::write_key(const char *p_utf8, int p_length) {
+	ERR_FAIL_COND_MSG(levels.is_empty() || !levels[levels.size() - 1].object || levels[levels.size() - 1].has_key, "Keys can only be written inside JSON objects, once per value.");
+	Level &level = levels[levels.size() - 1];
+	if (level.count > 0) {
+		_put_char(',');
+		if (!indent.is_empty()) {
+			_put_char('\n');
+		}
+	}
+	_put_indent(levels.size());
+	_put_escaped(p_utf8, p_length);
+	_put_char(':');
+	if (!indent.is_empty()) {
+		_put_char(' ');
+	}
+	level.count++;
+	level.has_key = true;
+}
+
+void JSONWriter::write_null() {
+	_begin_value();
+	_put("null", 4);
+}
+
+void JSONWriter::write_bool(bool p_value) {
+	_begin_value();
+	if (p_value) {
+		_put("true", 4);
+	} else {
+		_put("false", 5);
+	}
+}
+
+void JSONWriter::write_int(int64_t p_value) {
+	_begin_value();
+	char digits[24];
+	int pos = sizeof(digits);
+	uint64_t value = p_value < 0 ? 0 - uint64_t(p_value) : uint64_t(p_value);
+	do {
+		digits[--pos] = char('0' + value % 10);
+		value /= 10;
+	} while (value);
+	if (p_value < 0) {
+		digits[--pos] = '-';
+	}
+	_put(digits + pos, sizeof(digits) - pos);
+}
+
+void JSONWriter::write_float(double p_value) {
+	_begin_value();
+	// Store unreliable digits (17) in full precision so that the value can be
+	// decoded exactly, otherwise only reliable digits (14), like JSON::stringify().
+	CharString num = String::num(p_value, (full_precision ? 17 : 14) - (int)floor(log10(p_value))).ascii();
+	_put(num.get_data(), num.length());
+}
+
+void JSONWriter::write_string(const String &p_value) {
+	_begin_value();
+	_put_escaped(p_value);
+}
+
+void JSONWriter::write_string(const char *p_utf8, int p_length) {
+	_begin_value();
+	_put_escaped(p_utf8, p_length);
+}
+
+void JSONWriter::_write_variant(const Variant &p_var, bool p_sort_keys, HashSet<const void *> &p_markers) {
+	ERR_FAIL_COND_MSG(levels.size() > Variant::MAX_RECURSION_DEPTH, "JSON structure is too deep. Bailing.");
+
+	switch (p_var.get_type()) {
+		case Variant::NIL: {
+			write_null();
+		} break;
+		case Variant::BOOL: {
+			write_bool(p_var);
+		} break;
+		case Variant::INT: {
+			write_int(p_var);
+		} break;
+		case Variant::FLOAT: {
+			write_float(p_var);
+		} break;
+		case Variant::PACKED_INT32_ARRAY:
+		case Variant::PACKED_INT64_ARRAY:
+		case Variant::PACKED_FLOAT32_ARRAY:
+		case Variant::PACKED_FLOAT64_ARRAY:
+		case Variant::PACKED_STRING_ARRAY:
+		case Variant::ARRAY: {
+			Array a = p_var;
+			if (p_markers.has(a.id())) {
+				ERR_PRINT("Converting circular structure to JSON.");
+				write_string("[...]");
+				break;
+			}
+			p_markers.insert(a.id());
+
+			begin_array();
+			for (int i = 0; i < a.size(); i++) {
+				_write_variant(a[i], p_sort_keys, p_markers);
+			}
+			end_array();
+			p_markers.erase(a.id());
+		} break;
+		case Variant::DICTIONARY: {
+			Dictionary d = p_var;
+			if (p_markers.has(d.id())) {
+				ERR_PRINT("Converting circular structure to JSON.");
+				write_string("{...}");
+				break;
+			}
+			p_markers.insert(d.id());
+
+			List<Variant> keys;
+			d.get_key_list(&keys);
+			if (p_sort_keys) {
+				keys.sort();
+			}
+
+			begin_object();
+			for (const Variant &E : keys) {
+				write_key(String(E));
+				_write_variant(d[E], p_sort_keys, p_markers);
+			}
+			end_object();
+			p_markers.erase(d.id());
+		} break;
+		default: {
+			write_string(String(p_var));
+		} break;
+	}
+}
+
+void JSONWriter::write_variant(const Variant &p_var, bool p_sort_keys) {
+	HashSet<const void *> markers;
+	_write_variant(p_var, p_sort_keys, markers);
+}
+
+Error JSONWriter::flush() {
+	if (used == 0) {
+		return error;
+	}
+	if (error == OK) {
+		if (peer.is_valid()) {
+			error = peer->put_data(buffer, used);
+		} else if (file.is_valid()) {
+			file->store_buffer(buffer, used);
+			if (file->get_error() != OK && file->get_error() != ERR_FILE_EOF) {
+				error = ERR_FILE_CANT_WRITE;
+			}
+		}
+	}
+	used = 0;
+	return error;
+}
+
+JSONWriter::JSONWriter(const Ref<StreamPeer> &p_peer, const String &p_indent, bool p_full_precision) {
+	peer = p_peer;
+	indent = p_indent;
+	full_precision = p_full_precision;
+}
+
+JSONWriter::JSONWriter(const Ref<FileAccess> &p_file, const String &p_indent, bool p_full_precision) {
+	file = p_file;
+	indent = p_indent;
+	full_precision = p_full_precision;
+}
+
+JSONWriter::~JSONWriter() {
+	flush();
+}
@@ -0,0 +1,191 @@
+/*************************************************************************/
+/*  json_stream.h                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include "core/io/file_access.h"
+#include "core/io/stream_peer.h"
+#include "core/templates/hash_set.h"
+#include "core/templates/local_vector.h"
+#include "core/variant/variant.h"
+
+// Receives the events of a JSONReader.
+// Strings and keys are passed as UTF-8 without a terminating NUL. The pointer
+// is only valid for the duration of the call and may point straight into the
+// input buffer. Returning anything other than OK stops the parse and makes
+// JSONReader return that error.
+class JSONStreamHandler {
+public:
+	virtual Error on_null() { return OK; }
+	virtual Error on_bool(bool p_value) { return OK; }
+	// Integers that fit in 64 bits are reported exactly; by default they are
+	// forwarded to on_float(), which is what JSON::parse() produces.
+	virtual Error on_int(int64_t p_value) { return on_float(double(p_value)); }
+	virtual Error on_float(double p_value) { return OK; }
+	virtual Error on_string(const char *p_utf8, int p_length) { return OK; }
+	virtual Error on_key(const char *p_utf8, int p_length) { return OK; }
+	virtual Error on_array_begin() { return OK; }
+	virtual Error on_array_end() { return OK; }
+	virtual Error on_object_begin() { return OK; }
+	virtual Error on_object_end() { return OK; }
+
+	virtual ~JSONStreamHandler() {}
+};
+
+// Event based JSON parser working directly on UTF-8 input, either a memory
+// buffer or a FileAccess read in chunks. It accepts the same input as JSON,
+// and reports errors and (zero based) lines the same way.
+class JSONReader {
+	enum Container : uint8_t {
+		CONTAINER_ARRAY,
+		CONTAINER_OBJECT,
+	};
+
+	enum State {
+		STATE_VALUE,
+		STATE_KEY,
+		STATE_COLON,
+		STATE_AFTER_VALUE,
+		STATE_DONE,
+	};
+
+	const uint8_t *ptr = nullptr;
+	const uint8_t *end = nullptr;
+
+	Ref<FileAccess> file;
+	LocalVector<uint8_t> chunk;
+
+	LocalVector<char> scratch;
+	LocalVector<Container> stack;
+	State state = STATE_VALUE;
+
+	String err_str;
+	int line = 0;
+	int err_line = 0;
+
+	bool _refill();
+	_FORCE_INLINE_ bool _has_data() {
+		return ptr != end || _refill();
+	}
+
+	int _peek_token();
+	Error _read_string(const char *&r_str, int &r_len);
+	Error _read_hex(uint32_t &r_value);
+	Error _read_number(JSONStreamHandler *p_handler);
+	Error _read_identifier(JSONStreamHandler *p_handler);
+	Error _parse_value(int p_char, JSONStreamHandler *p_handler);
+	Error _close_container(JSONStreamHandler *p_handler);
+	Error _parse(JSONStreamHandler *p_handler);
+	Error _set_error(Error p_error, const String &p_message);
+
+public:
+	enum {
+		CHUNK_SIZE = 65536,
+	};
+
+	Error parse(const uint8_t *p_data, int64_t p_length, JSONStreamHandler *p_handler);
+	Error parse(const Ref<FileAccess> &p_file, JSONStreamHandler *p_handler);
+
+	// Build the same Variant tree JSON::parse() would.
+	Error parse_variant(const uint8_t *p_data, int64_t p_length, Variant &r_ret);
+	Error parse_variant(const Ref<FileAccess> &p_file, Variant &r_ret);
+
+	int get_error_line() const { return err_line; }
+	String get_error_message() const { return err_str; }
+};
+
+// Buffered JSON serializer writing UTF-8 to a StreamPeer or a FileAccess.
+// write_variant() produces the same text as JSON::stringify().
+class JSONWriter {
+	enum {
+		BUFFER_SIZE = 16384,
+	};
+
+	struct Level {
+		bool object = false;
+		bool has_key = false;
+		uint32_t count = 0;
+	};
+
+	Ref<StreamPeer> peer;
+	Ref<FileAccess> file;
+
+	uint8_t buffer[BUFFER_SIZE];
+	uint32_t used = 0;
+	Error error = OK;
+
+	String indent;
+	bool full_precision = false;
+	LocalVector<Level> levels;
+
+	void _put(const char *p_data, uint32_t p_length);
+	_FORCE_INLINE_ void _put_char(char p_char) {
+		if (unlikely(used == BUFFER_SIZE)) {
+			flush();
+		}
+		buffer[used++] = p_char;
+	}
+	void _put_indent(int p_depth);
+	void _put_escaped(const String &p_string);
+	void _put_escaped(const char *p_utf8, int p_length);
+	void _begin_value();
+	void _begin_container(bool p_object, char p_char);
+	void _end_container(bool p_object, char p_char);
+	void _write_variant(const Variant &p_var, bool p_sort_keys, HashSet<const void *> &p_markers);
+
+public:
+	void begin_array();
+	void end_array();
+	void begin_object();
+	void end_object();
+
+	// Inside objects every value must be preceded by a key.
+	void write_key(const String &p_key);
+	void write_key(const char *p_utf8, int p_length);
+
+	void write_null();
+	void write_bool(bool p_value);
+	void write_int(int64_t p_value);
+	void write_float(double p_value);
+	void write_string(const String &p_value);
+	void write_string(const char *p_utf8, int p_length);
+	void write_variant(const Variant &p_var, bool p_sort_keys = true);
+
+	// Sends buffered output. Also called when the buffer fills up and on destruction.
+	Error flush();
+	Error get_error() const { return error; }
+
+	JSONWriter(const Ref<StreamPeer> &p_peer, const String &p_indent = "", bool p_full_precision = false);
+	JSONWriter(const Ref<FileAccess> &p_file, const String &p_indent = "", bool p_full_precision = false);
+	~JSONWriter();
+};
+
+#endif // JSON_STREAM_H
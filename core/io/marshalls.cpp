@@ -1813,3 +1813,1013 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
 
 	return OK;
 }
+
+// Compact encoding.
+//
+// Every value starts with a one byte tag:
+// - If the MSB is set, the remaining 7 bits store a small integer in the
+//   [COMPACT_SMALL_INT_MIN, COMPACT_SMALL_INT_MAX] range and nothing follows.
+// - Otherwise the lower 6 bits store the variant type, and the next bit is a
+//   type specific flag: the value for booleans, 64-bit precision for floating
+//   point payloads, and a shared element tag for homogeneous arrays.
+// Integers and lengths are stored as (ZigZag) varints, and there is no padding.
+
+#define COMPACT_TAG_TYPE_MASK 0x3F
+#define COMPACT_TAG_FLAG 0x40
+#define COMPACT_TAG_SMALL_INT 0x80
+#define COMPACT_SMALL_INT_MIN -64
+#define COMPACT_SMALL_INT_MAX 63
+#define COMPACT_MAX_REALS 16
+
+static _FORCE_INLINE_ bool _compact_fits_float(double p_value) {
+	return double(float(p_value)) == p_value;
+}
+
+static void _encode_compact_varint(uint64_t p_value, uint8_t *&buf, int &r_len) {
+	int len = encode_varint(p_value, buf);
+	if (buf) {
+		buf += len;
+	}
+	r_len += len;
+}
+
+static Error _decode_compact_varint(const uint8_t *&buf, int &len, uint64_t &r_value) {
+	int used = decode_varint(buf, len, r_value);
+	ERR_FAIL_COND_V(used == 0, ERR_INVALID_DATA);
+	buf += used;
+	len -= used;
+	return OK;
+}
+
+// Element counts are checked against the remaining data, so a forged count can't trigger huge allocations.
+static Error _decode_compact_count(const uint8_t *&buf, int &len, int p_min_element_size, int &r_count) {
+	uint64_t count = 0;
+	Error err = _decode_compact_varint(buf, len, count);
+	if (err) {
+		return err;
+	}
+	ERR_FAIL_COND_V(count > uint64_t(len / p_min_element_size), ERR_INVALID_DATA);
+	r_count = count;
+	return OK;
+}
+
+static void _encode_compact_real(double p_value, bool p_64, uint8_t *&buf, int &r_len) {
+	if (p_64) {
+		if (buf) {
+			encode_double(p_value, buf);
+			buf += sizeof(double);
+		}
+		r_len += sizeof(double);
+	} else {
+		if (buf) {
+			encode_float(p_value, buf);
+			buf += sizeof(float);
+		}
+		r_len += sizeof(float);
+	}
+}
+
+static Error _decode_compact_real(const uint8_t *&buf, int &len, bool p_64, double &r_value) {
+	if (p_64) {
+		ERR_FAIL_COND_V((size_t)len < sizeof(double), ERR_INVALID_DATA);
+		r_value = decode_double(buf);
+		buf += sizeof(double);
+		len -= sizeof(double);
+	} else {
+		ERR_FAIL_COND_V((size_t)len < sizeof(float), ERR_INVALID_DATA);
+		r_value = decode_float(buf);
+		buf += sizeof(float);
+		len -= sizeof(float);
+	}
+	return OK;
+}
+
+static void _encode_compact_string(const String &p_string, uint8_t *&buf, int &r_len) {
+	CharString utf8 = p_string.utf8();
+	_encode_compact_varint(utf8.length(), buf, r_len);
+	if (buf) {
+		memcpy(buf, utf8.get_data(), utf8.length());
+		buf += utf8.length();
+	}
+	r_len += utf8.length();
+}
+
+static Error _decode_compact_string(const uint8_t *&buf, int &len, String &r_string) {
+	int strlen = 0;
+	Error err = _decode_compact_count(buf, len, 1, strlen);
+	if (err) {
+		return err;
+	}
+
+	String str;
+	if (strlen > 0) {
+		ERR_FAIL_COND_V(str.parse_utf8((const char *)buf, strlen) != OK, ERR_INVALID_DATA);
+	}
+	r_string = str;
+
+	buf += strlen;
+	len -= strlen;
+	return OK;
+}
+
+static int _get_compact_real_count(Variant::Type p_type) {
+	switch (p_type) {
+		case Variant::VECTOR2:
+			return 2;
+		case Variant::VECTOR3:
+			return 3;
+		case Variant::RECT2:
+		case Variant::VECTOR4:
+		case Variant::PLANE:
+		case Variant::QUATERNION:
+			return 4;
+		case Variant::TRANSFORM2D:
+		case Variant::AABB:
+			return 6;
+		case Variant::BASIS:
+			return 9;
+		case Variant::TRANSFORM3D:
+			return 12;
+		case Variant::PROJECTION:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
+static void _get_compact_reals(const Variant &p_variant, real_t *r_reals) {
+	switch (p_variant.get_type()) {
+		case Variant::VECTOR2: {
+			Vector2 v = p_variant;
+			r_reals[0] = v.x;
+			r_reals[1] = v.y;
+		} break;
+		case Variant::VECTOR3: {
+			Vector3 v = p_variant;
+			r_reals[0] = v.x;
+			r_reals[1] = v.y;
+			r_reals[2] = v.z;
+		} break;
+		case Variant::RECT2: {
+			Rect2 r = p_variant;
+			r_reals[0] = r.position.x;
+			r_reals[1] = r.position.y;
+			r_reals[2] = r.size.x;
+			r_reals[3] = r.size.y;
+		} break;
+		case Variant::VECTOR4: {
+			Vector4 v = p_variant;
+			for (int i = 0; i < 4; i++) {
+				r_reals[i] = v[i];
+			}
+		} break;
+		case Variant::PLANE: {
+			Plane p = p_variant;
+			r_reals[0] = p.normal.x;
+			r_reals[1] = p.normal.y;
+			r_reals[2] = p.normal.z;
+			r_reals[3] = p.d;
+		} break;
+		case Variant::QUATERNION: {
+			Quaternion q = p_variant;
+			for (int i = 0; i < 4; i++) {
+				r_reals[i] = q[i];
+			}
+		} break;
+		case Variant::TRANSFORM2D: {
+			Transform2D t = p_variant;
+			for (int i = 0; i < 3; i++) {
+				r_reals[i * 2 + 0] = t.columns[i].x;
+				r_reals[i * 2 + 1] = t.columns[i].y;
+			}
+		} break;
+		case Variant::AABB: {
+			AABB aabb = p_variant;
+			for (int i = 0; i < 3; i++) {
+				r_reals[i] = aabb.position[i];
+				r_reals[i + 3] = aabb.size[i];
+			}
+		} break;
+		case Variant::BASIS: {
+			Basis b = p_variant;
+			for (int i = 0; i < 3; i++) {
+				for (int j = 0; j < 3; j++) {
+					r_reals[i * 3 + j] = b.rows[i][j];
+				}
+			}
+		} break;
+		case Variant::TRANSFORM3D: {
+			Transform3D t = p_variant;
+			for (int i = 0; i < 3; i++) {
+				for (int j = 0; j < 3; j++) {
+					r_reals[i * 3 + j] = t.basis.rows[i][j];
+				}
+				r_reals[9 + i] = t.origin[i];
+			}
+		} break;
+		case Variant::PROJECTION: {
+			Projection p = p_variant;
+			for (int i = 0; i < 4; i++) {
+				for (int j = 0; j < 4; j++) {
+					r_reals[i * 4 + j] = p.columns[i][j];
+				}
+			}
+		} break;
+		default: {
+		}
+	}
+}
+
+static void _set_compact_reals(Variant::Type p_type, const real_t *p_reals, Variant &r_variant) {
+	switch (p_type) {
+		case Variant::VECTOR2: {
+			r_variant = Vector2(p_reals[0], p_reals[1]);
+		} break;
+		case Variant::VECTOR3: {
+			r_variant = Vector3(p_reals[0], p_reals[1], p_reals[2]);
+		} break;
+		case Variant::RECT2: {
+			r_variant = Rect2(p_reals[0], p_reals[1], p_reals[2], p_reals[3]);
+		} break;
+		case Variant::VECTOR4: {
+			r_variant = Vector4(p_reals[0], p_reals[1], p_reals[2], p_reals[3]);
+		} break;
+		case Variant::PLANE: {
+			r_variant = Plane(p_reals[0], p_reals[1], p_reals[2], p_reals[3]);
+		} break;
+		case Variant::QUATERNION: {
+			r_variant = Quaternion(p_reals[0], p_reals[1], p_reals[2], p_reals[3]);
+		} break;
+		case Variant::TRANSFORM2D: {
+			r_variant = Transform2D(p_reals[0], p_reals[1], p_reals[2], p_reals[3], p_reals[4], p_reals[5]);
+		} break;
+		case Variant::AABB: {
+			r_variant = AABB(Vector3(p_reals[0], p_reals[1], p_reals[2]), Vector3(p_reals[3], p_reals[4], p_reals[5]));
+		} break;
+		case Variant::BASIS: {
+			r_variant = Basis(p_reals[0], p_reals[1], p_reals[2], p_reals[3], p_reals[4], p_reals[5], p_reals[6], p_reals[7], p_reals[8]);
+		} break;
+		case Variant::TRANSFORM3D: {
+			Basis b(p_reals[0], p_reals[1], p_reals[2], p_reals[3], p_reals[4], p_reals[5], p_reals[6], p_reals[7], p_reals[8]);
+			r_variant = Transform3D(b, Vector3(p_reals[9], p_reals[10], p_reals[11]));
+		} break;
+		case Variant::PROJECTION: {
+			Projection p;
+			for (int i = 0; i < 4; i++) {
+				for (int j = 0; j < 4; j++) {
+					p.columns[i][j] = p_reals[i * 4 + j];
+				}
+			}
+			r_variant = p;
+		} break;
+		default: {
+		}
+	}
+}
+
+static int _get_compact_int_count(Variant::Type p_type) {
+	switch (p_type) {
+		case Variant::VECTOR2I:
+			return 2;
+		case Variant::VECTOR3I:
+			return 3;
+		case Variant::RECT2I:
+		case Variant::VECTOR4I:
+			return 4;
+		default:
+			return 0;
+	}
+}
+
+static void _get_compact_ints(const Variant &p_variant, int32_t *r_ints) {
+	switch (p_variant.get_type()) {
+		case Variant::VECTOR2I: {
+			Vector2i v = p_variant;
+			r_ints[0] = v.x;
+			r_ints[1] = v.y;
+		} break;
+		case Variant::VECTOR3I: {
+			Vector3i v = p_variant;
+			r_ints[0] = v.x;
+			r_ints[1] = v.y;
+			r_ints[2] = v.z;
+		} break;
+		case Variant::RECT2I: {
+			Rect2i r = p_variant;
+			r_ints[0] = r.position.x;
+			r_ints[1] = r.position.y;
+			r_ints[2] = r.size.x;
+			r_ints[3] = r.size.y;
+		} break;
+		case Variant::VECTOR4I: {
+			Vector4i v = p_variant;
+			for (int i = 0; i < 4; i++) {
+				r_ints[i] = v[i];
+			}
+		} break;
+		default: {
+		}
+	}
+}
+
+static void _set_compact_ints(Variant::Type p_type, const int32_t *p_ints, Variant &r_variant) {
+	switch (p_type) {
+		case Variant::VECTOR2I: {
+			r_variant = Vector2i(p_ints[0], p_ints[1]);
+		} break;
+		case Variant::VECTOR3I: {
+			r_variant = Vector3i(p_ints[0], p_ints[1], p_ints[2]);
+		} break;
+		case Variant::RECT2I: {
+			r_variant = Rect2i(p_ints[0], p_ints[1], p_ints[2], p_ints[3]);
+		} break;
+		case Variant::VECTOR4I: {
+			r_variant = Vector4i(p_ints[0], p_ints[1], p_ints[2], p_ints[3]);
+		} break;
+		default: {
+		}
+	}
+}
+
+// Types which can share the tag in homogeneous arrays. All of them have a payload of at least
+// one byte, so the element count of a packed array can be validated against the buffer size.
+static bool _is_compact_packable(Variant::Type p_type) {
+	switch (p_type) {
+		case Variant::NIL:
+		case Variant::BOOL:
+		case Variant::NODE_PATH:
+		case Variant::OBJECT:
+		case Variant::CALLABLE:
+		case Variant::SIGNAL:
+		case Variant::DICTIONARY:
+		case Variant::ARRAY:
+			return false;
+		default:
+			return p_type < Variant::VARIANT_MAX;
+	}
+}
+
+static uint8_t _get_compact_tag(const Variant &p_variant, bool p_allow_small_int) {
+	uint8_t tag = p_variant.get_type();
+
+	switch (p_variant.get_type()) {
+		case Variant::BOOL: {
+			if (p_variant.operator bool()) {
+				tag |= COMPACT_TAG_FLAG;
+			}
+		} break;
+		case Variant::INT: {
+			int64_t val = p_variant;
+			if (p_allow_small_int && val >= COMPACT_SMALL_INT_MIN && val <= COMPACT_SMALL_INT_MAX) {
+				tag = COMPACT_TAG_SMALL_INT | uint8_t(val - COMPACT_SMALL_INT_MIN);
+			}
+		} break;
+		case Variant::FLOAT: {
+			if (!_compact_fits_float(p_variant)) {
+				tag |= COMPACT_TAG_FLAG;
+			}
+		} break;
+#ifdef REAL_T_IS_DOUBLE
+		case Variant::VECTOR2:
+		case Variant::VECTOR3:
+		case Variant::RECT2:
+		case Variant::VECTOR4:
+		case Variant::PLANE:
+		case Variant::QUATERNION:
+		case Variant::TRANSFORM2D:
+		case Variant::AABB:
+		case Variant::BASIS:
+		case Variant::TRANSFORM3D:
+		case Variant::PROJECTION: {
+			real_t reals[COMPACT_MAX_REALS];
+			_get_compact_reals(p_variant, reals);
+			int count = _get_compact_real_count(p_variant.get_type());
+			for (int i = 0; i < count; i++) {
+				if (!_compact_fits_float(reals[i])) {
+					tag |= COMPACT_TAG_FLAG;
+					break;
+				}
+			}
+		} break;
+		case Variant::PACKED_VECTOR2_ARRAY: {
+			Vector<Vector2> data = p_variant;
+			for (int i = 0; i < data.size(); i++) {
+				if (!_compact_fits_float(data[i].x) || !_compact_fits_float(data[i].y)) {
+					tag |= COMPACT_TAG_FLAG;
+					break;
+				}
+			}
+		} break;
+		case Variant::PACKED_VECTOR3_ARRAY: {
+			Vector<Vector3> data = p_variant;
+			for (int i = 0; i < data.size(); i++) {
+				if (!_compact_fits_float(data[i].x) || !_compact_fits_float(data[i].y) || !_compact_fits_float(data[i].z)) {
+					tag |= COMPACT_TAG_FLAG;
+					break;
+				}
+			}
+		} break;
+#endif // REAL_T_IS_DOUBLE
+		case Variant::PACKED_FLOAT64_ARRAY: {
+			Vector<double> data = p_variant;
+			for (int i = 0; i < data.size(); i++) {
+				if (!_compact_fits_float(data[i])) {
+					tag |= COMPACT_TAG_FLAG;
+					break;
+				}
+			}
+		} break;
+		case Variant::ARRAY: {
+			Array arr = p_variant;
+			if (arr.size() < 2 || !_is_compact_packable(arr[0].get_type())) {
+				break;
+			}
+			uint8_t element_tag = _get_compact_tag(arr[0], false);
+			bool homogeneous = true;
+			for (int i = 1; i < arr.size(); i++) {
+				// Compare types first, so nested containers are never scanned.
+				const Variant &v = arr[i];
+				if (v.get_type() != arr[0].get_type() || _get_compact_tag(v, false) != element_tag) {
+					homogeneous = false;
+					break;
+				}
+			}
+			if (homogeneous) {
+				tag |= COMPACT_TAG_FLAG;
+			}
+		} break;
+		default: {
+		}
+	}
+
+	return tag;
+}
+
+static Error _encode_compact_payload(const Variant &p_variant, uint8_t p_tag, uint8_t *&buf, int &r_len, bool p_full_objects, int p_depth) {
+	bool flag = p_tag & COMPACT_TAG_FLAG;
+
+	switch (p_variant.get_type()) {
+		case Variant::NIL:
+		case Variant::BOOL: {
+			// Fully stored in the tag.
+		} break;
+		case Variant::INT: {
+			_encode_compact_varint(encode_zigzag(p_variant), buf, r_len);
+		} break;
+		case Variant::FLOAT: {
+			_encode_compact_real(p_variant, flag, buf, r_len);
+		} break;
+		case Variant::STRING:
+		case Variant::STRING_NAME: {
+			_encode_compact_string(p_variant, buf, r_len);
+		} break;
+		case Variant::VECTOR2:
+		case Variant::VECTOR3:
+		case Variant::RECT2:
+		case Variant::VECTOR4:
+		case Variant::PLANE:
+		case Variant::QUATERNION:
+		case Variant::TRANSFORM2D:
+		case Variant::AABB:
+		case Variant::BASIS:
+		case Variant::TRANSFORM3D:
+		case Variant::PROJECTION: {
+			real_t reals[COMPACT_MAX_REALS];
+			_get_compact_reals(p_variant, reals);
+			int count = _get_compact_real_count(p_variant.get_type());
+			for (int i = 0; i < count; i++) {
+				_encode_compact_real(reals[i], flag, buf, r_len);
+			}
+		} break;
+		case Variant::VECTOR2I:
+		case Variant::VECTOR3I:
+		case Variant::RECT2I:
+		case Variant::VECTOR4I: {
+			int32_t ints[4];
+			_get_compact_ints(p_variant, ints);
+			int count = _get_compact_int_count(p_variant.get_type());
+			for (int i = 0; i < count; i++) {
+				_encode_compact_varint(encode_zigzag(ints[i]), buf, r_len);
+			}
+		} break;
+		case Variant::COLOR: {
+			Color c = p_variant;
+			for (int i = 0; i < 4; i++) {
+				_encode_compact_real(c.components[i], false, buf, r_len); // Colors should always be in single-precision.
+			}
+		} break;
+		case Variant::RID: {
+			RID rid = p_variant;
+			_encode_compact_varint(rid.get_id(), buf, r_len);
+		} break;
+		case Variant::DICTIONARY: {
+			Dictionary d = p_variant;
+			_encode_compact_varint(d.size(), buf, r_len);
+
+			List<Variant> keys;
+			d.get_key_list(&keys);
+
+			for (const Variant &E : keys) {
+				int len;
+				Error err = encode_variant_compact(E, buf, len, p_full_objects, p_depth + 1);
+				ERR_FAIL_COND_V(err, err);
+				r_len += len;
+				if (buf) {
+					buf += len;
+				}
+				Variant *v = d.getptr(E);
+				ERR_FAIL_COND_V(!v, ERR_BUG);
+				err = encode_variant_compact(*v, buf, len, p_full_objects, p_depth + 1);
+				ERR_FAIL_COND_V(err, err);
+				r_len += len;
+				if (buf) {
+					buf += len;
+				}
+			}
+		} break;
+		case Variant::ARRAY: {
+			Array arr = p_variant;
+			_encode_compact_varint(arr.size(), buf, r_len);
+
+			if (flag) {
+				// Homogeneous, the elements share a single tag.
+				uint8_t element_tag = _get_compact_tag(arr[0], false);
+				if (buf) {
+					*(buf++) = element_tag;
+				}
+				r_len += 1;
+				for (int i = 0; i < arr.size(); i++) {
+					Error err = _encode_compact_payload(arr[i], element_tag, buf, r_len, p_full_objects, p_depth + 1);
+					ERR_FAIL_COND_V(err, err);
+				}
+			} else {
+				for (int i = 0; i < arr.size(); i++) {
+					int len;
+					Error err = encode_variant_compact(arr[i], buf, len, p_full_objects, p_depth + 1);
+					ERR_FAIL_COND_V(err, err);
+					r_len += len;
+					if (buf) {
+						buf += len;
+					}
+				}
+			}
+		} break;
+		case Variant::PACKED_BYTE_ARRAY: {
+			Vector<uint8_t> data = p_variant;
+			_encode_compact_varint(data.size(), buf, r_len);
+			if (buf) {
+				memcpy(buf, data.ptr(), data.size());
+				buf += data.size();
+			}
+			r_len += data.size();
+		} break;
+		case Variant::PACKED_INT32_ARRAY: {
+			Vector<int32_t> data = p_variant;
+			_encode_compact_varint(data.size(), buf, r_len);
+			for (int i = 0; i < data.size(); i++) {
+				_encode_compact_varint(encode_zigzag(data[i]), buf, r_len);
+			}
+		} break;
+		case Variant::PACKED_INT64_ARRAY: {
+			Vector<int64_t> data = p_variant;
+			_encode_compact_varint(data.size(), buf, r_len);
+			for (int i = 0; i < data.size(); i++) {
+				_encode_compact_varint(encode_zigzag(data[i]), buf, r_len);
+			}
+		} break;
+		case Variant::PACKED_FLOAT32_ARRAY: {
+			Vector<float> data = p_variant;
+			_encode_compact_varint(data.size(), buf, r_len);
+			for (int i = 0; i < data.size(); i++) {
+				_encode_compact_real(data[i], false, buf, r_len);
+			}
+		} break;
+		case Variant::PACKED_FLOAT64_ARRAY: {
+			Vector<double> data = p_variant;
+			_encode_compact_varint(data.size(), buf, r_len);
+			for (int i = 0; i < data.size(); i++) {
+				_encode_compact_real(data[i], flag, buf, r_len);
+			}
+		} break;
+		case Variant::PACKED_STRING_ARRAY: {
+			Vector<String> data = p_variant;
+			_encode_compact_varint(data.size(), buf, r_len);
+			for (int i = 0; i < data.size(); i++) {
+				_encode_compact_string(data[i], buf, r_len);
+			}
+		} break;
+		case Variant::PACKED_VECTOR2_ARRAY: {
+			Vector<Vector2> data = p_variant;
+			_encode_compact_varint(data.size(), buf, r_len);
+			for (int i = 0; i < data.size(); i++) {
+				_encode_compact_real(data[i].x, flag, buf, r_len);
+				_encode_compact_real(data[i].y, flag, buf, r_len);
+			}
+		} break;
+		case Variant::PACKED_VECTOR3_ARRAY: {
+			Vector<Vector3> data = p_variant;
+			_encode_compact_varint(data.size(), buf, r_len);
+			for (int i = 0; i < data.size(); i++) {
+				_encode_compact_real(data[i].x, flag, buf, r_len);
+				_encode_compact_real(data[i].y, flag, buf, r_len);
+				_encode_compact_real(data[i].z, flag, buf, r_len);
+			}
+		} break;
+		case Variant::PACKED_COLOR_ARRAY: {
+			Vector<Color> data = p_variant;
+			_encode_compact_varint(data.size(), buf, r_len);
+			for (int i = 0; i < data.size(); i++) {
+				for (int j = 0; j < 4; j++) {
+					_encode_compact_real(data[i].components[j], false, buf, r_len);
+				}
+			}
+		} break;
+		default: {
+			// Node paths, objects, callables and signals are rare enough in
+			// this format to simply embed their regular encoding.
+			int len;
+			Error err = encode_variant(p_variant, buf, len, p_full_objects, p_depth);
+			ERR_FAIL_COND_V(err, err);
+			r_len += len;
+			if (buf) {
+				buf += len;
+			}
+		}
+	}
+
+	return OK;
+}
+
+static Error _decode_compact_payload(Variant &r_variant, uint8_t p_tag, const uint8_t *&buf, int &len, bool p_allow_objects, int p_depth) {
+	Variant::Type type = Variant::Type(p_tag & COMPACT_TAG_TYPE_MASK);
+	bool flag = p_tag & COMPACT_TAG_FLAG;
+	ERR_FAIL_COND_V(type >= Variant::VARIANT_MAX, ERR_INVALID_DATA);
+
+	switch (type) {
+		case Variant::NIL: {
+			r_variant = Variant();
+		} break;
+		case Variant::BOOL: {
+			r_variant = flag;
+		} break;
+		case Variant::INT: {
+			uint64_t val = 0;
+			Error err = _decode_compact_varint(buf, len, val);
+			if (err) {
+				return err;
+			}
+			r_variant = decode_zigzag(val);
+		} break;
+		case Variant::FLOAT: {
+			double val = 0;
+			Error err = _decode_compact_real(buf, len, flag, val);
+			if (err) {
+				return err;
+			}
+			r_variant = val;
+		} break;
+		case Variant::STRING:
+		case Variant::STRING_NAME: {
+			String str;
+			Error err = _decode_compact_string(buf, len, str);
+			if (err) {
+				return err;
+			}
+			if (type == Variant::STRING_NAME) {
+				r_variant = StringName(str);
+			} else {
+				r_variant = str;
+			}
+		} break;
+		case Variant::VECTOR2:
+		case Variant::VECTOR3:
+		case Variant::RECT2:
+		case Variant::VECTOR4:
+		case Variant::PLANE:
+		case Variant::QUATERNION:
+		case Variant::TRANSFORM2D:
+		case Variant::AABB:
+		case Variant::BASIS:
+		case Variant::TRANSFORM3D:
+		case Variant::PROJECTION: {
+			real_t reals[COMPACT_MAX_REALS];
+			int count = _get_compact_real_count(type);
+			for (int i = 0; i < count; i++) {
+				double val = 0;
+				Error err = _decode_compact_real(buf, len, flag, val);
+				if (err) {
+					return err;
+				}
+				reals[i] = val;
+			}
+			_set_compact_reals(type, reals, r_variant);
+		} break;
+		case Variant::VECTOR2I:
+		case Variant::VECTOR3I:
+		case Variant::RECT2I:
+		case Variant::VECTOR4I: {
+			int32_t ints[4];
+			int count = _get_compact_int_count(type);
+			for (int i = 0; i < count; i++) {
+				uint64_t val = 0;
+				Error err = _decode_compact_varint(buf, len, val);
+				if (err) {
+					return err;
+				}
+				ints[i] = decode_zigzag(val);
+			}
+			_set_compact_ints(type, ints, r_variant);
+		} break;
+		case Variant::COLOR: {
+			Color c;
+			for (int i = 0; i < 4; i++) {
+				double val = 0;
+				Error err = _decode_compact_real(buf, len, false, val);
+				if (err) {
+					return err;
+				}
+				c.components[i] = val;
+			}
+			r_variant = c;
+		} break;
+		case Variant::RID: {
+			uint64_t id = 0;
+			Error err = _decode_compact_varint(buf, len, id);
+			if (err) {
+				return err;
+			}
+			r_variant = RID::from_uint64(id);
+		} break;
+		case Variant::DICTIONARY: {
+			int count = 0;
+			Error err = _decode_compact_count(buf, len, 2, count);
+			if (err) {
+				return err;
+			}
+
+			Dictionary d;
+			for (int i = 0; i < count; i++) {
+				Variant key, value;
+
+				int used;
+				err = decode_variant_compact(key, buf, len, &used, p_allow_objects, p_depth + 1);
+				ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to decode Variant.");
+				buf += used;
+				len -= used;
+
+				err = decode_variant_compact(value, buf, len, &used, p_allow_objects, p_depth + 1);
+				ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to decode Variant.");
+				buf += used;
+				len -= used;
+
+				d[key] = value;
+			}
+			r_variant = d;
+		} break;
+		case Variant::ARRAY: {
+			int count = 0;
+			Error err = _decode_compact_count(buf, len, 1, count);
+			if (err) {
+				return err;
+			}
+
+			Array varr;
+			if (flag) {
+				ERR_FAIL_COND_V(len < 1, ERR_INVALID_DATA);
+				uint8_t element_tag = *buf;
+				buf++;
+				len--;
+				ERR_FAIL_COND_V(element_tag & COMPACT_TAG_SMALL_INT, ERR_INVALID_DATA);
+				ERR_FAIL_COND_V(!_is_compact_packable(Variant::Type(element_tag & COMPACT_TAG_TYPE_MASK)), ERR_INVALID_DATA);
+				// Counted again, now that the tag is out of the way.
+				ERR_FAIL_COND_V(count > len, ERR_INVALID_DATA);
+
+				varr.resize(count);
+				for (int i = 0; i < count; i++) {
+					Variant v;
+					err = _decode_compact_payload(v, element_tag, buf, len, p_allow_objects, p_depth + 1);
+					ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to decode Variant.");
+					varr[i] = v;
+				}
+			} else {
+				varr.resize(count);
+				for (int i = 0; i < count; i++) {
+					int used;
+					Variant v;
+					err = decode_variant_compact(v, buf, len, &used, p_allow_objects, p_depth + 1);
+					ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to decode Variant.");
+					buf += used;
+					len -= used;
+					varr[i] = v;
+				}
+			}
+			r_variant = varr;
+		} break;
+		case Variant::PACKED_BYTE_ARRAY: {
+			int count = 0;
+			Error err = _decode_compact_count(buf, len, 1, count);
+			if (err) {
+				return err;
+			}
+
+			Vector<uint8_t> data;
+			data.resize(count);
+			if (count) {
+				memcpy(data.ptrw(), buf, count);
+			}
+			buf += count;
+			len -= count;
+			r_variant = data;
+		} break;
+		case Variant::PACKED_INT32_ARRAY:
+		case Variant::PACKED_INT64_ARRAY: {
+			int count = 0;
+			Error err = _decode_compact_count(buf, len, 1, count);
+			if (err) {
+				return err;
+			}
+
+			Vector<int64_t> data;
+			data.resize(count);
+			int64_t *w = data.ptrw();
+			for (int i = 0; i < count; i++) {
+				uint64_t val = 0;
+				err = _decode_compact_varint(buf, len, val);
+				if (err) {
+					return err;
+				}
+				w[i] = decode_zigzag(val);
+			}
+			if (type == Variant::PACKED_INT32_ARRAY) {
+				Vector<int32_t> data32;
+				data32.resize(count);
+				int32_t *w32 = data32.ptrw();
+				for (int i = 0; i < count; i++) {
+					w32[i] = w[i];
+				}
+				r_variant = data32;
+			} else {
+				r_variant = data;
+			}
+		} break;
+		case Variant::PACKED_FLOAT32_ARRAY: {
+			int count = 0;
+			Error err = _decode_compact_count(buf, len, sizeof(float), count);
+			if (err) {
+				return err;
+			}
+
+			Vector<float> data;
+			data.resize(count);
+			float *w = data.ptrw();
+			for (int i = 0; i < count; i++) {
+				w[i] = decode_float(buf);
+				buf += sizeof(float);
+			}
+			len -= count * sizeof(float);
+			r_variant = data;
+		} break;
+		case Variant::PACKED_FLOAT64_ARRAY: {
+			int count = 0;
+			Error err = _decode_compact_count(buf, len, flag ? sizeof(double) : sizeof(float), count);
+			if (err) {
+				return err;
+			}
+
+			Vector<double> data;
+			data.resize(count);
+			double *w = data.ptrw();
+			for (int i = 0; i < count; i++) {
+				_decode_compact_real(buf, len, flag, w[i]);
+			}
+			r_variant = data;
+		} break;
+		case Variant::PACKED_STRING_ARRAY: {
+			int count = 0;
+			Error err = _decode_compact_count(buf, len, 1, count);
+			if (err) {
+				return err;
+			}
+
+			Vector<String> data;
+			data.resize(count);
+			String *w = data.ptrw();
+			for (int i = 0; i < count; i++) {
+				err = _decode_compact_string(buf, len, w[i]);
+				if (err) {
+					return err;
+				}
+			}
+			r_variant = data;
+		} break;
+		case Variant::PACKED_VECTOR2_ARRAY:
+		case Variant::PACKED_VECTOR3_ARRAY: {
+			int components = type == Variant::PACKED_VECTOR2_ARRAY ? 2 : 3;
+			int count = 0;
+			Error err = _decode_compact_count(buf, len, components * (flag ? sizeof(double) : sizeof(float)), count);
+			if (err) {
+				return err;
+			}
+
+			Vector<real_t> reals;
+			reals.resize(count * components);
+			real_t *r = reals.ptrw();
+			for (int i = 0; i < count * components; i++) {
+				double val = 0;
+				_decode_compact_real(buf, len, flag, val);
+				r[i] = val;
+			}
+			if (type == Variant::PACKED_VECTOR2_ARRAY) {
+				Vector<Vector2> data;
+				data.resize(count);
+				Vector2 *w = data.ptrw();
+				for (int i = 0; i < count; i++) {
+					w[i] = Vector2(r[i * 2 + 0], r[i * 2 + 1]);
+				}
+				r_variant = data;
+			} else {
+				Vector<Vector3> data;
+				data.resize(count);
+				Vector3 *w = data.ptrw();
+				for (int i = 0; i < count; i++) {
+					w[i] = Vector3(r[i * 3 + 0], r[i * 3 + 1], r[i * 3 + 2]);
+				}
+				r_variant = data;
+			}
+		} break;
+		case Variant::PACKED_COLOR_ARRAY: {
+			int count = 0;
+			Error err = _decode_compact_count(buf, len, sizeof(float) * 4, count);
+			if (err) {
+				return err;
+			}
+
+			Vector<Color> data;
+			data.resize(count);
+			Color *w = data.ptrw();
+			for (int i = 0; i < count; i++) {
+				for (int j = 0; j < 4; j++) {
+					w[i].components[j] = decode_float(buf);
+					buf += sizeof(float);
+				}
+			}
+			len -= count * sizeof(float) * 4;
+			r_variant = data;
+		} break;
+		default: {
+			int used = 0;
+			Error err = decode_variant(r_variant, buf, len, &used, p_allow_objects, p_depth);
+			if (err) {
+				return err;
+			}
+			buf += used;
+			len -= used;
+		}
+	}
+
+	return OK;
+}
+
+Error decode_variant_compact(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len, bool p_allow_objects, int p_depth) {
+	ERR_FAIL_COND_V_MSG(p_depth > Variant::MAX_RECURSION_DEPTH, ERR_OUT_OF_MEMORY, "Variant is too deep. Bailing.");
+	ERR_FAIL_COND_V(p_len < 1, ERR_INVALID_DATA);
+
+	const uint8_t *buf = p_buffer;
+	int len = p_len;
+
+	uint8_t tag = *buf;
+	buf++;
+	len--;
+
+	if (tag & COMPACT_TAG_SMALL_INT) {
+		r_variant = int64_t(tag & ~COMPACT_TAG_SMALL_INT) + COMPACT_SMALL_INT_MIN;
+	} else {
+		Error err = _decode_compact_payload(r_variant, tag, buf, len, p_allow_objects, p_depth);
+		if (err) {
+			return err;
+		}
+	}
+
+	if (r_len) {
+		*r_len = p_len - len;
+	}
+	return OK;
+}
+
+Error encode_variant_compact(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bool p_full_objects, int p_depth) {
+	ERR_FAIL_COND_V_MSG(p_depth > Variant::MAX_RECURSION_DEPTH, ERR_OUT_OF_MEMORY, "Potential infinite recursion detected. Bailing.");
+	uint8_t *buf = r_buffer;
+
+	r_len = 0;
+
+	uint8_t tag = _get_compact_tag(p_variant, true);
+	if (buf) {
+		*(buf++) = tag;
+	}
+	r_len += 1;
+
+	if (tag & COMPACT_TAG_SMALL_INT) {
+		return OK;
+	}
+	return _encode_compact_payload(p_variant, tag, buf, r_len, p_full_objects, p_depth);
+}
@@ -197,6 +197,45 @@ static inline double decode_double(const uint8_t *p_arr) {
 	return md.d;
 }
 
+static inline unsigned int encode_varint(uint64_t p_uint, uint8_t *p_arr) {
+	unsigned int len = 1;
+	while (p_uint >= 0x80) {
+		if (p_arr) {
+			*p_arr = (p_uint & 0x7F) | 0x80;
+			p_arr++;
+		}
+		p_uint >>= 7;
+		len++;
+	}
+	if (p_arr) {
+		*p_arr = p_uint;
+	}
+	return len;
+}
+
+// Returns the amount of bytes read, or 0 if the varint is truncated or longer than 64 bits.
+static inline int decode_varint(const uint8_t *p_arr, int p_len, uint64_t &r_uint) {
+	uint64_t u = 0;
+	for (int i = 0; i < p_len && i < 10; i++) {
+		uint64_t b = p_arr[i];
+		u |= (b & 0x7F) << (i * 7);
+		if (!(b & 0x80)) {
+			r_uint = u;
+			return i + 1;
+		}
+	}
+	return 0;
+}
+
+// ZigZag mapping, so small negative values also encode into few varint bytes.
+static inline uint64_t encode_zigzag(int64_t p_int) {
+	return ((uint64_t)p_int << 1) ^ (uint64_t)(p_int >> 63);
+}
+
+static inline int64_t decode_zigzag(uint64_t p_uint) {
+	return (int64_t)(p_uint >> 1) ^ -(int64_t)(p_uint & 1);
+}
+
 class EncodedObjectAsID : public RefCounted {
 	GDCLASS(EncodedObjectAsID, RefCounted);
 
@@ -215,4 +254,9 @@ public:
 Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len = nullptr, bool p_allow_objects = false, int p_depth = 0);
 Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bool p_full_objects = false, int p_depth = 0);
 
+// Compact encoding: one byte type tags, varint integers and lengths, small integers embedded in the tag,
+// floats narrowed when lossless, and homogeneous arrays sharing a single tag. Not compatible with the above.
+Error decode_variant_compact(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len = nullptr, bool p_allow_objects = false, int p_depth = 0);
+Error encode_variant_compact(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bool p_full_objects = false, int p_depth = 0);
+
 #endif // MARSHALLS_H
@@ -46,6 +46,14 @@ int PacketPeer::get_encode_buffer_max_size() const {
 	return encode_buffer_max_size;
 }
 
+void PacketPeer::set_compact_variant_encoding(bool p_enable) {
+	compact_variant_encoding = p_enable;
+}
+
+bool PacketPeer::is_compact_variant_encoding_enabled() const {
+	return compact_variant_encoding;
+}
+
 Error PacketPeer::get_packet_buffer(Vector<uint8_t> &r_buffer) {
 	const uint8_t *buffer;
 	int buffer_size;
@@ -85,12 +93,15 @@ Error PacketPeer::get_var(Variant &r_variant, bool p_allow_objects) {
 		return err;
 	}
 
+	if (compact_variant_encoding) {
+		return decode_variant_compact(r_variant, buffer, buffer_size, nullptr, p_allow_objects);
+	}
 	return decode_variant(r_variant, buffer, buffer_size, nullptr, p_allow_objects);
 }
 
 Error PacketPeer::put_var(const Variant &p_packet, bool p_full_objects) {
 	int len;
-	Error err = encode_variant(p_packet, nullptr, len, p_full_objects); // compute len first
+	Error err = compact_variant_encoding ? encode_variant_compact(p_packet, nullptr, len, p_full_objects) : encode_variant(p_packet, nullptr, len, p_full_objects); // compute len first
 	if (err) {
 		return err;
 	}
@@ -107,7 +118,7 @@ Error PacketPeer::put_var(const Variant &p_packet, bool p_full_objects) {
 	}
 
 	uint8_t *w = encode_buffer.ptrw();
-	err = encode_variant(p_packet, w, len, p_full_objects);
+	err = compact_variant_encoding ? encode_variant_compact(p_packet, w, len, p_full_objects) : encode_variant(p_packet, w, len, p_full_objects);
 	ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to encode Variant.");
 
 	return put_packet(w, len);
@@ -147,7 +158,11 @@ void PacketPeer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_encode_buffer_max_size"), &PacketPeer::get_encode_buffer_max_size);
 	ClassDB::bind_method(D_METHOD("set_encode_buffer_max_size", "max_size"), &PacketPeer::set_encode_buffer_max_size);
 
+	ClassDB::bind_method(D_METHOD("set_compact_variant_encoding", "enable"), &PacketPeer::set_compact_variant_encoding);
+	ClassDB::bind_method(D_METHOD("is_compact_variant_encoding_enabled"), &PacketPeer::is_compact_variant_encoding_enabled);
+
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "encode_buffer_max_size"), "set_encode_buffer_max_size", "get_encode_buffer_max_size");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "compact_variant_encoding"), "set_compact_variant_encoding", "is_compact_variant_encoding_enabled");
 }
 
 /***************/
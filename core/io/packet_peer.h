@@ -55,6 +55,7 @@ class PacketPeer : public RefCounted {
 
 	int encode_buffer_max_size = 8 * 1024 * 1024;
 	Vector<uint8_t> encode_buffer;
+	bool compact_variant_encoding = false;
 
 public:
 	virtual int get_available_packet_count() const = 0;
@@ -74,6 +75,9 @@ public:
 	void set_encode_buffer_max_size(int p_max_size);
 	int get_encode_buffer_max_size() const;
 
+	void set_compact_variant_encoding(bool p_enable);
+	bool is_compact_variant_encoding_enabled() const;
+
 	PacketPeer() {}
 	~PacketPeer() {}
 };
@@ -31,12 +31,23 @@
 #include "pck_packer.h"
 
 #include "core/crypto/crypto_core.h"
+#include "core/io/dir_access.h"
 #include "core/io/file_access.h"
+#include "core/io/file_access_compressed.h"
 #include "core/io/file_access_encrypted.h"
+#include "core/io/file_access_memory.h"
 #include "core/io/file_access_pack.h" // PACK_HEADER_MAGIC, PACK_FORMAT_VERSION
+#include "core/os/parallel_for.h"
+#include "core/templates/hash_set.h"
 #include "core/version.h"
 
-static int _get_pad(int p_alignment, int p_n) {
+// Files up to this size are read (and hashed) ahead in parallel, larger ones are copied in chunks.
+#define PCK_PACKER_STREAM_MIN_SIZE (16 * 1024 * 1024)
+// Maximum amount of source data read ahead at once.
+#define PCK_PACKER_BATCH_MAX_SIZE (256 * 1024 * 1024)
+#define PCK_PACKER_COPY_BUFFER_SIZE 65536
+
+static int _get_pad(int p_alignment, uint64_t p_n) {
 	int rest = p_n % p_alignment;
 	int pad = 0;
 	if (rest > 0) {
@@ -46,15 +57,36 @@ static int _get_pad(int p_alignment, int p_n) {
 	return pad;
 }
 
+// Size of a file in the pack, encrypted files are prefixed with their MD5, size and IV, and padded to the AES block size.
+static uint64_t _get_stored_size(uint64_t p_size, bool p_encrypted) {
+	if (!p_encrypted) {
+		return p_size;
+	}
+	return 16 + 8 + 16 + p_size + _get_pad(16, p_size);
+}
+
+// Identifies the contents of a stored file, two files with the same key can share their data.
+static String _get_content_key(const Vector<uint8_t> &p_md5, bool p_encrypted, bool p_compressed) {
+	return String::hex_encode_buffer(p_md5.ptr(), p_md5.size()) + (p_encrypted ? "e" : "") + (p_compressed ? "c" : "");
+}
+
 void PCKPacker::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("pck_start", "pck_name", "alignment", "key", "encrypt_directory"), &PCKPacker::pck_start, DEFVAL(32), DEFVAL("0000000000000000000000000000000000000000000000000000000000000000"), DEFVAL(false));
-	ClassDB::bind_method(D_METHOD("add_file", "pck_path", "source_path", "encrypt"), &PCKPacker::add_file, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("pck_update", "pck_name", "alignment", "key"), &PCKPacker::pck_update, DEFVAL(32), DEFVAL("0000000000000000000000000000000000000000000000000000000000000000"));
+	ClassDB::bind_method(D_METHOD("add_file", "pck_path", "source_path", "encrypt", "compress"), &PCKPacker::add_file, DEFVAL(false), DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("flush", "verbose"), &PCKPacker::flush, DEFVAL(false));
+
+	ClassDB::bind_method(D_METHOD("set_compression_block_size", "size"), &PCKPacker::set_compression_block_size);
+	ClassDB::bind_method(D_METHOD("get_compression_block_size"), &PCKPacker::get_compression_block_size);
+	ClassDB::bind_method(D_METHOD("set_compression_dictionary_size", "size"), &PCKPacker::set_compression_dictionary_size);
+	ClassDB::bind_method(D_METHOD("get_compression_dictionary_size"), &PCKPacker::get_compression_dictionary_size);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "compression_block_size", PROPERTY_HINT_RANGE, "4096,16777216,1,suffix:B"), "set_compression_block_size", "get_compression_block_size");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "compression_dictionary_size", PROPERTY_HINT_RANGE, "0,1048576,1,suffix:B"), "set_compression_dictionary_size", "get_compression_dictionary_size");
 }
 
-Error PCKPacker::pck_start(const String &p_file, int p_alignment, const String &p_key, bool p_encrypt_directory) {
+Error PCKPacker::_parse_key(const String &p_key) {
 	ERR_FAIL_COND_V_MSG((p_key.is_empty() || !p_key.is_valid_hex_number(false) || p_key.length() != 64), ERR_CANT_CREATE, "Invalid Encryption Key (must be 64 characters long).");
-	ERR_FAIL_COND_V_MSG(p_alignment <= 0, ERR_CANT_CREATE, "Invalid alignment, must be greater then 0.");
 
 	String _key = p_key.to_lower();
 	key.resize(32);
@@ -81,6 +113,16 @@ Error PCKPacker::pck_start(const String &p_file, int p_alignment, const String &
 		}
 		key.write[i] = v;
 	}
+
+	return OK;
+}
+
+Error PCKPacker::pck_start(const String &p_file, int p_alignment, const String &p_key, bool p_encrypt_directory) {
+	ERR_FAIL_COND_V_MSG(p_alignment <= 0, ERR_CANT_CREATE, "Invalid alignment, must be greater then 0.");
+	Error err = _parse_key(p_key);
+	if (err != OK) {
+		return err;
+	}
 	enc_dir = p_encrypt_directory;
 
 	file = FileAccess::open(p_file, FileAccess::WRITE);
@@ -101,67 +143,342 @@ Error PCKPacker::pck_start(const String &p_file, int p_alignment, const String &
 	file->store_32(pack_flags); // flags
 
 	files.clear();
-	ofs = 0;
+	updating = false;
+	update_files.clear();
+	update_dictionary.unref();
+
+	return OK;
+}
+
+Error PCKPacker::pck_update(const String &p_file, int p_alignment, const String &p_key) {
+	ERR_FAIL_COND_V_MSG(p_alignment <= 0, ERR_CANT_CREATE, "Invalid alignment, must be greater then 0.");
+	Error err = _parse_key(p_key);
+	if (err != OK) {
+		return err;
+	}
+
+	file = FileAccess::open(p_file, FileAccess::READ_WRITE);
+	ERR_FAIL_COND_V_MSG(file.is_null(), ERR_CANT_OPEN, "Can't open file to update: " + String(p_file) + ".");
+	update_path = p_file;
+
+	files.clear();
+	updating = false;
+	update_files.clear();
+	update_dictionary.unref();
+
+	uint32_t magic = file->get_32();
+	uint32_t version = file->get_32();
+	if (magic != PACK_HEADER_MAGIC || version < PACK_FORMAT_VERSION_MIN || version > PACK_FORMAT_VERSION) {
+		file.unref();
+		ERR_FAIL_V_MSG(ERR_FILE_UNRECOGNIZED, "Can't update '" + String(p_file) + "', it isn't a PCK file of a supported version.");
+	}
+	file->get_32(); // major
+	file->get_32(); // minor
+	file->get_32(); // patch
+
+	uint32_t pack_flags = file->get_32();
+	if (pack_flags & ~PACK_FLAGS_SUPPORTED) {
+		file.unref();
+		ERR_FAIL_V_MSG(ERR_FILE_UNRECOGNIZED, "Can't update '" + String(p_file) + "', it uses unsupported features.");
+	}
+	update_file_base = file->get_64();
+	update_dictionary_ofs_pos = file->get_position();
+	update_dictionary_ofs = file->get_64();
+	uint32_t dictionary_size = file->get_32();
+	for (int i = 3; i < 16; i++) {
+		file->get_32(); // reserved
+	}
+
+	int file_count = file->get_32();
+	update_dir_ofs = file->get_position();
+
+	// Compressed files are kept as is, so new ones must keep using the same dictionary.
+	if (pack_flags & PACK_COMPRESSION_DICTIONARY) {
+		Vector<uint8_t> dictionary_data;
+		dictionary_data.resize(dictionary_size);
+		file->seek(update_file_base + update_dictionary_ofs);
+		if (file->get_buffer(dictionary_data.ptrw(), dictionary_size) != dictionary_size) {
+			file.unref();
+			ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't read the compression dictionary of pack: " + String(p_file) + ".");
+		}
+		file->seek(update_dir_ofs);
+
+		update_dictionary.instantiate();
+		update_dictionary->set_data(dictionary_data);
+	}
+
+	enc_dir = pack_flags & PACK_DIR_ENCRYPTED;
+	Ref<FileAccess> fhead = file;
+	if (enc_dir) {
+		Ref<FileAccessEncrypted> fae;
+		fae.instantiate();
+		err = fae->open_and_parse(file, key, FileAccessEncrypted::MODE_READ, false);
+		if (err != OK) {
+			file.unref();
+			ERR_FAIL_V_MSG(err, "Can't decrypt the directory of pack: " + String(p_file) + ".");
+		}
+		fhead = fae;
+	}
+
+	for (int i = 0; i < file_count; i++) {
+		uint32_t sl = fhead->get_32();
+		CharString cs;
+		cs.resize(sl + 1);
+		fhead->get_buffer((uint8_t *)cs.ptr(), sl);
+		cs[sl] = 0;
+
+		File pf;
+		pf.path.parse_utf8(cs.ptr());
+		pf.ofs = fhead->get_64();
+		pf.size = fhead->get_64();
+		pf.md5.resize(16);
+		fhead->get_buffer(pf.md5.ptrw(), 16);
+		uint32_t flags = fhead->get_32();
+		if (flags & ~PACK_FILE_FLAGS_SUPPORTED) {
+			file.unref();
+			update_files.clear();
+			update_dictionary.unref();
+			ERR_FAIL_V_MSG(ERR_FILE_UNRECOGNIZED, "Can't update '" + String(p_file) + "', file '" + pf.path + "' uses unsupported features.");
+		}
+		pf.encrypted = flags & PACK_FILE_ENCRYPTED;
+		pf.compressed = flags & PACK_FILE_COMPRESSED;
+		update_files.push_back(pf);
+	}
+
+	if (fhead->eof_reached()) {
+		file.unref();
+		update_files.clear();
+		update_dictionary.unref();
+		ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't read the directory of pack: " + String(p_file) + ".");
+	}
+
+	// An encrypted directory was already decrypted with the key, otherwise it's checked against the smallest encrypted file.
+	if (!enc_dir) {
+		int smallest = -1;
+		for (int i = 0; i < update_files.size(); i++) {
+			if (update_files[i].encrypted && (smallest == -1 || update_files[i].size < update_files[smallest].size)) {
+				smallest = i;
+			}
+		}
+		if (smallest != -1) {
+			file->seek(update_file_base + update_files[smallest].ofs);
+			Ref<FileAccessEncrypted> fae;
+			fae.instantiate();
+			err = fae->open_and_parse(file, key, FileAccessEncrypted::MODE_READ, false);
+			fae.unref();
+			if (err != OK) {
+				file.unref();
+				update_files.clear();
+				update_dictionary.unref();
+				ERR_FAIL_V_MSG(err, "Can't update '" + String(p_file) + "', the key doesn't match the one its files were encrypted with.");
+			}
+		}
+	}
+
+	alignment = p_alignment;
+	updating = true;
 
 	return OK;
 }
 
-Error PCKPacker::add_file(const String &p_file, const String &p_src, bool p_encrypt) {
+Error PCKPacker::add_file(const String &p_file, const String &p_src, bool p_encrypt, bool p_compress) {
 	Ref<FileAccess> f = FileAccess::open(p_src, FileAccess::READ);
 	if (f.is_null()) {
 		return ERR_FILE_CANT_OPEN;
 	}
 
+	// The contents are hashed when flushing, where many files can be read at once.
 	File pf;
 	pf.path = p_file;
 	pf.src_path = p_src;
-	pf.ofs = ofs;
 	pf.size = f->get_length();
+	pf.encrypted = p_encrypt;
+	pf.compressed = p_compress;
 
-	Vector<uint8_t> data = FileAccess::get_file_as_array(p_src);
-	{
-		unsigned char hash[16];
-		CryptoCore::md5(data.ptr(), data.size(), hash);
-		pf.md5.resize(16);
-		for (int i = 0; i < 16; i++) {
-			pf.md5.write[i] = hash[i];
-		}
+	files.push_back(pf);
+
+	return OK;
+}
+
+uint64_t PCKPacker::_get_directory_size() const {
+	uint64_t dir_size = 0;
+	for (int i = 0; i < files.size(); i++) {
+		int string_len = files[i].path.utf8().length();
+		dir_size += 4 + string_len + _get_pad(4, string_len) + 8 + 8 + 16 + 4;
+	}
+	if (enc_dir) {
+		dir_size += _get_pad(16, dir_size); // Pad to encryption block size.
+		dir_size += 16 + 8 + 16; // hash, data size and iv.
+	}
+	return dir_size;
+}
+
+void PCKPacker::_hash_file(File &r_file) {
+	if (!r_file.md5.is_empty()) {
+		return;
 	}
-	pf.encrypted = p_encrypt;
 
-	uint64_t _size = pf.size;
-	if (p_encrypt) { // Add encryption overhead.
-		if (_size % 16) { // Pad to encryption block size.
-			_size += 16 - (_size % 16);
+	Ref<FileAccess> src = FileAccess::open(r_file.src_path, FileAccess::READ);
+	if (src.is_null()) {
+		return;
+	}
+
+	LocalVector<uint8_t> buf;
+	buf.resize(PCK_PACKER_COPY_BUFFER_SIZE);
+	CryptoCore::MD5Context ctx;
+	ctx.start();
+	while (true) {
+		uint64_t read = src->get_buffer(buf.ptr(), buf.size());
+		if (read == 0) {
+			break;
 		}
-		_size += 16; // hash
-		_size += 8; // data size
-		_size += 16; // iv
+		ctx.update(buf.ptr(), read);
 	}
 
-	int pad = _get_pad(alignment, ofs + _size);
-	ofs = ofs + _size + pad;
+	unsigned char hash[16];
+	ctx.finish(hash);
+	r_file.md5.resize(16);
+	memcpy(r_file.md5.ptrw(), hash, 16);
+}
 
-	files.push_back(pf);
+void PCKPacker::_prepare_file(File &r_file, const Ref<CompressionDictionary> &p_dictionary, uint32_t p_block_size, PreparedFile &r_prepared) {
+	if (!r_file.compressed && r_file.size > PCK_PACKER_STREAM_MIN_SIZE) {
+		r_prepared.streamed = true;
+		return;
+	}
 
-	return OK;
+	Vector<uint8_t> data = FileAccess::get_file_as_array(r_file.src_path, &r_prepared.error);
+	if (r_prepared.error != OK) {
+		return;
+	}
+
+	if (r_file.md5.is_empty()) {
+		unsigned char hash[16];
+		CryptoCore::md5(data.ptr(), data.size(), hash);
+		r_file.md5.resize(16);
+		memcpy(r_file.md5.ptrw(), hash, 16);
+	}
+
+	if (!r_file.compressed) {
+		r_prepared.data = data;
+		return;
+	}
+
+	// Large enough for the worst case. One byte more, so a completely full buffer is not reported as EOF.
+	const uint64_t block_count = (data.size() / p_block_size) + 1;
+	const uint64_t magic_size = strlen(PACK_COMPRESSED_FILE_MAGIC);
+	const uint64_t max_size = magic_size * 2 + 12 + block_count * (4 + Compression::get_max_compressed_buffer_size(p_block_size, Compression::MODE_ZSTD));
+	r_prepared.data.resize(max_size + 1);
+
+	Ref<FileAccessMemory> fm;
+	fm.instantiate();
+	fm->open_custom(r_prepared.data.ptr(), r_prepared.data.size());
+	r_prepared.error = FileAccessCompressed::store_blocks(fm, PACK_COMPRESSED_FILE_MAGIC, data.ptr(), data.size(), Compression::MODE_ZSTD, p_block_size, p_dictionary);
+	r_prepared.data.resize(fm->get_position());
 }
 
-Error PCKPacker::flush(bool p_verbose) {
-	ERR_FAIL_COND_V_MSG(file.is_null(), ERR_INVALID_PARAMETER, "File must be opened before use.");
+Error PCKPacker::_store_files(const LocalVector<int> &p_indices, int64_t p_file_base, const Ref<CompressionDictionary> &p_dictionary, bool p_verbose) {
+	File *fw = files.ptrw();
+	LocalVector<uint8_t> buf;
+	buf.resize(PCK_PACKER_COPY_BUFFER_SIZE);
+
+	uint32_t done = 0;
+	while (done < p_indices.size()) {
+		// Read, hash and compress a batch of files in parallel, then write them in order.
+		uint32_t batch_end = done;
+		uint64_t batch_size = 0;
+		while (batch_end < p_indices.size() && (batch_end == done || batch_size < PCK_PACKER_BATCH_MAX_SIZE)) {
+			const File &pf = fw[p_indices[batch_end]];
+			if (pf.compressed || pf.size <= PCK_PACKER_STREAM_MIN_SIZE) {
+				batch_size += pf.size;
+			}
+			batch_end++;
+		}
 
-	int64_t file_base_ofs = file->get_position();
-	file->store_64(0); // files base
+		LocalVector<PreparedFile> prepared;
+		prepared.resize(batch_end - done);
+		parallel_for(
+				done, batch_end, [&](uint32_t p_begin, uint32_t p_end) {
+					for (uint32_t i = p_begin; i < p_end; i++) {
+						_prepare_file(fw[p_indices[i]], p_dictionary, compression_block_size, prepared[i - done]);
+					}
+				},
+				1, "PCKPacker::flush");
+
+		for (uint32_t i = done; i < batch_end; i++) {
+			File &pf = fw[p_indices[i]];
+			PreparedFile &pp = prepared[i - done];
+			ERR_FAIL_COND_V_MSG(pp.error != OK, pp.error, "Can't store file: " + pf.src_path + ".");
+
+			pf.ofs = file->get_position() - p_file_base;
+
+			Ref<FileAccess> ftmp = file;
+			Ref<FileAccessEncrypted> fae;
+			if (pf.encrypted) {
+				fae.instantiate();
+				ERR_FAIL_COND_V(fae.is_null(), ERR_CANT_CREATE);
+
+				Error err = fae->open_and_parse(file, key, FileAccessEncrypted::MODE_WRITE_AES256, false);
+				ERR_FAIL_COND_V(err != OK, ERR_CANT_CREATE);
+				ftmp = fae;
+			}
 
-	for (int i = 0; i < 16; i++) {
-		file->store_32(0); // reserved
+			if (pp.streamed) {
+				Ref<FileAccess> src = FileAccess::open(pf.src_path, FileAccess::READ);
+				ERR_FAIL_COND_V_MSG(src.is_null(), ERR_FILE_CANT_OPEN, "Can't open file: " + pf.src_path + ".");
+
+				bool hash = pf.md5.is_empty();
+				CryptoCore::MD5Context ctx;
+				if (hash) {
+					ctx.start();
+				}
+				uint64_t to_write = pf.size;
+				while (to_write > 0) {
+					uint64_t read = src->get_buffer(buf.ptr(), MIN(to_write, (uint64_t)buf.size()));
+					ERR_FAIL_COND_V_MSG(read == 0, ERR_FILE_CANT_READ, "File changed while packing: " + pf.src_path + ".");
+					if (hash) {
+						ctx.update(buf.ptr(), read);
+					}
+					ftmp->store_buffer(buf.ptr(), read);
+					to_write -= read;
+				}
+				if (hash) {
+					unsigned char md5[16];
+					ctx.finish(md5);
+					pf.md5.resize(16);
+					memcpy(pf.md5.ptrw(), md5, 16);
+				}
+			} else {
+				ftmp->store_buffer(pp.data.ptr(), pp.data.size());
+				pf.size = pp.data.size();
+				pp.data.clear();
+			}
+
+			if (fae.is_valid()) {
+				ftmp.unref();
+				fae.unref();
+			}
+
+			int pad = _get_pad(alignment, file->get_position());
+			for (int j = 0; j < pad; j++) {
+				file->store_8(Math::rand() % 256);
+			}
+
+			if (p_verbose) {
+				print_line(vformat("[%d/%d - %d%%] PCKPacker flush: %s -> %s", i + 1, p_indices.size(), float(i + 1) / p_indices.size() * 100, pf.src_path, pf.path));
+			}
+		}
+
+		done = batch_end;
 	}
 
-	// write the index
-	file->store_32(files.size());
+	return OK;
+}
 
-	Ref<FileAccessEncrypted> fae;
+Error PCKPacker::_store_directory(int64_t p_dir_ofs, uint64_t p_dir_size) {
+	file->seek(p_dir_ofs);
 	Ref<FileAccess> fhead = file;
+	Ref<FileAccessEncrypted> fae;
 
 	if (enc_dir) {
 		fae.instantiate();
@@ -191,6 +508,9 @@ Error PCKPacker::flush(bool p_verbose) {
 		if (files[i].encrypted) {
 			flags |= PACK_FILE_ENCRYPTED;
 		}
+		if (files[i].compressed) {
+			flags |= PACK_FILE_COMPRESSED;
+		}
 		fhead->store_32(flags);
 	}
 
@@ -198,64 +518,373 @@ Error PCKPacker::flush(bool p_verbose) {
 		fhead.unref();
 		fae.unref();
 	}
+	ERR_FAIL_COND_V_MSG(file->get_position() != (uint64_t)p_dir_ofs + p_dir_size, ERR_BUG, "PCK directory size mismatch.");
+
+	return OK;
+}
+
+int64_t PCKPacker::_reserve_header(int64_t &r_dir_ofs, uint64_t &r_dir_size) {
+	file->store_64(0); // files base
+	file->store_64(0); // dictionary offset
+	file->store_32(0); // dictionary size
+
+	for (int i = 3; i < 16; i++) {
+		file->store_32(0); // reserved
+	}
+
+	// write the index
+	file->store_32(files.size());
+
+	// The directory is written once all files are stored and their offsets and sizes known. Reserve its space.
+	r_dir_ofs = file->get_position();
+	r_dir_size = _get_directory_size();
+
+	{
+		LocalVector<uint8_t> zero;
+		zero.resize(PCK_PACKER_COPY_BUFFER_SIZE);
+		memset(zero.ptr(), 0, zero.size());
+		for (uint64_t left = r_dir_size; left > 0;) {
+			uint64_t chunk = MIN(left, (uint64_t)zero.size());
+			file->store_buffer(zero.ptr(), chunk);
+			left -= chunk;
+		}
+	}
 
 	int header_padding = _get_pad(alignment, file->get_position());
 	for (int i = 0; i < header_padding; i++) {
 		file->store_8(Math::rand() % 256);
 	}
 
-	int64_t file_base = file->get_position();
-	file->seek(file_base_ofs);
-	file->store_64(file_base); // update files base
-	file->seek(file_base);
+	return file->get_position();
+}
 
-	const uint32_t buf_max = 65536;
-	uint8_t *buf = memnew_arr(uint8_t, buf_max);
+uint64_t PCKPacker::_store_dictionary(const Ref<CompressionDictionary> &p_dictionary, int64_t p_file_base) {
+	if (p_dictionary.is_null()) {
+		return 0;
+	}
 
-	int count = 0;
-	for (int i = 0; i < files.size(); i++) {
-		Ref<FileAccess> src = FileAccess::open(files[i].src_path, FileAccess::READ);
-		uint64_t to_write = files[i].size;
+	uint64_t dictionary_ofs = file->get_position() - p_file_base;
+	file->store_buffer(p_dictionary->get_data().ptr(), p_dictionary->get_data().size());
 
-		Ref<FileAccess> ftmp = file;
-		if (files[i].encrypted) {
-			fae.instantiate();
-			ERR_FAIL_COND_V(fae.is_null(), ERR_CANT_CREATE);
+	int pad = _get_pad(alignment, file->get_position());
+	for (int j = 0; j < pad; j++) {
+		file->store_8(Math::rand() % 256);
+	}
+
+	return dictionary_ofs;
+}
+
+void PCKPacker::_store_header_offsets(int64_t p_header_ofs, int64_t p_file_base, uint64_t p_dictionary_ofs, const Ref<CompressionDictionary> &p_dictionary) {
+	file->seek(p_header_ofs);
+	file->store_64(p_file_base); // update files base
+	if (p_dictionary.is_valid()) {
+		file->store_64(p_dictionary_ofs);
+		file->store_32(p_dictionary->get_data().size());
+	}
+}
+
+Error PCKPacker::flush(bool p_verbose) {
+	ERR_FAIL_COND_V_MSG(file.is_null(), ERR_INVALID_PARAMETER, "File must be opened before use.");
+
+	if (updating) {
+		return _flush_update(p_verbose);
+	}
+
+	// Compressed files share a dictionary built from the start of their contents. It's stored in plain text,
+	// so encrypted files don't contribute to it (they still use it).
+	Ref<CompressionDictionary> dictionary;
+	if (compression_dictionary_size > 0) {
+		Vector<Vector<uint8_t>> samples;
+		for (int i = 0; i < files.size(); i++) {
+			if (!files[i].compressed || files[i].encrypted) {
+				continue;
+			}
+			Ref<FileAccess> src = FileAccess::open(files[i].src_path, FileAccess::READ);
+			ERR_CONTINUE(src.is_null());
+			Vector<uint8_t> sample;
+			sample.resize(MIN(src->get_length(), (uint64_t)compression_block_size));
+			src->get_buffer(sample.ptrw(), sample.size());
+			samples.push_back(sample);
+		}
+		if (samples.size() > 1) {
+			dictionary = CompressionDictionary::create_from_samples(samples, compression_dictionary_size);
+		}
+	}
+
+	int64_t file_base_ofs = file->get_position();
+	int64_t dir_ofs = 0;
+	uint64_t dir_size = 0;
+	int64_t file_base = _reserve_header(dir_ofs, dir_size);
+	uint64_t dictionary_ofs = _store_dictionary(dictionary, file_base);
+
+	LocalVector<int> indices;
+	indices.resize(files.size());
+	for (int i = 0; i < files.size(); i++) {
+		indices[i] = i;
+	}
+	Error err = _store_files(indices, file_base, dictionary, p_verbose);
+	if (err != OK) {
+		return err;
+	}
 
-			Error err = fae->open_and_parse(file, key, FileAccessEncrypted::MODE_WRITE_AES256, false);
-			ERR_FAIL_COND_V(err != OK, ERR_CANT_CREATE);
-			ftmp = fae;
+	_store_header_offsets(file_base_ofs, file_base, dictionary_ofs, dictionary);
+	if (dictionary.is_valid()) {
+		uint32_t pack_flags = PACK_COMPRESSION_DICTIONARY;
+		if (enc_dir) {
+			pack_flags |= PACK_DIR_ENCRYPTED;
 		}
+		file->seek(file_base_ofs - 4);
+		file->store_32(pack_flags); // flags
+	}
+
+	err = _store_directory(dir_ofs, dir_size);
+	if (err != OK) {
+		return err;
+	}
+
+	if (p_verbose) {
+		printf("\n");
+	}
 
-		while (to_write > 0) {
-			uint64_t read = src->get_buffer(buf, MIN(to_write, buf_max));
-			ftmp->store_buffer(buf, read);
-			to_write -= read;
+	file.unref();
+
+	return OK;
+}
+
+Error PCKPacker::_flush_update(bool p_verbose) {
+	// Unchanged files are recognized by their contents, so everything is hashed first.
+	File *fw = files.ptrw();
+	parallel_for(
+			0, files.size(), [&](uint32_t p_begin, uint32_t p_end) {
+				for (uint32_t i = p_begin; i < p_end; i++) {
+					_hash_file(fw[i]);
+				}
+			},
+			1, "PCKPacker::flush");
+
+	HashMap<String, int> existing;
+	for (int i = 0; i < update_files.size(); i++) {
+		existing[_get_content_key(update_files[i].md5, update_files[i].encrypted, update_files[i].compressed)] = i;
+	}
+
+	LocalVector<int> changed;
+	LocalVector<int> reused;
+	for (int i = 0; i < files.size(); i++) {
+		ERR_FAIL_COND_V_MSG(fw[i].md5.is_empty(), ERR_FILE_CANT_READ, "Can't read file: " + fw[i].src_path + ".");
+		const int *E = existing.getptr(_get_content_key(fw[i].md5, fw[i].encrypted, fw[i].compressed));
+		if (E) {
+			fw[i].ofs = update_files[*E].ofs;
+			fw[i].size = update_files[*E].size;
+			reused.push_back(i);
+		} else {
+			changed.push_back(i);
 		}
+	}
 
-		if (fae.is_valid()) {
-			ftmp.unref();
-			fae.unref();
+	// The data of files that were replaced or removed stays in the pack. Once it takes more space than the data
+	// still used, the pack is rewritten without it instead of being updated in place.
+	uint64_t used_size = update_dictionary.is_valid() ? update_dictionary->get_data().size() : 0;
+	HashSet<uint64_t> used_ofs;
+	for (uint32_t i = 0; i < reused.size(); i++) {
+		const File &pf = fw[reused[i]];
+		if (!used_ofs.has(pf.ofs)) {
+			used_ofs.insert(pf.ofs);
+			used_size += _get_stored_size(pf.size, pf.encrypted);
 		}
+	}
+	const int64_t unused_size = (int64_t)file->get_length() - update_file_base - (int64_t)used_size;
+	if (unused_size > (int64_t)used_size) {
+		return _flush_compacted(reused, changed, p_verbose);
+	}
+
+	// New data goes at the end. The directory stays in place, and if it grows, what it would overwrite is moved to the end too.
+	const uint64_t dir_size = _get_directory_size();
+	const int64_t dir_end = update_dir_ofs + dir_size;
+	file->seek_end();
+	int64_t write_end = MAX((int64_t)file->get_length(), dir_end);
+	write_end += _get_pad(alignment, write_end);
+	while ((int64_t)file->get_position() < write_end) {
+		file->store_8(Math::rand() % 256);
+	}
 
+	LocalVector<uint8_t> buf;
+	buf.resize(PCK_PACKER_COPY_BUFFER_SIZE);
+	HashMap<uint64_t, uint64_t> moved; // Old offset to new offset, entries with the same contents share their data.
+	auto move_data = [&](uint64_t p_ofs, uint64_t p_size) -> uint64_t {
+		const uint64_t *M = moved.getptr(p_ofs);
+		if (M) {
+			return *M;
+		}
+		uint64_t new_ofs = write_end - update_file_base;
+		for (uint64_t copied = 0; copied < p_size;) {
+			uint64_t chunk = MIN(p_size - copied, (uint64_t)buf.size());
+			file->seek(update_file_base + p_ofs + copied);
+			file->get_buffer(buf.ptr(), chunk);
+			file->seek(write_end + copied);
+			file->store_buffer(buf.ptr(), chunk);
+			copied += chunk;
+		}
 		int pad = _get_pad(alignment, file->get_position());
 		for (int j = 0; j < pad; j++) {
 			file->store_8(Math::rand() % 256);
 		}
-
-		count += 1;
-		const int file_num = files.size();
-		if (p_verbose && (file_num > 0)) {
-			print_line(vformat("[%d/%d - %d%%] PCKPacker flush: %s -> %s", count, file_num, float(count) / file_num * 100, files[i].src_path, files[i].path));
+		write_end = file->get_position();
+		moved[p_ofs] = new_ofs;
+		return new_ofs;
+	};
+
+	for (uint32_t i = 0; i < reused.size(); i++) {
+		File &pf = fw[reused[i]];
+		if (update_file_base + (int64_t)pf.ofs < dir_end) {
+			pf.ofs = move_data(pf.ofs, _get_stored_size(pf.size, pf.encrypted));
 		}
 	}
 
+	bool dictionary_moved = false;
+	if (update_dictionary.is_valid() && update_file_base + (int64_t)update_dictionary_ofs < dir_end) {
+		update_dictionary_ofs = move_data(update_dictionary_ofs, update_dictionary->get_data().size());
+		dictionary_moved = true;
+	}
+
+	file->seek(write_end);
+	Error err = _store_files(changed, update_file_base, update_dictionary, p_verbose);
+	if (err != OK) {
+		return err;
+	}
+
+	// Everything the new directory points to is written, only now replace the old one.
+	if (dictionary_moved) {
+		file->seek(update_dictionary_ofs_pos);
+		file->store_64(update_dictionary_ofs);
+	}
+	file->seek(update_dir_ofs - 4);
+	file->store_32(files.size());
+	file->seek(4);
+	file->store_32(PACK_FORMAT_VERSION); // Files stored now may use features older versions don't have.
+
+	err = _store_directory(update_dir_ofs, dir_size);
+	if (err != OK) {
+		return err;
+	}
+
 	if (p_verbose) {
-		printf("\n");
+		print_line(vformat("PCKPacker flush: %d files reused, %d files written.", reused.size(), changed.size()));
 	}
 
 	file.unref();
-	memdelete_arr(buf);
+	updating = false;
+	update_files.clear();
+	update_dictionary.unref();
 
 	return OK;
 }
+
+Error PCKPacker::_flush_compacted(const LocalVector<int> &p_reused, const LocalVector<int> &p_changed, bool p_verbose) {
+	// The new pack is written next to the old one, which is only replaced once complete.
+	const String tmp_path = update_path + ".tmp";
+	Ref<FileAccess> old_file = file;
+	file = FileAccess::open(tmp_path, FileAccess::WRITE);
+	if (file.is_null()) {
+		file = old_file;
+		ERR_FAIL_V_MSG(ERR_CANT_CREATE, "Can't open file to write: " + tmp_path + ".");
+	}
+
+	file->store_32(PACK_HEADER_MAGIC);
+	file->store_32(PACK_FORMAT_VERSION);
+	file->store_32(VERSION_MAJOR);
+	file->store_32(VERSION_MINOR);
+	file->store_32(VERSION_PATCH);
+
+	uint32_t pack_flags = 0;
+	if (enc_dir) {
+		pack_flags |= PACK_DIR_ENCRYPTED;
+	}
+	if (update_dictionary.is_valid()) {
+		pack_flags |= PACK_COMPRESSION_DICTIONARY;
+	}
+	file->store_32(pack_flags); // flags
+
+	int64_t file_base_ofs = file->get_position();
+	int64_t dir_ofs = 0;
+	uint64_t dir_size = 0;
+	int64_t file_base = _reserve_header(dir_ofs, dir_size);
+	uint64_t dictionary_ofs = _store_dictionary(update_dictionary, file_base);
+
+	// Reused files are copied as stored, without decrypting or decompressing them.
+	File *fw = files.ptrw();
+	LocalVector<uint8_t> buf;
+	buf.resize(PCK_PACKER_COPY_BUFFER_SIZE);
+	HashMap<uint64_t, uint64_t> copied; // Old offset to new offset, entries with the same contents share their data.
+	for (uint32_t i = 0; i < p_reused.size(); i++) {
+		File &pf = fw[p_reused[i]];
+		const uint64_t *C = copied.getptr(pf.ofs);
+		if (C) {
+			pf.ofs = *C;
+			continue;
+		}
+		const uint64_t new_ofs = file->get_position() - file_base;
+		const uint64_t size = _get_stored_size(pf.size, pf.encrypted);
+		old_file->seek(update_file_base + pf.ofs);
+		for (uint64_t left = size; left > 0;) {
+			uint64_t chunk = MIN(left, (uint64_t)buf.size());
+			if (old_file->get_buffer(buf.ptr(), chunk) != chunk) {
+				file.unref();
+				old_file.unref();
+				DirAccess::remove_absolute(tmp_path);
+				ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't read file '" + pf.path + "' from pack: " + update_path + ".");
+			}
+			file->store_buffer(buf.ptr(), chunk);
+			left -= chunk;
+		}
+		int pad = _get_pad(alignment, file->get_position());
+		for (int j = 0; j < pad; j++) {
+			file->store_8(Math::rand() % 256);
+		}
+		copied[pf.ofs] = new_ofs;
+		pf.ofs = new_ofs;
+	}
+
+	Error err = _store_files(p_changed, file_base, update_dictionary, p_verbose);
+	if (err == OK) {
+		_store_header_offsets(file_base_ofs, file_base, dictionary_ofs, update_dictionary);
+		err = _store_directory(dir_ofs, dir_size);
+	}
+
+	file.unref();
+	old_file.unref();
+	if (err != OK) {
+		DirAccess::remove_absolute(tmp_path);
+		return err;
+	}
+
+	err = DirAccess::rename_absolute(tmp_path, update_path);
+	ERR_FAIL_COND_V_MSG(err != OK, err, "Can't replace pack '" + update_path + "' with its compacted version.");
+
+	if (p_verbose) {
+		print_line(vformat("PCKPacker flush: %d files reused, %d files written, unused data removed.", p_reused.size(), p_changed.size()));
+	}
+
+	updating = false;
+	update_files.clear();
+	update_dictionary.unref();
+
+	return OK;
+}
+
+void PCKPacker::set_compression_block_size(int p_size) {
+	ERR_FAIL_COND_MSG(p_size < 4096 || p_size > 16777216, "Compression block size must be between 4 KiB and 16 MiB.");
+	compression_block_size = p_size;
+}
+
+int PCKPacker::get_compression_block_size() const {
+	return compression_block_size;
+}
+
+void PCKPacker::set_compression_dictionary_size(int p_size) {
+	ERR_FAIL_COND(p_size < 0);
+	compression_dictionary_size = p_size;
+}
+
+int PCKPacker::get_compression_dictionary_size() const {
+	return compression_dictionary_size;
+}
@@ -32,7 +32,9 @@
 #define PCK_PACKER_H
 
 #include "core/object/ref_counted.h"
+#include "core/templates/local_vector.h"
 
+class CompressionDictionary;
 class FileAccess;
 
 class PCKPacker : public RefCounted {
@@ -40,7 +42,8 @@ class PCKPacker : public RefCounted {
 
 	Ref<FileAccess> file;
 	int alignment = 0;
-	uint64_t ofs = 0;
+	uint32_t compression_block_size = 65536;
+	int compression_dictionary_size = 65536;
 
 	Vector<uint8_t> key;
 	bool enc_dir = false;
@@ -51,17 +54,53 @@ class PCKPacker : public RefCounted {
 		String path;
 		String src_path;
 		uint64_t ofs = 0;
-		uint64_t size = 0;
+		uint64_t size = 0; // Stored size, only known once flushed for compressed files.
 		bool encrypted = false;
+		bool compressed = false;
 		Vector<uint8_t> md5;
 	};
 	Vector<File> files;
 
+	// Contents of a file as stored in the pack (before encryption), read and compressed ahead of writing.
+	struct PreparedFile {
+		Vector<uint8_t> data;
+		bool streamed = false; // Too large to keep in memory, copied from the source while writing.
+		Error error = OK;
+	};
+
+	// State of the pack opened with pck_update().
+	bool updating = false;
+	String update_path;
+	int64_t update_dir_ofs = 0;
+	int64_t update_file_base = 0;
+	uint64_t update_dictionary_ofs = 0;
+	int64_t update_dictionary_ofs_pos = 0; // Where the dictionary offset is stored in the header.
+	Ref<CompressionDictionary> update_dictionary;
+	Vector<File> update_files;
+
+	Error _parse_key(const String &p_key);
+	uint64_t _get_directory_size() const;
+	static void _hash_file(File &r_file);
+	static void _prepare_file(File &r_file, const Ref<CompressionDictionary> &p_dictionary, uint32_t p_block_size, PreparedFile &r_prepared);
+	Error _store_files(const LocalVector<int> &p_indices, int64_t p_file_base, const Ref<CompressionDictionary> &p_dictionary, bool p_verbose);
+	int64_t _reserve_header(int64_t &r_dir_ofs, uint64_t &r_dir_size);
+	uint64_t _store_dictionary(const Ref<CompressionDictionary> &p_dictionary, int64_t p_file_base);
+	void _store_header_offsets(int64_t p_header_ofs, int64_t p_file_base, uint64_t p_dictionary_ofs, const Ref<CompressionDictionary> &p_dictionary);
+	Error _store_directory(int64_t p_dir_ofs, uint64_t p_dir_size);
+	Error _flush_update(bool p_verbose);
+	Error _flush_compacted(const LocalVector<int> &p_reused, const LocalVector<int> &p_changed, bool p_verbose);
+
 public:
 	Error pck_start(const String &p_file, int p_alignment = 32, const String &p_key = "0000000000000000000000000000000000000000000000000000000000000000", bool p_encrypt_directory = false);
-	Error add_file(const String &p_file, const String &p_src, bool p_encrypt = false);
+	Error pck_update(const String &p_file, int p_alignment = 32, const String &p_key = "0000000000000000000000000000000000000000000000000000000000000000");
+	Error add_file(const String &p_file, const String &p_src, bool p_encrypt = false, bool p_compress = false);
 	Error flush(bool p_verbose = false);
 
+	void set_compression_block_size(int p_size);
+	int get_compression_block_size() const;
+	void set_compression_dictionary_size(int p_size);
+	int get_compression_dictionary_size() const;
+
 	PCKPacker() {}
 };
 
@@ -468,7 +468,17 @@ Mutex ResourceCache::lock;
 RWLock ResourceCache::path_cache_lock;
 #endif
 
+BinaryMutex ResourceCache::retained_lock;
+List<ResourceCache::RetainedResource> ResourceCache::retained;
+HashMap<const Resource *, List<ResourceCache::RetainedResource>::Element *> ResourceCache::retained_map;
+uint64_t ResourceCache::retained_budget = 0;
+uint64_t ResourceCache::retained_memory[MEMORY_CATEGORY_MAX] = {};
+uint64_t ResourceCache::retained_memory_total = 0;
+SafeNumeric<uint64_t> ResourceCache::eviction_count;
+
 void ResourceCache::clear() {
+	clear_retained();
+
 	if (resources.size()) {
 		ERR_PRINT("Resources still in use at exit (run with --verbose for details).");
 		if (OS::get_singleton()->is_stdout_verbose()) {
@@ -542,3 +552,122 @@ int ResourceCache::get_cached_resource_count() {
 
 	return rc;
 }
+
+ResourceCache::MemoryCategory ResourceCache::_get_memory_category(const Ref<Resource> &p_resource) {
+	if (p_resource->is_class("Texture")) {
+		return MEMORY_CATEGORY_TEXTURE;
+	}
+	if (p_resource->is_class("Mesh")) {
+		return MEMORY_CATEGORY_MESH;
+	}
+	if (p_resource->is_class("AudioStream")) {
+		return MEMORY_CATEGORY_AUDIO;
+	}
+	return MEMORY_CATEGORY_OTHER;
+}
+
+void ResourceCache::_evict_retained(List<Ref<Resource>> &r_evicted) {
+	// Must be called with retained_lock held. Evicted references are handed back
+	// to the caller so they are released (and possibly freed) outside the lock.
+	List<RetainedResource>::Element *E = retained.back();
+	while (E && retained_memory_total > retained_budget) {
+		List<RetainedResource>::Element *prev = E->prev();
+		if (E->get().resource->get_reference_count() <= 1) {
+			// Only the cache holds it, so it can go.
+			retained_memory[E->get().category] -= E->get().memory;
+			retained_memory_total -= E->get().memory;
+			retained_map.erase(E->get().resource.ptr());
+			r_evicted.push_back(E->get().resource);
+			retained.erase(E);
+			eviction_count.increment();
+		}
+		E = prev;
+	}
+}
+
+void ResourceCache::set_retained_budget(uint64_t p_bytes) {
+	if (p_bytes == 0) {
+		retained_budget = 0;
+		clear_retained();
+		return;
+	}
+
+	List<Ref<Resource>> evicted;
+	retained_lock.lock();
+	retained_budget = p_bytes;
+	_evict_retained(evicted);
+	retained_lock.unlock();
+}
+
+uint64_t ResourceCache::get_retained_budget() {
+	return retained_budget;
+}
+
+void ResourceCache::retain(const Ref<Resource> &p_resource) {
+	if (retained_budget == 0 || p_resource.is_null()) {
+		return;
+	}
+
+	// Measure outside the lock, this may query servers.
+	uint64_t memory = p_resource->get_memory_usage();
+	MemoryCategory category = _get_memory_category(p_resource);
+
+	List<Ref<Resource>> evicted;
+	retained_lock.lock();
+	List<RetainedResource>::Element **existing = retained_map.getptr(p_resource.ptr());
+	if (existing) {
+		// Move to the front and refresh the estimate, the data may have changed.
+		List<RetainedResource>::Element *E = *existing;
+		retained_memory[E->get().category] -= E->get().memory;
+		retained_memory_total -= E->get().memory;
+		E->get().memory = memory;
+		E->get().category = category;
+		retained.move_to_front(E);
+	} else {
+		RetainedResource rr;
+		rr.resource = p_resource;
+		rr.memory = memory;
+		rr.category = category;
+		retained_map.insert(p_resource.ptr(), retained.push_front(rr));
+	}
+	retained_memory[category] += memory;
+	retained_memory_total += memory;
+	_evict_retained(evicted);
+	retained_lock.unlock();
+}
+
+void ResourceCache::clear_retained() {
+	List<Ref<Resource>> evicted;
+	retained_lock.lock();
+	for (const RetainedResource &E : retained) {
+		evicted.push_back(E.resource);
+	}
+	retained.clear();
+	retained_map.clear();
+	for (int i = 0; i < MEMORY_CATEGORY_MAX; i++) {
+		retained_memory[i] = 0;
+	}
+	retained_memory_total = 0;
+	retained_lock.unlock();
+}
+
+int ResourceCache::get_retained_count() {
+	retained_lock.lock();
+	int rc = retained.size();
+	retained_lock.unlock();
+
+	return rc;
+}
+
+uint64_t ResourceCache::get_retained_memory(MemoryCategory p_category) {
+	ERR_FAIL_INDEX_V(p_category, MEMORY_CATEGORY_MAX, 0);
+	retained_lock.lock();
+	uint64_t mem = retained_memory[p_category];
+	retained_lock.unlock();
+
+	return mem;
+}
+
+uint64_t ResourceCache::get_eviction_count() {
+	return eviction_count.get();
+}
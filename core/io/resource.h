@@ -34,6 +34,7 @@
 #include "core/io/resource_uid.h"
 #include "core/object/class_db.h"
 #include "core/object/ref_counted.h"
+#include "core/templates/list.h"
 #include "core/templates/safe_refcount.h"
 #include "core/templates/self_list.h"
 
@@ -139,6 +140,7 @@ public:
 	bool is_translation_remapped() const;
 
 	virtual RID get_rid() const; // some resources may offer conversion to RID
+	virtual uint64_t get_memory_usage() const { return 0; } // Estimated size of the resource data, used for cache budgeting.
 
 #ifdef TOOLS_ENABLED
 	//helps keep IDs same number when loading/saving scenes. -1 clears ID and it Returns -1 when no id stored
@@ -151,10 +153,41 @@ public:
 };
 
 class ResourceCache {
+public:
+	enum MemoryCategory {
+		MEMORY_CATEGORY_TEXTURE,
+		MEMORY_CATEGORY_MESH,
+		MEMORY_CATEGORY_AUDIO,
+		MEMORY_CATEGORY_OTHER,
+		MEMORY_CATEGORY_MAX,
+	};
+
+private:
 	friend class Resource;
 	friend class ResourceLoader; //need the lock
 	static Mutex lock;
 	static HashMap<String, Resource *> resources;
+
+	// Loaded resources are kept alive here after their last user releases them,
+	// so reloading them is a cache hit. Least recently used entries that nobody
+	// else references are dropped once the memory budget is exceeded.
+	struct RetainedResource {
+		Ref<Resource> resource;
+		uint64_t memory = 0;
+		MemoryCategory category = MEMORY_CATEGORY_OTHER;
+	};
+
+	static BinaryMutex retained_lock;
+	static List<RetainedResource> retained; // Most recently used first.
+	static HashMap<const Resource *, List<RetainedResource>::Element *> retained_map;
+	static uint64_t retained_budget;
+	static uint64_t retained_memory[MEMORY_CATEGORY_MAX];
+	static uint64_t retained_memory_total;
+	static SafeNumeric<uint64_t> eviction_count; // Read without the lock.
+
+	static MemoryCategory _get_memory_category(const Ref<Resource> &p_resource);
+	static void _evict_retained(List<Ref<Resource>> &r_evicted);
+
 #ifdef TOOLS_ENABLED
 	static HashMap<String, HashMap<String, String>> resource_path_cache; // Each tscn has a set of resource paths and IDs.
 	static RWLock path_cache_lock;
@@ -169,6 +202,14 @@ public:
 	static Ref<Resource> get_ref(const String &p_path);
 	static void get_cached_resources(List<Ref<Resource>> *p_resources);
 	static int get_cached_resource_count();
+
+	static void set_retained_budget(uint64_t p_bytes); // 0 disables retaining.
+	static uint64_t get_retained_budget();
+	static void retain(const Ref<Resource> &p_resource);
+	static void clear_retained();
+	static int get_retained_count();
+	static uint64_t get_retained_memory(MemoryCategory p_category);
+	static uint64_t get_eviction_count();
 };
 
 #endif // RESOURCE_H
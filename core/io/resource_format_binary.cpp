@@ -36,6 +36,7 @@
 #include "core/io/image.h"
 #include "core/io/marshalls.h"
 #include "core/io/missing_resource.h"
+#include "core/templates/local_vector.h"
 #include "core/version.h"
 
 //#define print_bl(m_what) print_line(m_what)
@@ -153,14 +154,20 @@ StringName ResourceLoaderBinary::_get_string() {
 	uint32_t id = f->get_32();
 	if (id & 0x80000000) {
 		uint32_t len = id & 0x7FFFFFFF;
-		if ((int)len > str_buf.size()) {
-			str_buf.resize(len);
-		}
 		if (len == 0) {
 			return StringName();
 		}
-		f->get_buffer((uint8_t *)&str_buf[0], len);
 		String s;
+		// Decode straight from memory when the file is mapped.
+		const uint8_t *view = f->get_buffer_view(len);
+		if (view) {
+			s.parse_utf8((const char *)view, len);
+			return s;
+		}
+		if ((int)len > str_buf.size()) {
+			str_buf.resize(len);
+		}
+		f->get_buffer((uint8_t *)&str_buf[0], len);
 		s.parse_utf8(&str_buf[0]);
 		return s;
 	}
@@ -683,7 +690,7 @@ Error ResourceLoaderBinary::load() {
 
 		if (!path.contains("://") && path.is_relative_path()) {
 			// path is relative to file being loaded, so convert to a resource path
-			path = ProjectSettings::get_singleton()->localize_path(path.get_base_dir().path_join(external_resources[i].path));
+			path = ProjectSettings::get_singleton()->localize_path(local_path.get_base_dir().path_join(external_resources[i].path));
 		}
 
 		external_resources.write[i].path = path; //remap happens here, not on load because on load it can actually be used for filesystem dock resource remap
@@ -713,22 +720,36 @@ Error ResourceLoaderBinary::load() {
 		}
 	}
 
+	for (int i = 0; i < internal_resources.size() - 1; i++) {
+		String path = internal_resources[i].path;
+		if (path.begins_with("local://")) {
+			String id = path.replace_first("local://", "");
+			internal_resources.write[i].id = id;
+			internal_resources.write[i].path = res_path + "::" + id; // Update path.
+		}
+	}
+
+	if (has_dependency_table && !internal_resources.is_empty()) {
+		_find_needed_resources();
+	}
+
 	for (int i = 0; i < internal_resources.size(); i++) {
 		bool main = i == (internal_resources.size() - 1);
 
+		if (!internal_resources[i].needed) {
+			continue;
+		}
+
 		//maybe it is loaded already
 		String path;
 		String id;
 
 		if (!main) {
 			path = internal_resources[i].path;
+			id = internal_resources[i].id;
 
-			if (path.begins_with("local://")) {
-				path = path.replace_first("local://", "");
-				id = path;
-				path = res_path + "::" + path;
-
-				internal_resources.write[i].path = path; // Update path.
+			if (internal_index_cache.has(path)) {
+				continue; // Already taken from the cache by _find_needed_resources().
 			}
 
 			if (cache_mode == ResourceFormatLoader::CACHE_MODE_REUSE && ResourceCache::has(path)) {
@@ -870,6 +891,40 @@ Error ResourceLoaderBinary::load() {
 	return ERR_FILE_EOF;
 }
 
+void ResourceLoaderBinary::_find_needed_resources() {
+	// Only what the main resource can reach gets loaded. Sub-resources that are reused from
+	// the cache already hold their own references, so what only they use is skipped too.
+	int main_index = internal_resources.size() - 1;
+	for (int i = 0; i < main_index; i++) {
+		internal_resources.write[i].needed = false;
+	}
+
+	LocalVector<int> pending;
+	pending.push_back(main_index);
+	while (pending.size()) {
+		int index = pending[pending.size() - 1];
+		pending.resize(pending.size() - 1);
+
+		if (index != main_index && cache_mode == ResourceFormatLoader::CACHE_MODE_REUSE) {
+			const String &path = internal_resources[index].path;
+			Ref<Resource> cached = ResourceCache::get_ref(path);
+			if (cached.is_valid()) {
+				internal_index_cache[path] = cached;
+				continue;
+			}
+		}
+
+		const Vector<uint32_t> &dependencies = internal_resources[index].dependencies;
+		for (int i = 0; i < dependencies.size(); i++) {
+			uint32_t dependency = dependencies[i];
+			if (dependency < (uint32_t)main_index && !internal_resources[dependency].needed) {
+				internal_resources.write[dependency].needed = true;
+				pending.push_back(dependency);
+			}
+		}
+	}
+}
+
 void ResourceLoaderBinary::set_translation_remapped(bool p_remapped) {
 	translation_remapped = p_remapped;
 }
@@ -892,14 +947,19 @@ static String get_ustring(Ref<FileAccess> f) {
 
 String ResourceLoaderBinary::get_unicode_string() {
 	int len = f->get_32();
+	if (len <= 0) {
+		return String();
+	}
+	String s;
+	const uint8_t *view = f->get_buffer_view(len);
+	if (view) {
+		s.parse_utf8((const char *)view, len);
+		return s;
+	}
 	if (len > str_buf.size()) {
 		str_buf.resize(len);
 	}
-	if (len == 0) {
-		return String();
-	}
 	f->get_buffer((uint8_t *)&str_buf[0], len);
-	String s;
 	s.parse_utf8(&str_buf[0]);
 	return s;
 }
@@ -1013,6 +1073,8 @@ void ResourceLoaderBinary::open(Ref<FileAccess> p_f, bool p_no_resources, bool p
 		uid = ResourceUID::INVALID_ID;
 	}
 
+	uint64_t dependency_table_ofs = f->get_64(); // Was reserved, so zero in older files.
+
 	for (int i = 0; i < ResourceFormatSaverBinaryInstance::RESERVED_FIELDS; i++) {
 		f->get_32(); //skip a few reserved fields
 	}
@@ -1074,6 +1136,31 @@ void ResourceLoaderBinary::open(Ref<FileAccess> p_f, bool p_no_resources, bool p
 		f.unref();
 		ERR_FAIL_MSG("Premature end of file (EOF): " + local_path + ".");
 	}
+
+	if ((flags & ResourceFormatSaverBinaryInstance::FORMAT_FLAG_DEPENDENCY_TABLE) && dependency_table_ofs != 0) {
+		f->seek(dependency_table_ofs);
+		has_dependency_table = true;
+		for (uint32_t i = 0; i < int_resources_size; i++) {
+			uint32_t dependency_count = f->get_32();
+			if (f->eof_reached() || dependency_count > int_resources_size) {
+				has_dependency_table = false;
+				break;
+			}
+			Vector<uint32_t> &dependencies = internal_resources.write[i].dependencies;
+			dependencies.resize(dependency_count);
+			for (uint32_t j = 0; j < dependency_count; j++) {
+				dependencies.write[j] = f->get_32();
+			}
+		}
+
+		// Without a complete table, everything is loaded as in older files.
+		if (f->eof_reached()) {
+			has_dependency_table = false;
+		}
+		if (!has_dependency_table) {
+			WARN_PRINT("Broken sub-resource dependency table in '" + local_path + "', loading all sub-resources.");
+		}
+	}
 }
 
 String ResourceLoaderBinary::recognize(Ref<FileAccess> p_f) {
@@ -1300,6 +1387,10 @@ Error ResourceFormatLoaderBinary::rename_dependencies(const String &p_path, cons
 	fw->store_32(flags);
 	fw->store_64(uid_data);
 
+	uint64_t dependency_table_ofs_pos = fw->get_position();
+	uint64_t dependency_table_ofs = f->get_64();
+	fw->store_64(0);
+
 	for (int i = 0; i < ResourceFormatSaverBinaryInstance::RESERVED_FIELDS; i++) {
 		fw->store_32(0); // reserved
 		f->get_32();
@@ -1384,6 +1475,10 @@ Error ResourceFormatLoaderBinary::rename_dependencies(const String &p_path, cons
 
 	fw->seek(md_ofs);
 	fw->store_64(importmd_ofs + size_diff);
+	if (dependency_table_ofs != 0) {
+		fw->seek(dependency_table_ofs_pos);
+		fw->store_64(dependency_table_ofs + size_diff);
+	}
 
 	if (!all_ok) {
 		return ERR_CANT_CREATE;
@@ -1953,6 +2048,55 @@ void ResourceFormatSaverBinaryInstance::_find_resources(const Variant &p_variant
 	}
 }
 
+void ResourceFormatSaverBinaryInstance::find_dependencies(const Variant &p_property, const HashMap<Ref<Resource>, int> &p_resource_map, HashSet<int> &r_dependencies) {
+	// Same references as write_variant() stores as OBJECT_INTERNAL_RESOURCE.
+	switch (p_property.get_type()) {
+		case Variant::OBJECT: {
+			Ref<Resource> res = p_property;
+			if (res.is_null() || !res->is_built_in()) {
+				return;
+			}
+			const int *index = p_resource_map.getptr(res);
+			if (index) {
+				r_dependencies.insert(*index);
+			}
+		} break;
+		case Variant::ARRAY: {
+			Array array = p_property;
+			for (int i = 0; i < array.size(); i++) {
+				find_dependencies(array[i], p_resource_map, r_dependencies);
+			}
+		} break;
+		case Variant::DICTIONARY: {
+			Dictionary d = p_property;
+			List<Variant> keys;
+			d.get_key_list(&keys);
+			for (const Variant &E : keys) {
+				find_dependencies(E, p_resource_map, r_dependencies);
+				find_dependencies(d[E], p_resource_map, r_dependencies);
+			}
+		} break;
+		default: {
+		}
+	}
+}
+
+void ResourceFormatSaverBinaryInstance::write_dependency_table(Ref<FileAccess> f, uint64_t p_table_offset_pos, const Vector<HashSet<int>> &p_dependencies) {
+	// For each internal resource, the internal resources its properties reference, so loaders
+	// can skip the ones that aren't needed. Placed at the end so it doesn't move anything else.
+	uint64_t table_ofs = f->get_position();
+	for (int i = 0; i < p_dependencies.size(); i++) {
+		f->store_32(p_dependencies[i].size());
+		for (const int &E : p_dependencies[i]) {
+			f->store_32(E);
+		}
+	}
+
+	f->seek(p_table_offset_pos);
+	f->store_64(table_ofs);
+	f->seek_end();
+}
+
 void ResourceFormatSaverBinaryInstance::save_unicode_string(Ref<FileAccess> p_f, const String &p_string, bool p_bit_on_len) {
 	CharString utf8 = p_string.utf8();
 	if (p_bit_on_len) {
@@ -2038,7 +2182,7 @@ Error ResourceFormatSaverBinaryInstance::save(const String &p_path, const Ref<Re
 	save_unicode_string(f, _resource_get_class(p_resource));
 	f->store_64(0); //offset to import metadata
 	{
-		uint32_t format_flags = FORMAT_FLAG_NAMED_SCENE_IDS | FORMAT_FLAG_UIDS;
+		uint32_t format_flags = FORMAT_FLAG_NAMED_SCENE_IDS | FORMAT_FLAG_UIDS | FORMAT_FLAG_DEPENDENCY_TABLE;
 #ifdef REAL_T_IS_DOUBLE
 		format_flags |= FORMAT_FLAG_REAL_T_IS_DOUBLE;
 #endif
@@ -2046,6 +2190,8 @@ Error ResourceFormatSaverBinaryInstance::save(const String &p_path, const Ref<Re
 	}
 	ResourceUID::ID uid = ResourceSaver::get_resource_id_for_path(p_path, true);
 	f->store_64(uid);
+	uint64_t dependency_table_ofs_pos = f->get_position();
+	f->store_64(0); // Offset to the dependency table, written once resources are saved.
 	for (int i = 0; i < ResourceFormatSaverBinaryInstance::RESERVED_FIELDS; i++) {
 		f->store_32(0); // reserved
 	}
@@ -2180,8 +2326,11 @@ Error ResourceFormatSaverBinaryInstance::save(const String &p_path, const Ref<Re
 	}
 
 	Vector<uint64_t> ofs_table;
+	Vector<HashSet<int>> dependencies;
+	dependencies.resize(resources.size());
 
 	//now actually save the resources
+	int rd_index = 0;
 	for (const ResourceData &rd : resources) {
 		ofs_table.push_back(f->get_position());
 		save_unicode_string(f, rd.type);
@@ -2190,9 +2339,13 @@ Error ResourceFormatSaverBinaryInstance::save(const String &p_path, const Ref<Re
 		for (const Property &p : rd.properties) {
 			f->store_32(p.name_idx);
 			write_variant(f, p.value, resource_map, external_resources, string_map, p.pi);
+			find_dependencies(p.value, resource_map, dependencies.write[rd_index]);
 		}
+		rd_index++;
 	}
 
+	write_dependency_table(f, dependency_table_ofs_pos, dependencies);
+
 	for (int i = 0; i < ofs_table.size(); i++) {
 		f->seek(ofs_pos[i]);
 		f->store_64(ofs_table[i]);
@@ -71,9 +71,14 @@ class ResourceLoaderBinary {
 
 	struct IntResource {
 		String path;
+		String id;
 		uint64_t offset;
+		Vector<uint32_t> dependencies;
+		bool needed = true;
 	};
 
+	bool has_dependency_table = false;
+
 	Vector<IntResource> internal_resources;
 	HashMap<String, Ref<Resource>> internal_index_cache;
 
@@ -88,6 +93,7 @@ class ResourceLoaderBinary {
 	friend class ResourceFormatLoaderBinary;
 
 	Error parse_variant(Variant &r_v);
+	void _find_needed_resources();
 
 	HashMap<String, Ref<Resource>> dependency_cache;
 
@@ -165,12 +171,15 @@ public:
 		FORMAT_FLAG_NAMED_SCENE_IDS = 1,
 		FORMAT_FLAG_UIDS = 2,
 		FORMAT_FLAG_REAL_T_IS_DOUBLE = 4,
+		FORMAT_FLAG_DEPENDENCY_TABLE = 8,
 
-		// Amount of reserved 32-bit fields in resource header
-		RESERVED_FIELDS = 11
+		// Amount of reserved 32-bit fields in resource header, after the 64-bit dependency table offset.
+		RESERVED_FIELDS = 9
 	};
 	Error save(const String &p_path, const Ref<Resource> &p_resource, uint32_t p_flags = 0);
 	static void write_variant(Ref<FileAccess> f, const Variant &p_property, HashMap<Ref<Resource>, int> &resource_map, HashMap<Ref<Resource>, int> &external_resources, HashMap<StringName, int> &string_map, const PropertyInfo &p_hint = PropertyInfo());
+	static void find_dependencies(const Variant &p_property, const HashMap<Ref<Resource>, int> &p_resource_map, HashSet<int> &r_dependencies);
+	static void write_dependency_table(Ref<FileAccess> f, uint64_t p_table_offset_pos, const Vector<HashSet<int>> &p_dependencies);
 };
 
 class ResourceFormatSaverBinary : public ResourceFormatSaver {
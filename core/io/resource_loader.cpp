@@ -226,38 +226,11 @@ void ResourceLoader::_thread_load_function(void *p_userdata) {
 	ThreadLoadTask &load_task = *(ThreadLoadTask *)p_userdata;
 	load_task.loader_id = Thread::get_caller_id();
 
-	if (load_task.semaphore) {
-		//this is an actual thread, so wait for Ok from semaphore
-		thread_load_semaphore->wait(); //wait until its ok to start loading
-	}
 	load_task.resource = _load(load_task.remapped_path, load_task.remapped_path != load_task.local_path ? load_task.local_path : String(), load_task.type_hint, load_task.cache_mode, &load_task.error, load_task.use_sub_threads, &load_task.progress);
 
 	load_task.progress = 1.0; //it was fully loaded at this point, so force progress to 1.0
 
-	thread_load_mutex->lock();
-	if (load_task.error != OK) {
-		load_task.status = THREAD_LOAD_FAILED;
-	} else {
-		load_task.status = THREAD_LOAD_LOADED;
-	}
-	if (load_task.semaphore) {
-		if (load_task.start_next && thread_waiting_count > 0) {
-			thread_waiting_count--;
-			//thread loading count remains constant, this ends but another one begins
-			thread_load_semaphore->post();
-		} else {
-			thread_loading_count--; //no threads waiting, just reduce loading count
-		}
-
-		print_lt("END: load count: " + itos(thread_loading_count) + " / wait count: " + itos(thread_waiting_count) + " / suspended count: " + itos(thread_suspended_count) + " / active: " + itos(thread_loading_count - thread_suspended_count));
-
-		for (int i = 0; i < load_task.poll_requests; i++) {
-			load_task.semaphore->post();
-		}
-		memdelete(load_task.semaphore);
-		load_task.semaphore = nullptr;
-	}
-
+	// Nobody else touches the resource until the status is published, so finish it up without holding the lock.
 	if (load_task.resource.is_valid()) {
 		load_task.resource->set_path(load_task.local_path);
 
@@ -278,9 +251,58 @@ void ResourceLoader::_thread_load_function(void *p_userdata) {
 		if (_loaded_callback) {
 			_loaded_callback(load_task.resource, load_task.local_path);
 		}
+
+		if (load_task.cache_mode != ResourceFormatLoader::CACHE_MODE_IGNORE) {
+			ResourceCache::retain(load_task.resource);
+		}
 	}
 
+	LocalVector<WorkerThreadPool::TaskID> finished_tasks;
+
+	thread_load_mutex->lock();
+	if (load_task.error != OK) {
+		load_task.status = THREAD_LOAD_FAILED;
+	} else {
+		load_task.status = THREAD_LOAD_LOADED;
+	}
+
+	print_lt("END: " + load_task.local_path + " / waiters: " + itos(load_task.poll_requests));
+
+	for (int i = 0; i < load_task.poll_requests; i++) {
+		load_task.semaphore->post();
+	}
+	load_task.poll_requests = 0;
+
+	// Dependencies requested ahead that the format loader did not claim (it may have failed early, or resolved paths differently).
+	for (const String &E : load_task.dependency_tasks) {
+		load_task.sub_tasks.erase(E);
+		WorkerThreadPool::TaskID finished = _release_task(E);
+		if (finished != WorkerThreadPool::INVALID_TASK_ID) {
+			finished_tasks.push_back(finished);
+		}
+	}
+	load_task.dependency_tasks.clear();
 	thread_load_mutex->unlock();
+
+	for (uint32_t i = 0; i < finished_tasks.size(); i++) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(finished_tasks[i]);
+	}
+}
+
+WorkerThreadPool::TaskID ResourceLoader::_release_task(const String &p_local_path) {
+	// Must be called with thread_load_mutex locked. Returns the pool task the caller must still wait for (outside the lock), if any.
+	ThreadLoadTask *load_task = thread_load_tasks.getptr(p_local_path);
+	ERR_FAIL_COND_V(!load_task, WorkerThreadPool::INVALID_TASK_ID);
+
+	load_task->requests--;
+	if (load_task->requests > 0) {
+		return WorkerThreadPool::INVALID_TASK_ID;
+	}
+
+	WorkerThreadPool::TaskID task_id = load_task->awaited ? WorkerThreadPool::INVALID_TASK_ID : load_task->task_id;
+	memdelete(load_task->semaphore);
+	thread_load_tasks.erase(p_local_path);
+	return task_id;
 }
 
 static String _validate_local_path(const String &p_path) {
@@ -293,95 +315,197 @@ static String _validate_local_path(const String &p_path) {
 		return ProjectSettings::get_singleton()->localize_path(p_path);
 	}
 }
-Error ResourceLoader::load_threaded_request(const String &p_path, const String &p_type_hint, bool p_use_sub_threads, ResourceFormatLoader::CacheMode p_cache_mode, const String &p_source_resource) {
-	String local_path = _validate_local_path(p_path);
+
+// Resolves a dependency the way format loaders do, so the request made ahead is claimed by theirs. Empty if it can't be resolved.
+static String _resolve_dependency_path(const String &p_local_path, const String &p_dependency) {
+	ResourceUID::ID uid = ResourceUID::get_singleton()->text_to_id(p_dependency);
+	if (uid != ResourceUID::INVALID_ID) {
+		return ResourceUID::get_singleton()->has_id(uid) ? ResourceUID::get_singleton()->get_id_path(uid) : String();
+	}
+	if (!p_dependency.contains("://") && p_dependency.is_relative_path()) {
+		return ProjectSettings::get_singleton()->localize_path(p_local_path.get_base_dir().path_join(p_dependency));
+	}
+	return p_dependency;
+}
+
+ResourceLoader::ThreadLoadTask *ResourceLoader::_create_task(const String &p_local_path, const String &p_type_hint, bool p_use_sub_threads, ResourceFormatLoader::CacheMode p_cache_mode, const String &p_source_resource, WorkerThreadPool::TaskID &r_task_id) {
+	r_task_id = WorkerThreadPool::INVALID_TASK_ID;
 
 	thread_load_mutex->lock();
 
-	if (!p_source_resource.is_empty()) {
-		//must be loading from this resource
-		if (!thread_load_tasks.has(p_source_resource)) {
-			thread_load_mutex->unlock();
-			ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "There is no thread loading source resource '" + p_source_resource + "'.");
-		}
-		//must be loading from this thread
-		if (thread_load_tasks[p_source_resource].loader_id != Thread::get_caller_id()) {
-			thread_load_mutex->unlock();
-			ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "Threading loading resource'" + local_path + " failed: Source specified: '" + p_source_resource + "' but was not called by it.");
+	ThreadLoadTask *existing_task = thread_load_tasks.getptr(p_local_path);
+	if (existing_task) {
+		existing_task->requests++;
+		if (!p_source_resource.is_empty()) {
+			thread_load_tasks[p_source_resource].sub_tasks.insert(p_local_path);
 		}
+		r_task_id = existing_task->task_id;
+		thread_load_mutex->unlock();
+		return nullptr;
+	}
 
-		//must not be already added as s sub tasks
-		if (thread_load_tasks[p_source_resource].sub_tasks.has(local_path)) {
-			thread_load_mutex->unlock();
-			ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "Thread loading source resource '" + p_source_resource + "' already is loading '" + local_path + "'.");
+	//create load task
+
+	ThreadLoadTask new_task;
+
+	new_task.requests = 1;
+	new_task.remapped_path = _path_remap(p_local_path, &new_task.xl_remapped);
+	new_task.local_path = p_local_path;
+	new_task.type_hint = p_type_hint;
+	new_task.cache_mode = p_cache_mode;
+	new_task.use_sub_threads = p_use_sub_threads;
+	new_task.semaphore = memnew(Semaphore);
+
+	//must check if resource is already loaded before attempting to load it in a thread
+	Ref<Resource> existing = ResourceCache::get_ref(p_local_path);
+
+	if (existing.is_valid()) {
+		//referencing is fine
+		new_task.resource = existing;
+		new_task.status = THREAD_LOAD_LOADED;
+		new_task.progress = 1.0;
+		if (p_cache_mode != ResourceFormatLoader::CACHE_MODE_IGNORE) {
+			ResourceCache::retain(existing);
 		}
 	}
 
-	if (thread_load_tasks.has(local_path)) {
-		thread_load_tasks[local_path].requests++;
-		if (!p_source_resource.is_empty()) {
-			thread_load_tasks[p_source_resource].sub_tasks.insert(local_path);
-		}
-		thread_load_mutex->unlock();
-		return OK;
+	if (!p_source_resource.is_empty()) {
+		thread_load_tasks[p_source_resource].sub_tasks.insert(p_local_path);
 	}
 
-	{
-		//create load task
+	thread_load_tasks[p_local_path] = new_task;
+	// Elements don't move while other tasks are added or erased, and this one is kept alive by its request.
+	ThreadLoadTask *load_task = new_task.status == THREAD_LOAD_IN_PROGRESS ? thread_load_tasks.getptr(p_local_path) : nullptr;
 
-		ThreadLoadTask load_task;
+	thread_load_mutex->unlock();
 
-		load_task.requests = 1;
-		load_task.remapped_path = _path_remap(local_path, &load_task.xl_remapped);
-		load_task.local_path = local_path;
-		load_task.type_hint = p_type_hint;
-		load_task.cache_mode = p_cache_mode;
-		load_task.use_sub_threads = p_use_sub_threads;
+	return load_task;
+}
 
-		{ //must check if resource is already loaded before attempting to load it in a thread
+WorkerThreadPool::TaskID ResourceLoader::_request_task(const String &p_local_path, const String &p_type_hint, bool p_use_sub_threads, ResourceFormatLoader::CacheMode p_cache_mode, const String &p_source_resource) {
+	WorkerThreadPool::TaskID task_id;
+	ThreadLoadTask *load_task = _create_task(p_local_path, p_type_hint, p_use_sub_threads, p_cache_mode, p_source_resource, task_id);
+	if (!load_task) {
+		return task_id;
+	}
 
-			if (load_task.loader_id == Thread::get_caller_id()) {
-				thread_load_mutex->unlock();
-				ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "Attempted to load a resource already being loaded from this thread, cyclic reference?");
+	// When sub-resources are loaded in threads too, request the whole dependency graph first so it is
+	// scheduled depth first: each resource only starts once all its dependencies are done, and independent
+	// branches load in parallel without any pool thread blocking on another.
+	// Walked with an explicit stack, as dependency chains can be thousands of resources deep.
+	struct Request {
+		ThreadLoadTask *load_task = nullptr;
+		List<String> dependency_list;
+		const List<String>::Element *next_dependency = nullptr;
+		Vector<WorkerThreadPool::TaskID> dependencies;
+	};
+
+	LocalVector<Request> stack;
+	HashSet<String> scheduling; // Paths in the stack.
+
+	stack.push_back(Request());
+	stack[0].load_task = load_task;
+	if (p_use_sub_threads) {
+		get_dependencies(load_task->remapped_path, &stack[0].dependency_list, true);
+		stack[0].next_dependency = stack[0].dependency_list.front();
+		scheduling.insert(p_local_path);
+	}
+
+	while (true) {
+		Request &request = stack[stack.size() - 1];
+		const String &local_path = request.load_task->local_path;
+
+		if (request.next_dependency) {
+			const String &E = request.next_dependency->get();
+			request.next_dependency = request.next_dependency->next();
+
+			String dependency_path = _resolve_dependency_path(local_path, E.get_slice("::", 0));
+			if (dependency_path.is_empty()) {
+				continue;
+			}
+			if (scheduling.has(dependency_path)) {
+				ERR_PRINT("Cyclic dependency between '" + local_path + "' and '" + dependency_path + "', it can't be loaded ahead.");
+				continue;
 			}
 
-			Ref<Resource> existing = ResourceCache::get_ref(local_path);
+			thread_load_mutex->lock();
+			bool requested = request.load_task->dependency_tasks.has(dependency_path);
+			if (!requested) {
+				request.load_task->dependency_tasks.insert(dependency_path);
+			}
+			thread_load_mutex->unlock();
+			if (requested) {
+				continue;
+			}
 
-			if (existing.is_valid()) {
-				//referencing is fine
-				load_task.resource = existing;
-				load_task.status = THREAD_LOAD_LOADED;
-				load_task.progress = 1.0;
+			WorkerThreadPool::TaskID dependency_task;
+			ThreadLoadTask *dependency_load_task = _create_task(dependency_path, E.get_slice("::", 1), true, ResourceFormatLoader::CACHE_MODE_REUSE, local_path, dependency_task);
+			if (dependency_load_task) {
+				// Scheduled once its own dependencies are, the request can't be used past this point.
+				Request dependency_request;
+				dependency_request.load_task = dependency_load_task;
+				get_dependencies(dependency_load_task->remapped_path, &dependency_request.dependency_list, true);
+				dependency_request.next_dependency = dependency_request.dependency_list.front();
+				scheduling.insert(dependency_path);
+				stack.push_back(dependency_request);
+			} else if (dependency_task != WorkerThreadPool::INVALID_TASK_ID) {
+				request.dependencies.push_back(dependency_task);
 			}
+			continue;
 		}
 
-		if (!p_source_resource.is_empty()) {
-			thread_load_tasks[p_source_resource].sub_tasks.insert(local_path);
-		}
+		print_lt("REQUEST: " + local_path + " / dependencies: " + itos(request.dependencies.size()));
 
-		thread_load_tasks[local_path] = load_task;
+		task_id = WorkerThreadPool::get_singleton()->add_native_dependent_task(&ResourceLoader::_thread_load_function, request.load_task, request.dependencies, true, "Load: " + local_path);
+
+		thread_load_mutex->lock();
+		request.load_task->task_id = task_id;
+		thread_load_mutex->unlock();
+
+		scheduling.erase(local_path);
+		stack.remove_at(stack.size() - 1);
+		if (stack.is_empty()) {
+			return task_id;
+		}
+		stack[stack.size() - 1].dependencies.push_back(task_id);
 	}
+}
 
-	ThreadLoadTask &load_task = thread_load_tasks[local_path];
+Error ResourceLoader::load_threaded_request(const String &p_path, const String &p_type_hint, bool p_use_sub_threads, ResourceFormatLoader::CacheMode p_cache_mode, const String &p_source_resource) {
+	String local_path = _validate_local_path(p_path);
 
-	if (load_task.resource.is_null()) { //needs to be loaded in thread
+	if (!p_source_resource.is_empty()) {
+		thread_load_mutex->lock();
 
-		load_task.semaphore = memnew(Semaphore);
-		if (thread_loading_count < thread_load_max) {
-			thread_loading_count++;
-			thread_load_semaphore->post(); //we have free threads, so allow one
-		} else {
-			thread_waiting_count++;
+		//must be loading from this resource
+		ThreadLoadTask *source_task = thread_load_tasks.getptr(p_source_resource);
+		if (!source_task) {
+			thread_load_mutex->unlock();
+			ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "There is no thread loading source resource '" + p_source_resource + "'.");
+		}
+		//must be loading from this thread
+		if (source_task->loader_id != Thread::get_caller_id()) {
+			thread_load_mutex->unlock();
+			ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "Threading loading resource'" + local_path + " failed: Source specified: '" + p_source_resource + "' but was not called by it.");
 		}
 
-		print_lt("REQUEST: load count: " + itos(thread_loading_count) + " / wait count: " + itos(thread_waiting_count) + " / suspended count: " + itos(thread_suspended_count) + " / active: " + itos(thread_loading_count - thread_suspended_count));
+		//requested ahead when scheduling the source, just hand over that request
+		if (source_task->dependency_tasks.has(local_path)) {
+			source_task->dependency_tasks.erase(local_path);
+			thread_load_mutex->unlock();
+			return OK;
+		}
 
-		load_task.thread = memnew(Thread);
-		load_task.thread->start(_thread_load_function, &thread_load_tasks[local_path]);
-		load_task.loader_id = load_task.thread->get_id();
+		//must not be already added as s sub tasks
+		if (source_task->sub_tasks.has(local_path)) {
+			thread_load_mutex->unlock();
+			ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "Thread loading source resource '" + p_source_resource + "' already is loading '" + local_path + "'.");
+		}
+
+		thread_load_mutex->unlock();
 	}
 
-	thread_load_mutex->unlock();
+	_request_task(local_path, p_type_hint, p_use_sub_threads, p_cache_mode, p_source_resource);
 
 	return OK;
 }
@@ -432,7 +556,8 @@ Ref<Resource> ResourceLoader::load_threaded_get(const String &p_path, Error *r_e
 	String local_path = _validate_local_path(p_path);
 
 	thread_load_mutex->lock();
-	if (!thread_load_tasks.has(local_path)) {
+	ThreadLoadTask *load_task = thread_load_tasks.getptr(local_path);
+	if (!load_task) {
 		thread_load_mutex->unlock();
 		if (r_error) {
 			*r_error = ERR_INVALID_PARAMETER;
@@ -440,43 +565,25 @@ Ref<Resource> ResourceLoader::load_threaded_get(const String &p_path, Error *r_e
 		return Ref<Resource>();
 	}
 
-	ThreadLoadTask &load_task = thread_load_tasks[local_path];
-
-	//semaphore still exists, meaning it's still loading, request poll
-	Semaphore *semaphore = load_task.semaphore;
-	if (semaphore) {
-		load_task.poll_requests++;
-
-		{
-			// As we got a semaphore, this means we are going to have to wait
-			// until the sub-resource is done loading
-			//
-			// As this thread will become 'blocked' we should "exchange" its
-			// active status with a waiting one, to ensure load continues.
-			//
-			// This ensures loading is never blocked and that is also within
-			// the maximum number of active threads.
-
-			if (thread_waiting_count > 0) {
-				thread_waiting_count--;
-				thread_loading_count++;
-				thread_load_semaphore->post();
-
-				load_task.start_next = false; //do not start next since we are doing it here
-			}
-
-			thread_suspended_count++;
-
-			print_lt("GET: load count: " + itos(thread_loading_count) + " / wait count: " + itos(thread_waiting_count) + " / suspended count: " + itos(thread_suspended_count) + " / active: " + itos(thread_loading_count - thread_suspended_count));
+	if (load_task->status == THREAD_LOAD_IN_PROGRESS) {
+		// Still loading, so this has to wait. The first waiter goes through the pool, which runs the task
+		// right here if no thread picked it up yet (and keeps pool threads busy meanwhile), others just
+		// wait to be signaled.
+		if (load_task->task_id != WorkerThreadPool::INVALID_TASK_ID && !load_task->awaited) {
+			load_task->awaited = true;
+			WorkerThreadPool::TaskID task_id = load_task->task_id;
+			thread_load_mutex->unlock();
+			WorkerThreadPool::get_singleton()->wait_for_task_completion(task_id);
+		} else {
+			load_task->poll_requests++;
+			Semaphore *semaphore = load_task->semaphore;
+			thread_load_mutex->unlock();
+			semaphore->wait();
 		}
-
-		thread_load_mutex->unlock();
-		semaphore->wait();
 		thread_load_mutex->lock();
 
-		thread_suspended_count--;
-
-		if (!thread_load_tasks.has(local_path)) { //may have been erased during unlock and this was always an invalid call
+		load_task = thread_load_tasks.getptr(local_path);
+		if (!load_task) { //may have been erased during unlock and this was always an invalid call
 			thread_load_mutex->unlock();
 			if (r_error) {
 				*r_error = ERR_INVALID_PARAMETER;
@@ -485,23 +592,19 @@ Ref<Resource> ResourceLoader::load_threaded_get(const String &p_path, Error *r_e
 		}
 	}
 
-	Ref<Resource> resource = load_task.resource;
+	Ref<Resource> resource = load_task->resource;
 	if (r_error) {
-		*r_error = load_task.error;
+		*r_error = load_task->error;
 	}
 
-	load_task.requests--;
-
-	if (load_task.requests == 0) {
-		if (load_task.thread) { //thread may not have been used
-			load_task.thread->wait_to_finish();
-			memdelete(load_task.thread);
-		}
-		thread_load_tasks.erase(local_path);
-	}
+	WorkerThreadPool::TaskID finished_task = _release_task(local_path);
 
 	thread_load_mutex->unlock();
 
+	if (finished_task != WorkerThreadPool::INVALID_TASK_ID) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(finished_task);
+	}
+
 	return resource;
 }
 
@@ -536,6 +639,7 @@ Ref<Resource> ResourceLoader::load(const String &p_path, const String &p_type_hi
 
 		if (existing.is_valid()) {
 			thread_load_mutex->unlock();
+			ResourceCache::retain(existing);
 
 			if (r_error) {
 				*r_error = OK;
@@ -553,12 +657,14 @@ Ref<Resource> ResourceLoader::load(const String &p_path, const String &p_type_hi
 		load_task.type_hint = p_type_hint;
 		load_task.cache_mode = p_cache_mode; //ignore
 		load_task.loader_id = Thread::get_caller_id();
+		load_task.semaphore = memnew(Semaphore);
 
 		thread_load_tasks[local_path] = load_task;
+		ThreadLoadTask *inline_task = thread_load_tasks.getptr(local_path);
 
 		thread_load_mutex->unlock();
 
-		_thread_load_function(&thread_load_tasks[local_path]);
+		_thread_load_function(inline_task);
 
 		return load_threaded_get(p_path, r_error);
 
@@ -1026,16 +1132,10 @@ void ResourceLoader::remove_custom_loaders() {
 
 void ResourceLoader::initialize() {
 	thread_load_mutex = memnew(Mutex);
-	thread_load_max = OS::get_singleton()->get_processor_count();
-	thread_loading_count = 0;
-	thread_waiting_count = 0;
-	thread_suspended_count = 0;
-	thread_load_semaphore = memnew(Semaphore);
 }
 
 void ResourceLoader::finalize() {
 	memdelete(thread_load_mutex);
-	memdelete(thread_load_semaphore);
 }
 
 ResourceLoadErrorNotify ResourceLoader::err_notify = nullptr;
@@ -1050,12 +1150,6 @@ bool ResourceLoader::timestamp_on_load = false;
 
 Mutex *ResourceLoader::thread_load_mutex = nullptr;
 HashMap<String, ResourceLoader::ThreadLoadTask> ResourceLoader::thread_load_tasks;
-Semaphore *ResourceLoader::thread_load_semaphore = nullptr;
-
-int ResourceLoader::thread_loading_count = 0;
-int ResourceLoader::thread_waiting_count = 0;
-int ResourceLoader::thread_suspended_count = 0;
-int ResourceLoader::thread_load_max = 0;
 
 SelfList<Resource>::List ResourceLoader::remapped_list;
 HashMap<String, Vector<String>> ResourceLoader::translation_remaps;
@@ -34,6 +34,7 @@
 #include "core/io/resource.h"
 #include "core/object/gdvirtual.gen.inc"
 #include "core/object/script_language.h"
+#include "core/object/worker_thread_pool.h"
 #include "core/os/semaphore.h"
 #include "core/os/thread.h"
 
@@ -132,9 +133,9 @@ private:
 	static Ref<ResourceFormatLoader> _find_custom_resource_format_loader(String path);
 
 	struct ThreadLoadTask {
-		Thread *thread = nullptr;
+		WorkerThreadPool::TaskID task_id = WorkerThreadPool::INVALID_TASK_ID;
 		Thread::ID loader_id = 0;
-		Semaphore *semaphore = nullptr;
+		Semaphore *semaphore = nullptr; // Posted once per waiter when loading ends.
 		String local_path;
 		String remapped_path;
 		String type_hint;
@@ -145,20 +146,19 @@ private:
 		Ref<Resource> resource;
 		bool xl_remapped = false;
 		bool use_sub_threads = false;
-		bool start_next = true;
+		bool awaited = false; // The pool task was waited for already.
 		int requests = 0;
 		int poll_requests = 0;
 		HashSet<String> sub_tasks;
+		HashSet<String> dependency_tasks; // Requested ahead on behalf of the loader, not claimed by it yet.
 	};
 
 	static void _thread_load_function(void *p_userdata);
+	static ThreadLoadTask *_create_task(const String &p_local_path, const String &p_type_hint, bool p_use_sub_threads, ResourceFormatLoader::CacheMode p_cache_mode, const String &p_source_resource, WorkerThreadPool::TaskID &r_task_id);
+	static WorkerThreadPool::TaskID _request_task(const String &p_local_path, const String &p_type_hint, bool p_use_sub_threads, ResourceFormatLoader::CacheMode p_cache_mode, const String &p_source_resource);
+	static WorkerThreadPool::TaskID _release_task(const String &p_local_path);
 	static Mutex *thread_load_mutex;
 	static HashMap<String, ThreadLoadTask> thread_load_tasks;
-	static Semaphore *thread_load_semaphore;
-	static int thread_waiting_count;
-	static int thread_loading_count;
-	static int thread_suspended_count;
-	static int thread_load_max;
 
 	static float _dependency_get_progress(const String &p_path);
 
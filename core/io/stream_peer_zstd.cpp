@@ -0,0 +1,224 @@
+/*************************************************************************/
+/*  stream_peer_zstd.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "core/io/stream_peer_zstd.h"
+
+#include <zstd.h>
+
+void StreamPeerZSTD::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("start_compression", "buffer_size"), &StreamPeerZSTD::start_compression, DEFVAL(65535));
+	ClassDB::bind_method(D_METHOD("start_decompression", "buffer_size"), &StreamPeerZSTD::start_decompression, DEFVAL(65535));
+	ClassDB::bind_method(D_METHOD("finish"), &StreamPeerZSTD::finish);
+	ClassDB::bind_method(D_METHOD("clear"), &StreamPeerZSTD::clear);
+	ClassDB::bind_method(D_METHOD("set_dictionary", "dictionary"), &StreamPeerZSTD::set_dictionary);
+	ClassDB::bind_method(D_METHOD("get_dictionary"), &StreamPeerZSTD::get_dictionary);
+
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "dictionary", PROPERTY_HINT_RESOURCE_TYPE, "CompressionDictionary"), "set_dictionary", "get_dictionary");
+}
+
+StreamPeerZSTD::StreamPeerZSTD() {
+}
+
+StreamPeerZSTD::~StreamPeerZSTD() {
+	_close();
+}
+
+void StreamPeerZSTD::_close() {
+	if (ctx) {
+		if (compressing) {
+			ZSTD_freeCCtx((ZSTD_CCtx *)ctx);
+		} else {
+			ZSTD_freeDCtx((ZSTD_DCtx *)ctx);
+		}
+		ctx = nullptr;
+	}
+}
+
+void StreamPeerZSTD::clear() {
+	_close();
+	rb.clear();
+	buffer.clear();
+}
+
+void StreamPeerZSTD::set_dictionary(const Ref<CompressionDictionary> &p_dictionary) {
+	dictionary = p_dictionary;
+}
+
+Ref<CompressionDictionary> StreamPeerZSTD::get_dictionary() const {
+	return dictionary;
+}
+
+Error StreamPeerZSTD::start_compression(int p_buffer_size) {
+	return _start(true, p_buffer_size);
+}
+
+Error StreamPeerZSTD::start_decompression(int p_buffer_size) {
+	return _start(false, p_buffer_size);
+}
+
+Error StreamPeerZSTD::_start(bool p_compress, int p_buffer_size) {
+	ERR_FAIL_COND_V(ctx != nullptr, ERR_ALREADY_IN_USE);
+	clear();
+	compressing = p_compress;
+	rb.resize(nearest_shift(p_buffer_size - 1));
+	buffer.resize(1024);
+
+	// Create ctx.
+	size_t err = 0;
+	if (compressing) {
+		ZSTD_CCtx *cctx = ZSTD_createCCtx();
+		ERR_FAIL_NULL_V(cctx, ERR_OUT_OF_MEMORY);
+		ctx = cctx;
+		if (dictionary.is_valid()) {
+			err = ZSTD_CCtx_refCDict(cctx, (const ZSTD_CDict *)dictionary->get_zstd_cdict(Compression::zstd_level));
+		} else {
+			err = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, Compression::zstd_level);
+		}
+	} else {
+		ZSTD_DCtx *dctx = ZSTD_createDCtx();
+		ERR_FAIL_NULL_V(dctx, ERR_OUT_OF_MEMORY);
+		ctx = dctx;
+		if (Compression::zstd_long_distance_matching) {
+			ZSTD_DCtx_setParameter(dctx, ZSTD_d_windowLogMax, Compression::zstd_window_log_size);
+		}
+		if (dictionary.is_valid()) {
+			err = ZSTD_DCtx_refDDict(dctx, (const ZSTD_DDict *)dictionary->get_zstd_ddict());
+		}
+	}
+	ERR_FAIL_COND_V(ZSTD_isError(err), FAILED);
+	return OK;
+}
+
+Error StreamPeerZSTD::_process(uint8_t *p_dst, int p_dst_size, const uint8_t *p_src, int p_src_size, int &r_consumed, int &r_out) {
+	ERR_FAIL_COND_V(!ctx, ERR_UNCONFIGURED);
+	ZSTD_inBuffer in = { p_src, (size_t)p_src_size, 0 };
+	ZSTD_outBuffer out = { p_dst, (size_t)p_dst_size, 0 };
+	if (compressing) {
+		size_t err = ZSTD_compressStream2((ZSTD_CCtx *)ctx, &out, &in, ZSTD_e_continue);
+		ERR_FAIL_COND_V_MSG(ZSTD_isError(err), FAILED, ZSTD_getErrorName(err));
+	} else {
+		size_t err = ZSTD_decompressStream((ZSTD_DCtx *)ctx, &out, &in);
+		ERR_FAIL_COND_V_MSG(ZSTD_isError(err), FAILED, ZSTD_getErrorName(err));
+	}
+	r_out = out.pos;
+	r_consumed = in.pos;
+	return OK;
+}
+
+Error StreamPeerZSTD::put_data(const uint8_t *p_data, int p_bytes) {
+	int wrote = 0;
+	Error err = put_partial_data(p_data, p_bytes, wrote);
+	if (err != OK) {
+		return err;
+	}
+	ERR_FAIL_COND_V(p_bytes != wrote, ERR_OUT_OF_MEMORY);
+	return OK;
+}
+
+Error StreamPeerZSTD::put_partial_data(const uint8_t *p_data, int p_bytes, int &r_sent) {
+	ERR_FAIL_COND_V(!ctx, ERR_UNCONFIGURED);
+	ERR_FAIL_COND_V(p_bytes < 0, ERR_INVALID_PARAMETER);
+
+	// Ensure we have enough space in temporary buffer.
+	if (buffer.size() < p_bytes) {
+		buffer.resize(p_bytes);
+	}
+
+	r_sent = 0;
+	while (rb.space_left() > 1024) { // Keep the ring buffer size meaningful.
+		int sent = 0;
+		int to_write = 0;
+		const int out_size = MIN(buffer.size(), rb.space_left());
+		// Compress or decompress
+		Error err = _process(buffer.ptrw(), out_size, p_data + r_sent, p_bytes - r_sent, sent, to_write);
+		if (err != OK) {
+			return err;
+		}
+		r_sent += sent;
+
+		if (to_write) {
+			// Copy to ring buffer.
+			int wrote = rb.write(buffer.ptr(), to_write);
+			ERR_FAIL_COND_V(wrote != to_write, ERR_BUG);
+		}
+
+		// ZSTD buffers whole blocks, so it can have output left after consuming all the input.
+		if ((r_sent == p_bytes && to_write < out_size) || (sent == 0 && to_write == 0)) {
+			break;
+		}
+	}
+	return OK;
+}
+
+Error StreamPeerZSTD::get_data(uint8_t *p_buffer, int p_bytes) {
+	int received = 0;
+	Error err = get_partial_data(p_buffer, p_bytes, received);
+	if (err != OK) {
+		return err;
+	}
+	ERR_FAIL_COND_V(p_bytes != received, ERR_UNAVAILABLE);
+	return OK;
+}
+
+Error StreamPeerZSTD::get_partial_data(uint8_t *p_buffer, int p_bytes, int &r_received) {
+	ERR_FAIL_COND_V(p_bytes < 0, ERR_INVALID_PARAMETER);
+
+	r_received = MIN(p_bytes, rb.data_left());
+	if (r_received == 0) {
+		return OK;
+	}
+	int received = rb.read(p_buffer, r_received);
+	ERR_FAIL_COND_V(received != r_received, ERR_BUG);
+	return OK;
+}
+
+int StreamPeerZSTD::get_available_bytes() const {
+	return rb.data_left();
+}
+
+Error StreamPeerZSTD::finish() {
+	ERR_FAIL_COND_V(!ctx || !compressing, ERR_UNAVAILABLE);
+	// Ensure we have enough space in temporary buffer.
+	if (buffer.size() < 1024) {
+		buffer.resize(1024);
+	}
+	// Unlike zlib, ZSTD may hold a whole block back, so flush until the frame is complete.
+	size_t left = 0;
+	do {
+		ZSTD_inBuffer in = { nullptr, 0, 0 };
+		ZSTD_outBuffer out = { buffer.ptrw(), (size_t)MIN(buffer.size(), rb.space_left()), 0 };
+		ERR_FAIL_COND_V(out.size == 0, ERR_OUT_OF_MEMORY);
+		left = ZSTD_compressStream2((ZSTD_CCtx *)ctx, &out, &in, ZSTD_e_end);
+		ERR_FAIL_COND_V_MSG(ZSTD_isError(left), FAILED, ZSTD_getErrorName(left));
+		int wrote = rb.write(buffer.ptr(), out.pos);
+		ERR_FAIL_COND_V(wrote != (int)out.pos, ERR_OUT_OF_MEMORY);
+	} while (left > 0);
+	return OK;
+}
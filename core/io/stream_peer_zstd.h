@@ -0,0 +1,80 @@
+/*************************************************************************/
+/*  stream_peer_zstd.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef STREAM_PEER_ZSTD_H
+#define STREAM_PEER_ZSTD_H
+
+#include "core/io/stream_peer.h"
+
+#include "core/io/compression.h"
+#include "core/templates/ring_buffer.h"
+
+class StreamPeerZSTD : public StreamPeer {
+	GDCLASS(StreamPeerZSTD, StreamPeer);
+
+private:
+	void *ctx = nullptr; // Will hold our ZSTD_CCtx or ZSTD_DCtx instance.
+	bool compressing = true;
+	Ref<CompressionDictionary> dictionary;
+
+	RingBuffer<uint8_t> rb;
+	Vector<uint8_t> buffer;
+
+	Error _process(uint8_t *p_dst, int p_dst_size, const uint8_t *p_src, int p_src_size, int &r_consumed, int &r_out);
+	void _close();
+	Error _start(bool p_compress, int p_buffer_size);
+
+protected:
+	static void _bind_methods();
+
+public:
+	Error start_compression(int p_buffer_size = 65535);
+	Error start_decompression(int p_buffer_size = 65535);
+
+	// Both ends of the stream must use the same dictionary. It's used from the next start.
+	void set_dictionary(const Ref<CompressionDictionary> &p_dictionary);
+	Ref<CompressionDictionary> get_dictionary() const;
+
+	Error finish();
+	void clear();
+
+	virtual Error put_data(const uint8_t *p_data, int p_bytes) override;
+	virtual Error put_partial_data(const uint8_t *p_data, int p_bytes, int &r_sent) override;
+
+	virtual Error get_data(uint8_t *p_buffer, int p_bytes) override;
+	virtual Error get_partial_data(uint8_t *p_buffer, int p_bytes, int &r_received) override;
+
+	virtual int get_available_bytes() const override;
+
+	StreamPeerZSTD();
+	~StreamPeerZSTD();
+};
+
+#endif // STREAM_PEER_ZSTD_H
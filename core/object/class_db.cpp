@@ -63,7 +63,7 @@ ClassDB::APIType ClassDB::get_current_api() {
 
 HashMap<StringName, ClassDB::ClassInfo> ClassDB::classes;
 HashMap<StringName, StringName> ClassDB::resource_base_extensions;
-HashMap<StringName, StringName> ClassDB::compat_classes;
+FlatHashMap<StringName, StringName> ClassDB::compat_classes;
 
 bool ClassDB::_is_parent_class(const StringName &p_class, const StringName &p_inherits) {
 	if (!classes.has(p_class)) {
@@ -444,15 +444,18 @@ void ClassDB::get_method_list(const StringName &p_class, List<MethodInfo> *p_met
 		}
 
 #ifdef DEBUG_METHODS_ENABLED
-
 		for (const MethodInfo &E : type->virtual_methods) {
 			p_methods->push_back(E);
 		}
+#endif
 
+		// FlatHashMap order depends on the hashes, list methods as they were registered in every build.
 		for (const StringName &E : type->method_order) {
+#ifdef DEBUG_METHODS_ENABLED
 			if (p_exclude_from_properties && type->methods_in_properties.has(E)) {
 				continue;
 			}
+#endif
 
 			MethodBind *method = type->method_map.get(E);
 			MethodInfo minfo = info_from_bind(method);
@@ -460,16 +463,6 @@ void ClassDB::get_method_list(const StringName &p_class, List<MethodInfo> *p_met
 			p_methods->push_back(minfo);
 		}
 
-#else
-
-		for (KeyValue<StringName, MethodBind *> &E : type->method_map) {
-			MethodBind *m = E.value;
-			MethodInfo minfo = info_from_bind(m);
-			p_methods->push_back(minfo);
-		}
-
-#endif
-
 		if (p_no_inheritance) {
 			break;
 		}
@@ -1265,10 +1258,7 @@ void ClassDB::bind_method_custom(const StringName &p_class, MethodBind *p_method
 		ERR_FAIL_MSG("Method already bound '" + p_class + "::" + p_method->get_name() + "'.");
 	}
 
-#ifdef DEBUG_METHODS_ENABLED
 	type->method_order.push_back(p_method->get_name());
-#endif
-
 	type->method_map[p_method->get_name()] = p_method;
 }
 
@@ -1311,10 +1301,9 @@ MethodBind *ClassDB::bind_methodfi(uint32_t p_flags, MethodBind *p_bind, const c
 	}
 
 	p_bind->set_argument_names(method_name.args);
-
-	type->method_order.push_back(mdname);
 #endif
 
+	type->method_order.push_back(mdname);
 	type->method_map[mdname] = p_bind;
 
 	Vector<Variant> defvals;
@@ -38,6 +38,7 @@
 // Makes callable_mp readily available in all classes connecting signals.
 // Needs to come after method_bind and object have been included.
 #include "core/object/callable_method_pointer.h"
+#include "core/templates/flat_hash_map.h"
 #include "core/templates/hash_set.h"
 
 #define DEFVAL(m_defval) (m_defval)
@@ -102,7 +103,9 @@ public:
 
 		ObjectNativeExtension *native_extension = nullptr;
 
-		HashMap<StringName, MethodBind *> method_map;
+		// Iterated in hash order, method_order keeps the registration order.
+		FlatHashMap<StringName, MethodBind *> method_map;
+		List<StringName> method_order;
 		HashMap<StringName, int64_t> constant_map;
 		struct EnumInfo {
 			List<StringName> constants;
@@ -115,14 +118,13 @@ public:
 		HashMap<StringName, PropertyInfo> property_map;
 #ifdef DEBUG_METHODS_ENABLED
 		List<StringName> constant_order;
-		List<StringName> method_order;
 		HashSet<StringName> methods_in_properties;
 		List<MethodInfo> virtual_methods;
 		HashMap<StringName, MethodInfo> virtual_methods_map;
 		HashMap<StringName, Vector<Error>> method_error_values;
 		HashMap<StringName, List<StringName>> linked_properties;
 #endif
-		HashMap<StringName, PropertySetGet> property_setget;
+		FlatHashMap<StringName, PropertySetGet> property_setget;
 
 		StringName inherits;
 		StringName name;
@@ -143,7 +145,7 @@ public:
 	static RWLock lock;
 	static HashMap<StringName, ClassInfo> classes;
 	static HashMap<StringName, StringName> resource_base_extensions;
-	static HashMap<StringName, StringName> compat_classes;
+	static FlatHashMap<StringName, StringName> compat_classes;
 
 #ifdef DEBUG_METHODS_ENABLED
 	static MethodBind *bind_methodfi(uint32_t p_flags, MethodBind *p_bind, const MethodDefinition &method_name, const Variant **p_defs, int p_defcount);
@@ -288,10 +290,10 @@ public:
 			ERR_FAIL_V_MSG(nullptr, "Method already bound: " + instance_type + "::" + p_name + ".");
 		}
 		type->method_map[p_name] = bind;
+		type->method_order.push_back(p_name);
 #ifdef DEBUG_METHODS_ENABLED
 		// FIXME: <reduz> set_return_type is no longer in MethodBind, so I guess it should be moved to vararg method bind
 		//bind->set_return_type("Variant");
-		type->method_order.push_back(p_name);
 #endif
 
 		return bind;
@@ -36,65 +36,162 @@
 #include "core/object/script_language.h"
 
 MessageQueue *MessageQueue::singleton = nullptr;
+thread_local MessageQueue::ThreadBufferOwner MessageQueue::thread_buffer_owner;
+SafeNumeric<uint32_t> MessageQueue::last_queue_id;
+
+static const uint32_t PAGE_DATA_OFFSET = 64; // Keeps messages aligned, and the header on its own cache line.
+
+_FORCE_INLINE_ static uint8_t *_page_data(void *p_page) {
+	return (uint8_t *)p_page + PAGE_DATA_OFFSET;
+}
+
+MessageQueue::ThreadBufferOwner::~ThreadBufferOwner() {
+	if (buffer && MessageQueue::singleton && queue_id == MessageQueue::singleton->queue_id) {
+		// Thread is exiting, let another one take over the buffer.
+		buffer->owners.decrement();
+	}
+}
 
 MessageQueue *MessageQueue::get_singleton() {
 	return singleton;
 }
 
-Error MessageQueue::push_callp(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
-	return push_callablep(Callable(p_id, p_method), p_args, p_argcount, p_show_error);
+MessageQueue::Page *MessageQueue::_alloc_page(uint32_t p_capacity) {
+	static_assert(sizeof(Page) <= PAGE_DATA_OFFSET);
+	Page *page = (Page *)memalloc(PAGE_DATA_OFFSET + p_capacity);
+	memnew_placement(page, Page);
+	page->capacity = p_capacity;
+	return page;
 }
 
-Error MessageQueue::push_set(ObjectID p_id, const StringName &p_prop, const Variant &p_value) {
-	_THREAD_SAFE_METHOD_
+MessageQueue::ThreadBuffer *MessageQueue::_get_thread_buffer() {
+	ThreadBufferOwner &owner = thread_buffer_owner;
+	if (likely(owner.buffer && owner.queue_id == queue_id)) {
+		return owner.buffer;
+	}
 
-	uint8_t room_needed = sizeof(Message) + sizeof(Variant);
+	// Reuse the buffer of a thread that exited, if any.
+	ThreadBuffer *buffer = thread_buffers.load(std::memory_order_acquire);
+	while (buffer) {
+		if (buffer->owners.increment() == 1) {
+			break;
+		}
+		buffer->owners.decrement();
+		buffer = buffer->next;
+	}
 
-	if ((buffer_end + room_needed) >= buffer_size) {
-		String type;
-		if (ObjectDB::get_instance(p_id)) {
-			type = ObjectDB::get_instance(p_id)->get_class();
+	if (!buffer) {
+		buffer = memnew(ThreadBuffer);
+		buffer->owners.set(1);
+		buffer->write_page = _alloc_page(PAGE_SIZE_KB * 1024);
+		pages_size.add(PAGE_SIZE_KB * 1024); // Not checked against the threshold, every thread needs one.
+		buffer->read_page = buffer->write_page;
+		buffer->next = thread_buffers.load(std::memory_order_relaxed);
+		while (!thread_buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_acq_rel)) {
+			// Retry with the new head.
 		}
-		print_line("Failed set: " + type + ":" + p_prop + " target ID: " + itos(p_id));
-		statistics();
-		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	owner.queue_id = queue_id;
+	owner.buffer = buffer;
+	return buffer;
+}
+
+MessageQueue::Message *MessageQueue::_alloc_message(uint32_t p_size, ThreadBuffer *&r_buffer) {
+	r_buffer = _get_thread_buffer();
+	Page *page = r_buffer->write_page;
+	if (r_buffer->write_pos + p_size > page->capacity) {
+		uint32_t capacity = MAX(uint32_t(PAGE_SIZE_KB * 1024), p_size);
+		if (pages_size.add(capacity) > max_pages_size && size_warnings.postincrement() == 0) {
+			WARN_PRINT("The message queue grew past 'memory/limits/message_queue/max_size_kb', messages may be pushed faster than they are flushed.");
+		}
+
+		// Page is full. The consumer frees it once it sees the next one and has read everything.
+		Page *new_page = _alloc_page(capacity);
+		r_buffer->write_page = new_page;
+		r_buffer->write_pos = 0;
+		page->next.store(new_page, std::memory_order_release);
+		page = new_page;
+	}
+
+	Message *msg = memnew_placement(_page_data(page) + r_buffer->write_pos, Message);
+	msg->sequence = sequence.postincrement();
+	return msg;
+}
+
+void MessageQueue::_commit_message(ThreadBuffer *p_buffer, uint32_t p_size) {
+	p_buffer->write_pos += p_size;
+	p_buffer->write_page->committed.set(p_buffer->write_pos);
+}
+
+MessageQueue::Message *MessageQueue::_peek_message(ThreadBuffer *p_buffer) {
+	Page *page = p_buffer->read_page;
+	while (true) {
+		if (p_buffer->read_pos < page->committed.get()) {
+			return (Message *)(_page_data(page) + p_buffer->read_pos);
+		}
+		Page *next = page->next.load(std::memory_order_acquire);
+		if (!next) {
+			return nullptr;
+		}
+		// The producer moved to the next page, so whatever was committed here is final.
+		if (p_buffer->read_pos < page->committed.get()) {
+			return (Message *)(_page_data(page) + p_buffer->read_pos);
+		}
+		p_buffer->read_page = next;
+		p_buffer->read_pos = 0;
+		pages_size.sub(page->capacity);
+		page->~Page();
+		memfree(page);
+		page = next;
+	}
+}
+
+void MessageQueue::_free_message(Message *p_message) {
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+		Variant *args = (Variant *)(p_message + 1);
+		for (int i = 0; i < p_message->args; i++) {
+			args[i].~Variant();
+		}
+	}
+	p_message->~Message();
+}
+
+Error MessageQueue::push_callp(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
+	return push_callablep(Callable(p_id, p_method), p_args, p_argcount, p_show_error);
+}
+
+Error MessageQueue::push_set(ObjectID p_id, const StringName &p_prop, const Variant &p_value) {
+	uint32_t room_needed = sizeof(Message) + sizeof(Variant);
+
+	ThreadBuffer *buffer;
+	Message *msg = _alloc_message(room_needed, buffer);
 	msg->args = 1;
 	msg->callable = Callable(p_id, p_prop);
 	msg->type = TYPE_SET;
 
-	buffer_end += sizeof(Message);
-
-	Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-	buffer_end += sizeof(Variant);
+	Variant *v = memnew_placement(msg + 1, Variant);
 	*v = p_value;
 
+	_commit_message(buffer, room_needed);
+
 	return OK;
 }
 
 Error MessageQueue::push_notification(ObjectID p_id, int p_notification) {
-	_THREAD_SAFE_METHOD_
-
 	ERR_FAIL_COND_V(p_notification < 0, ERR_INVALID_PARAMETER);
 
-	uint8_t room_needed = sizeof(Message);
-
-	if ((buffer_end + room_needed) >= buffer_size) {
-		print_line("Failed notification: " + itos(p_notification) + " target ID: " + itos(p_id));
-		statistics();
-		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
-	}
+	uint32_t room_needed = sizeof(Message);
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	ThreadBuffer *buffer;
+	Message *msg = _alloc_message(room_needed, buffer);
 
 	msg->type = TYPE_NOTIFICATION;
 	msg->callable = Callable(p_id, CoreStringNames::get_singleton()->notification); //name is meaningless but callable needs it
 	//msg->target;
 	msg->notification = p_notification;
 
-	buffer_end += sizeof(Message);
+	_commit_message(buffer, room_needed);
 
 	return OK;
 }
@@ -112,17 +209,10 @@ Error MessageQueue::push_set(Object *p_object, const StringName &p_prop, const V
 }
 
 Error MessageQueue::push_callablep(const Callable &p_callable, const Variant **p_args, int p_argcount, bool p_show_error) {
-	_THREAD_SAFE_METHOD_
-
-	int room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
-
-	if ((buffer_end + room_needed) >= buffer_size) {
-		print_line("Failed method: " + p_callable);
-		statistics();
-		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
-	}
+	uint32_t room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	ThreadBuffer *buffer;
+	Message *msg = _alloc_message(room_needed, buffer);
 	msg->args = p_argcount;
 	msg->callable = p_callable;
 	msg->type = TYPE_CALL;
@@ -130,14 +220,14 @@ Error MessageQueue::push_callablep(const Callable &p_callable, const Variant **p
 		msg->type |= FLAG_SHOW_ERROR;
 	}
 
-	buffer_end += sizeof(Message);
-
+	Variant *args = (Variant *)(msg + 1);
 	for (int i = 0; i < p_argcount; i++) {
-		Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-		buffer_end += sizeof(Variant);
+		Variant *v = memnew_placement(&args[i], Variant);
 		*v = *p_args[i];
 	}
 
+	_commit_message(buffer, room_needed);
+
 	return OK;
 }
 
@@ -146,56 +236,67 @@ void MessageQueue::statistics() {
 	HashMap<int, int> notify_count;
 	HashMap<Callable, int> call_count;
 	int null_count = 0;
+	uint64_t total_bytes = 0;
 
-	uint32_t read_pos = 0;
-	while (read_pos < buffer_end) {
-		Message *message = (Message *)&buffer[read_pos];
+	_THREAD_SAFE_LOCK_
 
-		Object *target = message->callable.get_object();
+	for (ThreadBuffer *buffer = thread_buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+		Page *page = buffer->read_page;
+		uint32_t read_pos = buffer->read_pos;
+		while (page) {
+			uint32_t committed = page->committed.get();
+			while (read_pos < committed) {
+				Message *message = (Message *)(_page_data(page) + read_pos);
 
-		if (target != nullptr) {
-			switch (message->type & FLAG_MASK) {
-				case TYPE_CALL: {
-					if (!call_count.has(message->callable)) {
-						call_count[message->callable] = 0;
-					}
+				Object *target = message->callable.get_object();
 
-					call_count[message->callable]++;
+				if (target != nullptr) {
+					switch (message->type & FLAG_MASK) {
+						case TYPE_CALL: {
+							if (!call_count.has(message->callable)) {
+								call_count[message->callable] = 0;
+							}
 
-				} break;
-				case TYPE_NOTIFICATION: {
-					if (!notify_count.has(message->notification)) {
-						notify_count[message->notification] = 0;
-					}
+							call_count[message->callable]++;
 
-					notify_count[message->notification]++;
+						} break;
+						case TYPE_NOTIFICATION: {
+							if (!notify_count.has(message->notification)) {
+								notify_count[message->notification] = 0;
+							}
 
-				} break;
-				case TYPE_SET: {
-					StringName t = message->callable.get_method();
-					if (!set_count.has(t)) {
-						set_count[t] = 0;
-					}
+							notify_count[message->notification]++;
 
-					set_count[t]++;
+						} break;
+						case TYPE_SET: {
+							StringName t = message->callable.get_method();
+							if (!set_count.has(t)) {
+								set_count[t] = 0;
+							}
 
-				} break;
-			}
+							set_count[t]++;
 
-		} else {
-			//object was deleted
-			print_line("Object was deleted while awaiting a callback");
+						} break;
+					}
 
-			null_count++;
-		}
+				} else {
+					//object was deleted
+					print_line("Object was deleted while awaiting a callback");
+
+					null_count++;
+				}
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			read_pos += sizeof(Variant) * message->args;
+				read_pos += message->get_size();
+				total_bytes += message->get_size();
+			}
+			page = page->next.load(std::memory_order_acquire);
+			read_pos = 0;
 		}
 	}
 
-	print_line("TOTAL BYTES: " + itos(buffer_end));
+	_THREAD_SAFE_UNLOCK_
+
+	print_line("TOTAL BYTES: " + itos(total_bytes));
 	print_line("NULL count: " + itos(null_count));
 
 	for (const KeyValue<StringName, int> &E : set_count) {
@@ -233,13 +334,6 @@ void MessageQueue::_call_function(const Callable &p_callable, const Variant *p_a
 }
 
 void MessageQueue::flush() {
-	if (buffer_end > buffer_max_used) {
-		buffer_max_used = buffer_end;
-	}
-
-	uint32_t read_pos = 0;
-
-	//using reverse locking strategy
 	_THREAD_SAFE_LOCK_
 
 	if (flushing) {
@@ -248,21 +342,44 @@ void MessageQueue::flush() {
 	}
 	flushing = true;
 
-	while (read_pos < buffer_end) {
-		//lock on each iteration, so a call can re-add itself to the message queue
+	_THREAD_SAFE_UNLOCK_
+
+	uint32_t bytes_flushed = 0;
 
-		Message *message = (Message *)&buffer[read_pos];
+	ThreadBuffer *oldest_buffer = nullptr;
+	Message *message = nullptr;
 
-		uint32_t advance = sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			advance += sizeof(Variant) * message->args;
+	// Producers never block, so messages keep coming (even from the calls below) while flushing.
+	// Always run the oldest one among all thread buffers, so the order is the same as the push order.
+	while (true) {
+		// statistics() walks the same messages and pages, they are only freed while locked.
+		_THREAD_SAFE_LOCK_
+
+		if (message) {
+			// Only advance once done, as the page is freed when moving past its end.
+			uint32_t size = message->get_size();
+			_free_message(message);
+			oldest_buffer->read_pos += size;
+			bytes_flushed += size;
+
+			oldest_buffer = nullptr;
+			message = nullptr;
 		}
 
-		//pre-advance so this function is reentrant
-		read_pos += advance;
+		for (ThreadBuffer *buffer = thread_buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+			Message *candidate = _peek_message(buffer);
+			if (candidate && (!message || int32_t(candidate->sequence - message->sequence) < 0)) {
+				oldest_buffer = buffer;
+				message = candidate;
+			}
+		}
 
 		_THREAD_SAFE_UNLOCK_
 
+		if (!message) {
+			break;
+		}
+
 		Object *target = message->callable.get_object();
 
 		if (target != nullptr) {
@@ -288,20 +405,12 @@ void MessageQueue::flush() {
 				} break;
 			}
 		}
-
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			Variant *args = (Variant *)(message + 1);
-			for (int i = 0; i < message->args; i++) {
-				args[i].~Variant();
-			}
-		}
-
-		message->~Message();
-
-		_THREAD_SAFE_LOCK_
 	}
 
-	buffer_end = 0; // reset buffer
+	_THREAD_SAFE_LOCK_
+	if (bytes_flushed > buffer_max_used) {
+		buffer_max_used = bytes_flushed;
+	}
 	flushing = false;
 	_THREAD_SAFE_UNLOCK_
 }
@@ -313,33 +422,34 @@ bool MessageQueue::is_flushing() const {
 MessageQueue::MessageQueue() {
 	ERR_FAIL_COND_MSG(singleton != nullptr, "A MessageQueue singleton already exists.");
 	singleton = this;
+	queue_id = last_queue_id.increment();
 
-	buffer_size = GLOBAL_DEF_RST("memory/limits/message_queue/max_size_kb", DEFAULT_QUEUE_SIZE_KB);
+	// Pages are allocated as needed without limit, past this size a warning is printed (once).
+	max_pages_size = GLOBAL_DEF_RST("memory/limits/message_queue/max_size_kb", DEFAULT_QUEUE_SIZE_KB);
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/message_queue/max_size_kb", PropertyInfo(Variant::INT, "memory/limits/message_queue/max_size_kb", PROPERTY_HINT_RANGE, "1024,4096,1,or_greater"));
-	buffer_size *= 1024;
-	buffer = memnew_arr(uint8_t, buffer_size);
+	max_pages_size *= 1024;
 }
 
 MessageQueue::~MessageQueue() {
-	uint32_t read_pos = 0;
-
-	while (read_pos < buffer_end) {
-		Message *message = (Message *)&buffer[read_pos];
-		Variant *args = (Variant *)(message + 1);
-		int argc = message->args;
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			for (int i = 0; i < argc; i++) {
-				args[i].~Variant();
+	ThreadBuffer *buffer = thread_buffers.load(std::memory_order_acquire);
+	while (buffer) {
+		while (true) {
+			Message *message = _peek_message(buffer);
+			if (!message) {
+				break;
 			}
+			uint32_t size = message->get_size();
+			_free_message(message);
+			buffer->read_pos += size;
 		}
-		message->~Message();
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			read_pos += sizeof(Variant) * message->args;
-		}
+		buffer->read_page->~Page();
+		memfree(buffer->read_page);
+
+		ThreadBuffer *next = buffer->next;
+		memdelete(buffer);
+		buffer = next;
 	}
 
 	singleton = nullptr;
-	memdelete_arr(buffer);
 }
@@ -33,15 +33,19 @@
 
 #include "core/object/object_id.h"
 #include "core/os/thread_safe.h"
+#include "core/templates/safe_refcount.h"
 #include "core/variant/variant.h"
 
+#include <atomic>
+
 class Object;
 
 class MessageQueue {
 	_THREAD_SAFE_CLASS_
 
 	enum {
-		DEFAULT_QUEUE_SIZE_KB = 4096
+		DEFAULT_QUEUE_SIZE_KB = 4096,
+		PAGE_SIZE_KB = 64
 	};
 
 	enum {
@@ -55,17 +59,68 @@ class MessageQueue {
 
 	struct Message {
 		Callable callable;
+		uint32_t sequence; // Global push order, used to merge the thread buffers.
 		int16_t type;
 		union {
 			int16_t notification;
 			int16_t args;
 		};
+
+		_FORCE_INLINE_ uint32_t get_size() const {
+			return sizeof(Message) + ((type & FLAG_MASK) != TYPE_NOTIFICATION ? sizeof(Variant) * args : 0);
+		}
+	};
+
+	// Append-only chunk of messages. Only the owning thread writes to it,
+	// publishing each message by bumping `committed`, and links a new page
+	// once it runs out of room. Pages are freed by flush() once consumed.
+	struct Page {
+		SafeNumeric<uint32_t> committed;
+		std::atomic<Page *> next = { nullptr };
+		uint32_t capacity = 0;
+	};
+
+	// One per pushing thread, so producers never contend with each other.
+	// Buffers of finished threads are reused by new ones.
+	struct ThreadBuffer {
+		ThreadBuffer *next = nullptr;
+		SafeNumeric<uint32_t> owners;
+
+		// Producer side.
+		Page *write_page = nullptr;
+		uint32_t write_pos = 0;
+
+		// Consumer side (flush).
+		Page *read_page = nullptr;
+		uint32_t read_pos = 0;
+	};
+
+	struct ThreadBufferOwner {
+		uint32_t queue_id = 0;
+		ThreadBuffer *buffer = nullptr;
+		~ThreadBufferOwner();
 	};
 
-	uint8_t *buffer = nullptr;
-	uint32_t buffer_end = 0;
+	static thread_local ThreadBufferOwner thread_buffer_owner;
+	static SafeNumeric<uint32_t> last_queue_id;
+
+	uint32_t queue_id = 0; // Queues may be recreated at the same address, so threads check this instead.
+
+	std::atomic<ThreadBuffer *> thread_buffers = { nullptr };
+	SafeNumeric<uint32_t> sequence;
 	uint32_t buffer_max_used = 0;
-	uint32_t buffer_size = 0;
+
+	// Memory taken by pages that weren't flushed yet, and past which size it's worth a warning.
+	SafeNumeric<uint64_t> pages_size;
+	uint64_t max_pages_size = 0;
+	SafeNumeric<uint32_t> size_warnings;
+
+	static Page *_alloc_page(uint32_t p_capacity);
+	ThreadBuffer *_get_thread_buffer();
+	Message *_alloc_message(uint32_t p_size, ThreadBuffer *&r_buffer);
+	void _commit_message(ThreadBuffer *p_buffer, uint32_t p_size);
+	Message *_peek_message(ThreadBuffer *p_buffer);
+	void _free_message(Message *p_message);
 
 	void _call_function(const Callable &p_callable, const Variant *p_args, int p_argcount, bool p_show_error);
 
@@ -398,6 +398,22 @@ void ScriptLanguage::get_core_type_words(List<String> *p_core_type_words) const
 	p_core_type_words->push_back("PackedColorArray");
 }
 
+int ScriptLanguage::profiling_get_accumulated_data_and_allocs(ProfilingInfo *p_info_arr, uint64_t *r_alloc_counts, int p_info_max) {
+	int count = profiling_get_accumulated_data(p_info_arr, p_info_max);
+	for (int i = 0; i < count; i++) {
+		r_alloc_counts[i] = 0;
+	}
+	return count;
+}
+
+int ScriptLanguage::profiling_get_frame_data_and_allocs(ProfilingInfo *p_info_arr, uint64_t *r_alloc_counts, int p_info_max) {
+	int count = profiling_get_frame_data(p_info_arr, p_info_max);
+	for (int i = 0; i < count; i++) {
+		r_alloc_counts[i] = 0;
+	}
+	return count;
+}
+
 void ScriptLanguage::frame() {
 }
 
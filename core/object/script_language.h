@@ -422,6 +422,10 @@ public:
 
 	virtual int profiling_get_accumulated_data(ProfilingInfo *p_info_arr, int p_info_max) = 0;
 	virtual int profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_info_max) = 0;
+	// Optional, for languages that count the containers allocated by their functions. Like the above, also
+	// writing the count of each function to r_alloc_counts, in the same order. Languages that don't count them report 0.
+	virtual int profiling_get_accumulated_data_and_allocs(ProfilingInfo *p_info_arr, uint64_t *r_alloc_counts, int p_info_max);
+	virtual int profiling_get_frame_data_and_allocs(ProfilingInfo *p_info_arr, uint64_t *r_alloc_counts, int p_info_max);
 
 	virtual void *alloc_instance_binding_data(Object *p_object) { return nullptr; } //optional, not used by all languages
 	virtual void free_instance_binding_data(void *p_data) {} //optional, not used by all languages
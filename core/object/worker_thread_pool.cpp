@@ -30,6 +30,7 @@
 
 #include "worker_thread_pool.h"
 
+#include "core/debugger/frame_profiler.h"
 #include "core/os/os.h"
 
 void WorkerThreadPool::Task::free_template_userdata() {
@@ -40,17 +41,53 @@ void WorkerThreadPool::Task::free_template_userdata() {
 }
 
 WorkerThreadPool *WorkerThreadPool::singleton = nullptr;
+thread_local WorkerThreadPool::ThreadData *WorkerThreadPool::current_thread_data = nullptr;
+
+WorkerThreadPool::Task *WorkerThreadPool::_pop_task(uint32_t p_thread_index) {
+	// Own queue first, newest task first since it's the most likely to be hot in cache.
+	{
+		ThreadData &own = threads[p_thread_index];
+		MutexLock lock(own.queue_mutex);
+		SelfList<Task> *E = own.task_queue.last();
+		if (E) {
+			own.task_queue.remove(E);
+			return E->self();
+		}
+	}
 
-void WorkerThreadPool::_process_task_queue() {
-	task_mutex.lock();
-	Task *task = task_queue.first()->self();
-	task_queue.remove(task_queue.first());
-	task_mutex.unlock();
-	_process_task(task);
+	// Nothing to do, so steal the oldest task from another thread.
+	for (uint32_t i = 1; i < threads.size(); i++) {
+		ThreadData &victim = threads[(p_thread_index + i) % threads.size()];
+		MutexLock lock(victim.queue_mutex);
+		SelfList<Task> *E = victim.task_queue.first();
+		if (E) {
+			victim.task_queue.remove(E);
+			return E->self();
+		}
+	}
+
+	return nullptr;
+}
+
+bool WorkerThreadPool::_claim_task(Task *p_task) {
+	int32_t index = p_task->queue_index.get();
+	if (index < 0) {
+		return false; // Not in any thread queue.
+	}
+
+	// A task only ever enters a single thread queue, so if it's still there it was not picked up yet.
+	ThreadData &owner = threads[index];
+	MutexLock lock(owner.queue_mutex);
+	if (!p_task->task_elem.in_list()) {
+		return false;
+	}
+	owner.task_queue.remove(&p_task->task_elem);
+	return true;
 }
 
 void WorkerThreadPool::_process_task(Task *p_task) {
 	bool low_priority = p_task->low_priority;
+	FrameProfiler::Zone zone(p_task->zone_name);
 
 	if (p_task->group) {
 		// Handling a group
@@ -103,16 +140,12 @@ void WorkerThreadPool::_process_task(Task *p_task) {
 
 			if (finished_users == max_users) {
 				// Get rid of the group, because nobody else is using it.
-				task_mutex.lock();
 				group_allocator.free(p_task->group);
-				task_mutex.unlock();
 			}
 
 			// For groups, tasks get rid of themselves.
 
-			task_mutex.lock();
 			task_allocator.free(p_task);
-			task_mutex.unlock();
 		}
 	} else {
 		if (p_task->native_func) {
@@ -126,63 +159,115 @@ void WorkerThreadPool::_process_task(Task *p_task) {
 			p_task->callable.callp(nullptr, 0, ret, ce);
 		}
 
-		p_task->completed = true;
-		p_task->done_semaphore.post();
+		_complete_task(p_task);
 	}
 
 	if (!use_native_low_priority_threads && low_priority) {
-		// A low prioriry task was freed, so see if we can move a pending one to the high priority queue.
-		bool post = false;
+		// A low prioriry task was freed, so see if we can move a pending one to the thread queues.
+		Task *low_prio_task = nullptr;
 		task_mutex.lock();
 		if (low_priority_task_queue.first()) {
-			Task *low_prio_task = low_priority_task_queue.first()->self();
+			low_prio_task = low_priority_task_queue.first()->self();
 			low_priority_task_queue.remove(low_priority_task_queue.first());
-			task_queue.add_last(&low_prio_task->task_elem);
-			post = true;
 		} else {
 			low_priority_threads_used.decrement();
 		}
-		task_mutex.lock();
-		if (post) {
-			task_available_semaphore.post();
+		task_mutex.unlock();
+		if (low_prio_task) {
+			_push_task(low_prio_task);
+		}
+	}
+}
+
+void WorkerThreadPool::_complete_task(Task *p_task) {
+	LocalVector<Task *> ready;
+
+	p_task->dependents_mutex.lock();
+	p_task->completed = true;
+	for (uint32_t i = 0; i < p_task->dependents.size(); i++) {
+		if (p_task->dependents[i]->pending_dependencies.decrement() == 0) {
+			ready.push_back(p_task->dependents[i]);
 		}
 	}
+	p_task->dependents_mutex.unlock();
+
+	// The waiting thread may free the task as soon as this is posted, so don't touch it anymore.
+	p_task->done_semaphore.post();
+
+	for (uint32_t i = 0; i < ready.size(); i++) {
+		_post_task(ready[i], !ready[i]->low_priority);
+	}
 }
 
 void WorkerThreadPool::_thread_function(void *p_user) {
+	ThreadData *thread_data = (ThreadData *)p_user;
+	WorkerThreadPool *pool = thread_data->pool;
+	current_thread_data = thread_data;
+	FrameProfiler::set_thread_name("WorkerThreadPool " + itos(thread_data->index));
+
 	while (true) {
-		singleton->task_available_semaphore.wait();
-		if (singleton->exit_threads.is_set()) {
+		pool->task_available_semaphore.wait();
+		if (pool->exit_threads.is_set()) {
 			break;
 		}
-		singleton->_process_task_queue();
+		// Posts are only a wake up hint, another thread may have taken the task already.
+		// Drain everything available, stealing from other threads when the own queue is empty.
+		while (true) {
+			Task *task = pool->_pop_task(thread_data->index);
+			if (!task) {
+				break;
+			}
+			pool->_process_task(task);
+		}
 	}
+
+	current_thread_data = nullptr;
 }
 
 void WorkerThreadPool::_native_low_priority_thread_function(void *p_user) {
 	Task *task = (Task *)p_user;
-	singleton->_process_task(task);
+	task->pool->_process_task(task);
+}
+
+void WorkerThreadPool::_push_task(Task *p_task) {
+	if (unlikely(threads.size() == 0)) {
+		// Nobody would ever pick it up.
+		_process_task(p_task);
+		return;
+	}
+
+	// Tasks posted from a pool thread go to its own queue, others are spread among all threads.
+	ThreadData *thread_data = _get_current_thread_data();
+	uint32_t index = thread_data ? thread_data->index : next_queue.postincrement() % threads.size();
+
+	ThreadData &owner = threads[index];
+	owner.queue_mutex.lock();
+	p_task->queue_index.set(index);
+	owner.task_queue.add_last(&p_task->task_elem);
+	owner.queue_mutex.unlock();
+
+	task_available_semaphore.post();
 }
 
 void WorkerThreadPool::_post_task(Task *p_task, bool p_high_priority) {
-	task_mutex.lock();
 	p_task->low_priority = !p_high_priority;
 	if (!p_high_priority && use_native_low_priority_threads) {
-		task_mutex.unlock();
 		p_task->low_priority_thread = native_thread_allocator.alloc();
 		p_task->low_priority_thread->start(_native_low_priority_thread_function, p_task); // Pask task directly to thread.
 
-	} else if (p_high_priority || low_priority_threads_used.get() < max_low_priority_threads) {
-		task_queue.add_last(&p_task->task_elem);
-		if (!p_high_priority) {
+	} else if (p_high_priority) {
+		_push_task(p_task);
+	} else {
+		task_mutex.lock();
+		if (low_priority_threads_used.get() < max_low_priority_threads) {
 			low_priority_threads_used.increment();
+			task_mutex.unlock();
+			_push_task(p_task);
+		} else {
+			// Too many threads using low priority, must go to queue.
+			low_priority_task_queue.add_last(&p_task->task_elem);
+			task_mutex.unlock();
 		}
-		task_mutex.unlock();
-		task_available_semaphore.post();
-	} else {
-		// Too many threads using low priority, must go to queue.
-		low_priority_task_queue.add_last(&p_task->task_elem);
-		task_mutex.unlock();
 	}
 }
 
@@ -190,20 +275,40 @@ WorkerThreadPool::TaskID WorkerThreadPool::add_native_task(void (*p_func)(void *
 	return _add_task(Callable(), p_func, p_userdata, nullptr, p_high_priority, p_description);
 }
 
-WorkerThreadPool::TaskID WorkerThreadPool::_add_task(const Callable &p_callable, void (*p_func)(void *), void *p_userdata, BaseTemplateUserdata *p_template_userdata, bool p_high_priority, const String &p_description) {
-	task_mutex.lock();
+WorkerThreadPool::TaskID WorkerThreadPool::_add_task(const Callable &p_callable, void (*p_func)(void *), void *p_userdata, BaseTemplateUserdata *p_template_userdata, bool p_high_priority, const String &p_description, const TaskID *p_dependencies, int p_dependency_count) {
 	// Get a free task
 	Task *task = task_allocator.alloc();
-	TaskID id = last_task++;
+	task->pool = this;
 	task->callable = p_callable;
 	task->native_func = p_func;
 	task->native_func_userdata = p_userdata;
 	task->description = p_description;
+	task->zone_name = p_description.is_empty() ? "WorkerThreadPool task" : FrameProfiler::get_name(p_description);
 	task->template_userdata = p_template_userdata;
+	task->low_priority = !p_high_priority;
+	task->pending_dependencies.set(1); // Held until all dependencies are registered.
+
+	task_mutex.lock();
+	TaskID id = last_task++;
+	for (int i = 0; i < p_dependency_count; i++) {
+		Task **dependencyp = tasks.getptr(p_dependencies[i]);
+		if (!dependencyp) {
+			continue; // Already waited for, hence completed.
+		}
+		Task *dependency = *dependencyp;
+		dependency->dependents_mutex.lock();
+		if (!dependency->completed) {
+			task->pending_dependencies.increment();
+			dependency->dependents.push_back(task);
+		}
+		dependency->dependents_mutex.unlock();
+	}
 	tasks.insert(id, task);
 	task_mutex.unlock();
 
-	_post_task(task, p_high_priority);
+	if (task->pending_dependencies.decrement() == 0) {
+		_post_task(task, p_high_priority);
+	}
 
 	return id;
 }
@@ -212,6 +317,14 @@ WorkerThreadPool::TaskID WorkerThreadPool::add_task(const Callable &p_action, bo
 	return _add_task(p_action, nullptr, nullptr, nullptr, p_high_priority, p_description);
 }
 
+WorkerThreadPool::TaskID WorkerThreadPool::add_native_dependent_task(void (*p_func)(void *), void *p_userdata, const Vector<TaskID> &p_dependencies, bool p_high_priority, const String &p_description) {
+	return _add_task(Callable(), p_func, p_userdata, nullptr, p_high_priority, p_description, p_dependencies.ptr(), p_dependencies.size());
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::add_dependent_task(const Callable &p_action, const Vector<TaskID> &p_dependencies, bool p_high_priority, const String &p_description) {
+	return _add_task(p_action, nullptr, nullptr, nullptr, p_high_priority, p_description, p_dependencies.ptr(), p_dependencies.size());
+}
+
 bool WorkerThreadPool::is_task_completed(TaskID p_task_id) const {
 	task_mutex.lock();
 	const Task *const *taskp = tasks.getptr(p_task_id);
@@ -249,35 +362,35 @@ void WorkerThreadPool::wait_for_task_completion(TaskID p_task_id) {
 
 	task_mutex.unlock();
 
-	if (use_native_low_priority_threads && task->low_priority) {
-		task->low_priority_thread->wait_to_finish();
-		native_thread_allocator.free(task->low_priority_thread);
-	} else {
-		int *index = thread_ids.getptr(Thread::get_caller_id());
-
-		if (index) {
-			// We are an actual process thread, we must not be blocked so continue processing stuff if available.
-			while (true) {
-				if (task->done_semaphore.try_wait()) {
-					// If done, exit
-					break;
-				}
-				if (task_available_semaphore.try_wait()) {
-					// Solve tasks while they are around.
-					_process_task_queue();
-					continue;
-				}
+	if (_claim_task(task)) {
+		// No thread picked it up yet, so rather than blocking, run it here.
+		_process_task(task);
+	}
+
+	ThreadData *thread_data = _get_current_thread_data();
+	if (thread_data) {
+		// We are an actual process thread, we must not be blocked so continue processing stuff if available.
+		while (!task->done_semaphore.try_wait()) {
+			Task *other_task = _pop_task(thread_data->index);
+			if (other_task) {
+				_process_task(other_task);
+			} else {
 				OS::get_singleton()->delay_usec(1); // Microsleep, this could be converted to waiting for multiple objects in supported platforms for a bit more performance.
 			}
-		} else {
-			task->done_semaphore.wait();
 		}
+	} else {
+		task->done_semaphore.wait();
+	}
+
+	if (task->low_priority_thread) {
+		task->low_priority_thread->wait_to_finish();
+		native_thread_allocator.free(task->low_priority_thread);
 	}
 
 	task_mutex.lock();
 	tasks.erase(p_task_id);
-	task_allocator.free(task);
 	task_mutex.unlock();
+	task_allocator.free(task);
 }
 
 WorkerThreadPool::GroupID WorkerThreadPool::_add_group_task(const Callable &p_callable, void (*p_func)(void *, uint32_t), void *p_userdata, BaseTemplateUserdata *p_template_userdata, int p_elements, int p_tasks, bool p_high_priority, const String &p_description) {
@@ -286,11 +399,8 @@ WorkerThreadPool::GroupID WorkerThreadPool::_add_group_task(const Callable &p_ca
 		p_tasks = threads.size();
 	}
 
-	task_mutex.lock();
 	Group *group = group_allocator.alloc();
-	GroupID id = last_task++;
 	group->max = p_elements;
-	group->self = id;
 
 	Task **tasks_posted = nullptr;
 	if (p_elements == 0) {
@@ -306,11 +416,14 @@ WorkerThreadPool::GroupID WorkerThreadPool::_add_group_task(const Callable &p_ca
 	} else {
 		group->tasks_used = p_tasks;
 		tasks_posted = (Task **)alloca(sizeof(Task *) * p_tasks);
+		const char *zone_name = p_description.is_empty() ? "WorkerThreadPool group task" : FrameProfiler::get_name(p_description);
 		for (int i = 0; i < p_tasks; i++) {
 			Task *task = task_allocator.alloc();
+			task->pool = this;
 			task->native_group_func = p_func;
 			task->native_func_userdata = p_userdata;
 			task->description = p_description;
+			task->zone_name = zone_name;
 			task->group = group;
 			task->callable = p_callable;
 			task->template_userdata = p_template_userdata;
@@ -319,6 +432,9 @@ WorkerThreadPool::GroupID WorkerThreadPool::_add_group_task(const Callable &p_ca
 		}
 	}
 
+	task_mutex.lock();
+	GroupID id = last_task++;
+	group->self = id;
 	groups[id] = group;
 	task_mutex.unlock();
 
@@ -370,39 +486,48 @@ bool WorkerThreadPool::is_group_task_completed(GroupID p_group) const {
 void WorkerThreadPool::wait_for_group_task_completion(GroupID p_group) {
 	task_mutex.lock();
 	Group **groupp = groups.getptr(p_group);
+	Group *group = groupp ? *groupp : nullptr;
 	task_mutex.unlock();
-	if (!groupp) {
+	if (!group) {
 		ERR_FAIL_MSG("Invalid Group ID");
 	}
-	Group *group = *groupp;
 
 	if (group->low_priority_native_tasks.size() > 0) {
 		for (uint32_t i = 0; i < group->low_priority_native_tasks.size(); i++) {
 			group->low_priority_native_tasks[i]->low_priority_thread->wait_to_finish();
 			native_thread_allocator.free(group->low_priority_native_tasks[i]->low_priority_thread);
-			task_mutex.lock();
 			task_allocator.free(group->low_priority_native_tasks[i]);
-			task_mutex.unlock();
 		}
 
-		task_mutex.lock();
 		group_allocator.free(group);
-		task_mutex.unlock();
 	} else {
-		group->done_semaphore.wait();
+		ThreadData *thread_data = _get_current_thread_data();
+		if (thread_data) {
+			// Same as with single tasks, a process thread keeps working while waiting.
+			while (!group->done_semaphore.try_wait()) {
+				Task *other_task = _pop_task(thread_data->index);
+				if (other_task) {
+					_process_task(other_task);
+				} else {
+					OS::get_singleton()->delay_usec(1);
+				}
+			}
+		} else {
+			group->done_semaphore.wait();
+		}
 
 		uint32_t max_users = group->tasks_used + 1; // Add 1 because the thread waiting for it is also user. Read before to avoid another thread freeing task after increment.
 		uint32_t finished_users = group->finished.increment(); // fetch happens before inc, so increment later.
 
 		if (finished_users == max_users) {
 			// All tasks using this group are gone (finished before the group), so clear the group too.
-			task_mutex.lock();
 			group_allocator.free(group);
-			task_mutex.unlock();
 		}
 	}
 
-	groups.erase(p_group); // Threads do not access this, so safe to erase here.
+	task_mutex.lock();
+	groups.erase(p_group);
+	task_mutex.unlock();
 }
 
 void WorkerThreadPool::init(int p_thread_count, bool p_use_native_threads_low_priority, float p_low_priority_task_ratio) {
@@ -418,13 +543,17 @@ void WorkerThreadPool::init(int p_thread_count, bool p_use_native_threads_low_pr
 	}
 
 	use_native_low_priority_threads = p_use_native_threads_low_priority;
+	exit_threads.set_to(false);
 
 	threads.resize(p_thread_count);
 
 	for (uint32_t i = 0; i < threads.size(); i++) {
 		threads[i].index = i;
+		threads[i].pool = this;
+	}
+	// Start only once all the queues exist, as threads steal from each other.
+	for (uint32_t i = 0; i < threads.size(); i++) {
 		threads[i].thread.start(&WorkerThreadPool::_thread_function, &threads[i]);
-		thread_ids.insert(threads[i].thread.get_id(), i);
 	}
 }
 
@@ -456,6 +585,7 @@ void WorkerThreadPool::finish() {
 
 void WorkerThreadPool::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("add_task", "action", "high_priority", "description"), &WorkerThreadPool::add_task, DEFVAL(false), DEFVAL(String()));
+	ClassDB::bind_method(D_METHOD("add_dependent_task", "action", "dependencies", "high_priority", "description"), &WorkerThreadPool::add_dependent_task, DEFVAL(false), DEFVAL(String()));
 	ClassDB::bind_method(D_METHOD("is_task_completed", "task_id"), &WorkerThreadPool::is_task_completed);
 	ClassDB::bind_method(D_METHOD("wait_for_task_completion", "task_id"), &WorkerThreadPool::wait_for_task_completion);
 
@@ -466,9 +596,14 @@ void WorkerThreadPool::_bind_methods() {
 }
 
 WorkerThreadPool::WorkerThreadPool() {
-	singleton = this;
+	if (!singleton) {
+		singleton = this; // Additional pools may be created (e.g. for benchmarking), the first one is the engine's.
+	}
 }
 
 WorkerThreadPool::~WorkerThreadPool() {
 	finish();
+	if (singleton == this) {
+		singleton = nullptr;
+	}
 }
@@ -32,6 +32,7 @@
 #define WORKER_THREAD_POOL_H
 
 #include "core/os/memory.h"
+#include "core/os/mutex.h"
 #include "core/os/os.h"
 #include "core/os/semaphore.h"
 #include "core/os/thread.h"
@@ -39,6 +40,7 @@
 #include "core/templates/paged_allocator.h"
 #include "core/templates/rid.h"
 #include "core/templates/safe_refcount.h"
+#include "core/templates/self_list.h"
 
 class WorkerThreadPool : public Object {
 	GDCLASS(WorkerThreadPool, Object)
@@ -77,39 +79,54 @@ private:
 		void (*native_group_func)(void *, uint32_t) = nullptr;
 		void *native_func_userdata = nullptr;
 		String description;
+		const char *zone_name = nullptr; // Description as a frame profiler name.
 		Semaphore done_semaphore;
 		bool completed = false;
 		Group *group = nullptr;
 		SelfList<Task> task_elem;
+		SafeNumeric<int32_t> queue_index = SafeNumeric<int32_t>(-1); // Thread queue holding the task, -1 if not queued there (yet).
 		bool waiting = false; // Waiting for completion
 		bool low_priority = false;
 		BaseTemplateUserdata *template_userdata = nullptr;
 		Thread *low_priority_thread = nullptr;
+		WorkerThreadPool *pool = nullptr;
+
+		// Dependencies. The task is only posted once pending_dependencies drops to zero,
+		// and posts its own dependents when it completes.
+		SafeNumeric<uint32_t> pending_dependencies;
+		BinaryMutex dependents_mutex;
+		LocalVector<Task *> dependents;
 
 		void free_template_userdata();
 		Task() :
 				task_elem(this) {}
 	};
 
-	PagedAllocator<Task> task_allocator;
-	PagedAllocator<Group> group_allocator;
-	PagedAllocator<Thread> native_thread_allocator;
+	PagedAllocator<Task, true> task_allocator;
+	PagedAllocator<Group, true> group_allocator;
+	PagedAllocator<Thread, true> native_thread_allocator;
 
 	SelfList<Task>::List low_priority_task_queue;
-	SelfList<Task>::List task_queue;
 
 	Mutex task_mutex;
 	Semaphore task_available_semaphore;
 
 	struct ThreadData {
-		uint32_t index;
+		uint32_t index = 0;
+		WorkerThreadPool *pool = nullptr;
 		Thread thread;
+		// Each thread owns a queue. The owner pushes and pops at the back,
+		// while idle threads steal from the front.
+		BinaryMutex queue_mutex;
+		SelfList<Task>::List task_queue;
 	};
 
 	TightLocalVector<ThreadData> threads;
 	SafeFlag exit_threads;
+	SafeNumeric<uint32_t> next_queue; // Round-robin queue for tasks posted from outside the pool.
+
+	static thread_local ThreadData *current_thread_data;
 
-	HashMap<Thread::ID, int> thread_ids;
 	HashMap<TaskID, Task *> tasks;
 	HashMap<GroupID, Group *> groups;
 
@@ -122,14 +139,21 @@ private:
 	static void _thread_function(void *p_user);
 	static void _native_low_priority_thread_function(void *p_user);
 
-	void _process_task_queue();
+	_FORCE_INLINE_ ThreadData *_get_current_thread_data() const {
+		return (current_thread_data && current_thread_data->pool == this) ? current_thread_data : nullptr;
+	}
+
+	Task *_pop_task(uint32_t p_thread_index);
+	bool _claim_task(Task *p_task);
 	void _process_task(Task *task);
+	void _complete_task(Task *p_task);
 
+	void _push_task(Task *p_task);
 	void _post_task(Task *p_task, bool p_high_priority);
 
 	static WorkerThreadPool *singleton;
 
-	TaskID _add_task(const Callable &p_callable, void (*p_func)(void *), void *p_userdata, BaseTemplateUserdata *p_template_userdata, bool p_high_priority, const String &p_description);
+	TaskID _add_task(const Callable &p_callable, void (*p_func)(void *), void *p_userdata, BaseTemplateUserdata *p_template_userdata, bool p_high_priority, const String &p_description, const TaskID *p_dependencies = nullptr, int p_dependency_count = 0);
 	GroupID _add_group_task(const Callable &p_callable, void (*p_func)(void *, uint32_t), void *p_userdata, BaseTemplateUserdata *p_template_userdata, int p_elements, int p_tasks, bool p_high_priority, const String &p_description);
 
 	template <class C, class M, class U>
@@ -168,6 +192,20 @@ public:
 	TaskID add_native_task(void (*p_func)(void *), void *p_userdata, bool p_high_priority = false, const String &p_description = String());
 	TaskID add_task(const Callable &p_action, bool p_high_priority = false, const String &p_description = String());
 
+	// Dependent tasks (continuations) are not posted until all the tasks they depend on are completed.
+	// Dependencies that were already waited for are considered completed.
+	template <class C, class M, class U>
+	TaskID add_template_dependent_task(C *p_instance, M p_method, U p_userdata, const Vector<TaskID> &p_dependencies, bool p_high_priority = false, const String &p_description = String()) {
+		typedef TaskUserData<C, M, U> TUD;
+		TUD *ud = memnew(TUD);
+		ud->instance = p_instance;
+		ud->method = p_method;
+		ud->userdata = p_userdata;
+		return _add_task(Callable(), nullptr, nullptr, ud, p_high_priority, p_description, p_dependencies.ptr(), p_dependencies.size());
+	}
+	TaskID add_native_dependent_task(void (*p_func)(void *), void *p_userdata, const Vector<TaskID> &p_dependencies, bool p_high_priority = false, const String &p_description = String());
+	TaskID add_dependent_task(const Callable &p_action, const Vector<TaskID> &p_dependencies, bool p_high_priority = false, const String &p_description = String());
+
 	bool is_task_completed(TaskID p_task_id) const;
 	void wait_for_task_completion(TaskID p_task_id);
 
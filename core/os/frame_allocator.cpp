@@ -0,0 +1,184 @@
+/*************************************************************************/
+/*  frame_allocator.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "frame_allocator.h"
+
+thread_local FrameAllocator::Arena FrameAllocator::arena;
+SafeNumeric<uint32_t> FrameAllocator::frame;
+
+FrameAllocator::Arena::~Arena() {
+	Block *block = first;
+	while (block) {
+		Block *next = block->next;
+		memfree(block);
+		block = next;
+	}
+	for (uint32_t i = 0; i < heap_allocations.size(); i++) {
+		memfree(heap_allocations[i]);
+	}
+}
+
+void FrameAllocator::_reset(Arena &p_arena) {
+	for (uint32_t i = 0; i < p_arena.heap_allocations.size(); i++) {
+		memfree(p_arena.heap_allocations[i]);
+	}
+	p_arena.heap_allocations.clear();
+	p_arena.current = nullptr;
+	p_arena.offset = 0;
+	p_arena.last = nullptr;
+	p_arena.frame = frame.get();
+}
+
+void FrameAllocator::_next_block(Arena &p_arena, size_t p_bytes) {
+	// Blocks after the current one are free, use the first one that is big enough.
+	Block *prev = p_arena.current;
+	Block *block = prev ? prev->next : p_arena.first;
+	while (block && block->size < p_bytes) {
+		prev = block;
+		block = block->next;
+	}
+
+	if (!block) {
+		size_t size = MAX(size_t(BLOCK_SIZE), p_bytes);
+		block = (Block *)memalloc(DATA_OFFSET + size);
+		CRASH_COND_MSG(!block, "Out of memory");
+		block->next = nullptr;
+		block->size = size;
+		if (prev) {
+			prev->next = block;
+		} else {
+			p_arena.first = block;
+		}
+	}
+
+	p_arena.current = block;
+	p_arena.offset = 0;
+}
+
+bool FrameAllocator::_is_scope_memory(const Arena &p_arena, const void *p_ptr) {
+	if (p_arena.scope_depth == 0) {
+		return true;
+	}
+
+	// The scope owns its block from the saved offset on, and every block after it up to the current one.
+	const Block *block = p_arena.scope_block ? p_arena.scope_block : p_arena.first;
+	size_t from = p_arena.scope_block ? p_arena.scope_offset : 0;
+	const uint8_t *ptr = (const uint8_t *)p_ptr;
+	while (block) {
+		const uint8_t *data = const_cast<Block *>(block)->get_data();
+		if (ptr >= data + from && ptr < data + block->size) {
+			return true;
+		}
+		if (block == p_arena.current) {
+			break;
+		}
+		block = block->next;
+		from = 0;
+	}
+	return false;
+}
+
+void *FrameAllocator::realloc(void *p_ptr, size_t p_old_bytes, size_t p_bytes) {
+	if (p_ptr == nullptr) {
+		return alloc(p_bytes);
+	}
+
+	Arena &a = arena;
+	if (p_ptr == a.last) {
+		// Last allocation, grow or shrink it in place if the block has room.
+		// Opening or closing a scope forgets the last allocation, so it always belongs to the current scope.
+		size_t start = a.last - a.current->get_data();
+		size_t bytes = _align(p_bytes);
+		if (start + bytes <= a.current->size) {
+			a.offset = start + bytes;
+			return p_ptr;
+		}
+	} else if (p_bytes <= p_old_bytes) {
+		return p_ptr;
+	}
+
+	if (!_is_scope_memory(a, p_ptr)) {
+		// A copy in the arena would live in the scope's memory, and be handed out again once the scope closes.
+		// It goes to the heap instead, where it stays valid until the frame memory is reset.
+		for (uint32_t i = 0; i < a.heap_allocations.size(); i++) {
+			if (a.heap_allocations[i] == p_ptr) {
+				void *ptr = memrealloc(p_ptr, p_bytes);
+				CRASH_COND_MSG(!ptr, "Out of memory");
+				a.heap_allocations[i] = ptr;
+				return ptr;
+			}
+		}
+		void *ptr = memalloc(p_bytes);
+		CRASH_COND_MSG(!ptr, "Out of memory");
+		memcpy(ptr, p_ptr, MIN(p_old_bytes, p_bytes));
+		a.heap_allocations.push_back(ptr);
+		return ptr;
+	}
+
+	void *ptr = alloc(p_bytes);
+	memcpy(ptr, p_ptr, MIN(p_old_bytes, p_bytes));
+	return ptr;
+}
+
+void FrameAllocator::end_frame() {
+	frame.increment();
+}
+
+uint64_t FrameAllocator::get_thread_capacity() {
+	uint64_t capacity = 0;
+	for (Block *block = arena.first; block; block = block->next) {
+		capacity += block->size;
+	}
+	return capacity;
+}
+
+FrameAllocator::Scope::Scope() {
+	Arena &a = arena;
+	_check_frame(a);
+	a.scope_depth++;
+	block = a.current;
+	offset = a.offset;
+	outer_block = a.scope_block;
+	outer_offset = a.scope_offset;
+	a.scope_block = block;
+	a.scope_offset = offset;
+	// Allocations from before the scope must not grow into it.
+	a.last = nullptr;
+}
+
+FrameAllocator::Scope::~Scope() {
+	Arena &a = arena;
+	a.current = block;
+	a.offset = offset;
+	a.last = nullptr;
+	a.scope_block = outer_block;
+	a.scope_offset = outer_offset;
+	a.scope_depth--;
+}
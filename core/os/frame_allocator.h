@@ -0,0 +1,158 @@
+/*************************************************************************/
+/*  frame_allocator.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef FRAME_ALLOCATOR_H
+#define FRAME_ALLOCATOR_H
+
+#include "core/os/memory.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/paged_array.h"
+#include "core/templates/safe_refcount.h"
+
+// Linear, thread-local scratch allocator for memory that only needs to live for
+// a short time (usually a single frame).
+//
+// Every thread owns an arena made of large blocks. Allocating just bumps an
+// offset, freeing only reclaims memory if it was the last allocation. Blocks
+// are never returned to the system while the thread lives, they are reused.
+//
+// Memory is reclaimed in two ways:
+// - A FrameAllocator::Scope rewinds the arena of the current thread to where
+//   it was when the scope was opened. This is what code running on threads
+//   that are not synchronized with the main loop (render thread, worker
+//   threads) must use.
+// - Allocations done outside of any scope stay valid until the main loop
+//   calls end_frame(). The arena of each thread is then reset lazily, on the
+//   first allocation done after the frame ended and only if no scope is open.
+//
+// Memory allocated before a scope can't be grown inside of it, since the copy
+// would be handed out again when the scope closes. Such copies are taken from
+// the heap instead, and freed when the arena is reset after the frame ends.
+//
+// Memory obtained from here must never be passed to other threads that may
+// keep it past the end of the scope or frame.
+
+class FrameAllocator {
+	enum {
+		ALIGNMENT = 16,
+		BLOCK_SIZE = 64 * 1024,
+	};
+
+	struct Block {
+		Block *next = nullptr;
+		size_t size = 0;
+
+		_FORCE_INLINE_ uint8_t *get_data() { return reinterpret_cast<uint8_t *>(this) + DATA_OFFSET; }
+	};
+
+	static constexpr size_t DATA_OFFSET = (sizeof(Block) + ALIGNMENT - 1) & ~size_t(ALIGNMENT - 1);
+
+	struct Arena {
+		Block *first = nullptr;
+		Block *current = nullptr; // nullptr when nothing is allocated.
+		size_t offset = 0;
+		uint8_t *last = nullptr; // Last allocation, can be resized in place.
+		uint32_t frame = 0;
+		uint32_t scope_depth = 0;
+		// Where the memory of the innermost open scope starts.
+		Block *scope_block = nullptr;
+		size_t scope_offset = 0;
+		// Copies of memory from outside the current scope that had to grow.
+		LocalVector<void *> heap_allocations;
+
+		~Arena();
+	};
+
+	static thread_local Arena arena;
+	static SafeNumeric<uint32_t> frame;
+
+	static void _reset(Arena &p_arena);
+	static void _next_block(Arena &p_arena, size_t p_bytes);
+	static bool _is_scope_memory(const Arena &p_arena, const void *p_ptr);
+
+	_FORCE_INLINE_ static size_t _align(size_t p_bytes) { return (p_bytes + ALIGNMENT - 1) & ~size_t(ALIGNMENT - 1); }
+	_FORCE_INLINE_ static void _check_frame(Arena &p_arena) {
+		if (unlikely(p_arena.frame != frame.get()) && p_arena.scope_depth == 0) {
+			_reset(p_arena);
+		}
+	}
+
+public:
+	class Scope {
+		Block *block = nullptr;
+		size_t offset = 0;
+		Block *outer_block = nullptr;
+		size_t outer_offset = 0;
+
+	public:
+		Scope();
+		~Scope();
+	};
+
+	_FORCE_INLINE_ static void *alloc(size_t p_bytes) {
+		Arena &a = arena;
+		_check_frame(a);
+		size_t bytes = _align(p_bytes);
+		if (unlikely(a.current == nullptr || a.offset + bytes > a.current->size)) {
+			_next_block(a, bytes);
+		}
+		uint8_t *ptr = a.current->get_data() + a.offset;
+		a.offset += bytes;
+		a.last = ptr;
+		return ptr;
+	}
+
+	static void *realloc(void *p_ptr, size_t p_old_bytes, size_t p_bytes);
+
+	_FORCE_INLINE_ static void free(void *p_ptr) {
+		// Only the last allocation can be given back, anything else is reclaimed when the scope or frame ends.
+		Arena &a = arena;
+		if (p_ptr != nullptr && p_ptr == a.last) {
+			a.offset = a.last - a.current->get_data();
+			a.last = nullptr;
+		}
+	}
+
+	// Called by the main loop once per iteration.
+	static void end_frame();
+	static uint32_t get_frame() { return frame.get(); }
+
+	// Memory reserved by the arena of the calling thread.
+	static uint64_t get_thread_capacity();
+};
+
+// Scratch containers backed by the frame allocator, see the notes above about their lifetime.
+template <class T, class U = uint32_t, bool force_trivial = false, bool tight = false>
+using FrameLocalVector = LocalVector<T, U, force_trivial, tight, FrameAllocator>;
+
+template <class T>
+using FramePagedArray = PagedArray<T, FrameAllocator>;
+
+#endif // FRAME_ALLOCATOR_H
@@ -0,0 +1,149 @@
+/*************************************************************************/
+/*  parallel_for.h                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include "core/object/worker_thread_pool.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/safe_refcount.h"
+
+// Fork/join helpers on top of WorkerThreadPool.
+//
+// The range is split in chunks of p_grain elements (picked automatically when 0),
+// which the pool threads and the calling thread grab dynamically until none are left.
+// Calls can be nested, as pool threads keep working while waiting.
+
+template <class F>
+struct ParallelForData {
+	F *body = nullptr;
+	uint32_t from = 0;
+	uint32_t to = 0;
+	uint32_t grain = 1;
+	uint32_t chunk_count = 0;
+	SafeNumeric<uint32_t> next_chunk;
+
+	template <class... Args>
+	void process(Args &...p_args) {
+		while (true) {
+			uint32_t chunk = next_chunk.postincrement();
+			if (chunk >= chunk_count) {
+				break;
+			}
+			uint32_t begin = from + chunk * grain;
+			uint32_t end = MIN(begin + grain, to);
+			(*body)(begin, end, p_args...);
+		}
+	}
+};
+
+// Returns the amount of tasks to post (besides the calling thread), zero if it's not worth it.
+_FORCE_INLINE_ uint32_t _parallel_prepare(uint32_t p_from, uint32_t p_to, uint32_t &r_grain, uint32_t &r_chunk_count) {
+	uint32_t elements = p_to > p_from ? p_to - p_from : 0;
+	uint32_t thread_count = WorkerThreadPool::get_singleton()->get_thread_count();
+	if (r_grain == 0) {
+		// A few chunks per thread, so threads that finish early can balance the load.
+		r_grain = MAX(elements / ((thread_count + 1) * 4), 1u);
+	}
+	r_chunk_count = (elements + r_grain - 1) / r_grain;
+	return r_chunk_count > 1 ? MIN(r_chunk_count - 1, thread_count) : 0;
+}
+
+// Calls p_body(begin, end) on consecutive, non-overlapping sub-ranges covering [p_from, p_to).
+template <class F>
+void parallel_for(uint32_t p_from, uint32_t p_to, F p_body, uint32_t p_grain = 0, const String &p_description = String()) {
+	typedef ParallelForData<F> PFD;
+	PFD data;
+	data.body = &p_body;
+	data.from = p_from;
+	data.to = p_to;
+	uint32_t tasks = _parallel_prepare(p_from, p_to, p_grain, data.chunk_count);
+	data.grain = p_grain;
+
+	if (tasks == 0) {
+		data.process();
+		return;
+	}
+
+	WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_native_group_task(
+			[](void *p_userdata, uint32_t p_index) { ((PFD *)p_userdata)->process(); },
+			&data, tasks, tasks, true, p_description);
+	data.process();
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+}
+
+// Calls p_body(begin, end, r_accum) like parallel_for, but each participating thread accumulates
+// into its own copy of p_identity. These are merged with p_reduce(a, b) after all work is done,
+// so no locking is needed. The order in which elements are accumulated is not deterministic.
+template <class T, class F, class R>
+T parallel_reduce(uint32_t p_from, uint32_t p_to, const T &p_identity, F p_body, R p_reduce, uint32_t p_grain = 0, const String &p_description = String()) {
+	typedef ParallelForData<F> PFD;
+	struct ReduceData {
+		PFD data;
+		LocalVector<T> accumulators;
+	};
+
+	ReduceData reduce;
+	reduce.data.body = &p_body;
+	reduce.data.from = p_from;
+	reduce.data.to = p_to;
+	uint32_t tasks = _parallel_prepare(p_from, p_to, p_grain, reduce.data.chunk_count);
+	reduce.data.grain = p_grain;
+
+	T result = p_identity;
+	if (tasks == 0) {
+		reduce.data.process(result);
+		return result;
+	}
+
+	reduce.accumulators.resize(tasks);
+	for (uint32_t i = 0; i < tasks; i++) {
+		reduce.accumulators[i] = p_identity;
+	}
+
+	WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_native_group_task(
+			[](void *p_userdata, uint32_t p_index) {
+				ReduceData *rd = (ReduceData *)p_userdata;
+				// Accumulate in a local to avoid false sharing between threads.
+				T accum = rd->accumulators[p_index];
+				rd->data.process(accum);
+				rd->accumulators[p_index] = accum;
+			},
+			&reduce, tasks, tasks, true, p_description);
+	reduce.data.process(result);
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+
+	for (uint32_t i = 0; i < tasks; i++) {
+		result = p_reduce(result, reduce.accumulators[i]);
+	}
+	return result;
+}
+
+#endif // PARALLEL_FOR_H
@@ -38,11 +38,13 @@
 #include "core/crypto/crypto.h"
 #include "core/crypto/hashing_context.h"
 #include "core/debugger/engine_profiler.h"
+#include "core/debugger/frame_profiler.h"
 #include "core/extension/native_extension.h"
 #include "core/extension/native_extension_manager.h"
 #include "core/input/input.h"
 #include "core/input/input_map.h"
 #include "core/input/shortcut.h"
+#include "core/io/compression.h"
 #include "core/io/config_file.h"
 #include "core/io/dir_access.h"
 #include "core/io/dtls_server.h"
@@ -61,6 +63,7 @@
 #include "core/io/resource_uid.h"
 #include "core/io/stream_peer_gzip.h"
 #include "core/io/stream_peer_tls.h"
+#include "core/io/stream_peer_zstd.h"
 #include "core/io/tcp_server.h"
 #include "core/io/translation_loader_po.h"
 #include "core/io/udp_server.h"
@@ -187,6 +190,7 @@ void register_core_types() {
 	GDREGISTER_CLASS(StreamPeerExtension);
 	GDREGISTER_CLASS(StreamPeerBuffer);
 	GDREGISTER_CLASS(StreamPeerGZIP);
+	GDREGISTER_CLASS(StreamPeerZSTD);
 	GDREGISTER_CLASS(StreamPeerTCP);
 	GDREGISTER_CLASS(TCPServer);
 
@@ -243,6 +247,7 @@ void register_core_types() {
 	GDREGISTER_CLASS(ConfigFile);
 
 	GDREGISTER_CLASS(PCKPacker);
+	GDREGISTER_CLASS(CompressionDictionary);
 
 	GDREGISTER_CLASS(PackedDataContainer);
 	GDREGISTER_ABSTRACT_CLASS(PackedDataContainerRef);
@@ -379,6 +384,7 @@ void unregister_core_types() {
 	memdelete(_geometry_3d);
 
 	memdelete(worker_thread_pool);
+	FrameProfiler::finish(); // After the worker threads exit.
 
 	ResourceLoader::remove_resource_format_loader(resource_format_image);
 	resource_format_image.unref();
@@ -39,14 +39,14 @@ StaticCString StaticCString::create(const char *p_ptr) {
 	return scs;
 }
 
-StringName::_Data *StringName::_table[STRING_TABLE_LEN];
+std::atomic<StringName::_Data *> StringName::_table[STRING_TABLE_LEN];
+StringName::_Shard StringName::_shards[SHARD_COUNT];
 
 StringName _scs_create(const char *p_chr, bool p_static) {
 	return (p_chr[0] ? StringName(StaticCString::create(p_chr), p_static) : StringName());
 }
 
 bool StringName::configured = false;
-Mutex StringName::mutex;
 
 #ifdef DEBUG_ENABLED
 bool StringName::debug_stringname = false;
@@ -55,22 +55,24 @@ bool StringName::debug_stringname = false;
 void StringName::setup() {
 	ERR_FAIL_COND(configured);
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
-		_table[i] = nullptr;
+		_table[i].store(nullptr);
 	}
 	configured = true;
 }
 
 void StringName::cleanup() {
-	MutexLock lock(mutex);
+	for (int i = 0; i < SHARD_COUNT; i++) {
+		_shards[i].mutex.lock();
+	}
 
 #ifdef DEBUG_ENABLED
 	if (unlikely(debug_stringname)) {
 		Vector<_Data *> data;
 		for (int i = 0; i < STRING_TABLE_LEN; i++) {
-			_Data *d = _table[i];
+			_Data *d = _table[i].load();
 			while (d) {
 				data.push_back(d);
-				d = d->next;
+				d = d->next.load();
 			}
 		}
 
@@ -80,10 +82,10 @@ void StringName::cleanup() {
 		int unreferenced_stringnames = 0;
 		int rarely_referenced_stringnames = 0;
 		for (int i = 0; i < data.size(); i++) {
-			print_line(itos(i + 1) + ": " + data[i]->get_name() + " - " + itos(data[i]->debug_references));
-			if (data[i]->debug_references == 0) {
+			print_line(itos(i + 1) + ": " + data[i]->get_name() + " - " + itos(data[i]->debug_references.get()));
+			if (data[i]->debug_references.get() == 0) {
 				unreferenced_stringnames += 1;
-			} else if (data[i]->debug_references < 5) {
+			} else if (data[i]->debug_references.get() < 5) {
 				rarely_referenced_stringnames += 1;
 			}
 		}
@@ -94,8 +96,8 @@ void StringName::cleanup() {
 #endif
 	int lost_strings = 0;
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
-		while (_table[i]) {
-			_Data *d = _table[i];
+		_Data *d = _table[i].load();
+		while (d) {
 			if (d->static_count.get() != d->refcount.get()) {
 				lost_strings++;
 
@@ -108,45 +110,129 @@ void StringName::cleanup() {
 				}
 			}
 
-			_table[i] = _table[i]->next;
+			_Data *next = d->next.load();
 			memdelete(d);
+			d = next;
 		}
+		_table[i].store(nullptr);
 	}
 	if (lost_strings) {
 		print_verbose("StringName: " + itos(lost_strings) + " unclaimed string names at exit.");
 	}
+
+	for (int i = 0; i < SHARD_COUNT; i++) {
+		_Data *d = _shards[i].unlinked;
+		while (d) {
+			_Data *next = d->next_unlinked;
+			memdelete(d);
+			d = next;
+		}
+		_shards[i].unlinked = nullptr;
+		_shards[i].mutex.unlock();
+	}
 	configured = false;
 }
 
-void StringName::unref() {
-	ERR_FAIL_COND(!configured);
+static _FORCE_INLINE_ bool _name_equals(const char *p_cname, const String &p_data_name, const char *p_name) {
+	if (p_cname) {
+		return strcmp(p_cname, p_name) == 0;
+	}
+	return p_data_name == p_name;
+}
 
-	if (_data && _data->refcount.unref()) {
-		MutexLock lock(mutex);
+static _FORCE_INLINE_ bool _name_equals(const char *p_cname, const String &p_data_name, const char32_t *p_name) {
+	if (p_cname) {
+		const uint8_t *c = (const uint8_t *)p_cname;
+		while (*c && char32_t(*c) == *p_name) {
+			c++;
+			p_name++;
+		}
+		return *c == 0 && *p_name == 0;
+	}
+	return p_data_name == p_name;
+}
 
-		if (_data->static_count.get() > 0) {
-			if (_data->cname) {
-				ERR_PRINT("BUG: Unreferenced static string to 0: " + String(_data->cname));
-			} else {
-				ERR_PRINT("BUG: Unreferenced static string to 0: " + String(_data->name));
+static _FORCE_INLINE_ bool _name_equals(const char *p_cname, const String &p_data_name, const String &p_name) {
+	if (p_cname) {
+		return p_name == p_cname;
+	}
+	return p_data_name == p_name;
+}
+
+// Lock free lookup, returns the data with a new reference, or nullptr.
+template <class T>
+StringName::_Data *StringName::_find(const T &p_name, uint32_t p_hash) {
+	const uint32_t idx = p_hash & STRING_TABLE_MASK;
+	_Shard &shard = _shards[idx & SHARD_MASK];
+
+	_Data *found = nullptr;
+	shard.readers.fetch_add(1);
+	for (_Data *d = _table[idx].load(); d; d = d->next.load()) {
+		// Compare hash first. Data being removed has no references left and can't be referenced again.
+		if (d->hash == p_hash && _name_equals(d->cname, d->name, p_name)) {
+			if (d->refcount.ref()) {
+				found = d;
+				break;
 			}
 		}
-		if (_data->prev) {
-			_data->prev->next = _data->next;
-		} else {
-			if (_table[_data->idx] != _data) {
-				ERR_PRINT("BUG!");
-			}
-			_table[_data->idx] = _data->next;
+	}
+	shard.readers.fetch_sub(1);
+
+#ifdef DEBUG_ENABLED
+	if (found && unlikely(debug_stringname)) {
+		found->debug_references.increment();
+	}
+#endif
+	return found;
+}
+
+template <class T>
+StringName::_Data *StringName::_find_or_create(const T &p_name, uint32_t p_hash, bool p_static, const char *p_cname) {
+	_Data *data = _find(p_name, p_hash);
+	if (likely(data)) {
+		if (p_static) {
+			data->static_count.increment();
 		}
+		return data;
+	}
 
-		if (_data->next) {
-			_data->next->prev = _data->prev;
+	const uint32_t idx = p_hash & STRING_TABLE_MASK;
+	_Shard &shard = _shards[idx & SHARD_MASK];
+	MutexLock lock(shard.mutex);
+
+	// Another thread may have created it in the meantime.
+	data = _find(p_name, p_hash);
+	if (data) {
+		if (p_static) {
+			data->static_count.increment();
 		}
-		memdelete(_data);
+		return data;
 	}
 
-	_data = nullptr;
+	data = memnew(_Data);
+	if (p_cname) {
+		data->cname = p_cname;
+	} else {
+		data->name = p_name;
+	}
+	data->refcount.init();
+	data->static_count.set(p_static ? 1 : 0);
+	data->hash = p_hash;
+	data->idx = idx;
+#ifdef DEBUG_ENABLED
+	if (unlikely(debug_stringname)) {
+		// Keep in memory, force static.
+		data->refcount.ref();
+		data->static_count.increment();
+	}
+#endif
+
+	// Fully initialized before being published to readers.
+	data->next.store(_table[idx].load());
+	_table[idx].store(data);
+
+	_free_unlinked(shard);
+	return data;
 }
 
 bool StringName::operator==(const String &p_name) const {
@@ -154,7 +240,7 @@ bool StringName::operator==(const String &p_name) const {
 		return (p_name.length() == 0);
 	}
 
-	return (_data->get_name() == p_name);
+	return _name_equals(_data->cname, _data->name, p_name);
 }
 
 bool StringName::operator==(const char *p_name) const {
@@ -162,7 +248,7 @@ bool StringName::operator==(const char *p_name) const {
 		return (p_name[0] == 0);
 	}
 
-	return (_data->get_name() == p_name);
+	return _name_equals(_data->cname, _data->name, p_name);
 }
 
 bool StringName::operator!=(const String &p_name) const {
@@ -206,59 +292,7 @@ StringName::StringName(const char *p_name, bool p_static) {
 		return; //empty, ignore
 	}
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			if (p_static) {
-				_data->static_count.increment();
-			}
-#ifdef DEBUG_ENABLED
-			if (unlikely(debug_stringname)) {
-				_data->debug_references++;
-			}
-#endif
-		}
-
-		return;
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->static_count.set(p_static ? 1 : 0);
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = nullptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-
-#ifdef DEBUG_ENABLED
-	if (unlikely(debug_stringname)) {
-		// Keep in memory, force static.
-		_data->refcount.ref();
-		_data->static_count.increment();
-	}
-#endif
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
+	_data = _find_or_create(p_name, String::hash(p_name), p_static);
 }
 
 StringName::StringName(const StaticCString &p_static_string, bool p_static) {
@@ -268,57 +302,7 @@ StringName::StringName(const StaticCString &p_static_string, bool p_static) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = String::hash(p_static_string.ptr);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_static_string.ptr) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			if (p_static) {
-				_data->static_count.increment();
-			}
-#ifdef DEBUG_ENABLED
-			if (unlikely(debug_stringname)) {
-				_data->debug_references++;
-			}
-#endif
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-
-	_data->refcount.init();
-	_data->static_count.set(p_static ? 1 : 0);
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = p_static_string.ptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-#ifdef DEBUG_ENABLED
-	if (unlikely(debug_stringname)) {
-		// Keep in memory, force static.
-		_data->refcount.ref();
-		_data->static_count.increment();
-	}
-#endif
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
+	_data = _find_or_create(p_static_string.ptr, String::hash(p_static_string.ptr), p_static, p_static_string.ptr);
 }
 
 StringName::StringName(const String &p_name, bool p_static) {
@@ -330,56 +314,7 @@ StringName::StringName(const String &p_name, bool p_static) {
 		return;
 	}
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = p_name.hash();
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			if (p_static) {
-				_data->static_count.increment();
-			}
-#ifdef DEBUG_ENABLED
-			if (unlikely(debug_stringname)) {
-				_data->debug_references++;
-			}
-#endif
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->static_count.set(p_static ? 1 : 0);
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = nullptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-#ifdef DEBUG_ENABLED
-	if (unlikely(debug_stringname)) {
-		// Keep in memory, force static.
-		_data->refcount.ref();
-		_data->static_count.increment();
-	}
-#endif
-
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
+	_data = _find_or_create(p_name, p_name.hash(), p_static);
 }
 
 StringName StringName::search(const char *p_name) {
@@ -390,32 +325,7 @@ StringName StringName::search(const char *p_name) {
 		return StringName();
 	}
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = String::hash(p_name);
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-#ifdef DEBUG_ENABLED
-		if (unlikely(debug_stringname)) {
-			_data->debug_references++;
-		}
-#endif
-
-		return StringName(_data);
-	}
-
-	return StringName(); //does not exist
+	return StringName(_find(p_name, String::hash(p_name))); // nullptr if it does not exist.
 }
 
 StringName StringName::search(const char32_t *p_name) {
@@ -426,58 +336,60 @@ StringName StringName::search(const char32_t *p_name) {
 		return StringName();
 	}
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = String::hash(p_name);
+	return StringName(_find(p_name, String::hash(p_name)));
+}
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
+StringName StringName::search(const String &p_name) {
+	ERR_FAIL_COND_V(p_name.is_empty(), StringName());
 
-	_Data *_data = _table[idx];
+	return StringName(_find(p_name, p_name.hash()));
+}
 
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
+void StringName::_free_unlinked(_Shard &p_shard) {
+	// Must be called with the shard locked. Once no reader is active, nobody can
+	// hold a pointer to entries that were unlinked before.
+	if (p_shard.unlinked && p_shard.readers.load() == 0) {
+		_Data *d = p_shard.unlinked;
+		p_shard.unlinked = nullptr;
+		while (d) {
+			_Data *next = d->next_unlinked;
+			memdelete(d);
+			d = next;
 		}
-		_data = _data->next;
 	}
-
-	if (_data && _data->refcount.ref()) {
-		return StringName(_data);
-	}
-
-	return StringName(); //does not exist
 }
 
-StringName StringName::search(const String &p_name) {
-	ERR_FAIL_COND_V(p_name.is_empty(), StringName());
-
-	MutexLock lock(mutex);
-
-	uint32_t hash = p_name.hash();
+void StringName::unref() {
+	ERR_FAIL_COND(!configured);
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
+	if (_data && _data->refcount.unref()) {
+		_Shard &shard = _shards[_data->idx & SHARD_MASK];
+		MutexLock lock(shard.mutex);
 
-	_Data *_data = _table[idx];
+		if (_data->static_count.get() > 0) {
+			if (_data->cname) {
+				ERR_PRINT("BUG: Unreferenced static string to 0: " + String(_data->cname));
+			} else {
+				ERR_PRINT("BUG: Unreferenced static string to 0: " + String(_data->name));
+			}
+		}
 
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && p_name == _data->get_name()) {
-			break;
+		std::atomic<_Data *> *link = &_table[_data->idx];
+		while (link->load() && link->load() != _data) {
+			link = &link->load()->next;
 		}
-		_data = _data->next;
-	}
 
-	if (_data && _data->refcount.ref()) {
-#ifdef DEBUG_ENABLED
-		if (unlikely(debug_stringname)) {
-			_data->debug_references++;
+		if (link->load() == _data) {
+			link->store(_data->next.load());
+			_data->next_unlinked = shard.unlinked;
+			shard.unlinked = _data;
+			_free_unlinked(shard);
+		} else {
+			ERR_PRINT("BUG!");
 		}
-#endif
-		return StringName(_data);
 	}
 
-	return StringName(); //does not exist
+	_data = nullptr;
 }
 
 bool operator==(const String &p_name, const StringName &p_string_name) {
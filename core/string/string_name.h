@@ -35,6 +35,8 @@
 #include "core/string/ustring.h"
 #include "core/templates/safe_refcount.h"
 
+#include <atomic>
+
 #define UNIQUE_NODE_PREFIX "%"
 
 class Main;
@@ -48,7 +50,10 @@ class StringName {
 	enum {
 		STRING_TABLE_BITS = 16,
 		STRING_TABLE_LEN = 1 << STRING_TABLE_BITS,
-		STRING_TABLE_MASK = STRING_TABLE_LEN - 1
+		STRING_TABLE_MASK = STRING_TABLE_LEN - 1,
+		SHARD_BITS = 6,
+		SHARD_COUNT = 1 << SHARD_BITS,
+		SHARD_MASK = SHARD_COUNT - 1,
 	};
 
 	struct _Data {
@@ -57,17 +62,27 @@ class StringName {
 		const char *cname = nullptr;
 		String name;
 #ifdef DEBUG_ENABLED
-		uint32_t debug_references = 0;
+		SafeNumeric<uint32_t> debug_references;
 #endif
 		String get_name() const { return cname ? String(cname) : name; }
 		int idx = 0;
 		uint32_t hash = 0;
-		_Data *prev = nullptr;
-		_Data *next = nullptr;
+		std::atomic<_Data *> next = { nullptr };
+		_Data *next_unlinked = nullptr;
 		_Data() {}
 	};
 
-	static _Data *_table[STRING_TABLE_LEN];
+	// Buckets are read without locking. Writers (insertion and removal) lock the
+	// shard the bucket belongs to. Removed entries are only freed once no reader
+	// is walking the buckets of the shard.
+	struct alignas(64) _Shard {
+		BinaryMutex mutex;
+		std::atomic<uint32_t> readers = { 0 };
+		_Data *unlinked = nullptr;
+	};
+
+	static std::atomic<_Data *> _table[STRING_TABLE_LEN];
+	static _Shard _shards[SHARD_COUNT];
 
 	_Data *_data = nullptr;
 
@@ -80,14 +95,20 @@ class StringName {
 	friend void register_core_types();
 	friend void unregister_core_types();
 	friend class Main;
-	static Mutex mutex;
 	static void setup();
 	static void cleanup();
 	static bool configured;
+
+	template <class T>
+	static _Data *_find(const T &p_name, uint32_t p_hash);
+	template <class T>
+	static _Data *_find_or_create(const T &p_name, uint32_t p_hash, bool p_static, const char *p_cname = nullptr);
+	static void _free_unlinked(_Shard &p_shard);
+
 #ifdef DEBUG_ENABLED
 	struct DebugSortReferences {
 		bool operator()(const _Data *p_left, const _Data *p_right) const {
-			return p_left->debug_references > p_right->debug_references;
+			return p_left->debug_references.get() > p_right->debug_references.get();
 		}
 	};
 
@@ -1661,6 +1661,253 @@ CharString String::ascii(bool p_allow_extended) const {
 	return cs;
 }
 
+/*************************************************************************/
+/*  Unicode transcoding fast paths                                       */
+/*************************************************************************/
+
+// Runs of characters that need no per-character transcoding (ASCII for
+// UTF-8, non-surrogate BMP for UTF-16) are detected and converted several
+// characters at a time. Anything else, including every invalid sequence,
+// falls back to the scalar code, so error reporting is unchanged.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USTRING_SSE2
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON) || defined(_M_ARM64)) && !defined(__ARM_BIG_ENDIAN)
+#define USTRING_NEON
+#include <arm_neon.h>
+
+static _FORCE_INLINE_ bool _neon_any(uint8x16_t p_v) {
+	uint64x2_t v = vreinterpretq_u64_u8(p_v);
+	return (vgetq_lane_u64(v, 0) | vgetq_lane_u64(v, 1)) != 0;
+}
+#endif
+
+// Number of leading bytes that are ASCII, not NUL and (optionally) not CR.
+static _FORCE_INLINE_ int _utf8_ascii_run(const uint8_t *p_src, int p_len, bool p_skip_cr) {
+	int i = 0;
+#if defined(USTRING_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i cr = _mm_set1_epi8('\r');
+	for (; i + 16 <= p_len; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(p_src + i));
+		__m128i bad = _mm_or_si128(v, _mm_cmpeq_epi8(v, zero));
+		if (p_skip_cr) {
+			bad = _mm_or_si128(bad, _mm_cmpeq_epi8(v, cr));
+		}
+		if (_mm_movemask_epi8(bad) != 0) {
+			break;
+		}
+	}
+#elif defined(USTRING_NEON)
+	const uint8x16_t high = vdupq_n_u8(0x80);
+	const uint8x16_t cr = vdupq_n_u8('\r');
+	for (; i + 16 <= p_len; i += 16) {
+		uint8x16_t v = vld1q_u8(p_src + i);
+		uint8x16_t bad = vorrq_u8(vcgeq_u8(v, high), vceqq_u8(v, vdupq_n_u8(0)));
+		if (p_skip_cr) {
+			bad = vorrq_u8(bad, vceqq_u8(v, cr));
+		}
+		if (_neon_any(bad)) {
+			break;
+		}
+	}
+#endif
+	for (; i < p_len; i++) {
+		uint8_t c = p_src[i];
+		if (c == 0 || c >= 0x80 || (p_skip_cr && c == '\r')) {
+			break;
+		}
+	}
+	return i;
+}
+
+static _FORCE_INLINE_ void _ascii_to_utf32(const uint8_t *p_src, char32_t *p_dst, int p_len) {
+	int i = 0;
+#if defined(USTRING_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= p_len; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(p_src + i));
+		__m128i lo = _mm_unpacklo_epi8(v, zero);
+		__m128i hi = _mm_unpackhi_epi8(v, zero);
+		_mm_storeu_si128((__m128i *)(p_dst + i), _mm_unpacklo_epi16(lo, zero));
+		_mm_storeu_si128((__m128i *)(p_dst + i + 4), _mm_unpackhi_epi16(lo, zero));
+		_mm_storeu_si128((__m128i *)(p_dst + i + 8), _mm_unpacklo_epi16(hi, zero));
+		_mm_storeu_si128((__m128i *)(p_dst + i + 12), _mm_unpackhi_epi16(hi, zero));
+	}
+#elif defined(USTRING_NEON)
+	for (; i + 16 <= p_len; i += 16) {
+		uint8x16_t v = vld1q_u8(p_src + i);
+		uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+		uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+		vst1q_u32((uint32_t *)(p_dst + i), vmovl_u16(vget_low_u16(lo)));
+		vst1q_u32((uint32_t *)(p_dst + i + 4), vmovl_u16(vget_high_u16(lo)));
+		vst1q_u32((uint32_t *)(p_dst + i + 8), vmovl_u16(vget_low_u16(hi)));
+		vst1q_u32((uint32_t *)(p_dst + i + 12), vmovl_u16(vget_high_u16(hi)));
+	}
+#endif
+	for (; i < p_len; i++) {
+		p_dst[i] = p_src[i];
+	}
+}
+
+// Number of leading code points below 0x80.
+static _FORCE_INLINE_ int _utf32_ascii_run(const char32_t *p_src, int p_len) {
+	int i = 0;
+#if defined(USTRING_SSE2)
+	const __m128i mask = _mm_set1_epi32(~0x7f);
+	for (; i + 8 <= p_len; i += 8) {
+		__m128i v = _mm_or_si128(_mm_loadu_si128((const __m128i *)(p_src + i)), _mm_loadu_si128((const __m128i *)(p_src + i + 4)));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(v, mask), _mm_setzero_si128())) != 0xffff) {
+			break;
+		}
+	}
+#elif defined(USTRING_NEON)
+	const uint32x4_t mask = vdupq_n_u32(~0x7fU);
+	for (; i + 8 <= p_len; i += 8) {
+		uint32x4_t v = vorrq_u32(vld1q_u32((const uint32_t *)(p_src + i)), vld1q_u32((const uint32_t *)(p_src + i + 4)));
+		if (_neon_any(vreinterpretq_u8_u32(vandq_u32(v, mask)))) {
+			break;
+		}
+	}
+#endif
+	for (; i < p_len; i++) {
+		if (uint32_t(p_src[i]) > 0x7f) {
+			break;
+		}
+	}
+	return i;
+}
+
+static _FORCE_INLINE_ void _utf32_to_ascii(const char32_t *p_src, uint8_t *p_dst, int p_len) {
+	int i = 0;
+#if defined(USTRING_SSE2)
+	for (; i + 16 <= p_len; i += 16) {
+		const __m128i *src = (const __m128i *)(p_src + i);
+		__m128i lo = _mm_packs_epi32(_mm_loadu_si128(src), _mm_loadu_si128(src + 1));
+		__m128i hi = _mm_packs_epi32(_mm_loadu_si128(src + 2), _mm_loadu_si128(src + 3));
+		_mm_storeu_si128((__m128i *)(p_dst + i), _mm_packus_epi16(lo, hi));
+	}
+#elif defined(USTRING_NEON)
+	for (; i + 16 <= p_len; i += 16) {
+		const uint32_t *src = (const uint32_t *)(p_src + i);
+		uint16x8_t lo = vcombine_u16(vmovn_u32(vld1q_u32(src)), vmovn_u32(vld1q_u32(src + 4)));
+		uint16x8_t hi = vcombine_u16(vmovn_u32(vld1q_u32(src + 8)), vmovn_u32(vld1q_u32(src + 12)));
+		vst1q_u8(p_dst + i, vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+	}
+#endif
+	for (; i < p_len; i++) {
+		p_dst[i] = p_src[i];
+	}
+}
+
+// Number of leading UTF-16 units that are neither NUL nor surrogates.
+static _FORCE_INLINE_ int _utf16_bmp_run(const char16_t *p_src, int p_len) {
+	int i = 0;
+#if defined(USTRING_SSE2)
+	const __m128i mask = _mm_set1_epi16(short(0xf800));
+	const __m128i surrogate = _mm_set1_epi16(short(0xd800));
+	for (; i + 8 <= p_len; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(p_src + i));
+		__m128i bad = _mm_or_si128(_mm_cmpeq_epi16(_mm_and_si128(v, mask), surrogate), _mm_cmpeq_epi16(v, _mm_setzero_si128()));
+		if (_mm_movemask_epi8(bad) != 0) {
+			break;
+		}
+	}
+#elif defined(USTRING_NEON)
+	const uint16x8_t mask = vdupq_n_u16(0xf800);
+	const uint16x8_t surrogate = vdupq_n_u16(0xd800);
+	for (; i + 8 <= p_len; i += 8) {
+		uint16x8_t v = vld1q_u16((const uint16_t *)(p_src + i));
+		uint16x8_t bad = vorrq_u16(vceqq_u16(vandq_u16(v, mask), surrogate), vceqq_u16(v, vdupq_n_u16(0)));
+		if (_neon_any(vreinterpretq_u8_u16(bad))) {
+			break;
+		}
+	}
+#endif
+	for (; i < p_len; i++) {
+		uint32_t c = p_src[i];
+		if (c == 0 || (c & 0xf800) == 0xd800) {
+			break;
+		}
+	}
+	return i;
+}
+
+static _FORCE_INLINE_ void _utf16_to_utf32(const char16_t *p_src, char32_t *p_dst, int p_len) {
+	int i = 0;
+#if defined(USTRING_SSE2)
+	for (; i + 8 <= p_len; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(p_src + i));
+		_mm_storeu_si128((__m128i *)(p_dst + i), _mm_unpacklo_epi16(v, _mm_setzero_si128()));
+		_mm_storeu_si128((__m128i *)(p_dst + i + 4), _mm_unpackhi_epi16(v, _mm_setzero_si128()));
+	}
+#elif defined(USTRING_NEON)
+	for (; i + 8 <= p_len; i += 8) {
+		uint16x8_t v = vld1q_u16((const uint16_t *)(p_src + i));
+		vst1q_u32((uint32_t *)(p_dst + i), vmovl_u16(vget_low_u16(v)));
+		vst1q_u32((uint32_t *)(p_dst + i + 4), vmovl_u16(vget_high_u16(v)));
+	}
+#endif
+	for (; i < p_len; i++) {
+		p_dst[i] = p_src[i];
+	}
+}
+
+// Number of leading code points below the surrogate range (one UTF-16 unit each).
+static _FORCE_INLINE_ int _utf32_bmp_run(const char32_t *p_src, int p_len) {
+	int i = 0;
+#if defined(USTRING_SSE2)
+	// SSE2 only has signed compares, flip the sign bit to compare unsigned.
+	const __m128i sign = _mm_set1_epi32(int32_t(0x80000000));
+	const __m128i limit = _mm_set1_epi32(int32_t(0x80000000 | 0xd800));
+	for (; i + 8 <= p_len; i += 8) {
+		__m128i a = _mm_cmplt_epi32(_mm_xor_si128(_mm_loadu_si128((const __m128i *)(p_src + i)), sign), limit);
+		__m128i b = _mm_cmplt_epi32(_mm_xor_si128(_mm_loadu_si128((const __m128i *)(p_src + i + 4)), sign), limit);
+		if (_mm_movemask_epi8(_mm_and_si128(a, b)) != 0xffff) {
+			break;
+		}
+	}
+#elif defined(USTRING_NEON)
+	const uint32x4_t limit = vdupq_n_u32(0xd800);
+	for (; i + 8 <= p_len; i += 8) {
+		uint32x4_t a = vcgeq_u32(vld1q_u32((const uint32_t *)(p_src + i)), limit);
+		uint32x4_t b = vcgeq_u32(vld1q_u32((const uint32_t *)(p_src + i + 4)), limit);
+		if (_neon_any(vreinterpretq_u8_u32(vorrq_u32(a, b)))) {
+			break;
+		}
+	}
+#endif
+	for (; i < p_len; i++) {
+		if (uint32_t(p_src[i]) >= 0xd800) {
+			break;
+		}
+	}
+	return i;
+}
+
+static _FORCE_INLINE_ void _utf32_to_utf16(const char32_t *p_src, uint16_t *p_dst, int p_len) {
+	int i = 0;
+#if defined(USTRING_SSE2)
+	// Bias into the signed 16-bit range so the saturating pack keeps every value.
+	const __m128i bias32 = _mm_set1_epi32(0x8000);
+	const __m128i bias16 = _mm_set1_epi16(short(0x8000));
+	for (; i + 8 <= p_len; i += 8) {
+		__m128i a = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(p_src + i)), bias32);
+		__m128i b = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(p_src + i + 4)), bias32);
+		_mm_storeu_si128((__m128i *)(p_dst + i), _mm_add_epi16(_mm_packs_epi32(a, b), bias16));
+	}
+#elif defined(USTRING_NEON)
+	for (; i + 8 <= p_len; i += 8) {
+		const uint32_t *src = (const uint32_t *)(p_src + i);
+		vst1q_u16(p_dst + i, vcombine_u16(vmovn_u32(vld1q_u32(src)), vmovn_u32(vld1q_u32(src + 4))));
+	}
+#endif
+	for (; i < p_len; i++) {
+		p_dst[i] = p_src[i];
+	}
+}
+
 String String::utf8(const char *p_utf8, int p_len) {
 	String ret;
 	ret.parse_utf8(p_utf8, p_len);
@@ -1690,6 +1937,10 @@ Error String::parse_utf8(const char *p_utf8, int p_len, bool p_skip_cr) {
 		}
 	}
 
+	if (p_len < 0) {
+		p_len = strlen(p_utf8);
+	}
+
 	bool decode_error = false;
 	bool decode_failed = false;
 	{
@@ -1698,6 +1949,16 @@ Error String::parse_utf8(const char *p_utf8, int p_len, bool p_skip_cr) {
 		int skip = 0;
 		uint8_t c_start = 0;
 		while (ptrtmp != ptrtmp_limit && *ptrtmp) {
+			if (skip == 0 && uint8_t(*ptrtmp) < 0x80) {
+				int run = _utf8_ascii_run((const uint8_t *)ptrtmp, ptrtmp_limit - ptrtmp, p_skip_cr);
+				ptrtmp += run;
+				cstr_size += run;
+				str_size += run;
+				if (ptrtmp == ptrtmp_limit || !*ptrtmp) {
+					break;
+				}
+			}
+
 			uint8_t c = *ptrtmp >= 0 ? *ptrtmp : uint8_t(256 + *ptrtmp);
 
 			if (skip == 0) {
@@ -1766,6 +2027,17 @@ Error String::parse_utf8(const char *p_utf8, int p_len, bool p_skip_cr) {
 	int skip = 0;
 	uint32_t unichar = 0;
 	while (cstr_size) {
+		if (skip == 0 && uint8_t(*p_utf8) < 0x80) {
+			int run = _utf8_ascii_run((const uint8_t *)p_utf8, cstr_size, p_skip_cr);
+			_ascii_to_utf32((const uint8_t *)p_utf8, dst, run);
+			dst += run;
+			p_utf8 += run;
+			cstr_size -= run;
+			if (!cstr_size) {
+				break;
+			}
+		}
+
 		uint8_t c = *p_utf8 >= 0 ? *p_utf8 : uint8_t(256 + *p_utf8);
 
 		if (skip == 0) {
@@ -1851,7 +2123,9 @@ CharString String::utf8() const {
 	for (int i = 0; i < l; i++) {
 		uint32_t c = d[i];
 		if (c <= 0x7f) { // 7 bits.
-			fl += 1;
+			int run = _utf32_ascii_run(d + i, l - i);
+			fl += run;
+			i += run - 1;
 		} else if (c <= 0x7ff) { // 11 bits
 			fl += 2;
 		} else if (c <= 0xffff) { // 16 bits
@@ -1884,7 +2158,10 @@ CharString String::utf8() const {
 		uint32_t c = d[i];
 
 		if (c <= 0x7f) { // 7 bits.
-			APPEND_CHAR(c);
+			int run = _utf32_ascii_run(d + i, l - i);
+			_utf32_to_ascii(d + i, cdst, run);
+			cdst += run;
+			i += run - 1;
 		} else if (c <= 0x7ff) { // 11 bits
 			APPEND_CHAR(uint32_t(0xc0 | ((c >> 6) & 0x1f))); // Top 5 bits.
 			APPEND_CHAR(uint32_t(0x80 | (c & 0x3f))); // Bottom 6 bits.
@@ -1956,6 +2233,13 @@ Error String::parse_utf16(const char16_t *p_utf16, int p_len) {
 		}
 	}
 
+	if (p_len < 0) {
+		p_len = 0;
+		while (p_utf16[p_len]) {
+			p_len++;
+		}
+	}
+
 	bool decode_error = false;
 	{
 		const char16_t *ptrtmp = p_utf16;
@@ -1963,6 +2247,19 @@ Error String::parse_utf16(const char16_t *p_utf16, int p_len) {
 		uint32_t c_prev = 0;
 		bool skip = false;
 		while (ptrtmp != ptrtmp_limit && *ptrtmp) {
+			if (!byteswap && !skip) {
+				int run = _utf16_bmp_run(ptrtmp, ptrtmp_limit - ptrtmp);
+				if (run) {
+					ptrtmp += run;
+					str_size += run;
+					cstr_size += run;
+					c_prev = *(ptrtmp - 1);
+					if (ptrtmp == ptrtmp_limit || !*ptrtmp) {
+						break;
+					}
+				}
+			}
+
 			uint32_t c = (byteswap) ? BSWAP16(*ptrtmp) : *ptrtmp;
 
 			if ((c & 0xfffffc00) == 0xd800) { // lead surrogate
@@ -2007,6 +2304,20 @@ Error String::parse_utf16(const char16_t *p_utf16, int p_len) {
 	bool skip = false;
 	uint32_t c_prev = 0;
 	while (cstr_size) {
+		if (!byteswap && !skip) {
+			int run = _utf16_bmp_run(p_utf16, cstr_size);
+			if (run) {
+				_utf16_to_utf32(p_utf16, dst, run);
+				dst += run;
+				p_utf16 += run;
+				cstr_size -= run;
+				c_prev = *(p_utf16 - 1);
+				if (!cstr_size) {
+					break;
+				}
+			}
+		}
+
 		uint32_t c = (byteswap) ? BSWAP16(*p_utf16) : *p_utf16;
 
 		if ((c & 0xfffffc00) == 0xd800) { // lead surrogate
@@ -2052,7 +2363,11 @@ Char16String String::utf16() const {
 	int fl = 0;
 	for (int i = 0; i < l; i++) {
 		uint32_t c = d[i];
-		if (c <= 0xffff) { // 16 bits.
+		if (c < 0xd800) { // 16 bits, below the surrogates.
+			int run = _utf32_bmp_run(d + i, l - i);
+			fl += run;
+			i += run - 1;
+		} else if (c <= 0xffff) { // 16 bits.
 			fl += 1;
 			if ((c & 0xfffff800) == 0xd800) {
 				print_unicode_error(vformat("Unpaired surrogate (%x)", c));
@@ -2078,7 +2393,12 @@ Char16String String::utf16() const {
 	for (int i = 0; i < l; i++) {
 		uint32_t c = d[i];
 
-		if (c <= 0xffff) { // 16 bits.
+		if (c < 0xd800) { // 16 bits, below the surrogates.
+			int run = _utf32_bmp_run(d + i, l - i);
+			_utf32_to_utf16(d + i, cdst, run);
+			cdst += run;
+			i += run - 1;
+		} else if (c <= 0xffff) { // 16 bits.
 			APPEND_CHAR(c);
 		} else if (c <= 0x10ffff) { // 32 bits.
 			APPEND_CHAR(uint32_t((c >> 10) + 0xd7c0)); // lead surrogate.
@@ -2209,13 +2529,12 @@ int64_t String::to_int() const {
 		return 0;
 	}
 
-	int to = (find(".") >= 0) ? find(".") : length();
+	const char32_t *str = get_data();
 
 	int64_t integer = 0;
 	int64_t sign = 1;
 
-	for (int i = 0; i < to; i++) {
-		char32_t c = operator[](i);
+	for (char32_t c = *str; c != '\0' && c != '.'; c = *(++str)) {
 		if (is_digit(c)) {
 			bool overflow = (integer > INT64_MAX / 10) || (integer == INT64_MAX / 10 && ((sign == 1 && c > '7') || (sign == -1 && c > '8')));
 			ERR_FAIL_COND_V_MSG(overflow, sign == 1 ? INT64_MAX : INT64_MIN, "Cannot represent " + *this + " as a 64-bit signed integer, since the value is " + (sign == 1 ? "too large." : "too small."));
@@ -3343,7 +3662,7 @@ bool String::matchn(const String &p_wildcard) const {
 }
 
 String String::format(const Variant &values, String placeholder) const {
-	String new_string = String(this->ptr());
+	String new_string = *this;
 
 	if (values.get_type() == Variant::ARRAY) {
 		Array values_arr = values;
@@ -3392,45 +3711,93 @@ String String::format(const Variant &values, String placeholder) const {
 }
 
 String String::replace(const String &p_key, const String &p_with) const {
-	String new_string;
-	int search_from = 0;
-	int result = 0;
+	const int key_len = p_key.length();
+	int result = find(p_key);
+	if (result < 0) {
+		return *this;
+	}
 
-	while ((result = find(p_key, search_from)) >= 0) {
-		new_string += substr(search_from, result - search_from);
-		new_string += p_with;
-		search_from = result + p_key.length();
+	int matches = 0;
+	for (int from = result; from >= 0; from = find(p_key, from + key_len)) {
+		matches++;
 	}
 
-	if (search_from == 0) {
-		return *this;
+	// Size the result once and copy the pieces straight in, instead of
+	// appending substr() temporaries.
+	const int len = length();
+	const int with_len = p_with.length();
+	const int new_len = len + matches * (with_len - key_len);
+	if (new_len == 0) {
+		return String();
 	}
+	String new_string;
+	new_string.resize(new_len + 1);
 
-	new_string += substr(search_from, length() - search_from);
+	const char32_t *src = get_data();
+	const char32_t *with = p_with.get_data();
+	char32_t *dst = new_string.ptrw();
+	int search_from = 0;
+
+	while (result >= 0) {
+		memcpy(dst, src + search_from, (result - search_from) * sizeof(char32_t));
+		dst += result - search_from;
+		memcpy(dst, with, with_len * sizeof(char32_t));
+		dst += with_len;
+		search_from = result + key_len;
+		result = find(p_key, search_from);
+	}
+
+	memcpy(dst, src + search_from, (len - search_from) * sizeof(char32_t));
+	dst[len - search_from] = _null;
 
 	return new_string;
 }
 
 String String::replace(const char *p_key, const char *p_with) const {
+	int key_len = 0;
+	while (p_key[key_len] != '\0') {
+		key_len++;
+	}
+
+	int result = find(p_key);
+	if (result < 0) {
+		return *this;
+	}
+
+	int matches = 0;
+	for (int from = result; from >= 0; from = find(p_key, from + key_len)) {
+		matches++;
+	}
+
+	int with_len = 0;
+	while (p_with[with_len] != '\0') {
+		with_len++;
+	}
+
+	const int len = length();
+	const int new_len = len + matches * (with_len - key_len);
+	if (new_len == 0) {
+		return String();
+	}
 	String new_string;
+	new_string.resize(new_len + 1);
+
+	const char32_t *src = get_data();
+	char32_t *dst = new_string.ptrw();
 	int search_from = 0;
-	int result = 0;
 
-	while ((result = find(p_key, search_from)) >= 0) {
-		new_string += substr(search_from, result - search_from);
-		new_string += p_with;
-		int k = 0;
-		while (p_key[k] != '\0') {
-			k++;
+	while (result >= 0) {
+		memcpy(dst, src + search_from, (result - search_from) * sizeof(char32_t));
+		dst += result - search_from;
+		for (int i = 0; i < with_len; i++) {
+			*(dst++) = (uint8_t)p_with[i];
 		}
-		search_from = result + k;
+		search_from = result + key_len;
+		result = find(p_key, search_from);
 	}
 
-	if (search_from == 0) {
-		return *this;
-	}
-
-	new_string += substr(search_from, length() - search_from);
+	memcpy(dst, src + search_from, (len - search_from) * sizeof(char32_t));
+	dst[len - search_from] = _null;
 
 	return new_string;
 }
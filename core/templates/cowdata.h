@@ -113,7 +113,7 @@ private:
 	void _unref(void *p_data);
 	void _ref(const CowData *p_from);
 	void _ref(const CowData &p_from);
-	uint32_t _copy_on_write();
+	bool _copy_on_write(uint32_t p_reserve = 0); // Returns true if the buffer was shared and got copied.
 
 public:
 	void operator=(const CowData<T> &p_from) { _ref(p_from); }
@@ -199,7 +199,8 @@ void CowData<T>::_unref(void *p_data) {
 
 	SafeNumeric<uint32_t> *refc = _get_refcount();
 
-	if (refc->decrement() > 0) {
+	// A sole owner can't race with anyone, so skip the atomic decrement.
+	if (refc->get() > 1 && refc->decrement() > 0) {
 		return; // still in use
 	}
 	// clean up
@@ -219,19 +220,19 @@ void CowData<T>::_unref(void *p_data) {
 }
 
 template <class T>
-uint32_t CowData<T>::_copy_on_write() {
+bool CowData<T>::_copy_on_write(uint32_t p_reserve) {
 	if (!_ptr) {
-		return 0;
+		return false;
 	}
 
 	SafeNumeric<uint32_t> *refc = _get_refcount();
 
-	uint32_t rc = refc->get();
-	if (unlikely(rc > 1)) {
+	if (unlikely(refc->get() > 1)) {
 		/* in use by more than me */
 		uint32_t current_size = *_get_size();
 
-		uint32_t *mem_new = (uint32_t *)Memory::alloc_static(_get_alloc_size(current_size), true);
+		// Reserve room up front when the caller is about to grow the copy.
+		uint32_t *mem_new = (uint32_t *)Memory::alloc_static(_get_alloc_size(MAX(current_size, p_reserve)), true);
 
 		new (mem_new - 2) SafeNumeric<uint32_t>(1); //refcount
 		*(mem_new - 1) = current_size; //size
@@ -251,9 +252,9 @@ uint32_t CowData<T>::_copy_on_write() {
 		_unref(_ptr);
 		_ptr = _data;
 
-		rc = 1;
+		return true;
 	}
-	return rc;
+	return false;
 }
 
 template <class T>
@@ -274,13 +275,16 @@ Error CowData<T>::resize(int p_size) {
 		return OK;
 	}
 
-	// possibly changing size, copy on write
-	uint32_t rc = _copy_on_write();
-
-	size_t current_alloc_size = _get_alloc_size(current_size);
 	size_t alloc_size;
 	ERR_FAIL_COND_V(!_get_alloc_size_checked(p_size, &alloc_size), ERR_OUT_OF_MEMORY);
 
+	// possibly changing size, copy on write
+	// a shared buffer that grows is copied straight into the larger allocation
+	// (only trust the copy itself, the refcount may drop between checks)
+	bool copied = _copy_on_write(p_size);
+
+	size_t current_alloc_size = _get_alloc_size(copied ? MAX((uint32_t)current_size, (uint32_t)p_size) : (uint32_t)current_size);
+
 	if (p_size > current_size) {
 		if (alloc_size != current_alloc_size) {
 			if (current_size == 0) {
@@ -295,7 +299,7 @@ Error CowData<T>::resize(int p_size) {
 			} else {
 				uint32_t *_ptrnew = (uint32_t *)Memory::realloc_static(_ptr, alloc_size, true);
 				ERR_FAIL_COND_V(!_ptrnew, ERR_OUT_OF_MEMORY);
-				new (_ptrnew - 2) SafeNumeric<uint32_t>(rc); //refcount
+				new (_ptrnew - 2) SafeNumeric<uint32_t>(1); //refcount
 
 				_ptr = (T *)(_ptrnew);
 			}
@@ -325,7 +329,7 @@ Error CowData<T>::resize(int p_size) {
 		if (alloc_size != current_alloc_size) {
 			uint32_t *_ptrnew = (uint32_t *)Memory::realloc_static(_ptr, alloc_size, true);
 			ERR_FAIL_COND_V(!_ptrnew, ERR_OUT_OF_MEMORY);
-			new (_ptrnew - 2) SafeNumeric<uint32_t>(rc); //refcount
+			new (_ptrnew - 2) SafeNumeric<uint32_t>(1); //refcount
 
 			_ptr = (T *)(_ptrnew);
 		}
@@ -0,0 +1,586 @@
+/*************************************************************************/
+/*  flat_hash_map.h                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include "core/os/memory.h"
+#include "core/templates/hashfuncs.h"
+#include "core/templates/pair.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAT_HASH_MAP_SSE2
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON) || defined(_M_ARM64)) && !defined(__ARM_BIG_ENDIAN)
+#define FLAT_HASH_MAP_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+/**
+ * A HashMap implementation that uses open addressing with SIMD group probing
+ * (the "Swiss table" layout).
+ *
+ * Every slot has a control byte that is either empty, deleted, or holds 7 bits
+ * of the hash of the key stored there. Lookups compare the control bytes of
+ * a whole group of 16 slots at once (using SSE2 or NEON when available), so
+ * keys are only compared for slots whose control byte matches, which almost
+ * always means the right one.
+ *
+ * Keys and values are stored inplace, in a flat array. Unlike HashMap there is
+ * no insertion order: iteration order is unspecified and pointers to elements
+ * are invalidated when the map grows. Erasing does not move other elements, so
+ * it's safe to erase the current element while iterating.
+ *
+ * Prefer it over HashMap for lookup heavy maps that are never iterated in
+ * a way visible to the user.
+ *
+ * The assignment operator copy the pairs from one map to the other.
+ */
+
+struct FlatHashMapGroup {
+	static constexpr uint32_t WIDTH = 16;
+
+	static constexpr int8_t CTRL_EMPTY = -128;
+	static constexpr int8_t CTRL_DELETED = -2;
+
+	// Bit mask of the slots of a group that matched, iterated with first() and next().
+#ifdef FLAT_HASH_MAP_NEON
+	typedef uint64_t Mask; // 4 bits per slot.
+	static constexpr uint32_t MASK_SHIFT = 2;
+#else
+	typedef uint32_t Mask; // 1 bit per slot.
+	static constexpr uint32_t MASK_SHIFT = 0;
+#endif
+
+#if defined(FLAT_HASH_MAP_SSE2)
+	static _FORCE_INLINE_ Mask match(const int8_t *p_ctrl, int8_t p_h2) {
+		__m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_ctrl));
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(p_h2)));
+	}
+	static _FORCE_INLINE_ Mask match_empty(const int8_t *p_ctrl) {
+		return match(p_ctrl, CTRL_EMPTY);
+	}
+	static _FORCE_INLINE_ Mask match_empty_or_deleted(const int8_t *p_ctrl) {
+		// Full slots have the sign bit clear.
+		return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p_ctrl)));
+	}
+#elif defined(FLAT_HASH_MAP_NEON)
+	static _FORCE_INLINE_ Mask _to_mask(uint8x16_t p_cmp) {
+		uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(p_cmp), 4);
+		return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & 0x8888888888888888ULL;
+	}
+	static _FORCE_INLINE_ Mask match(const int8_t *p_ctrl, int8_t p_h2) {
+		return _to_mask(vceqq_s8(vld1q_s8(p_ctrl), vdupq_n_s8(p_h2)));
+	}
+	static _FORCE_INLINE_ Mask match_empty(const int8_t *p_ctrl) {
+		return match(p_ctrl, CTRL_EMPTY);
+	}
+	static _FORCE_INLINE_ Mask match_empty_or_deleted(const int8_t *p_ctrl) {
+		return _to_mask(vcltq_s8(vld1q_s8(p_ctrl), vdupq_n_s8(0)));
+	}
+#else
+	static _FORCE_INLINE_ Mask match(const int8_t *p_ctrl, int8_t p_h2) {
+		Mask mask = 0;
+		for (uint32_t i = 0; i < WIDTH; i++) {
+			mask |= Mask(p_ctrl[i] == p_h2) << i;
+		}
+		return mask;
+	}
+	static _FORCE_INLINE_ Mask match_empty(const int8_t *p_ctrl) {
+		return match(p_ctrl, CTRL_EMPTY);
+	}
+	static _FORCE_INLINE_ Mask match_empty_or_deleted(const int8_t *p_ctrl) {
+		Mask mask = 0;
+		for (uint32_t i = 0; i < WIDTH; i++) {
+			mask |= Mask(p_ctrl[i] < 0) << i;
+		}
+		return mask;
+	}
+#endif
+
+	static _FORCE_INLINE_ uint32_t first(Mask p_mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+		unsigned long index;
+		if (!_BitScanForward(&index, uint32_t(p_mask))) {
+			_BitScanForward(&index, uint32_t(uint64_t(p_mask) >> 32));
+			index += 32;
+		}
+		return index >> MASK_SHIFT;
+#else
+		return uint32_t(__builtin_ctzll(p_mask)) >> MASK_SHIFT;
+#endif
+	}
+	static _FORCE_INLINE_ Mask next(Mask p_mask) {
+		return p_mask & (p_mask - 1);
+	}
+};
+
+template <class TKey, class TValue,
+		class Hasher = HashMapHasherDefault,
+		class Comparator = HashMapComparatorDefault<TKey>>
+class FlatHashMap {
+	typedef FlatHashMapGroup Group;
+	typedef KeyValue<TKey, TValue> Slot;
+
+public:
+	static constexpr uint32_t MIN_CAPACITY = Group::WIDTH;
+
+private:
+	// capacity + Group::WIDTH control bytes, the first Group::WIDTH ones are
+	// mirrored at the end so a group can be loaded from any position.
+	int8_t *ctrl = nullptr;
+	Slot *slots = nullptr;
+
+	uint32_t capacity = 0; // Always a power of 2 (or 0).
+	uint32_t num_elements = 0;
+	uint32_t growth_left = 0; // Empty slots that can be used before rehashing.
+
+	static _FORCE_INLINE_ uint32_t _get_max_load(uint32_t p_capacity) {
+		return p_capacity - p_capacity / 8;
+	}
+
+	static _FORCE_INLINE_ int8_t _h2(uint32_t p_hash) {
+		return int8_t(p_hash & 0x7F);
+	}
+
+	_FORCE_INLINE_ uint32_t _h1(uint32_t p_hash) const {
+		return (p_hash >> 7) & (capacity - 1);
+	}
+
+	_FORCE_INLINE_ void _set_ctrl(uint32_t p_pos, int8_t p_value) {
+		ctrl[p_pos] = p_value;
+		if (p_pos < Group::WIDTH) {
+			ctrl[capacity + p_pos] = p_value;
+		}
+	}
+
+	bool _lookup_pos_with_hash(const TKey &p_key, uint32_t p_hash, uint32_t &r_pos) const {
+		if (num_elements == 0) {
+			return false; // Failed lookups, no elements
+		}
+
+		const uint32_t mask = capacity - 1;
+		const int8_t h2 = _h2(p_hash);
+		uint32_t pos = _h1(p_hash);
+		uint32_t step = 0;
+
+		while (true) {
+			const int8_t *group = ctrl + pos;
+			for (Group::Mask m = Group::match(group, h2); m; m = Group::next(m)) {
+				uint32_t slot = (pos + Group::first(m)) & mask;
+				if (Comparator::compare(slots[slot].key, p_key)) {
+					r_pos = slot;
+					return true;
+				}
+			}
+
+			if (Group::match_empty(group)) {
+				return false;
+			}
+
+			// Triangular probing, visits every group once the whole table has been probed.
+			step += Group::WIDTH;
+			pos = (pos + step) & mask;
+		}
+	}
+
+	_FORCE_INLINE_ bool _lookup_pos(const TKey &p_key, uint32_t &r_pos) const {
+		return _lookup_pos_with_hash(p_key, Hasher::hash(p_key), r_pos);
+	}
+
+	uint32_t _find_free(uint32_t p_hash) const {
+		const uint32_t mask = capacity - 1;
+		uint32_t pos = _h1(p_hash);
+		uint32_t step = 0;
+
+		while (true) {
+			Group::Mask m = Group::match_empty_or_deleted(ctrl + pos);
+			if (m) {
+				return (pos + Group::first(m)) & mask;
+			}
+
+			step += Group::WIDTH;
+			pos = (pos + step) & mask;
+		}
+	}
+
+	void _rehash(uint32_t p_new_capacity) {
+		int8_t *old_ctrl = ctrl;
+		Slot *old_slots = slots;
+		uint32_t old_capacity = capacity;
+
+		capacity = p_new_capacity;
+		ctrl = static_cast<int8_t *>(Memory::alloc_static(capacity + Group::WIDTH));
+		slots = static_cast<Slot *>(Memory::alloc_static(sizeof(Slot) * capacity));
+		memset(ctrl, Group::CTRL_EMPTY, capacity + Group::WIDTH);
+		growth_left = _get_max_load(capacity) - num_elements;
+
+		if (old_ctrl == nullptr) {
+			return;
+		}
+
+		for (uint32_t i = 0; i < old_capacity; i++) {
+			if (old_ctrl[i] < 0) {
+				continue;
+			}
+			const uint32_t hash = Hasher::hash(old_slots[i].key);
+			const uint32_t pos = _find_free(hash);
+			_set_ctrl(pos, _h2(hash));
+			memnew_placement(&slots[pos], Slot(old_slots[i]));
+			old_slots[i].~Slot();
+		}
+
+		Memory::free_static(old_ctrl);
+		Memory::free_static(old_slots);
+	}
+
+	void _grow() {
+		if (capacity == 0) {
+			_rehash(MIN_CAPACITY);
+		} else if (num_elements <= _get_max_load(capacity) / 2) {
+			// Mostly deleted slots, rehashing in a table of the same size is enough to reclaim them.
+			_rehash(capacity);
+		} else {
+			_rehash(capacity * 2);
+		}
+	}
+
+	Slot *_insert(const TKey &p_key, const TValue &p_value) {
+		const uint32_t hash = Hasher::hash(p_key);
+		uint32_t pos = 0;
+		if (_lookup_pos_with_hash(p_key, hash, pos)) {
+			slots[pos].value = p_value;
+			return &slots[pos];
+		}
+
+		if (unlikely(capacity == 0)) {
+			_grow();
+		}
+		pos = _find_free(hash);
+		if (unlikely(growth_left == 0 && ctrl[pos] != Group::CTRL_DELETED)) {
+			_grow();
+			pos = _find_free(hash);
+		}
+
+		if (ctrl[pos] == Group::CTRL_EMPTY) {
+			growth_left--;
+		}
+		_set_ctrl(pos, _h2(hash));
+		memnew_placement(&slots[pos], Slot(p_key, p_value));
+		num_elements++;
+		return &slots[pos];
+	}
+
+	void _erase_pos(uint32_t p_pos) {
+		slots[p_pos].~Slot();
+		num_elements--;
+
+		if (num_elements == 0) {
+			// Nothing left, drop all the deleted markers.
+			memset(ctrl, Group::CTRL_EMPTY, capacity + Group::WIDTH);
+			growth_left = _get_max_load(capacity);
+		} else {
+			// Probe sequences may go through this slot, so it can't be marked as empty.
+			_set_ctrl(p_pos, Group::CTRL_DELETED);
+		}
+	}
+
+	_FORCE_INLINE_ uint32_t _next_full(uint32_t p_from) const {
+		while (p_from < capacity && ctrl[p_from] < 0) {
+			p_from++;
+		}
+		return p_from;
+	}
+
+public:
+	_FORCE_INLINE_ uint32_t get_capacity() const { return capacity; }
+	_FORCE_INLINE_ uint32_t size() const { return num_elements; }
+
+	bool is_empty() const {
+		return num_elements == 0;
+	}
+
+	void clear() {
+		if (ctrl == nullptr) {
+			return;
+		}
+		if constexpr (!std::is_trivially_destructible<Slot>::value) {
+			for (uint32_t i = 0; i < capacity && num_elements > 0; i++) {
+				if (ctrl[i] >= 0) {
+					slots[i].~Slot();
+					num_elements--;
+				}
+			}
+		}
+		num_elements = 0;
+		memset(ctrl, Group::CTRL_EMPTY, capacity + Group::WIDTH);
+		growth_left = _get_max_load(capacity);
+	}
+
+	TValue &get(const TKey &p_key) {
+		uint32_t pos = 0;
+		bool exists = _lookup_pos(p_key, pos);
+		CRASH_COND_MSG(!exists, "FlatHashMap key not found.");
+		return slots[pos].value;
+	}
+
+	const TValue &get(const TKey &p_key) const {
+		uint32_t pos = 0;
+		bool exists = _lookup_pos(p_key, pos);
+		CRASH_COND_MSG(!exists, "FlatHashMap key not found.");
+		return slots[pos].value;
+	}
+
+	const TValue *getptr(const TKey &p_key) const {
+		uint32_t pos = 0;
+		bool exists = _lookup_pos(p_key, pos);
+		if (exists) {
+			return &slots[pos].value;
+		}
+		return nullptr;
+	}
+
+	TValue *getptr(const TKey &p_key) {
+		uint32_t pos = 0;
+		bool exists = _lookup_pos(p_key, pos);
+		if (exists) {
+			return &slots[pos].value;
+		}
+		return nullptr;
+	}
+
+	_FORCE_INLINE_ bool has(const TKey &p_key) const {
+		uint32_t _pos = 0;
+		return _lookup_pos(p_key, _pos);
+	}
+
+	bool erase(const TKey &p_key) {
+		uint32_t pos = 0;
+		bool exists = _lookup_pos(p_key, pos);
+		if (!exists) {
+			return false;
+		}
+		_erase_pos(pos);
+		return true;
+	}
+
+	// Reserves space for a number of elements, useful to avoid many resizes and rehashes.
+	// If adding a known (possibly large) number of elements at once, must be larger than old capacity.
+	void reserve(uint32_t p_new_capacity) {
+		uint32_t new_capacity = MIN_CAPACITY;
+		while (_get_max_load(new_capacity) < p_new_capacity) {
+			new_capacity *= 2;
+		}
+		if (new_capacity > capacity) {
+			_rehash(new_capacity);
+		}
+	}
+
+	/** Iterator API **/
+
+	struct ConstIterator {
+		_FORCE_INLINE_ const KeyValue<TKey, TValue> &operator*() const {
+			return map->slots[index];
+		}
+		_FORCE_INLINE_ const KeyValue<TKey, TValue> *operator->() const { return &map->slots[index]; }
+		_FORCE_INLINE_ ConstIterator &operator++() {
+			if (map) {
+				index = map->_next_full(index + 1);
+			}
+			return *this;
+		}
+
+		_FORCE_INLINE_ bool operator==(const ConstIterator &b) const { return index == b.index && map == b.map; }
+		_FORCE_INLINE_ bool operator!=(const ConstIterator &b) const { return index != b.index || map != b.map; }
+
+		_FORCE_INLINE_ explicit operator bool() const {
+			return map != nullptr && index < map->capacity;
+		}
+
+		_FORCE_INLINE_ ConstIterator(const FlatHashMap *p_map, uint32_t p_index) {
+			map = p_map;
+			index = p_index;
+		}
+		_FORCE_INLINE_ ConstIterator() {}
+
+	private:
+		const FlatHashMap *map = nullptr;
+		uint32_t index = 0;
+	};
+
+	struct Iterator {
+		_FORCE_INLINE_ KeyValue<TKey, TValue> &operator*() const {
+			return map->slots[index];
+		}
+		_FORCE_INLINE_ KeyValue<TKey, TValue> *operator->() const { return &map->slots[index]; }
+		_FORCE_INLINE_ Iterator &operator++() {
+			if (map) {
+				index = map->_next_full(index + 1);
+			}
+			return *this;
+		}
+
+		_FORCE_INLINE_ bool operator==(const Iterator &b) const { return index == b.index && map == b.map; }
+		_FORCE_INLINE_ bool operator!=(const Iterator &b) const { return index != b.index || map != b.map; }
+
+		_FORCE_INLINE_ explicit operator bool() const {
+			return map != nullptr && index < map->capacity;
+		}
+
+		_FORCE_INLINE_ Iterator(FlatHashMap *p_map, uint32_t p_index) {
+			map = p_map;
+			index = p_index;
+		}
+		_FORCE_INLINE_ Iterator() {}
+
+		operator ConstIterator() const {
+			return ConstIterator(map, index);
+		}
+
+	private:
+		FlatHashMap *map = nullptr;
+		uint32_t index = 0;
+
+		friend class FlatHashMap;
+	};
+
+	_FORCE_INLINE_ Iterator begin() {
+		return Iterator(this, _next_full(0));
+	}
+	_FORCE_INLINE_ Iterator end() {
+		return Iterator(this, capacity);
+	}
+
+	_FORCE_INLINE_ Iterator find(const TKey &p_key) {
+		uint32_t pos = 0;
+		bool exists = _lookup_pos(p_key, pos);
+		if (!exists) {
+			return end();
+		}
+		return Iterator(this, pos);
+	}
+
+	_FORCE_INLINE_ void remove(const Iterator &p_iter) {
+		if (p_iter) {
+			_erase_pos(p_iter.index);
+		}
+	}
+
+	_FORCE_INLINE_ ConstIterator begin() const {
+		return ConstIterator(this, _next_full(0));
+	}
+	_FORCE_INLINE_ ConstIterator end() const {
+		return ConstIterator(this, capacity);
+	}
+
+	_FORCE_INLINE_ ConstIterator find(const TKey &p_key) const {
+		uint32_t pos = 0;
+		bool exists = _lookup_pos(p_key, pos);
+		if (!exists) {
+			return end();
+		}
+		return ConstIterator(this, pos);
+	}
+
+	/* Indexing */
+
+	const TValue &operator[](const TKey &p_key) const {
+		uint32_t pos = 0;
+		bool exists = _lookup_pos(p_key, pos);
+		CRASH_COND(!exists);
+		return slots[pos].value;
+	}
+
+	TValue &operator[](const TKey &p_key) {
+		uint32_t pos = 0;
+		bool exists = _lookup_pos(p_key, pos);
+		if (!exists) {
+			return _insert(p_key, TValue())->value;
+		} else {
+			return slots[pos].value;
+		}
+	}
+
+	/* Insert */
+
+	Iterator insert(const TKey &p_key, const TValue &p_value) {
+		Slot *slot = _insert(p_key, p_value);
+		return Iterator(this, uint32_t(slot - slots));
+	}
+
+	/* Constructors */
+
+	FlatHashMap(const FlatHashMap &p_other) {
+		if (p_other.num_elements == 0) {
+			return;
+		}
+
+		reserve(p_other.num_elements);
+		for (const KeyValue<TKey, TValue> &E : p_other) {
+			insert(E.key, E.value);
+		}
+	}
+
+	void operator=(const FlatHashMap &p_other) {
+		if (this == &p_other) {
+			return; // Ignore self assignment.
+		}
+		clear();
+
+		if (p_other.num_elements == 0) {
+			return; // Nothing to copy.
+		}
+
+		reserve(p_other.num_elements);
+		for (const KeyValue<TKey, TValue> &E : p_other) {
+			insert(E.key, E.value);
+		}
+	}
+
+	FlatHashMap(uint32_t p_initial_capacity) {
+		reserve(p_initial_capacity);
+	}
+	FlatHashMap() {}
+
+	~FlatHashMap() {
+		clear();
+
+		if (ctrl != nullptr) {
+			Memory::free_static(ctrl);
+			Memory::free_static(slots);
+		}
+	}
+};
+
+#endif // FLAT_HASH_MAP_H
@@ -41,13 +41,20 @@
 
 // If tight, it grows strictly as much as needed.
 // Otherwise, it grows exponentially (the default and what you want in most cases).
-template <class T, class U = uint32_t, bool force_trivial = false, bool tight = false>
+// A is the allocator used for the storage, it must provide static realloc() and free().
+template <class T, class U = uint32_t, bool force_trivial = false, bool tight = false, class A = DefaultAllocator>
 class LocalVector {
 private:
 	U count = 0;
 	U capacity = 0;
 	T *data = nullptr;
 
+	_FORCE_INLINE_ void _set_capacity(U p_capacity) {
+		data = (T *)A::realloc(data, capacity * sizeof(T), p_capacity * sizeof(T));
+		CRASH_COND_MSG(!data, "Out of memory");
+		capacity = p_capacity;
+	}
+
 public:
 	T *ptr() {
 		return data;
@@ -59,13 +66,7 @@ public:
 
 	_FORCE_INLINE_ void push_back(T p_elem) {
 		if (unlikely(count == capacity)) {
-			if (capacity == 0) {
-				capacity = 1;
-			} else {
-				capacity <<= 1;
-			}
-			data = (T *)memrealloc(data, capacity * sizeof(T));
-			CRASH_COND_MSG(!data, "Out of memory");
+			_set_capacity(capacity == 0 ? 1 : capacity << 1);
 		}
 
 		if constexpr (!std::is_trivially_constructible<T>::value && !force_trivial) {
@@ -116,7 +117,7 @@ public:
 	_FORCE_INLINE_ void reset() {
 		clear();
 		if (data) {
-			memfree(data);
+			A::free(data);
 			data = nullptr;
 			capacity = 0;
 		}
@@ -126,9 +127,7 @@ public:
 	_FORCE_INLINE_ void reserve(U p_size) {
 		p_size = tight ? p_size : nearest_power_of_2_templated(p_size);
 		if (p_size > capacity) {
-			capacity = p_size;
-			data = (T *)memrealloc(data, capacity * sizeof(T));
-			CRASH_COND_MSG(!data, "Out of memory");
+			_set_capacity(p_size);
 		}
 	}
 
@@ -143,14 +142,11 @@ public:
 			count = p_size;
 		} else if (p_size > count) {
 			if (unlikely(p_size > capacity)) {
-				if (capacity == 0) {
-					capacity = 1;
-				}
-				while (capacity < p_size) {
-					capacity <<= 1;
+				U new_capacity = capacity == 0 ? 1 : capacity;
+				while (new_capacity < p_size) {
+					new_capacity <<= 1;
 				}
-				data = (T *)memrealloc(data, capacity * sizeof(T));
-				CRASH_COND_MSG(!data, "Out of memory");
+				_set_capacity(new_capacity);
 			}
 			if constexpr (!std::is_trivially_constructible<T>::value && !force_trivial) {
 				for (U i = count; i < p_size; i++) {
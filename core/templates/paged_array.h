@@ -130,8 +130,9 @@ public:
 // PageArray is a local array that is optimized to grow in place, then be cleared often.
 // It does so by allocating pages from a PagedArrayPool.
 // It is safe to use multiple PagedArrays from different threads, sharing a single PagedArrayPool
+// The page table is allocated with A, pages always come from the pool.
 
-template <class T>
+template <class T, class A = DefaultAllocator>
 class PagedArray {
 	PagedArrayPool<T> *page_pool = nullptr;
 
@@ -152,13 +153,14 @@ class PagedArray {
 
 	void _grow_page_array() {
 		//no more room in the page array to put the new page, make room
+		uint32_t old_pages = max_pages_used;
 		if (max_pages_used == 0) {
 			max_pages_used = 1;
 		} else {
 			max_pages_used *= 2; // increase in powers of 2 to keep allocations to minimum
 		}
-		page_data = (T **)memrealloc(page_data, sizeof(T *) * max_pages_used);
-		page_ids = (uint32_t *)memrealloc(page_ids, sizeof(uint32_t) * max_pages_used);
+		page_data = (T **)A::realloc(page_data, sizeof(T *) * old_pages, sizeof(T *) * max_pages_used);
+		page_ids = (uint32_t *)A::realloc(page_ids, sizeof(uint32_t) * old_pages, sizeof(uint32_t) * max_pages_used);
 	}
 
 public:
@@ -250,8 +252,8 @@ public:
 	void reset() {
 		clear();
 		if (page_data) {
-			memfree(page_data);
-			memfree(page_ids);
+			A::free(page_data);
+			A::free(page_ids);
 			page_data = nullptr;
 			page_ids = nullptr;
 			max_pages_used = 0;
@@ -262,7 +264,7 @@ public:
 	// resulting order is undefined, but content is merged very efficiently,
 	// making it ideal to fill content on several threads to later join it.
 
-	void merge_unordered(PagedArray<T> &p_array) {
+	void merge_unordered(PagedArray<T, A> &p_array) {
 		ERR_FAIL_COND(page_pool != p_array.page_pool);
 
 		uint32_t remainder = count & page_size_mask;
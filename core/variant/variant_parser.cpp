@@ -33,39 +33,88 @@
 #include "core/input/input_event.h"
 #include "core/io/resource_loader.h"
 #include "core/os/keyboard.h"
+#include "core/templates/local_vector.h"
 #include "core/string/string_buffer.h"
 
-char32_t VariantParser::StreamFile::get_char() {
-	return f->get_8();
+char32_t VariantParser::Stream::_fill_readahead() {
+	readahead_pointer = 0;
+	readahead_filled = _read_buffer(readahead_buffer, readahead_enabled ? READAHEAD_SIZE : 1);
+	if (readahead_filled == 0) {
+		eof = true;
+		return 0;
+	}
+	return readahead_buffer[readahead_pointer++];
 }
 
-bool VariantParser::StreamFile::is_utf8() const {
-	return true;
+void VariantParser::Stream::_discard_pending_chars() {
+	readahead_pointer = 0;
+	readahead_filled = 0;
+	eof = false;
+	saved = 0;
 }
 
-bool VariantParser::StreamFile::is_eof() const {
-	return f->eof_reached();
+uint32_t VariantParser::StreamFile::_read_buffer(char32_t *p_buffer, uint32_t p_num_chars) {
+	ERR_FAIL_COND_V(f.is_null(), 0);
+
+	// Read the bytes in place, then widen them back to front so none is overwritten before it's used.
+	uint8_t *bytes = reinterpret_cast<uint8_t *>(p_buffer);
+	uint64_t num_read = f->get_buffer(bytes, p_num_chars);
+	for (int64_t i = num_read - 1; i >= 0; i--) {
+		p_buffer[i] = bytes[i];
+	}
+	return num_read;
 }
 
-char32_t VariantParser::StreamString::get_char() {
-	if (pos > s.length()) {
-		return 0;
-	} else if (pos == s.length()) {
-		// You need to try to read again when you have reached the end for EOF to be reported,
-		// so this works the same as files (like StreamFile does)
-		pos++;
-		return 0;
-	} else {
-		return s[pos++];
+bool VariantParser::StreamFile::is_utf8() const {
+	return true;
+}
+
+uint32_t VariantParser::StreamString::_read_buffer(char32_t *p_buffer, uint32_t p_num_chars) {
+	int available = MAX(s.length() - pos, 0);
+	uint32_t num_read = MIN((uint32_t)available, p_num_chars);
+	if (num_read > 0) {
+		memcpy(p_buffer, s.ptr() + pos, num_read * sizeof(char32_t));
+		pos += num_read;
 	}
+	return num_read;
 }
 
 bool VariantParser::StreamString::is_utf8() const {
 	return false;
 }
 
-bool VariantParser::StreamString::is_eof() const {
-	return pos > s.length();
+void VariantParser::StreamBuffer::set_data(const Vector<uint8_t> &p_data) {
+	data = p_data;
+	ptr = data.ptr();
+	length = data.size();
+	seek(0);
+}
+
+void VariantParser::StreamBuffer::set_view(const uint8_t *p_data, uint64_t p_length) {
+	data.clear();
+	ptr = p_data;
+	length = p_length;
+	seek(0);
+}
+
+void VariantParser::StreamBuffer::seek(uint64_t p_position) {
+	ERR_FAIL_COND(p_position > length);
+	pos = p_position;
+	_discard_pending_chars();
+}
+
+uint32_t VariantParser::StreamBuffer::_read_buffer(char32_t *p_buffer, uint32_t p_num_chars) {
+	uint32_t num_read = MIN(length - pos, (uint64_t)p_num_chars);
+	const uint8_t *src = ptr + pos;
+	for (uint32_t i = 0; i < num_read; i++) {
+		p_buffer[i] = src[i];
+	}
+	pos += num_read;
+	return num_read;
+}
+
+bool VariantParser::StreamBuffer::is_utf8() const {
+	return true;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
@@ -90,6 +139,24 @@ const char *VariantParser::tk_name[TK_MAX] = {
 	"ERROR"
 };
 
+static void _append_utf8(LocalVector<char> &r_utf8, char32_t p_char) {
+	if (p_char < 0x80) {
+		r_utf8.push_back(char(p_char));
+	} else if (p_char < 0x800) {
+		r_utf8.push_back(char(0xc0 | (p_char >> 6)));
+		r_utf8.push_back(char(0x80 | (p_char & 0x3f)));
+	} else if (p_char < 0x10000) {
+		r_utf8.push_back(char(0xe0 | (p_char >> 12)));
+		r_utf8.push_back(char(0x80 | ((p_char >> 6) & 0x3f)));
+		r_utf8.push_back(char(0x80 | (p_char & 0x3f)));
+	} else {
+		r_utf8.push_back(char(0xf0 | ((p_char >> 18) & 0x07)));
+		r_utf8.push_back(char(0x80 | ((p_char >> 12) & 0x3f)));
+		r_utf8.push_back(char(0x80 | ((p_char >> 6) & 0x3f)));
+		r_utf8.push_back(char(0x80 | (p_char & 0x3f)));
+	}
+}
+
 static double stor_fix(const String &p_str) {
 	if (p_str == "inf") {
 		return INFINITY;
@@ -217,6 +284,9 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 				[[fallthrough]];
 			}
 			case '"': {
+				// UTF-8 streams collect raw bytes and decode them once the string is complete.
+				const bool utf8 = p_stream->is_utf8();
+				LocalVector<char> utf8_str;
 				String str;
 				char32_t prev = 0;
 				while (true) {
@@ -320,7 +390,11 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 							r_token.type = TK_ERROR;
 							return ERR_PARSE_ERROR;
 						}
-						str += res;
+						if (utf8) {
+							_append_utf8(utf8_str, res);
+						} else {
+							str += res;
+						}
 					} else {
 						if (prev != 0) {
 							r_err_str = "Invalid UTF-16 sequence in string, unpaired lead surrogate";
@@ -330,7 +404,11 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 						if (ch == '\n') {
 							line++;
 						}
-						str += ch;
+						if (utf8) {
+							utf8_str.push_back(char(ch));
+						} else {
+							str += ch;
+						}
 					}
 				}
 				if (prev != 0) {
@@ -339,8 +417,8 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 					return ERR_PARSE_ERROR;
 				}
 
-				if (p_stream->is_utf8()) {
-					str.parse_utf8(str.ascii(true).get_data());
+				if (utf8 && utf8_str.size()) {
+					str.parse_utf8(utf8_str.ptr(), utf8_str.size());
 				}
 				if (string_name) {
 					r_token.type = TK_STRING_NAME;
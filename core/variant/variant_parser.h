@@ -38,37 +38,95 @@
 class VariantParser {
 public:
 	struct Stream {
-		virtual char32_t get_char() = 0;
-		virtual bool is_utf8() const = 0;
-		virtual bool is_eof() const = 0;
+	private:
+		enum {
+			READAHEAD_SIZE = 2048
+		};
+
+		char32_t readahead_buffer[READAHEAD_SIZE];
+		uint32_t readahead_pointer = 0;
+		uint32_t readahead_filled = 0;
+		bool eof = false;
+
+		char32_t _fill_readahead();
+
+	protected:
+		bool readahead_enabled = true;
+
+		// Reads up to p_num_chars characters, returns how many were read (0 once the end is reached).
+		virtual uint32_t _read_buffer(char32_t *p_buffer, uint32_t p_num_chars) = 0;
 
+		// Characters read from the source but not consumed by the parser yet.
+		uint32_t _get_pending_chars() const { return readahead_filled - readahead_pointer + (saved ? 1 : 0); }
+		void _discard_pending_chars();
+
+	public:
 		char32_t saved = 0;
 
+		_FORCE_INLINE_ char32_t get_char() {
+			if (likely(readahead_pointer < readahead_filled)) {
+				return readahead_buffer[readahead_pointer++];
+			}
+			return _fill_readahead();
+		}
+		virtual bool is_utf8() const = 0;
+		bool is_eof() const { return eof; }
+
 		Stream() {}
 		virtual ~Stream() {}
 	};
 
 	struct StreamFile : public Stream {
+	protected:
+		virtual uint32_t _read_buffer(char32_t *p_buffer, uint32_t p_num_chars) override;
+
+	public:
 		Ref<FileAccess> f;
 
-		virtual char32_t get_char() override;
 		virtual bool is_utf8() const override;
-		virtual bool is_eof() const override;
 
-		StreamFile() {}
+		// Without readahead, the file position always matches what the parser consumed.
+		StreamFile(bool p_readahead_enabled = true) { readahead_enabled = p_readahead_enabled; }
 	};
 
 	struct StreamString : public Stream {
+	protected:
+		virtual uint32_t _read_buffer(char32_t *p_buffer, uint32_t p_num_chars) override;
+
+	public:
 		String s;
 		int pos = 0;
 
-		virtual char32_t get_char() override;
 		virtual bool is_utf8() const override;
-		virtual bool is_eof() const override;
 
 		StreamString() {}
 	};
 
+	// UTF-8 text already in memory, either owned or borrowed.
+	struct StreamBuffer : public Stream {
+	private:
+		Vector<uint8_t> data;
+		const uint8_t *ptr = nullptr;
+		uint64_t length = 0;
+		uint64_t pos = 0;
+
+	protected:
+		virtual uint32_t _read_buffer(char32_t *p_buffer, uint32_t p_num_chars) override;
+
+	public:
+		void set_data(const Vector<uint8_t> &p_data);
+		void set_view(const uint8_t *p_data, uint64_t p_length); ///< p_data must stay valid while parsing.
+
+		const uint8_t *get_data() const { return ptr; }
+		uint64_t get_length() const { return length; }
+		uint64_t get_position() const { return pos - _get_pending_chars(); }
+		void seek(uint64_t p_position);
+
+		virtual bool is_utf8() const override;
+
+		StreamBuffer() {}
+	};
+
 	typedef Error (*ParseResourceFunc)(void *p_self, Stream *p_stream, Ref<Resource> &r_res, int &line, String &r_err_str);
 
 	struct ResourceParser {
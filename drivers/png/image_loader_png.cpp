@@ -67,9 +67,13 @@ Ref<Image> ImageLoaderPNG::load_mem_png(const uint8_t *p_png, int p_size) {
 }
 
 Ref<Image> ImageLoaderPNG::lossless_unpack_png(const Vector<uint8_t> &p_data) {
-	const int len = p_data.size();
+	return lossless_unpack_png_ptr(p_data.ptr(), p_data.size());
+}
+
+Ref<Image> ImageLoaderPNG::lossless_unpack_png_ptr(const uint8_t *p_data, int p_size) {
+	const int len = p_size;
 	ERR_FAIL_COND_V(len < 4, Ref<Image>());
-	const uint8_t *r = p_data.ptr();
+	const uint8_t *r = p_data;
 	ERR_FAIL_COND_V(r[0] != 'P' || r[1] != 'N' || r[2] != 'G' || r[3] != ' ', Ref<Image>());
 	return load_mem_png(&r[4], len - 4);
 }
@@ -100,5 +104,6 @@ Vector<uint8_t> ImageLoaderPNG::lossless_pack_png(const Ref<Image> &p_image) {
 ImageLoaderPNG::ImageLoaderPNG() {
 	Image::_png_mem_loader_func = load_mem_png;
 	Image::png_unpacker = lossless_unpack_png;
+	Image::png_unpacker_ptr = lossless_unpack_png_ptr;
 	Image::png_packer = lossless_pack_png;
 }
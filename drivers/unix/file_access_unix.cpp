@@ -41,6 +41,7 @@
 #include <sys/types.h>
 
 #if defined(UNIX_ENABLED)
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -135,6 +136,19 @@ void FileAccessUnix::_close() {
 		return;
 	}
 
+	// The descriptor must outlive the reads still in flight.
+	for (const KeyValue<AsyncReadID, AsyncRead *> &E : async_reads) {
+		_wait_async_read(E.value);
+		memdelete(E.value);
+	}
+	async_reads.clear();
+
+	if (mapped) {
+		munmap(mapped, mapped_length);
+		mapped = nullptr;
+		mapped_length = 0;
+	}
+
 	fclose(f);
 	f = nullptr;
 
@@ -230,6 +244,138 @@ uint64_t FileAccessUnix::get_buffer(uint8_t *p_dst, uint64_t p_length) const {
 	return read;
 }
 
+const uint8_t *FileAccessUnix::map_contents(uint64_t &r_length) {
+	ERR_FAIL_COND_V_MSG(!f, nullptr, "File must be opened before use.");
+	if (mapped) {
+		r_length = mapped_length;
+		return mapped;
+	}
+	if (flags != READ) {
+		return nullptr; // Only read-only files can be mapped, the contents must not change under the mapping.
+	}
+
+	uint64_t length = get_length();
+	if (length == 0 || length > SIZE_MAX) {
+		return nullptr;
+	}
+
+	void *addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+	if (addr == MAP_FAILED) {
+		return nullptr; // Callers fall back to regular reads.
+	}
+
+	mapped = (uint8_t *)addr;
+	mapped_length = length;
+	r_length = length;
+	return mapped;
+}
+
+void FileAccessUnix::_read_at(AsyncRead *p_read) {
+	uint64_t total = 0;
+	while (total < p_read->length) {
+		ssize_t read = pread(p_read->fd, p_read->dst + total, p_read->length - total, p_read->position + total);
+		if (read < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			p_read->result = -errno;
+			break;
+		}
+		if (read == 0) {
+			break; // End of file.
+		}
+		total += read;
+	}
+	if (p_read->result == 0) {
+		p_read->result = total;
+	}
+	p_read->completed.set();
+}
+
+void FileAccessUnix::_pool_read_function(void *p_userdata) {
+	_read_at((AsyncRead *)p_userdata);
+}
+
+void FileAccessUnix::_uring_read_done(void *p_userdata, int32_t p_result) {
+	AsyncRead *read = (AsyncRead *)p_userdata;
+	read->result = p_result;
+	read->completed.set();
+	read->done.post();
+}
+
+void FileAccessUnix::_wait_async_read(AsyncRead *p_read) {
+	if (p_read->task_id != WorkerThreadPool::INVALID_TASK_ID) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(p_read->task_id);
+	} else if (p_read->queued) {
+		p_read->done.wait(); // Even if already completed, the completion thread may still be posting.
+	}
+}
+
+FileAccess::AsyncReadID FileAccessUnix::read_async(uint64_t p_position, uint8_t *p_dst, uint64_t p_length) {
+	ERR_FAIL_COND_V_MSG(!f, INVALID_ASYNC_READ_ID, "File must be opened before use.");
+	ERR_FAIL_COND_V(!p_dst && p_length > 0, INVALID_ASYNC_READ_ID);
+
+	if (flags & WRITE) {
+		fflush(f); // Reads go to the descriptor, so they would miss buffered writes.
+	}
+
+	AsyncRead *read = memnew(AsyncRead);
+	read->fd = fileno(f);
+	read->dst = p_dst;
+	read->position = p_position;
+	read->length = p_length;
+
+	AsyncReadID id = last_async_read_id++;
+	async_reads.insert(id, read);
+
+#ifdef IO_URING_ENABLED
+	IOUring *ring = (p_length > 0 && p_length <= IOUring::MAX_READ_LENGTH) ? IOUring::get_singleton() : nullptr;
+	if (ring) {
+		read->uring_read.callback = _uring_read_done;
+		read->uring_read.userdata = read;
+		read->queued = true;
+		ring->submit_read(read->fd, p_dst, p_length, p_position, &read->uring_read);
+		return id;
+	}
+#endif
+
+	// Fall back to blocking reads on the thread pool. pread() leaves the cursor alone, so it is safe to keep using the file meanwhile.
+	if (p_length > 0 && WorkerThreadPool::get_singleton()) {
+		read->task_id = WorkerThreadPool::get_singleton()->add_native_task(_pool_read_function, read, false, "FileAccessUnix::read_async");
+	} else {
+		_read_at(read);
+	}
+	return id;
+}
+
+bool FileAccessUnix::is_async_read_completed(AsyncReadID p_id) const {
+	AsyncRead *const *read = async_reads.getptr(p_id);
+	ERR_FAIL_COND_V_MSG(!read, false, "Invalid asynchronous read ID.");
+	return (*read)->completed.is_set();
+}
+
+uint64_t FileAccessUnix::wait_async_read(AsyncReadID p_id, Error *r_error) {
+	AsyncRead **readp = async_reads.getptr(p_id);
+	if (!readp) {
+		if (r_error) {
+			*r_error = ERR_INVALID_PARAMETER;
+		}
+		ERR_FAIL_V_MSG(0, "Invalid asynchronous read ID.");
+	}
+
+	AsyncRead *read = *readp;
+	async_reads.erase(p_id);
+	_wait_async_read(read);
+
+	int64_t result = read->result;
+	memdelete(read);
+
+	if (r_error) {
+		*r_error = result < 0 ? ERR_FILE_CANT_READ : OK;
+	}
+	return result < 0 ? 0 : result;
+}
+
 Error FileAccessUnix::get_error() const {
 	return last_error;
 }
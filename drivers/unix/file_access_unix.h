@@ -32,7 +32,11 @@
 #define FILE_ACCESS_UNIX_H
 
 #include "core/io/file_access.h"
+#include "core/object/worker_thread_pool.h"
 #include "core/os/memory.h"
+#include "core/os/semaphore.h"
+#include "core/templates/safe_refcount.h"
+#include "drivers/unix/io_uring.h"
 
 #include <stdio.h>
 
@@ -43,12 +47,37 @@ typedef void (*CloseNotificationFunc)(const String &p_file, int p_flags);
 class FileAccessUnix : public FileAccess {
 	FILE *f = nullptr;
 	int flags = 0;
+	uint8_t *mapped = nullptr;
+	uint64_t mapped_length = 0;
 	void check_errors() const;
 	mutable Error last_error = OK;
 	String save_path;
 	String path;
 	String path_src;
 
+	struct AsyncRead {
+		int fd = -1;
+		uint8_t *dst = nullptr;
+		uint64_t position = 0;
+		uint64_t length = 0;
+		int64_t result = 0; // Bytes read, or a negated errno.
+		WorkerThreadPool::TaskID task_id = WorkerThreadPool::INVALID_TASK_ID; // When read from the thread pool.
+		bool queued = false; // When submitted to io_uring.
+		SafeFlag completed;
+		Semaphore done;
+#ifdef IO_URING_ENABLED
+		IOUring::Read uring_read;
+#endif
+	};
+
+	HashMap<AsyncReadID, AsyncRead *> async_reads;
+	AsyncReadID last_async_read_id = 0;
+
+	static void _read_at(AsyncRead *p_read);
+	static void _pool_read_function(void *p_userdata);
+	static void _uring_read_done(void *p_userdata, int32_t p_result);
+	static void _wait_async_read(AsyncRead *p_read);
+
 	void _close();
 
 public:
@@ -69,6 +98,10 @@ public:
 
 	virtual uint8_t get_8() const override; ///< get a byte
 	virtual uint64_t get_buffer(uint8_t *p_dst, uint64_t p_length) const override;
+	virtual const uint8_t *map_contents(uint64_t &r_length) override;
+	virtual AsyncReadID read_async(uint64_t p_position, uint8_t *p_dst, uint64_t p_length) override;
+	virtual bool is_async_read_completed(AsyncReadID p_id) const override;
+	virtual uint64_t wait_async_read(AsyncReadID p_id, Error *r_error = nullptr) override;
 
 	virtual Error get_error() const override; ///< get last error
 
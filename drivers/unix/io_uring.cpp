@@ -0,0 +1,277 @@
+/*************************************************************************/
+/*  io_uring.cpp                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "io_uring.h"
+
+#ifdef IO_URING_ENABLED
+
+#include "core/os/os.h"
+#include "core/string/print_string.h"
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+IOUring *IOUring::singleton = nullptr;
+BinaryMutex IOUring::singleton_mutex;
+bool IOUring::unavailable = false;
+
+static int _io_uring_setup(unsigned p_entries, struct io_uring_params *p_params) {
+	return (int)syscall(__NR_io_uring_setup, p_entries, p_params);
+}
+
+static int _io_uring_enter(int p_fd, unsigned p_to_submit, unsigned p_min_complete, unsigned p_flags) {
+	return (int)syscall(__NR_io_uring_enter, p_fd, p_to_submit, p_min_complete, p_flags, nullptr, 0);
+}
+
+Error IOUring::_setup() {
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	ring_fd = _io_uring_setup(QUEUE_SIZE, &params);
+	if (ring_fd < 0) {
+		return ERR_UNAVAILABLE; // Old kernel, or blocked by a seccomp policy (containers, sandboxes).
+	}
+
+	sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+	single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+#endif
+	if (single_mmap) {
+		sq_ring_size = MAX(sq_ring_size, cq_ring_size);
+		cq_ring_size = sq_ring_size;
+	}
+
+	void *ptr = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+	if (ptr == MAP_FAILED) {
+		return ERR_UNAVAILABLE;
+	}
+	sq_ring = (uint8_t *)ptr;
+
+	if (single_mmap) {
+		cq_ring = sq_ring;
+	} else {
+		ptr = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+		if (ptr == MAP_FAILED) {
+			return ERR_UNAVAILABLE;
+		}
+		cq_ring = (uint8_t *)ptr;
+	}
+
+	sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ptr = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+	if (ptr == MAP_FAILED) {
+		return ERR_UNAVAILABLE;
+	}
+	sqes = (io_uring_sqe *)ptr;
+
+	sq_head = (unsigned *)(sq_ring + params.sq_off.head);
+	sq_tail = (unsigned *)(sq_ring + params.sq_off.tail);
+	sq_mask = (unsigned *)(sq_ring + params.sq_off.ring_mask);
+	sq_array = (unsigned *)(sq_ring + params.sq_off.array);
+	cq_head = (unsigned *)(cq_ring + params.cq_off.head);
+	cq_tail = (unsigned *)(cq_ring + params.cq_off.tail);
+	cq_mask = (unsigned *)(cq_ring + params.cq_off.ring_mask);
+	cqes = (io_uring_cqe *)(cq_ring + params.cq_off.cqes);
+
+	// The completion queue is at least as large, so bounding the submissions bounds the completions too.
+	for (unsigned i = 0; i < params.sq_entries; i++) {
+		free_slots.post();
+	}
+
+	completion_thread.start(_completion_thread_function, this);
+
+	return OK;
+}
+
+bool IOUring::_submit(uint8_t p_opcode, int p_fd, uint64_t p_offset, Read *p_read, bool p_has_slot) {
+	if (!p_has_slot) {
+		free_slots.wait();
+	}
+
+	MutexLock lock(submit_mutex);
+
+	// Only this thread writes the tail, the kernel moves the head as it consumes entries.
+	unsigned tail = *sq_tail;
+	unsigned index = tail & *sq_mask;
+	struct io_uring_sqe *sqe = &sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = p_opcode;
+	sqe->fd = p_fd;
+	sqe->off = p_offset;
+	if (p_read) {
+		p_read->fd = p_fd;
+		p_read->offset = p_offset;
+		sqe->addr = (uint64_t)(uintptr_t)&p_read->iov;
+		sqe->len = 1;
+		sqe->user_data = (uint64_t)(uintptr_t)p_read;
+	}
+	sq_array[index] = index;
+	__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+	// Submit everything not consumed yet, which includes entries left behind by a previous interrupted call.
+	while (true) {
+		unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+		unsigned pending = tail + 1 - head;
+		if (pending == 0 || _io_uring_enter(ring_fd, pending, 0, 0) >= 0) {
+			return true;
+		}
+		if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+			continue;
+		}
+
+		ERR_PRINT("io_uring submission failed: " + itos(errno) + ". Reading without it instead.");
+
+		// Without SQPOLL the kernel only consumes entries inside io_uring_enter(), so the ones left
+		// can be taken back and completed here. Otherwise their callbacks would never be called.
+		bool submitted = true;
+		for (unsigned i = head; i != tail + 1; i++) {
+			Read *read = (Read *)(uintptr_t)sqes[sq_array[i & *sq_mask]].user_data;
+			free_slots.post();
+			if (read) {
+				_read_blocking(read);
+			} else {
+				submitted = false; // The no-op sent by finish().
+			}
+		}
+		__atomic_store_n(sq_tail, head, __ATOMIC_RELEASE);
+		return submitted;
+	}
+}
+
+void IOUring::_read_blocking(Read *p_read) {
+	while (p_read->iov.iov_len > 0) {
+		ssize_t read = pread(p_read->fd, p_read->iov.iov_base, p_read->iov.iov_len, p_read->offset);
+		if (read < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			p_read->callback(p_read->userdata, -errno);
+			return;
+		}
+		if (read == 0) {
+			break; // End of file.
+		}
+		p_read->advance(read);
+	}
+	p_read->callback(p_read->userdata, p_read->total);
+}
+
+void IOUring::_completion_thread_function(void *p_userdata) {
+	IOUring *ring = (IOUring *)p_userdata;
+
+	bool exit = false;
+	while (!exit) {
+		if (_io_uring_enter(ring->ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+			ERR_PRINT("Waiting for io_uring completions failed: " + itos(errno) + ".");
+			OS::get_singleton()->delay_usec(1000);
+		}
+
+		unsigned head = *ring->cq_head;
+		unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+		while (head != tail) {
+			const struct io_uring_cqe &cqe = ring->cqes[head & *ring->cq_mask];
+			Read *read = (Read *)(uintptr_t)cqe.user_data;
+			int32_t result = cqe.res;
+			head++;
+			__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+			if (!read) {
+				ring->free_slots.post();
+				exit = true; // The no-op sent by finish().
+			} else if (result > 0 && (uint32_t)result < read->iov.iov_len) {
+				// Short read, continue where it stopped. The read keeps its slot, so this can't block.
+				read->advance(result);
+				ring->_submit(IORING_OP_READV, read->fd, read->offset, read, true);
+			} else {
+				ring->free_slots.post();
+				read->callback(read->userdata, result < 0 ? result : int32_t(read->total + result));
+			}
+		}
+	}
+}
+
+IOUring *IOUring::get_singleton() {
+	MutexLock lock(singleton_mutex);
+	if (!singleton && !unavailable) {
+		IOUring *ring = memnew(IOUring);
+		if (ring->_setup() == OK) {
+			singleton = ring;
+		} else {
+			memdelete(ring);
+			unavailable = true;
+			print_verbose("io_uring is not available, asynchronous file reads will use the thread pool.");
+		}
+	}
+	return singleton;
+}
+
+void IOUring::finish() {
+	MutexLock lock(singleton_mutex);
+	if (singleton) {
+		if (singleton->_submit(IORING_OP_NOP, -1, 0, nullptr)) {
+			singleton->completion_thread.wait_to_finish();
+			memdelete(singleton);
+		} else {
+			// The completion thread can't be told to stop, so it has to keep the ring.
+			ERR_PRINT("Could not stop the io_uring completion thread.");
+		}
+		singleton = nullptr;
+	}
+}
+
+void IOUring::submit_read(int p_fd, uint8_t *p_dst, uint32_t p_length, uint64_t p_offset, Read *p_read) {
+	ERR_FAIL_COND(p_length > MAX_READ_LENGTH);
+	p_read->iov.iov_base = p_dst;
+	p_read->iov.iov_len = p_length;
+	p_read->total = 0;
+	_submit(IORING_OP_READV, p_fd, p_offset, p_read);
+}
+
+IOUring::~IOUring() {
+	if (sqes) {
+		munmap(sqes, sqes_size);
+	}
+	if (cq_ring && cq_ring != sq_ring) {
+		munmap(cq_ring, cq_ring_size);
+	}
+	if (sq_ring) {
+		munmap(sq_ring, sq_ring_size);
+	}
+	if (ring_fd >= 0) {
+		close(ring_fd);
+	}
+}
+
+#endif // IO_URING_ENABLED
@@ -0,0 +1,128 @@
+/*************************************************************************/
+/*  io_uring.h                                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef IO_URING_H
+#define IO_URING_H
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define IO_URING_ENABLED
+#endif
+#endif
+#endif
+
+#ifdef IO_URING_ENABLED
+
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+
+#include <sys/uio.h>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+// Minimal io_uring submission/completion ring, used to read files without blocking threads on disk.
+// It talks to the kernel directly, so no liburing is needed. Completions are handled by a dedicated thread.
+class IOUring {
+public:
+	enum {
+		QUEUE_SIZE = 256,
+		MAX_READ_LENGTH = 1 << 30, // Results are 32 bits.
+	};
+
+	struct Read {
+		void (*callback)(void *p_userdata, int32_t p_result) = nullptr; // Called with the amount of bytes read, or a negated errno. Usually from the completion thread, from the submitting one if io_uring fails.
+		void *userdata = nullptr;
+
+	private:
+		friend class IOUring;
+		struct iovec iov = {}; // What is left to read.
+		int fd = -1;
+		uint64_t offset = 0;
+		uint32_t total = 0; // Read so far, short reads are resubmitted.
+
+		void advance(uint32_t p_bytes) {
+			iov.iov_base = (uint8_t *)iov.iov_base + p_bytes;
+			iov.iov_len -= p_bytes;
+			offset += p_bytes;
+			total += p_bytes;
+		}
+	};
+
+private:
+	static IOUring *singleton;
+	static BinaryMutex singleton_mutex;
+	static bool unavailable;
+
+	int ring_fd = -1;
+	uint8_t *sq_ring = nullptr;
+	size_t sq_ring_size = 0;
+	uint8_t *cq_ring = nullptr;
+	size_t cq_ring_size = 0;
+	io_uring_sqe *sqes = nullptr;
+	size_t sqes_size = 0;
+
+	unsigned *sq_head = nullptr;
+	unsigned *sq_tail = nullptr;
+	unsigned *sq_mask = nullptr;
+	unsigned *sq_array = nullptr;
+	unsigned *cq_head = nullptr;
+	unsigned *cq_tail = nullptr;
+	unsigned *cq_mask = nullptr;
+	io_uring_cqe *cqes = nullptr;
+
+	BinaryMutex submit_mutex;
+	Semaphore free_slots; // One per submission queue entry, held until completion, so neither queue can overflow.
+	Thread completion_thread;
+
+	Error _setup();
+	bool _submit(uint8_t p_opcode, int p_fd, uint64_t p_offset, Read *p_read, bool p_has_slot = false);
+	static void _read_blocking(Read *p_read);
+	static void _completion_thread_function(void *p_userdata);
+
+	IOUring() {}
+
+public:
+	// Created on first use. Returns nullptr if the kernel doesn't support it (or it is not allowed to use it).
+	static IOUring *get_singleton();
+	static void finish();
+
+	// Reads p_length bytes at p_offset. The Read (and destination) must stay valid until its callback was called.
+	void submit_read(int p_fd, uint8_t *p_dst, uint32_t p_length, uint64_t p_offset, Read *p_read);
+
+	~IOUring();
+};
+
+#endif // IO_URING_ENABLED
+
+#endif // IO_URING_H
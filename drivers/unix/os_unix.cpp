@@ -37,6 +37,7 @@
 #include "core/debugger/script_debugger.h"
 #include "drivers/unix/dir_access_unix.h"
 #include "drivers/unix/file_access_unix.h"
+#include "drivers/unix/io_uring.h"
 #include "drivers/unix/net_socket_posix.h"
 #include "drivers/unix/thread_posix.h"
 #include "servers/rendering_server.h"
@@ -143,6 +144,9 @@ void OS_Unix::initialize_core() {
 
 void OS_Unix::finalize_core() {
 	NetSocketPosix::cleanup();
+#ifdef IO_URING_ENABLED
+	IOUring::finish();
+#endif
 }
 
 Vector<String> OS_Unix::get_video_adapter_driver_info() const {
@@ -358,6 +358,7 @@ void EditorProfiler::_update_frame() {
 			item->set_metadata(1, it.script);
 			item->set_metadata(2, it.line);
 			item->set_text_alignment(2, HORIZONTAL_ALIGNMENT_RIGHT);
+			item->set_text_alignment(3, HORIZONTAL_ALIGNMENT_RIGHT);
 			item->set_tooltip_text(0, it.name + "\n" + it.script + ":" + itos(it.line));
 
 			float time = dtime == DISPLAY_SELF_TIME ? it.self : it.total;
@@ -366,6 +367,9 @@ void EditorProfiler::_update_frame() {
 
 			item->set_text(2, itos(it.calls));
 
+			item->set_text(3, itos(it.allocs));
+			item->set_tooltip_text(3, TTR("Arrays and dictionaries allocated by the function's literals."));
+
 			if (plot_sigs.has(it.signature)) {
 				item->set_checked(0, true);
 				item->set_custom_color(0, _get_color_from_signature(it.signature));
@@ -648,7 +652,7 @@ EditorProfiler::EditorProfiler() {
 	variables->set_hide_folding(true);
 	h_split->add_child(variables);
 	variables->set_hide_root(true);
-	variables->set_columns(3);
+	variables->set_columns(4);
 	variables->set_column_titles_visible(true);
 	variables->set_column_title(0, TTR("Name"));
 	variables->set_column_expand(0, true);
@@ -662,6 +666,10 @@ EditorProfiler::EditorProfiler() {
 	variables->set_column_expand(2, false);
 	variables->set_column_clip_content(2, true);
 	variables->set_column_expand_ratio(2, 60);
+	variables->set_column_title(3, TTR("Allocs"));
+	variables->set_column_expand(3, false);
+	variables->set_column_clip_content(3, true);
+	variables->set_column_expand_ratio(3, 60);
 	variables->connect("item_edited", callable_mp(this, &EditorProfiler::_item_edited));
 
 	graph = memnew(TextureRect);
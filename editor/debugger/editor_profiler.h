@@ -66,6 +66,7 @@ public:
 				float self = 0;
 				float total = 0;
 				int calls = 0;
+				int allocs = 0;
 			};
 
 			Vector<Item> items;
@@ -678,6 +678,7 @@ void ScriptEditorDebugger::_parse_message(const String &p_msg, const Array &p_da
 			int calls = frame.script_functions[i].call_count;
 			float total = frame.script_functions[i].total_time;
 			float self = frame.script_functions[i].self_time;
+			int allocs = frame.script_functions[i].alloc_count;
 
 			EditorProfiler::Metric::Category::Item item;
 			if (profiler_signature.has(signature)) {
@@ -702,6 +703,7 @@ void ScriptEditorDebugger::_parse_message(const String &p_msg, const Array &p_da
 			item.calls = calls;
 			item.self = self;
 			item.total = total;
+			item.allocs = allocs;
 			funcs.items.write[i] = item;
 		}
 
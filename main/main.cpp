@@ -35,6 +35,7 @@
 #include "core/core_string_names.h"
 #include "core/crypto/crypto.h"
 #include "core/debugger/engine_debugger.h"
+#include "core/debugger/frame_profiler.h"
 #include "core/extension/extension_api_dump.h"
 #include "core/extension/gdnative_interface_dump.gen.h"
 #include "core/extension/native_extension_manager.h"
@@ -48,6 +49,7 @@
 #include "core/io/ip.h"
 #include "core/io/resource_loader.h"
 #include "core/object/message_queue.h"
+#include "core/os/frame_allocator.h"
 #include "core/os/os.h"
 #include "core/os/time.h"
 #include "core/register_core_types.h"
@@ -199,6 +201,8 @@ static int fixed_fps = -1;
 static MovieWriter *movie_writer = nullptr;
 static bool disable_vsync = false;
 static bool print_fps = false;
+static int profile_frames = 0;
+static String profile_output = "frame_profile.json";
 #ifdef TOOLS_ENABLED
 static bool dump_gdnative_interface = false;
 static bool dump_extension_api = false;
@@ -401,6 +405,8 @@ void Main::print_help(const char *p_binary) {
 	OS::get_singleton()->print("  --disable-crash-handler                      Disable crash handler when supported by the platform code.\n");
 	OS::get_singleton()->print("  --fixed-fps <fps>                            Force a fixed number of frames per second. This setting disables real-time synchronization.\n");
 	OS::get_singleton()->print("  --print-fps                                  Print the frames per second to the stdout.\n");
+	OS::get_singleton()->print("  --profile-frames <n>                         Capture a timeline of the first <n> frames, save it as a Chrome trace (see --profile-output) and quit.\n");
+	OS::get_singleton()->print("  --profile-output <file>                      Path of the trace saved by --profile-frames (defaults to 'frame_profile.json').\n");
 	OS::get_singleton()->print("\n");
 
 	OS::get_singleton()->print("Standalone tools:\n");
@@ -1258,6 +1264,22 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 			disable_vsync = true;
 		} else if (I->get() == "--print-fps") {
 			print_fps = true;
+		} else if (I->get() == "--profile-frames") {
+			if (I->next()) {
+				profile_frames = I->next()->get().to_int();
+				N = I->next()->next();
+			} else {
+				OS::get_singleton()->print("Missing profile-frames argument, aborting.\n");
+				goto error;
+			}
+		} else if (I->get() == "--profile-output") {
+			if (I->next()) {
+				profile_output = I->next()->get();
+				N = I->next()->next();
+			} else {
+				OS::get_singleton()->print("Missing profile-output argument, aborting.\n");
+				goto error;
+			}
 		} else if (I->get() == "--profile-gpu") {
 			profile_gpu = true;
 		} else if (I->get() == "--disable-crash-handler") {
@@ -1364,6 +1386,13 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 					"memory/limits/multithreaded_server/rid_pool_prealloc",
 					PROPERTY_HINT_RANGE,
 					"0,500,1")); // No negative and limit to 500 due to crashes
+	GLOBAL_DEF("memory/limits/resource_cache/retained_size_mb", 0);
+	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/resource_cache/retained_size_mb",
+			PropertyInfo(Variant::INT,
+					"memory/limits/resource_cache/retained_size_mb",
+					PROPERTY_HINT_RANGE,
+					"0,4096,1,or_greater,suffix:MiB"));
+	ResourceCache::set_retained_budget(uint64_t(MAX(0, int(GLOBAL_GET("memory/limits/resource_cache/retained_size_mb")))) * 1024 * 1024);
 	GLOBAL_DEF("network/limits/debugger/max_chars_per_second", 32768);
 	ProjectSettings::get_singleton()->set_custom_property_info("network/limits/debugger/max_chars_per_second",
 			PropertyInfo(Variant::INT,
@@ -3056,6 +3085,11 @@ bool Main::start() {
 		startup_benchmark_file = String();
 	}
 
+	if (profile_frames > 0) {
+		FrameProfiler::set_thread_name("Main");
+		FrameProfiler::begin_capture();
+	}
+
 	return true;
 }
 
@@ -3135,6 +3169,8 @@ bool Main::iteration() {
 
 		Engine::get_singleton()->_in_physics = true;
 
+		FRAME_PROFILE_ZONE("Main::physics_step");
+
 		uint64_t physics_begin = OS::get_singleton()->get_ticks_usec();
 
 		PhysicsServer3D::get_singleton()->sync();
@@ -3173,15 +3209,22 @@ bool Main::iteration() {
 
 	uint64_t process_begin = OS::get_singleton()->get_ticks_usec();
 
-	if (OS::get_singleton()->get_main_loop()->process(process_step * time_scale)) {
-		exit = true;
+	{
+		FRAME_PROFILE_ZONE("Main::process");
+		if (OS::get_singleton()->get_main_loop()->process(process_step * time_scale)) {
+			exit = true;
+		}
+		message_queue->flush();
 	}
-	message_queue->flush();
 
-	RenderingServer::get_singleton()->sync(); //sync if still drawing from previous frames.
+	{
+		FRAME_PROFILE_ZONE("RenderingServer::sync");
+		RenderingServer::get_singleton()->sync(); //sync if still drawing from previous frames.
+	}
 
 	if (DisplayServer::get_singleton()->can_any_window_draw() &&
 			RenderingServer::get_singleton()->is_render_loop_enabled()) {
+		FRAME_PROFILE_ZONE("RenderingServer::draw");
 		if ((!force_redraw_requested) && OS::get_singleton()->is_in_low_processor_usage_mode()) {
 			if (RenderingServer::get_singleton()->has_changed()) {
 				RenderingServer::get_singleton()->draw(true, scaled_step); // flush visual commands
@@ -3210,6 +3253,7 @@ bool Main::iteration() {
 
 	frames++;
 	Engine::get_singleton()->_process_frames++;
+	FrameAllocator::end_frame();
 
 	if (frame > 1000000) {
 		// Wait a few seconds before printing FPS, as FPS reporting just after the engine has started is inaccurate.
@@ -3237,6 +3281,15 @@ bool Main::iteration() {
 
 	iterating--;
 
+	if (profile_frames > 0 && Engine::get_singleton()->get_process_frames() >= (uint64_t)profile_frames) {
+		FrameProfiler::end_capture();
+		if (FrameProfiler::save_chrome_trace(profile_output) == OK) {
+			print_line(vformat("Saved a profile of %d frames to: %s", profile_frames, profile_output));
+		}
+		profile_frames = 0;
+		exit = true;
+	}
+
 	// Needed for OSs using input buffering regardless accumulation (like Android)
 	if (Input::get_singleton()->is_using_input_buffering() && !agile_input_event_flushing) {
 		Input::get_singleton()->flush_buffered_events();
@@ -3300,6 +3353,9 @@ void Main::cleanup(bool p_force) {
 
 	OS::get_singleton()->delete_main_loop();
 
+	// Release resources kept alive by the cache while their servers still exist.
+	ResourceCache::clear_retained();
+
 	OS::get_singleton()->_cmdline.clear();
 	OS::get_singleton()->_user_args.clear();
 	OS::get_singleton()->_execpath = "";
@@ -74,6 +74,12 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(RESOURCE_CACHE_RETAINED_COUNT);
+	BIND_ENUM_CONSTANT(RESOURCE_CACHE_TEXTURE_MEM);
+	BIND_ENUM_CONSTANT(RESOURCE_CACHE_MESH_MEM);
+	BIND_ENUM_CONSTANT(RESOURCE_CACHE_AUDIO_MEM);
+	BIND_ENUM_CONSTANT(RESOURCE_CACHE_OTHER_MEM);
+	BIND_ENUM_CONSTANT(RESOURCE_CACHE_EVICTIONS);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -113,6 +119,12 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/driver/output_latency",
+		"resource_cache/retained",
+		"resource_cache/texture_mem",
+		"resource_cache/mesh_mem",
+		"resource_cache/audio_mem",
+		"resource_cache/other_mem",
+		"resource_cache/evictions",
 
 	};
 
@@ -167,6 +179,18 @@ double Performance::get_monitor(Monitor p_monitor) const {
 			return PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY:
 			return AudioServer::get_singleton()->get_output_latency();
+		case RESOURCE_CACHE_RETAINED_COUNT:
+			return ResourceCache::get_retained_count();
+		case RESOURCE_CACHE_TEXTURE_MEM:
+			return ResourceCache::get_retained_memory(ResourceCache::MEMORY_CATEGORY_TEXTURE);
+		case RESOURCE_CACHE_MESH_MEM:
+			return ResourceCache::get_retained_memory(ResourceCache::MEMORY_CATEGORY_MESH);
+		case RESOURCE_CACHE_AUDIO_MEM:
+			return ResourceCache::get_retained_memory(ResourceCache::MEMORY_CATEGORY_AUDIO);
+		case RESOURCE_CACHE_OTHER_MEM:
+			return ResourceCache::get_retained_memory(ResourceCache::MEMORY_CATEGORY_OTHER);
+		case RESOURCE_CACHE_EVICTIONS:
+			return ResourceCache::get_eviction_count();
 
 		default: {
 		}
@@ -202,6 +226,12 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_QUANTITY,
 
 	};
 
@@ -89,6 +89,12 @@ public:
 		PHYSICS_3D_COLLISION_PAIRS,
 		PHYSICS_3D_ISLAND_COUNT,
 		AUDIO_OUTPUT_LATENCY,
+		RESOURCE_CACHE_RETAINED_COUNT,
+		RESOURCE_CACHE_TEXTURE_MEM,
+		RESOURCE_CACHE_MESH_MEM,
+		RESOURCE_CACHE_AUDIO_MEM,
+		RESOURCE_CACHE_OTHER_MEM,
+		RESOURCE_CACHE_EVICTIONS,
 		MONITOR_MAX
 	};
 
@@ -94,6 +94,8 @@ complete -c godot -l disable-render-loop -d "Disable render loop so rendering on
 complete -c godot -l disable-crash-handler -d "Disable crash handler when supported by the platform code"
 complete -c godot -l fixed-fps -d "Force a fixed number of frames per second (this setting disables real-time synchronization)" -x
 complete -c godot -l print-fps -d "Print the frames per second to the stdout"
+complete -c godot -l profile-frames -d "Capture a timeline of the first frames, save it as a Chrome trace and quit" -x
+complete -c godot -l profile-output -d "Path of the trace saved by --profile-frames" -r
 
 # Standalone tools:
 complete -c godot -s s -l script -d "Run a script" -r
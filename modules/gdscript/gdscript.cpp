@@ -40,6 +40,7 @@
 #include "core/io/file_access_encrypted.h"
 #include "core/os/os.h"
 #include "gdscript_analyzer.h"
+#include "gdscript_bytecode_cache.h"
 #include "gdscript_cache.h"
 #include "gdscript_compiler.h"
 #include "gdscript_parser.h"
@@ -880,7 +881,29 @@ Error GDScript::reload(bool p_keep_state) {
 		}
 	}
 
+	// Only scripts loaded from their own file, as they are loaded, are cached (no hot reloading).
+	bool cacheable = !p_keep_state && GDScriptBytecodeCache::is_cacheable(this);
+
 	valid = false;
+	if (cacheable && GDScriptBytecodeCache::load(this)) {
+		valid = true;
+
+		for (KeyValue<StringName, Ref<GDScript>> &E : subclasses) {
+			_set_subclass_path(E.value, path);
+		}
+
+		_init_rpc_methods_properties();
+
+		return OK;
+	}
+
+	// Parse what this script is expected to depend on in parallel, the analyzer
+	// takes them from the cache. They are kept until compiling is done.
+	Vector<Ref<GDScriptParserRef>> dependencies;
+	if (!p_keep_state && !path.is_empty() && Thread::get_caller_id() == Thread::get_main_id()) {
+		dependencies = GDScriptCache::parse_dependencies(path);
+	}
+
 	GDScriptParser parser;
 	Error err = parser.parse(source, path, false);
 	if (err) {
@@ -945,6 +968,10 @@ Error GDScript::reload(bool p_keep_state) {
 
 	_init_rpc_methods_properties();
 
+	if (cacheable) {
+		GDScriptBytecodeCache::save(this, parser);
+	}
+
 	return OK;
 }
 
@@ -1826,6 +1853,7 @@ Error GDScriptLanguage::execute_file(const String &p_path) {
 }
 
 void GDScriptLanguage::finish() {
+	GDScriptBytecodeCache::reset();
 }
 
 void GDScriptLanguage::profiling_start() {
@@ -1843,6 +1871,9 @@ void GDScriptLanguage::profiling_start() {
 		elem->self()->profile.last_frame_call_count = 0;
 		elem->self()->profile.last_frame_self_time = 0;
 		elem->self()->profile.last_frame_total_time = 0;
+		elem->self()->profile.alloc_count = 0;
+		elem->self()->profile.frame_alloc_count = 0;
+		elem->self()->profile.last_frame_alloc_count = 0;
 		elem = elem->next();
 	}
 
@@ -1859,6 +1890,14 @@ void GDScriptLanguage::profiling_stop() {
 }
 
 int GDScriptLanguage::profiling_get_accumulated_data(ProfilingInfo *p_info_arr, int p_info_max) {
+	return profiling_get_accumulated_data_and_allocs(p_info_arr, nullptr, p_info_max);
+}
+
+int GDScriptLanguage::profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_info_max) {
+	return profiling_get_frame_data_and_allocs(p_info_arr, nullptr, p_info_max);
+}
+
+int GDScriptLanguage::profiling_get_accumulated_data_and_allocs(ProfilingInfo *p_info_arr, uint64_t *r_alloc_counts, int p_info_max) {
 	int current = 0;
 #ifdef DEBUG_ENABLED
 
@@ -1872,6 +1911,9 @@ int GDScriptLanguage::profiling_get_accumulated_data(ProfilingInfo *p_info_arr,
 		p_info_arr[current].call_count = elem->self()->profile.call_count;
 		p_info_arr[current].self_time = elem->self()->profile.self_time;
 		p_info_arr[current].total_time = elem->self()->profile.total_time;
+		if (r_alloc_counts) {
+			r_alloc_counts[current] = elem->self()->profile.alloc_count;
+		}
 		p_info_arr[current].signature = elem->self()->profile.signature;
 		elem = elem->next();
 		current++;
@@ -1881,7 +1923,7 @@ int GDScriptLanguage::profiling_get_accumulated_data(ProfilingInfo *p_info_arr,
 	return current;
 }
 
-int GDScriptLanguage::profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_info_max) {
+int GDScriptLanguage::profiling_get_frame_data_and_allocs(ProfilingInfo *p_info_arr, uint64_t *r_alloc_counts, int p_info_max) {
 	int current = 0;
 
 #ifdef DEBUG_ENABLED
@@ -1896,6 +1938,9 @@ int GDScriptLanguage::profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_
 			p_info_arr[current].call_count = elem->self()->profile.last_frame_call_count;
 			p_info_arr[current].self_time = elem->self()->profile.last_frame_self_time;
 			p_info_arr[current].total_time = elem->self()->profile.last_frame_total_time;
+			if (r_alloc_counts) {
+				r_alloc_counts[current] = elem->self()->profile.last_frame_alloc_count;
+			}
 			p_info_arr[current].signature = elem->self()->profile.signature;
 			current++;
 		}
@@ -2090,9 +2135,11 @@ void GDScriptLanguage::frame() {
 			elem->self()->profile.last_frame_call_count = elem->self()->profile.frame_call_count;
 			elem->self()->profile.last_frame_self_time = elem->self()->profile.frame_self_time;
 			elem->self()->profile.last_frame_total_time = elem->self()->profile.frame_total_time;
+			elem->self()->profile.last_frame_alloc_count = elem->self()->profile.frame_alloc_count;
 			elem->self()->profile.frame_call_count = 0;
 			elem->self()->profile.frame_self_time = 0;
 			elem->self()->profile.frame_total_time = 0;
+			elem->self()->profile.frame_alloc_count = 0;
 			elem = elem->next();
 		}
 	}
@@ -2320,6 +2367,8 @@ GDScriptLanguage::GDScriptLanguage() {
 		_call_stack = nullptr;
 	}
 
+	GLOBAL_DEF("gdscript/bytecode_cache/enabled", true);
+
 #ifdef DEBUG_ENABLED
 	GLOBAL_DEF("debug/gdscript/warnings/enable", true);
 	GLOBAL_DEF("debug/gdscript/warnings/treat_warnings_as_errors", false);
@@ -74,6 +74,8 @@ class GDScript : public Script {
 	friend class GDScriptAnalyzer;
 	friend class GDScriptCompiler;
 	friend class GDScriptLanguage;
+	friend class GDScriptInlineCache;
+	friend class GDScriptBytecodeCache;
 	friend struct GDScriptUtilityFunctionsDefinitions;
 
 	Ref<GDScriptNativeClass> native;
@@ -88,6 +90,7 @@ class GDScript : public Script {
 	HashMap<StringName, Ref<GDScript>> subclasses;
 	HashMap<StringName, Vector<StringName>> _signals;
 	Dictionary rpc_config;
+	mutable SafeFlag inline_cached; // Whether inline cache entries may refer to this script.
 
 #ifdef TOOLS_ENABLED
 
@@ -267,6 +270,7 @@ class GDScriptInstance : public ScriptInstance {
 	friend class GDScriptLambdaCallable;
 	friend class GDScriptLambdaSelfCallable;
 	friend class GDScriptCompiler;
+	friend class GDScriptInlineCache;
 	friend struct GDScriptUtilityFunctionsDefinitions;
 
 	ObjectID owner_id;
@@ -502,6 +506,8 @@ public:
 
 	virtual int profiling_get_accumulated_data(ProfilingInfo *p_info_arr, int p_info_max) override;
 	virtual int profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_info_max) override;
+	virtual int profiling_get_accumulated_data_and_allocs(ProfilingInfo *p_info_arr, uint64_t *r_alloc_counts, int p_info_max) override;
+	virtual int profiling_get_frame_data_and_allocs(ProfilingInfo *p_info_arr, uint64_t *r_alloc_counts, int p_info_max) override;
 
 	/* LOADER FUNCTIONS */
 
@@ -1417,6 +1417,8 @@ void GDScriptAnalyzer::resolve_for(GDScriptParser::ForNode *p_for) {
 		p_for->variable->set_datatype(variable_type);
 	} else if (p_for->list) {
 		resolve_node(p_for->list, false);
+		// The loop only reads the list, but its elements are given to the loop variable.
+		reduce_non_escaping_literal(p_for->list, true);
 		if (p_for->list->datatype.has_container_element_type()) {
 			variable_type = p_for->list->datatype.get_container_element_type();
 			variable_type.type_source = GDScriptParser::DataType::ANNOTATED_INFERRED;
@@ -2112,6 +2114,10 @@ void GDScriptAnalyzer::reduce_binary_op(GDScriptParser::BinaryOpNode *p_binary_o
 	}
 	// TODO: Right operand must be a valid type with the `is` operator. Need to check here.
 
+	if (p_binary_op->operation == GDScriptParser::BinaryOpNode::OP_CONTENT_TEST) {
+		reduce_non_escaping_literal(p_binary_op->right_operand, false);
+	}
+
 	GDScriptParser::DataType left_type;
 	if (p_binary_op->left_operand) {
 		left_type = p_binary_op->left_operand->get_datatype();
@@ -3273,7 +3279,10 @@ void GDScriptAnalyzer::reduce_subscript(GDScriptParser::SubscriptNode *p_subscri
 	} else {
 		reduce_expression(p_subscript->base);
 
-		if (p_subscript->base->type == GDScriptParser::Node::ARRAY) {
+		if (!p_subscript->is_attribute) {
+			// Indexing only reads from the base, the element it returns is not the container.
+			reduce_non_escaping_literal(p_subscript->base, false);
+		} else if (p_subscript->base->type == GDScriptParser::Node::ARRAY) {
 			const_fold_array(static_cast<GDScriptParser::ArrayNode *>(p_subscript->base));
 		} else if (p_subscript->base->type == GDScriptParser::Node::DICTIONARY) {
 			const_fold_dictionary(static_cast<GDScriptParser::DictionaryNode *>(p_subscript->base));
@@ -3650,6 +3659,45 @@ void GDScriptAnalyzer::const_fold_dictionary(GDScriptParser::DictionaryNode *p_d
 	p_dictionary->reduced_value = dict;
 }
 
+// Container literals which are only read by the expression using them (iterated, searched or
+// indexed) can't be reached afterwards. Constant ones are folded so they are built only once, the
+// others are marked so the compiler can refill the same container instead of allocating a new one.
+void GDScriptAnalyzer::reduce_non_escaping_literal(GDScriptParser::ExpressionNode *p_expression, bool p_elements_escape) {
+	if (p_expression == nullptr || p_expression->is_constant) {
+		return;
+	}
+
+	if (p_expression->type == GDScriptParser::Node::ARRAY) {
+		GDScriptParser::ArrayNode *array = static_cast<GDScriptParser::ArrayNode *>(p_expression);
+		bool can_fold = true;
+		if (p_elements_escape) {
+			// Folding would share nested containers between runs, and the user can modify those.
+			for (int i = 0; i < array->elements.size() && can_fold; i++) {
+				GDScriptParser::Node::Type element_type = array->elements[i]->type;
+				can_fold = element_type != GDScriptParser::Node::ARRAY && element_type != GDScriptParser::Node::DICTIONARY;
+			}
+		}
+		if (can_fold) {
+			const_fold_array(array);
+		}
+		array->is_non_escaping = !array->is_constant;
+	} else if (p_expression->type == GDScriptParser::Node::DICTIONARY) {
+		GDScriptParser::DictionaryNode *dictionary = static_cast<GDScriptParser::DictionaryNode *>(p_expression);
+		bool can_fold = true;
+		if (p_elements_escape) {
+			for (int i = 0; i < dictionary->elements.size() && can_fold; i++) {
+				GDScriptParser::Node::Type key_type = dictionary->elements[i].key->type;
+				GDScriptParser::Node::Type value_type = dictionary->elements[i].value->type;
+				can_fold = key_type != GDScriptParser::Node::ARRAY && key_type != GDScriptParser::Node::DICTIONARY && value_type != GDScriptParser::Node::ARRAY && value_type != GDScriptParser::Node::DICTIONARY;
+			}
+		}
+		if (can_fold) {
+			const_fold_dictionary(dictionary);
+		}
+		dictionary->is_non_escaping = !dictionary->is_constant;
+	}
+}
+
 GDScriptParser::DataType GDScriptAnalyzer::type_from_variant(const Variant &p_value, const GDScriptParser::Node *p_source) {
 	GDScriptParser::DataType result;
 	result.is_constant = true;
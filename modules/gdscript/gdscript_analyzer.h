@@ -99,6 +99,7 @@ class GDScriptAnalyzer {
 
 	void const_fold_array(GDScriptParser::ArrayNode *p_array);
 	void const_fold_dictionary(GDScriptParser::DictionaryNode *p_dictionary);
+	void reduce_non_escaping_literal(GDScriptParser::ExpressionNode *p_expression, bool p_elements_escape);
 
 	// Helpers.
 	GDScriptParser::DataType type_from_variant(const Variant &p_value, const GDScriptParser::Node *p_source);
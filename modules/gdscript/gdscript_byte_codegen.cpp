@@ -32,6 +32,9 @@
 
 #include "core/debugger/engine_debugger.h"
 #include "gdscript.h"
+#include "gdscript_inline_cache.h"
+#include "gdscript_threaded_code.h"
+#include "gdscript_typed_operators.h"
 
 uint32_t GDScriptByteCodeGenerator::add_parameter(const StringName &p_name, bool p_is_optional, const GDScriptDataType &p_type) {
 #ifdef TOOLS_ENABLED
@@ -143,10 +146,24 @@ void GDScriptByteCodeGenerator::pop_temporary() {
 	ERR_FAIL_COND(used_temporaries.is_empty());
 	int slot_idx = used_temporaries.back()->get();
 	const StackSlot &slot = temporaries[slot_idx];
-	temporaries_pool[slot.type].push_back(slot_idx);
+	if (!slot.is_buffer) {
+		temporaries_pool[slot.type].push_back(slot_idx);
+	}
 	used_temporaries.pop_back();
 }
 
+uint32_t GDScriptByteCodeGenerator::add_buffer() {
+	// A buffer is only written by the instruction it's created for, so that instruction can reuse
+	// what it left there on the previous run. It starts as null, so a call which never reaches
+	// the instruction doesn't allocate anything.
+	StackSlot buffer;
+	buffer.is_buffer = true;
+	int idx = temporaries.size();
+	temporaries.push_back(buffer);
+	used_temporaries.push_back(idx);
+	return idx;
+}
+
 void GDScriptByteCodeGenerator::start_parameters() {
 	if (function->_default_arg_count > 0) {
 		append(GDScriptFunction::OPCODE_JUMP_TO_DEF_ARGUMENT);
@@ -401,6 +418,12 @@ GDScriptFunction *GDScriptByteCodeGenerator::write_end() {
 	function->_instruction_args_size = instr_args_max;
 	function->_ptrcall_args_size = ptrcall_max;
 
+	if (inline_cache_max) {
+		function->inline_cache = memnew(GDScriptInlineCache(inline_cache_max));
+	}
+
+	function->threaded_code = GDScriptThreadedCode::create(function);
+
 	ended = true;
 	return function;
 }
@@ -572,6 +595,31 @@ void GDScriptByteCodeGenerator::write_binary_operator(const Address &p_target, V
 			}
 		}
 
+		Variant::Type operand_type = p_left_operand.type.builtin_type;
+		if (operand_type == p_right_operand.type.builtin_type && GDScriptTypedOperator::is_supported(p_operator, operand_type)) {
+			// Common numeric operators work directly on the values.
+			GDScriptFunction::Opcode opcode = GDScriptFunction::OPCODE_OPERATOR_INT;
+			switch (operand_type) {
+				case Variant::FLOAT:
+					opcode = GDScriptFunction::OPCODE_OPERATOR_FLOAT;
+					break;
+				case Variant::VECTOR2:
+					opcode = GDScriptFunction::OPCODE_OPERATOR_VECTOR2;
+					break;
+				case Variant::VECTOR3:
+					opcode = GDScriptFunction::OPCODE_OPERATOR_VECTOR3;
+					break;
+				default:
+					break;
+			}
+			append(opcode, 3);
+			append(p_left_operand);
+			append(p_right_operand);
+			append(p_target);
+			append(p_operator);
+			return;
+		}
+
 		// Gather specific operator.
 		Variant::ValidatedOperatorEvaluator op_func = Variant::get_validated_operator_evaluator(p_operator, p_left_operand.type.builtin_type, p_right_operand.type.builtin_type);
 
@@ -771,6 +819,7 @@ void GDScriptByteCodeGenerator::write_set_named(const Address &p_target, const S
 	append(p_target);
 	append(p_source);
 	append(p_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_get_named(const Address &p_target, const StringName &p_name, const Address &p_source) {
@@ -786,6 +835,7 @@ void GDScriptByteCodeGenerator::write_get_named(const Address &p_target, const S
 	append(p_source);
 	append(p_target);
 	append(p_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_set_member(const Address &p_value, const StringName &p_name) {
@@ -929,6 +979,7 @@ void GDScriptByteCodeGenerator::write_call(const Address &p_target, const Addres
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_super_call(const Address &p_target, const StringName &p_function_name, const Vector<Address> &p_arguments) {
@@ -950,6 +1001,7 @@ void GDScriptByteCodeGenerator::write_call_async(const Address &p_target, const
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_call_gdscript_utility(const Address &p_target, GDScriptUtilityFunctions::FunctionPtr p_function, const Vector<Address> &p_arguments) {
@@ -1197,6 +1249,7 @@ void GDScriptByteCodeGenerator::write_call_self(const Address &p_target, const S
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_call_self_async(const Address &p_target, const StringName &p_function_name, const Vector<Address> &p_arguments) {
@@ -1208,6 +1261,7 @@ void GDScriptByteCodeGenerator::write_call_self_async(const Address &p_target, c
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_call_script_function(const Address &p_target, const Address &p_base, const StringName &p_function_name, const Vector<Address> &p_arguments) {
@@ -1219,6 +1273,7 @@ void GDScriptByteCodeGenerator::write_call_script_function(const Address &p_targ
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_lambda(const Address &p_target, GDScriptFunction *p_function, const Vector<Address> &p_captures, bool p_use_self) {
@@ -1283,7 +1338,8 @@ void GDScriptByteCodeGenerator::write_construct(const Address &p_target, Variant
 }
 
 void GDScriptByteCodeGenerator::write_construct_array(const Address &p_target, const Vector<Address> &p_arguments) {
-	append(GDScriptFunction::OPCODE_CONSTRUCT_ARRAY, 1 + p_arguments.size());
+	bool reuse = p_target.mode == Address::TEMPORARY && temporaries[p_target.address].is_buffer;
+	append(reuse ? GDScriptFunction::OPCODE_CONSTRUCT_ARRAY_REUSE : GDScriptFunction::OPCODE_CONSTRUCT_ARRAY, 1 + p_arguments.size());
 	for (int i = 0; i < p_arguments.size(); i++) {
 		append(p_arguments[i]);
 	}
@@ -1311,7 +1367,8 @@ void GDScriptByteCodeGenerator::write_construct_typed_array(const Address &p_tar
 }
 
 void GDScriptByteCodeGenerator::write_construct_dictionary(const Address &p_target, const Vector<Address> &p_arguments) {
-	append(GDScriptFunction::OPCODE_CONSTRUCT_DICTIONARY, 1 + p_arguments.size());
+	bool reuse = p_target.mode == Address::TEMPORARY && temporaries[p_target.address].is_buffer;
+	append(reuse ? GDScriptFunction::OPCODE_CONSTRUCT_DICTIONARY_REUSE : GDScriptFunction::OPCODE_CONSTRUCT_DICTIONARY, 1 + p_arguments.size());
 	for (int i = 0; i < p_arguments.size(); i++) {
 		append(p_arguments[i]);
 	}
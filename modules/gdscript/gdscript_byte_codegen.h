@@ -40,6 +40,7 @@ class GDScriptByteCodeGenerator : public GDScriptCodeGenerator {
 	struct StackSlot {
 		Variant::Type type = Variant::NIL;
 		Vector<int> bytecode_indices;
+		bool is_buffer = false; // Never returned to the pool, so it keeps its value between uses.
 
 		StackSlot() = default;
 		StackSlot(Variant::Type p_type) :
@@ -71,6 +72,7 @@ class GDScriptByteCodeGenerator : public GDScriptCodeGenerator {
 	int current_line = 0;
 	int instr_args_max = 0;
 	int ptrcall_max = 0;
+	int inline_cache_max = 0;
 
 #ifdef DEBUG_ENABLED
 	List<int> temp_stack;
@@ -400,6 +402,11 @@ class GDScriptByteCodeGenerator : public GDScriptCodeGenerator {
 		opcodes.push_back(get_lambda_function_pos(p_lambda_function));
 	}
 
+	// Reserves a site in the function's inline cache for the current instruction.
+	void append_inline_cache() {
+		opcodes.push_back(inline_cache_max++);
+	}
+
 	void patch_jump(int p_address) {
 		opcodes.write[p_address] = opcodes.size();
 	}
@@ -412,6 +419,7 @@ public:
 	virtual uint32_t add_or_get_name(const StringName &p_name) override;
 	virtual uint32_t add_temporary(const GDScriptDataType &p_type) override;
 	virtual void pop_temporary() override;
+	virtual uint32_t add_buffer() override;
 
 	virtual void start_parameters() override;
 	virtual void end_parameters() override;
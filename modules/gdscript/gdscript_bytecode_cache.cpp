@@ -0,0 +1,1876 @@
+/*************************************************************************/
+/*  gdscript_bytecode_cache.cpp                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_bytecode_cache.h"
+
+#include "core/config/engine.h"
+#include "core/config/project_settings.h"
+#include "core/debugger/engine_debugger.h"
+#include "core/debugger/script_debugger.h"
+#include "core/io/dir_access.h"
+#include "core/io/resource_loader.h"
+#include "core/object/class_db.h"
+#include "core/object/method_bind.h"
+#include "core/string/string_builder.h"
+#include "core/templates/local_vector.h"
+#include "core/version.h"
+#include "gdscript.h"
+#include "gdscript_cache.h"
+#include "gdscript_function.h"
+#include "gdscript_inline_cache.h"
+#include "gdscript_parser.h"
+#include "gdscript_threaded_code.h"
+#include "gdscript_warning.h"
+
+static const char *bytecode_cache_header = "GDBC";
+
+GDScriptBytecodeCache *GDScriptBytecodeCache::singleton = nullptr;
+
+void GDScriptBytecodeCache::_initialize() {
+	if (initialized) {
+		return;
+	}
+	initialized = true;
+
+	// Scripts are edited and reloaded in place all the time in the editor, only cache for running projects.
+	if (Engine::get_singleton()->is_editor_hint() || !bool(GLOBAL_GET("gdscript/bytecode_cache/enabled"))) {
+		return;
+	}
+
+	Ref<DirAccess> da = DirAccess::open("user://");
+	if (da.is_null()) {
+		ERR_PRINT("Can't open the user data folder, no GDScript bytecode caching will happen.");
+		return;
+	}
+	if (da->change_dir("gdscript_cache") != OK && da->make_dir("gdscript_cache") != OK) {
+		ERR_PRINT("Can't create GDScript bytecode cache folder, no GDScript bytecode caching will happen.");
+		return;
+	}
+	cache_dir = "user://gdscript_cache";
+}
+
+String GDScriptBytecodeCache::_get_cache_path(const String &p_path) const {
+	return cache_dir.path_join(p_path.md5_text() + ".gdbc");
+}
+
+String GDScriptBytecodeCache::_get_source_hash(const String &p_path) {
+	// Files don't change while the project runs, so each one is only hashed once.
+	HashMap<String, String>::Iterator E = source_hashes.find(p_path);
+	if (E) {
+		return E->value;
+	}
+	String hash;
+	if (FileAccess::exists(p_path)) {
+		hash = GDScriptCache::get_source_code(p_path).sha256_text();
+	}
+	source_hashes[p_path] = hash;
+	return hash;
+}
+
+String GDScriptBytecodeCache::_get_environment_hash() {
+	const HashMap<StringName, int> &globals = GDScriptLanguage::get_singleton()->get_global_map();
+	List<StringName> global_classes;
+	ScriptServer::get_global_class_list(&global_classes);
+
+	if (environment_globals == globals.size() && environment_global_classes == global_classes.size()) {
+		return environment_hash;
+	}
+
+	StringBuilder hash_build;
+	hash_build.append("[format]");
+	hash_build.append(itos(FORMAT_VERSION));
+	hash_build.append("[engine]");
+	hash_build.append(VERSION_FULL_BUILD);
+	hash_build.append(VERSION_HASH);
+#ifdef DEBUG_ENABLED
+	hash_build.append(".debug");
+#endif
+#ifdef TOOLS_ENABLED
+	hash_build.append(".tools");
+#endif
+	if (EngineDebugger::is_active()) {
+		// Functions carry extra debug information when compiled with the debugger attached.
+		hash_build.append(".debugger");
+	}
+	hash_build.append("[api]");
+	hash_build.append(itos((int64_t)ClassDB::get_api_hash(ClassDB::API_CORE)));
+	hash_build.append(itos((int64_t)ClassDB::get_api_hash(ClassDB::API_EXTENSION)));
+
+#ifdef DEBUG_ENABLED
+	// Warnings are replayed from the cache, and may turn into errors.
+	hash_build.append("[warnings]");
+	hash_build.append(String(GLOBAL_GET("debug/gdscript/warnings/enable")));
+	hash_build.append(String(GLOBAL_GET("debug/gdscript/warnings/treat_warnings_as_errors")));
+	hash_build.append(String(GLOBAL_GET("debug/gdscript/warnings/exclude_addons")));
+	for (int i = 0; i < (int)GDScriptWarning::WARNING_MAX; i++) {
+		hash_build.append(String(GLOBAL_GET(GDScriptWarning::get_settings_path_from_code((GDScriptWarning::Code)i))));
+	}
+#endif
+
+	// Bytecode refers to globals by index.
+	Vector<StringName> global_names;
+	global_names.resize(globals.size());
+	for (const KeyValue<StringName, int> &E : globals) {
+		ERR_CONTINUE(E.value < 0 || E.value >= global_names.size());
+		global_names.write[E.value] = E.key;
+	}
+	hash_build.append("[globals]");
+	for (int i = 0; i < global_names.size(); i++) {
+		hash_build.append(global_names[i]);
+		hash_build.append(",");
+	}
+
+	global_classes.sort_custom<StringName::AlphCompare>();
+	hash_build.append("[global_classes]");
+	for (const StringName &E : global_classes) {
+		hash_build.append(E);
+		hash_build.append(":");
+		hash_build.append(ScriptServer::get_global_class_path(E));
+		hash_build.append(":");
+		hash_build.append(ScriptServer::get_global_class_base(E));
+		hash_build.append(",");
+	}
+
+	environment_hash = hash_build.as_string().sha256_text();
+	environment_globals = globals.size();
+	environment_global_classes = global_classes.size();
+	return environment_hash;
+}
+
+void GDScriptBytecodeCache::_build_symbols() {
+	if (symbols_built) {
+		return;
+	}
+	symbols_built = true;
+
+	for (int i = 0; i < Variant::VARIANT_MAX; i++) {
+		Variant::Type type = Variant::Type(i);
+
+		Symbol symbol;
+		symbol.a = i;
+		if (Variant::get_member_validated_keyed_setter(type)) {
+			keyed_setter_symbols.insert(Variant::get_member_validated_keyed_setter(type), symbol);
+		}
+		if (Variant::get_member_validated_keyed_getter(type)) {
+			keyed_getter_symbols.insert(Variant::get_member_validated_keyed_getter(type), symbol);
+		}
+		if (Variant::get_member_validated_indexed_setter(type)) {
+			indexed_setter_symbols.insert(Variant::get_member_validated_indexed_setter(type), symbol);
+		}
+		if (Variant::get_member_validated_indexed_getter(type)) {
+			indexed_getter_symbols.insert(Variant::get_member_validated_indexed_getter(type), symbol);
+		}
+
+		for (int j = 0; j < Variant::get_constructor_count(type); j++) {
+			Variant::ValidatedConstructor constructor = Variant::get_validated_constructor(type, j);
+			if (constructor) {
+				Symbol constructor_symbol;
+				constructor_symbol.a = i;
+				constructor_symbol.b = j;
+				constructor_symbols.insert(constructor, constructor_symbol);
+			}
+		}
+
+		List<StringName> members;
+		Variant::get_member_list(type, &members);
+		for (const StringName &E : members) {
+			Symbol member_symbol;
+			member_symbol.a = i;
+			member_symbol.name = E;
+			if (Variant::get_member_validated_setter(type, E)) {
+				setter_symbols.insert(Variant::get_member_validated_setter(type, E), member_symbol);
+			}
+			if (Variant::get_member_validated_getter(type, E)) {
+				getter_symbols.insert(Variant::get_member_validated_getter(type, E), member_symbol);
+			}
+		}
+
+		List<StringName> methods;
+		Variant::get_builtin_method_list(type, &methods);
+		for (const StringName &E : methods) {
+			Variant::ValidatedBuiltInMethod method = Variant::get_validated_builtin_method(type, E);
+			if (method) {
+				Symbol method_symbol;
+				method_symbol.a = i;
+				method_symbol.name = E;
+				builtin_method_symbols.insert(method, method_symbol);
+			}
+		}
+
+		for (int op = 0; op < Variant::OP_MAX; op++) {
+			for (int j = 0; j < Variant::VARIANT_MAX; j++) {
+				Variant::ValidatedOperatorEvaluator evaluator = Variant::get_validated_operator_evaluator(Variant::Operator(op), type, Variant::Type(j));
+				if (evaluator) {
+					Symbol operator_symbol;
+					operator_symbol.a = op;
+					operator_symbol.b = i;
+					operator_symbol.c = j;
+					operator_symbols.insert(evaluator, operator_symbol);
+				}
+			}
+		}
+	}
+
+	List<StringName> utilities;
+	Variant::get_utility_function_list(&utilities);
+	for (const StringName &E : utilities) {
+		Symbol symbol;
+		symbol.name = E;
+		utility_symbols.insert(Variant::get_validated_utility_function(E), symbol);
+	}
+
+	List<StringName> gds_utilities;
+	GDScriptUtilityFunctions::get_function_list(&gds_utilities);
+	for (const StringName &E : gds_utilities) {
+		Symbol symbol;
+		symbol.name = E;
+		gds_utility_symbols.insert(GDScriptUtilityFunctions::get_function(E), symbol);
+	}
+}
+
+void GDScriptBytecodeCache::_update_global_objects() {
+	int size = GDScriptLanguage::get_singleton()->get_global_array_size();
+	if (size == global_objects_size) {
+		return;
+	}
+
+	global_objects.clear();
+	const Variant *global_array = GDScriptLanguage::get_singleton()->get_global_array();
+	for (const KeyValue<StringName, int> &E : GDScriptLanguage::get_singleton()->get_global_map()) {
+		Object *obj = global_array[E.value].get_validated_object();
+		if (obj) {
+			global_objects[obj->get_instance_id()] = E.key;
+		}
+	}
+	global_objects_size = size;
+}
+
+bool GDScriptBytecodeCache::_get_dependency_closure(const String &p_path, Vector<String> &r_closure) {
+	MutexLock cache_lock(GDScriptCache::singleton->lock);
+
+	HashSet<String> visited;
+	visited.insert(p_path);
+	List<String> pending;
+	pending.push_back(p_path);
+
+	while (!pending.is_empty()) {
+		String current = pending.front()->get();
+		pending.pop_front();
+
+		const HashSet<String> *depends = GDScriptCache::singleton->resolved_dependencies.getptr(current);
+		if (!depends) {
+			// Still being compiled (e.g. cyclic references), what it depends on is already known from analysis.
+			depends = GDScriptCache::singleton->dependencies.getptr(current);
+		}
+		if (!depends) {
+			return false;
+		}
+		for (const String &E : *depends) {
+			if (!visited.has(E)) {
+				visited.insert(E);
+				r_closure.push_back(E);
+				pending.push_back(E);
+			}
+		}
+	}
+	return true;
+}
+
+bool GDScriptBytecodeCache::_read_header(Ref<FileAccess> &p_file, Header &r_header) {
+	char header[5] = { 0, 0, 0, 0, 0 };
+	p_file->get_buffer((uint8_t *)header, 4);
+	if (header != String(bytecode_cache_header)) {
+		return false;
+	}
+	if (p_file->get_32() != FORMAT_VERSION) {
+		return false; // Wrong version.
+	}
+
+	r_header.environment_hash = p_file->get_pascal_string();
+	r_header.source_hash = p_file->get_pascal_string();
+
+	uint32_t count = p_file->get_32();
+	if (count > p_file->get_length()) {
+		return false;
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		r_header.dependencies.push_back(p_file->get_pascal_string());
+	}
+
+	count = p_file->get_32();
+	if (count > p_file->get_length()) {
+		return false;
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		r_header.closure.push_back(p_file->get_pascal_string());
+		r_header.closure_hashes.push_back(p_file->get_pascal_string());
+	}
+
+	return p_file->get_error() == OK;
+}
+
+bool GDScriptBytecodeCache::_check_count(Reader &r, uint32_t p_count) {
+	// Every element takes at least a byte, anything larger than the file means it's damaged.
+	if (p_count > r.file->get_length()) {
+		r.failed = true;
+	}
+	return !r.failed;
+}
+
+StringName GDScriptBytecodeCache::_read_name(Reader &r) {
+	return StringName(r.file->get_pascal_string());
+}
+
+void GDScriptBytecodeCache::_write_symbol(Writer &w, const Symbol &p_symbol) {
+	w.file->store_32(p_symbol.a);
+	w.file->store_32(p_symbol.b);
+	w.file->store_32(p_symbol.c);
+	w.file->store_pascal_string(p_symbol.name);
+}
+
+GDScriptBytecodeCache::Symbol GDScriptBytecodeCache::_read_symbol(Reader &r) {
+	Symbol symbol;
+	symbol.a = r.file->get_32();
+	symbol.b = r.file->get_32();
+	symbol.c = r.file->get_32();
+	symbol.name = _read_name(r);
+	if (symbol.a < 0 || symbol.b < 0 || symbol.c < 0) {
+		r.failed = true;
+	}
+	return symbol;
+}
+
+template <class T>
+void GDScriptBytecodeCache::_write_pointers(Writer &w, const Vector<T> &p_pointers, const RBMap<T, Symbol> &p_symbols) {
+	w.file->store_32(p_pointers.size());
+	for (int i = 0; i < p_pointers.size(); i++) {
+		const typename RBMap<T, Symbol>::Element *E = p_symbols.find(p_pointers[i]);
+		if (!E) {
+			w.failed = true;
+			return;
+		}
+		_write_symbol(w, E->value());
+	}
+}
+
+template <class T, class F>
+void GDScriptBytecodeCache::_read_pointers(Reader &r, Vector<T> &r_pointers, F p_resolve) {
+	uint32_t count = r.file->get_32();
+	if (!_check_count(r, count)) {
+		return;
+	}
+	r_pointers.resize(count);
+	for (uint32_t i = 0; i < count; i++) {
+		Symbol symbol = _read_symbol(r);
+		if (r.failed) {
+			return;
+		}
+		T pointer = p_resolve(symbol);
+		if (!pointer) {
+			r.failed = true;
+			return;
+		}
+		r_pointers.write[i] = pointer;
+	}
+}
+
+void GDScriptBytecodeCache::_write_method(Writer &w, MethodBind *p_method) {
+	// Only methods that can be found again by name, with the same signature, can be stored.
+	if (ClassDB::get_method(p_method->get_instance_class(), p_method->get_name()) != p_method) {
+		w.failed = true;
+		return;
+	}
+	w.file->store_pascal_string(p_method->get_instance_class());
+	w.file->store_pascal_string(p_method->get_name());
+	w.file->store_32(p_method->get_hint_flags());
+	w.file->store_8(p_method->has_return());
+	w.file->store_32(p_method->get_argument_count());
+	for (int i = -1; i < p_method->get_argument_count(); i++) {
+		w.file->store_32(p_method->get_argument_type(i));
+	}
+}
+
+MethodBind *GDScriptBytecodeCache::_read_method(Reader &r) {
+	StringName class_name = _read_name(r);
+	StringName name = _read_name(r);
+	uint32_t hint_flags = r.file->get_32();
+	bool has_return = r.file->get_8();
+	int argument_count = r.file->get_32();
+
+	MethodBind *method = ClassDB::get_method(class_name, name);
+	if (!method || method->get_hint_flags() != hint_flags || method->has_return() != has_return || method->get_argument_count() != argument_count) {
+		r.failed = true;
+		return nullptr;
+	}
+	for (int i = -1; i < argument_count; i++) {
+		if (method->get_argument_type(i) != (Variant::Type)r.file->get_32()) {
+			r.failed = true;
+			return nullptr;
+		}
+	}
+	return method;
+}
+
+void GDScriptBytecodeCache::_write_script_ref(Writer &w, const Script *p_script) {
+	if (!p_script) {
+		w.file->store_8(SCRIPT_NONE);
+		return;
+	}
+
+	const GDScript *gdscript = Object::cast_to<GDScript>(p_script);
+	if (gdscript) {
+		// Inner classes are found by name from the script of their file.
+		Vector<String> names;
+		const GDScript *top = gdscript;
+		while (top->_owner) {
+			names.push_back(top->name);
+			top = top->_owner;
+		}
+		names.reverse();
+
+		if (top == w.root) {
+			w.file->store_8(SCRIPT_LOCAL);
+		} else {
+			String path = top->get_path();
+			if (!path.begins_with("res://") || path.contains("::")) {
+				w.failed = true;
+				return;
+			}
+			w.file->store_8(SCRIPT_EXTERNAL);
+			w.file->store_pascal_string(path);
+		}
+		w.file->store_32(names.size());
+		for (int i = 0; i < names.size(); i++) {
+			w.file->store_pascal_string(names[i]);
+		}
+		return;
+	}
+
+	if (p_script->get_path().is_empty() || p_script->is_built_in()) {
+		w.failed = true;
+		return;
+	}
+	w.file->store_8(SCRIPT_RESOURCE);
+	w.file->store_pascal_string(p_script->get_path());
+}
+
+Ref<Script> GDScriptBytecodeCache::_read_script_ref(Reader &r, bool p_full) {
+	Ref<GDScript> script;
+
+	switch (r.file->get_8()) {
+		case SCRIPT_NONE: {
+			return Ref<Script>();
+		}
+		case SCRIPT_LOCAL: {
+			script = Ref<GDScript>(r.root);
+		} break;
+		case SCRIPT_EXTERNAL: {
+			String path = r.file->get_pascal_string();
+			if (p_full) {
+				// Same as when compiling, base classes from other files must be complete.
+				Error err = OK;
+				script = GDScriptCache::get_full_script(path, err, r.owner);
+				if (err != OK || script.is_null() || !script->is_valid()) {
+					r.failed = true;
+					return Ref<Script>();
+				}
+			} else {
+				script = GDScriptCache::get_shallow_script(path, r.owner);
+			}
+		} break;
+		case SCRIPT_RESOURCE: {
+			Ref<Script> resource = ResourceLoader::load(r.file->get_pascal_string(), "Script");
+			if (resource.is_null()) {
+				r.failed = true;
+			}
+			return resource;
+		}
+		default: {
+			r.failed = true;
+			return Ref<Script>();
+		}
+	}
+
+	uint32_t count = r.file->get_32();
+	if (!_check_count(r, count) || script.is_null()) {
+		r.failed = true;
+		return Ref<Script>();
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		// Shallow scripts from other files have no inner classes yet, compile them normally instead.
+		HashMap<StringName, Ref<GDScript>>::Iterator E = script->subclasses.find(_read_name(r));
+		if (!E) {
+			r.failed = true;
+			return Ref<Script>();
+		}
+		script = E->value;
+	}
+	return script;
+}
+
+void GDScriptBytecodeCache::_write_data_type(Writer &w, const GDScriptDataType &p_type) {
+	w.file->store_8(p_type.has_type);
+	w.file->store_8(p_type.kind);
+	w.file->store_32(p_type.builtin_type);
+	w.file->store_pascal_string(p_type.native_type);
+	_write_script_ref(w, p_type.script_type);
+	w.file->store_8(p_type.script_type_ref.is_valid());
+	w.file->store_8(p_type.has_container_element_type());
+	if (p_type.has_container_element_type()) {
+		_write_data_type(w, p_type.get_container_element_type());
+	}
+}
+
+void GDScriptBytecodeCache::_read_data_type(Reader &r, GDScriptDataType &r_type) {
+	r_type.has_type = r.file->get_8();
+	uint8_t kind = r.file->get_8();
+	uint32_t builtin_type = r.file->get_32();
+	if (kind > GDScriptDataType::GDSCRIPT || builtin_type >= Variant::VARIANT_MAX) {
+		r.failed = true;
+		return;
+	}
+	r_type.kind = GDScriptDataType::Kind(kind);
+	r_type.builtin_type = Variant::Type(builtin_type);
+	r_type.native_type = _read_name(r);
+
+	Ref<Script> script = _read_script_ref(r);
+	r_type.script_type = script.ptr();
+	if (r.file->get_8()) {
+		r_type.script_type_ref = script;
+	}
+
+	if (r.file->get_8() && !r.failed) {
+		GDScriptDataType element_type;
+		_read_data_type(r, element_type);
+		r_type.set_container_element_type(element_type);
+	}
+}
+
+void GDScriptBytecodeCache::_write_variant(Writer &w, const Variant &p_value) {
+	switch (p_value.get_type()) {
+		case Variant::OBJECT: {
+			Object *obj = p_value.get_validated_object();
+			if (!obj) {
+				w.file->store_8(VARIANT_NULL_OBJECT);
+				return;
+			}
+
+			const StringName *global = global_objects.getptr(obj->get_instance_id());
+			if (global) {
+				// Native classes and engine singletons.
+				w.file->store_8(VARIANT_GLOBAL);
+				w.file->store_pascal_string(*global);
+				return;
+			}
+
+			Script *script = Object::cast_to<Script>(obj);
+			if (script) {
+				w.file->store_8(VARIANT_SCRIPT);
+				_write_script_ref(w, script);
+				return;
+			}
+
+			Resource *resource = Object::cast_to<Resource>(obj);
+			if (resource && !resource->get_path().is_empty() && !resource->is_built_in()) {
+				w.file->store_8(VARIANT_RESOURCE);
+				w.file->store_pascal_string(resource->get_path());
+				w.file->store_pascal_string(resource->get_class());
+				return;
+			}
+
+			w.failed = true;
+		} break;
+		case Variant::ARRAY: {
+			Array array = p_value;
+			if (array.is_typed()) {
+				w.failed = true;
+				return;
+			}
+			w.file->store_8(VARIANT_ARRAY);
+			w.file->store_8(array.is_read_only());
+			w.file->store_32(array.size());
+			for (int i = 0; i < array.size(); i++) {
+				_write_variant(w, array[i]);
+			}
+		} break;
+		case Variant::DICTIONARY: {
+			Dictionary dictionary = p_value;
+			w.file->store_8(VARIANT_DICTIONARY);
+			w.file->store_8(dictionary.is_read_only());
+			w.file->store_32(dictionary.size());
+			List<Variant> keys;
+			dictionary.get_key_list(&keys);
+			for (const Variant &E : keys) {
+				_write_variant(w, E);
+				_write_variant(w, dictionary[E]);
+			}
+		} break;
+		case Variant::RID:
+		case Variant::CALLABLE:
+		case Variant::SIGNAL: {
+			w.failed = true;
+		} break;
+		default: {
+			w.file->store_8(VARIANT_VALUE);
+			w.file->store_var(p_value);
+		} break;
+	}
+}
+
+Variant GDScriptBytecodeCache::_read_variant(Reader &r) {
+	switch (r.file->get_8()) {
+		case VARIANT_VALUE: {
+			return r.file->get_var();
+		}
+		case VARIANT_NULL_OBJECT: {
+			return Variant((Object *)nullptr);
+		}
+		case VARIANT_ARRAY: {
+			bool read_only = r.file->get_8();
+			uint32_t count = r.file->get_32();
+			if (!_check_count(r, count)) {
+				return Variant();
+			}
+			Array array;
+			array.resize(count);
+			for (uint32_t i = 0; i < count && !r.failed; i++) {
+				array[i] = _read_variant(r);
+			}
+			array.set_read_only(read_only);
+			return array;
+		}
+		case VARIANT_DICTIONARY: {
+			bool read_only = r.file->get_8();
+			uint32_t count = r.file->get_32();
+			if (!_check_count(r, count)) {
+				return Variant();
+			}
+			Dictionary dictionary;
+			for (uint32_t i = 0; i < count && !r.failed; i++) {
+				Variant key = _read_variant(r);
+				dictionary[key] = _read_variant(r);
+			}
+			dictionary.set_read_only(read_only);
+			return dictionary;
+		}
+		case VARIANT_GLOBAL: {
+			StringName name = _read_name(r);
+			const int *index = GDScriptLanguage::get_singleton()->get_global_map().getptr(name);
+			if (!index || GDScriptLanguage::get_singleton()->get_global_array()[*index].get_type() != Variant::OBJECT) {
+				r.failed = true;
+				return Variant();
+			}
+			return GDScriptLanguage::get_singleton()->get_global_array()[*index];
+		}
+		case VARIANT_SCRIPT: {
+			Ref<Script> script = _read_script_ref(r);
+			if (script.is_null()) {
+				r.failed = true;
+			}
+			return script;
+		}
+		case VARIANT_RESOURCE: {
+			String path = r.file->get_pascal_string();
+			String type = r.file->get_pascal_string();
+			Ref<Resource> resource = ResourceLoader::load(path, type);
+			if (resource.is_null()) {
+				r.failed = true;
+			}
+			return resource;
+		}
+		default: {
+			r.failed = true;
+			return Variant();
+		}
+	}
+}
+
+void GDScriptBytecodeCache::_write_function(Writer &w, const GDScriptFunction *p_function) {
+	Ref<FileAccess> f = w.file;
+
+	f->store_pascal_string(p_function->name);
+	f->store_pascal_string(p_function->source);
+	f->store_8(p_function->_static);
+	_write_variant(w, p_function->rpc_config);
+	f->store_32(p_function->_initial_line);
+	f->store_32(p_function->_argument_count);
+	f->store_32(p_function->_stack_size);
+	f->store_32(p_function->_instruction_args_size);
+	f->store_32(p_function->_ptrcall_args_size);
+
+	_write_data_type(w, p_function->return_type);
+	f->store_32(p_function->argument_types.size());
+	for (int i = 0; i < p_function->argument_types.size(); i++) {
+		_write_data_type(w, p_function->argument_types[i]);
+	}
+
+	f->store_32(p_function->code.size());
+	for (int i = 0; i < p_function->code.size(); i++) {
+		f->store_32(p_function->code[i]);
+	}
+	f->store_32(p_function->default_arguments.size());
+	for (int i = 0; i < p_function->default_arguments.size(); i++) {
+		f->store_32(p_function->default_arguments[i]);
+	}
+	f->store_32(p_function->constants.size());
+	for (int i = 0; i < p_function->constants.size(); i++) {
+		_write_variant(w, p_function->constants[i]);
+	}
+	f->store_32(p_function->global_names.size());
+	for (int i = 0; i < p_function->global_names.size(); i++) {
+		f->store_pascal_string(p_function->global_names[i]);
+	}
+	if (w.failed) {
+		return;
+	}
+
+	_write_pointers(w, p_function->operator_funcs, operator_symbols);
+	_write_pointers(w, p_function->setters, setter_symbols);
+	_write_pointers(w, p_function->getters, getter_symbols);
+	_write_pointers(w, p_function->keyed_setters, keyed_setter_symbols);
+	_write_pointers(w, p_function->keyed_getters, keyed_getter_symbols);
+	_write_pointers(w, p_function->indexed_setters, indexed_setter_symbols);
+	_write_pointers(w, p_function->indexed_getters, indexed_getter_symbols);
+	_write_pointers(w, p_function->builtin_methods, builtin_method_symbols);
+	_write_pointers(w, p_function->constructors, constructor_symbols);
+	_write_pointers(w, p_function->utilities, utility_symbols);
+	_write_pointers(w, p_function->gds_utilities, gds_utility_symbols);
+	f->store_32(p_function->methods.size());
+	for (int i = 0; i < p_function->methods.size() && !w.failed; i++) {
+		_write_method(w, p_function->methods[i]);
+	}
+	f->store_32(p_function->lambdas.size());
+	for (int i = 0; i < p_function->lambdas.size() && !w.failed; i++) {
+		_write_function(w, p_function->lambdas[i]);
+	}
+	if (w.failed) {
+		return;
+	}
+
+	f->store_32(p_function->temporary_slots.size());
+	for (const KeyValue<int, Variant::Type> &E : p_function->temporary_slots) {
+		f->store_32(E.key);
+		f->store_32(E.value);
+	}
+	f->store_32(p_function->stack_debug.size());
+	for (const GDScriptFunction::StackDebug &E : p_function->stack_debug) {
+		f->store_32(E.line);
+		f->store_32(E.pos);
+		f->store_8(E.added);
+		f->store_pascal_string(E.identifier);
+	}
+	f->store_32(p_function->inline_cache ? p_function->inline_cache->get_site_count() : 0);
+
+#ifdef DEBUG_ENABLED
+	f->store_pascal_string(p_function->profile.signature);
+#endif
+#ifdef TOOLS_ENABLED
+	f->store_32(p_function->arg_names.size());
+	for (int i = 0; i < p_function->arg_names.size(); i++) {
+		f->store_pascal_string(p_function->arg_names[i]);
+	}
+	f->store_32(p_function->default_arg_values.size());
+	for (int i = 0; i < p_function->default_arg_values.size(); i++) {
+		_write_variant(w, p_function->default_arg_values[i]);
+	}
+#endif
+}
+
+bool GDScriptBytecodeCache::_validate_address(const GDScriptFunction *p_function, int p_member_count, int p_address) {
+	const int index = p_address & GDScriptFunction::ADDR_MASK;
+	switch ((p_address & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS) {
+		case GDScriptFunction::ADDR_TYPE_STACK:
+			return index < p_function->_stack_size;
+		case GDScriptFunction::ADDR_TYPE_CONSTANT:
+			return index < p_function->constants.size();
+		case GDScriptFunction::ADDR_TYPE_MEMBER:
+			return index < p_member_count;
+	}
+	return false;
+}
+
+bool GDScriptBytecodeCache::_validate_code(const GDScriptFunction *p_function, int p_member_count, int p_inline_cache_sites) {
+	// The interpreter trusts its bytecode, and release builds don't check any of it. Code that didn't come
+	// from the compiler is checked the same way GDScriptThreadedCode::_translate() checks what it runs, so
+	// that every instruction is complete and every operand, table index and jump stays in bounds.
+	const int *code = p_function->code.ptr();
+	const int code_size = p_function->code.size();
+	const int argument_count = p_function->_argument_count;
+
+	if (argument_count < 0 || argument_count != p_function->argument_types.size()) {
+		return false;
+	}
+	// Self, class and nil come first on the stack, followed by the arguments.
+	if (p_function->_stack_size < GDScriptFunction::ADDR_STACK_NIL + 1 + argument_count || p_function->_stack_size > GDScriptFunction::ADDR_MASK + 1) {
+		return false;
+	}
+	// Each instruction argument, pointer argument and inline cache site takes at least a word of code.
+	if (p_function->_instruction_args_size < 0 || p_function->_instruction_args_size > code_size) {
+		return false;
+	}
+	if (p_function->_ptrcall_args_size < 0 || p_function->_ptrcall_args_size > code_size) {
+		return false;
+	}
+	if (p_inline_cache_sites < 0 || p_inline_cache_sites > code_size) {
+		return false;
+	}
+	if (p_function->default_arguments.size() > argument_count + 1) {
+		return false;
+	}
+	for (const KeyValue<int, Variant::Type> &E : p_function->temporary_slots) {
+		if (E.key <= GDScriptFunction::ADDR_STACK_NIL || E.key >= p_function->_stack_size) {
+			return false;
+		}
+	}
+
+	LocalVector<bool> instruction_start;
+	instruction_start.resize(code_size);
+	for (int i = 0; i < code_size; i++) {
+		instruction_start[i] = false;
+	}
+	LocalVector<int> jump_targets;
+
+	int ip = 0;
+	int last_opcode = -1;
+	while (ip < code_size) {
+		const int opcode = code[ip] & GDScriptFunction::INSTR_MASK;
+		const int arg_count = (code[ip] & GDScriptFunction::INSTR_ARGS_MASK) >> GDScriptFunction::INSTR_BITS;
+		if (arg_count < 0 || arg_count > p_function->_instruction_args_size || ip + 1 + arg_count > code_size) {
+			return false;
+		}
+		for (int i = 0; i < arg_count; i++) {
+			if (!_validate_address(p_function, p_member_count, code[ip + 1 + i])) {
+				return false;
+			}
+		}
+
+		// Words stored after the operands, and how many of them the opcode uses.
+		const int *extra = code + ip + 1 + arg_count;
+		int extra_count = 0;
+
+#define CHECK_EXTRA(m_count)                            \
+	extra_count = m_count;                              \
+	if (ip + 1 + arg_count + extra_count > code_size) { \
+		return false;                                   \
+	}
+#define CHECK_LAYOUT(m_arg_count, m_extra_count) \
+	if (arg_count != (m_arg_count)) {            \
+		return false;                            \
+	}                                            \
+	CHECK_EXTRA(m_extra_count)
+#define CHECK_INDEX(m_idx, m_count)            \
+	if ((m_idx) < 0 || (m_idx) >= (m_count)) { \
+		return false;                          \
+	}
+// Variable sized instructions store how many of their operands are arguments.
+#define CHECK_ARGC(m_argc, m_args_per_argc, m_extra_operands)                                                     \
+	if ((m_argc) < 0 || (m_argc) > arg_count || (m_argc) * (m_args_per_argc) + (m_extra_operands) != arg_count) { \
+		return false;                                                                                             \
+	}
+
+		if (opcode >= GDScriptFunction::OPCODE_CALL_PTRCALL_NO_RETURN && opcode <= GDScriptFunction::OPCODE_CALL_PTRCALL_PACKED_COLOR_ARRAY) {
+			CHECK_EXTRA(2);
+			CHECK_ARGC(extra[0], 1, 2);
+			CHECK_INDEX(extra[1], p_function->methods.size());
+			if (extra[0] > p_function->_ptrcall_args_size) {
+				return false;
+			}
+		} else if (opcode >= GDScriptFunction::OPCODE_ITERATE_BEGIN && opcode <= GDScriptFunction::OPCODE_ITERATE_OBJECT) {
+			CHECK_LAYOUT(3, 1);
+			jump_targets.push_back(extra[0]);
+		} else if (opcode >= GDScriptFunction::OPCODE_TYPE_ADJUST_BOOL && opcode <= GDScriptFunction::OPCODE_TYPE_ADJUST_PACKED_COLOR_ARRAY) {
+			CHECK_LAYOUT(1, 0);
+		} else {
+			switch (opcode) {
+				case GDScriptFunction::OPCODE_OPERATOR:
+				case GDScriptFunction::OPCODE_OPERATOR_INT:
+				case GDScriptFunction::OPCODE_OPERATOR_FLOAT:
+				case GDScriptFunction::OPCODE_OPERATOR_VECTOR2:
+				case GDScriptFunction::OPCODE_OPERATOR_VECTOR3: {
+					CHECK_LAYOUT(3, 1);
+					CHECK_INDEX(extra[0], Variant::OP_MAX);
+				} break;
+				case GDScriptFunction::OPCODE_OPERATOR_VALIDATED: {
+					CHECK_LAYOUT(3, 1);
+					CHECK_INDEX(extra[0], p_function->operator_funcs.size());
+				} break;
+				case GDScriptFunction::OPCODE_EXTENDS_TEST:
+				case GDScriptFunction::OPCODE_SET_KEYED:
+				case GDScriptFunction::OPCODE_GET_KEYED:
+				case GDScriptFunction::OPCODE_ASSIGN_TYPED_NATIVE:
+				case GDScriptFunction::OPCODE_ASSIGN_TYPED_SCRIPT:
+				case GDScriptFunction::OPCODE_CAST_TO_NATIVE:
+				case GDScriptFunction::OPCODE_CAST_TO_SCRIPT: {
+					CHECK_LAYOUT(3, 0);
+				} break;
+				case GDScriptFunction::OPCODE_IS_BUILTIN:
+				case GDScriptFunction::OPCODE_ASSIGN_TYPED_BUILTIN:
+				case GDScriptFunction::OPCODE_CAST_TO_BUILTIN: {
+					CHECK_LAYOUT(2, 1);
+					CHECK_INDEX(extra[0], Variant::VARIANT_MAX);
+				} break;
+				case GDScriptFunction::OPCODE_SET_KEYED_VALIDATED: {
+					CHECK_LAYOUT(3, 1);
+					CHECK_INDEX(extra[0], p_function->keyed_setters.size());
+				} break;
+				case GDScriptFunction::OPCODE_SET_INDEXED_VALIDATED: {
+					CHECK_LAYOUT(3, 1);
+					CHECK_INDEX(extra[0], p_function->indexed_setters.size());
+				} break;
+				case GDScriptFunction::OPCODE_GET_KEYED_VALIDATED: {
+					CHECK_LAYOUT(3, 1);
+					CHECK_INDEX(extra[0], p_function->keyed_getters.size());
+				} break;
+				case GDScriptFunction::OPCODE_GET_INDEXED_VALIDATED: {
+					CHECK_LAYOUT(3, 1);
+					CHECK_INDEX(extra[0], p_function->indexed_getters.size());
+				} break;
+				case GDScriptFunction::OPCODE_SET_NAMED:
+				case GDScriptFunction::OPCODE_GET_NAMED: {
+					CHECK_LAYOUT(2, 2);
+					CHECK_INDEX(extra[0], p_function->global_names.size());
+					CHECK_INDEX(extra[1], p_inline_cache_sites);
+				} break;
+				case GDScriptFunction::OPCODE_SET_NAMED_VALIDATED: {
+					CHECK_LAYOUT(2, 1);
+					CHECK_INDEX(extra[0], p_function->setters.size());
+				} break;
+				case GDScriptFunction::OPCODE_GET_NAMED_VALIDATED: {
+					CHECK_LAYOUT(2, 1);
+					CHECK_INDEX(extra[0], p_function->getters.size());
+				} break;
+				case GDScriptFunction::OPCODE_SET_MEMBER:
+				case GDScriptFunction::OPCODE_GET_MEMBER:
+				case GDScriptFunction::OPCODE_STORE_NAMED_GLOBAL: {
+					CHECK_LAYOUT(1, 1);
+					CHECK_INDEX(extra[0], p_function->global_names.size());
+				} break;
+				case GDScriptFunction::OPCODE_STORE_GLOBAL: {
+					CHECK_LAYOUT(1, 1);
+					CHECK_INDEX(extra[0], GDScriptLanguage::get_singleton()->get_global_array_size());
+				} break;
+				case GDScriptFunction::OPCODE_ASSIGN:
+				case GDScriptFunction::OPCODE_ASSIGN_TYPED_ARRAY:
+				case GDScriptFunction::OPCODE_ASSERT:
+				case GDScriptFunction::OPCODE_RETURN_TYPED_NATIVE:
+				case GDScriptFunction::OPCODE_RETURN_TYPED_SCRIPT: {
+					CHECK_LAYOUT(2, 0);
+				} break;
+				case GDScriptFunction::OPCODE_ASSIGN_TRUE:
+				case GDScriptFunction::OPCODE_ASSIGN_FALSE:
+				case GDScriptFunction::OPCODE_RETURN:
+				case GDScriptFunction::OPCODE_AWAIT_RESUME: {
+					CHECK_LAYOUT(1, 0);
+				} break;
+				case GDScriptFunction::OPCODE_CONSTRUCT: {
+					CHECK_EXTRA(2);
+					CHECK_ARGC(extra[0], 1, 1);
+					CHECK_INDEX(extra[1], Variant::VARIANT_MAX);
+				} break;
+				case GDScriptFunction::OPCODE_CONSTRUCT_VALIDATED: {
+					CHECK_EXTRA(2);
+					CHECK_ARGC(extra[0], 1, 1);
+					CHECK_INDEX(extra[1], p_function->constructors.size());
+				} break;
+				case GDScriptFunction::OPCODE_CONSTRUCT_ARRAY:
+				case GDScriptFunction::OPCODE_CONSTRUCT_ARRAY_REUSE: {
+					CHECK_EXTRA(1);
+					CHECK_ARGC(extra[0], 1, 1);
+				} break;
+				case GDScriptFunction::OPCODE_CONSTRUCT_TYPED_ARRAY: {
+					CHECK_EXTRA(3);
+					CHECK_ARGC(extra[0], 1, 2);
+					CHECK_INDEX(extra[1], Variant::VARIANT_MAX);
+					CHECK_INDEX(extra[2], p_function->global_names.size());
+				} break;
+				case GDScriptFunction::OPCODE_CONSTRUCT_DICTIONARY:
+				case GDScriptFunction::OPCODE_CONSTRUCT_DICTIONARY_REUSE: {
+					CHECK_EXTRA(1);
+					CHECK_ARGC(extra[0], 2, 1);
+				} break;
+				case GDScriptFunction::OPCODE_CALL:
+				case GDScriptFunction::OPCODE_CALL_RETURN:
+				case GDScriptFunction::OPCODE_CALL_ASYNC: {
+					CHECK_EXTRA(3);
+					CHECK_ARGC(extra[0], 1, 2);
+					CHECK_INDEX(extra[1], p_function->global_names.size());
+					CHECK_INDEX(extra[2], p_inline_cache_sites);
+				} break;
+				case GDScriptFunction::OPCODE_CALL_UTILITY:
+				case GDScriptFunction::OPCODE_CALL_SELF_BASE: {
+					CHECK_EXTRA(2);
+					CHECK_ARGC(extra[0], 1, 1);
+					CHECK_INDEX(extra[1], p_function->global_names.size());
+				} break;
+				case GDScriptFunction::OPCODE_CALL_UTILITY_VALIDATED: {
+					CHECK_EXTRA(2);
+					CHECK_ARGC(extra[0], 1, 1);
+					CHECK_INDEX(extra[1], p_function->utilities.size());
+				} break;
+				case GDScriptFunction::OPCODE_CALL_GDSCRIPT_UTILITY: {
+					CHECK_EXTRA(2);
+					CHECK_ARGC(extra[0], 1, 1);
+					CHECK_INDEX(extra[1], p_function->gds_utilities.size());
+				} break;
+				case GDScriptFunction::OPCODE_CALL_BUILTIN_TYPE_VALIDATED: {
+					CHECK_EXTRA(2);
+					CHECK_ARGC(extra[0], 1, 2);
+					CHECK_INDEX(extra[1], p_function->builtin_methods.size());
+				} break;
+				case GDScriptFunction::OPCODE_CALL_METHOD_BIND:
+				case GDScriptFunction::OPCODE_CALL_METHOD_BIND_RET: {
+					CHECK_EXTRA(2);
+					CHECK_ARGC(extra[0], 1, 2);
+					CHECK_INDEX(extra[1], p_function->methods.size());
+				} break;
+				case GDScriptFunction::OPCODE_CALL_BUILTIN_STATIC: {
+					CHECK_EXTRA(3);
+					CHECK_INDEX(extra[0], Variant::VARIANT_MAX);
+					CHECK_INDEX(extra[1], p_function->global_names.size());
+					CHECK_ARGC(extra[2], 1, 1);
+				} break;
+				case GDScriptFunction::OPCODE_CALL_NATIVE_STATIC: {
+					CHECK_EXTRA(2);
+					CHECK_INDEX(extra[0], p_function->methods.size());
+					CHECK_ARGC(extra[1], 1, 1);
+				} break;
+				case GDScriptFunction::OPCODE_CREATE_LAMBDA:
+				case GDScriptFunction::OPCODE_CREATE_SELF_LAMBDA: {
+					CHECK_EXTRA(2);
+					CHECK_ARGC(extra[0], 1, 1);
+					CHECK_INDEX(extra[1], p_function->lambdas.size());
+				} break;
+				case GDScriptFunction::OPCODE_AWAIT: {
+					CHECK_LAYOUT(1, 0);
+					// Reads the target of the resume that always follows it.
+					if (ip + 2 >= code_size || (code[ip + 2] & GDScriptFunction::INSTR_MASK) != GDScriptFunction::OPCODE_AWAIT_RESUME) {
+						return false;
+					}
+				} break;
+				case GDScriptFunction::OPCODE_JUMP: {
+					CHECK_LAYOUT(0, 1);
+					jump_targets.push_back(extra[0]);
+				} break;
+				case GDScriptFunction::OPCODE_JUMP_IF:
+				case GDScriptFunction::OPCODE_JUMP_IF_NOT:
+				case GDScriptFunction::OPCODE_JUMP_IF_SHARED: {
+					CHECK_LAYOUT(1, 1);
+					jump_targets.push_back(extra[0]);
+				} break;
+				case GDScriptFunction::OPCODE_JUMP_TO_DEF_ARGUMENT: {
+					CHECK_LAYOUT(0, 0);
+					if (p_function->default_arguments.is_empty()) {
+						return false;
+					}
+				} break;
+				case GDScriptFunction::OPCODE_BREAKPOINT:
+				case GDScriptFunction::OPCODE_END: {
+					CHECK_LAYOUT(0, 0);
+				} break;
+				case GDScriptFunction::OPCODE_RETURN_TYPED_BUILTIN: {
+					CHECK_LAYOUT(1, 1);
+					CHECK_INDEX(extra[0], Variant::VARIANT_MAX);
+				} break;
+				case GDScriptFunction::OPCODE_RETURN_TYPED_ARRAY: {
+					CHECK_LAYOUT(2, 2);
+					CHECK_INDEX(extra[0], Variant::VARIANT_MAX);
+					CHECK_INDEX(extra[1], p_function->global_names.size());
+				} break;
+				case GDScriptFunction::OPCODE_LINE: {
+					CHECK_LAYOUT(0, 1);
+				} break;
+				default: {
+					return false;
+				}
+			}
+		}
+
+#undef CHECK_ARGC
+#undef CHECK_INDEX
+#undef CHECK_LAYOUT
+#undef CHECK_EXTRA
+
+		instruction_start[ip] = true;
+		last_opcode = opcode;
+		ip += 1 + arg_count + extra_count;
+	}
+
+	// Execution never runs past the end, and only lands on the start of an instruction.
+	if (last_opcode != GDScriptFunction::OPCODE_END) {
+		return false;
+	}
+	for (uint32_t i = 0; i < jump_targets.size(); i++) {
+		if (jump_targets[i] < 0 || jump_targets[i] >= code_size || !instruction_start[jump_targets[i]]) {
+			return false;
+		}
+	}
+	for (int i = 0; i < p_function->default_arguments.size(); i++) {
+		const int address = p_function->default_arguments[i];
+		if (address < 0 || address >= code_size || !instruction_start[address]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+GDScriptFunction *GDScriptBytecodeCache::_read_function(Reader &r, GDScript *p_script) {
+	Ref<FileAccess> f = r.file;
+	GDScriptFunction *function = memnew(GDScriptFunction);
+
+	function->name = _read_name(r);
+	function->_script = p_script;
+	function->source = _read_name(r);
+#ifdef DEBUG_ENABLED
+	function->func_cname = (String(function->source) + " - " + String(function->name)).utf8();
+	function->_func_cname = function->func_cname.get_data();
+#endif
+	function->_static = f->get_8();
+	function->rpc_config = _read_variant(r);
+	function->_initial_line = f->get_32();
+	function->_argument_count = f->get_32();
+	function->_stack_size = f->get_32();
+	function->_instruction_args_size = f->get_32();
+	function->_ptrcall_args_size = f->get_32();
+
+	_read_data_type(r, function->return_type);
+	uint32_t count = f->get_32();
+	if (_check_count(r, count)) {
+		function->argument_types.resize(count);
+		for (uint32_t i = 0; i < count && !r.failed; i++) {
+			_read_data_type(r, function->argument_types.write[i]);
+		}
+	}
+
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		function->code.resize(count);
+		int *code = function->code.ptrw();
+		for (uint32_t i = 0; i < count; i++) {
+			code[i] = f->get_32();
+		}
+	}
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		function->default_arguments.resize(count);
+		for (uint32_t i = 0; i < count; i++) {
+			function->default_arguments.write[i] = f->get_32();
+		}
+	}
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		function->constants.resize(count);
+		for (uint32_t i = 0; i < count && !r.failed; i++) {
+			function->constants.write[i] = _read_variant(r);
+		}
+	}
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		function->global_names.resize(count);
+		for (uint32_t i = 0; i < count; i++) {
+			function->global_names.write[i] = _read_name(r);
+		}
+	}
+	if (r.failed) {
+		memdelete(function);
+		return nullptr;
+	}
+
+	_read_pointers(r, function->operator_funcs, [](const Symbol &p_symbol) -> Variant::ValidatedOperatorEvaluator {
+		if (p_symbol.a >= Variant::OP_MAX || p_symbol.b >= Variant::VARIANT_MAX || p_symbol.c >= Variant::VARIANT_MAX) {
+			return nullptr;
+		}
+		return Variant::get_validated_operator_evaluator(Variant::Operator(p_symbol.a), Variant::Type(p_symbol.b), Variant::Type(p_symbol.c));
+	});
+	_read_pointers(r, function->setters, [](const Symbol &p_symbol) -> Variant::ValidatedSetter {
+		return p_symbol.a < Variant::VARIANT_MAX ? Variant::get_member_validated_setter(Variant::Type(p_symbol.a), p_symbol.name) : nullptr;
+	});
+	_read_pointers(r, function->getters, [](const Symbol &p_symbol) -> Variant::ValidatedGetter {
+		return p_symbol.a < Variant::VARIANT_MAX ? Variant::get_member_validated_getter(Variant::Type(p_symbol.a), p_symbol.name) : nullptr;
+	});
+	_read_pointers(r, function->keyed_setters, [](const Symbol &p_symbol) -> Variant::ValidatedKeyedSetter {
+		return p_symbol.a < Variant::VARIANT_MAX ? Variant::get_member_validated_keyed_setter(Variant::Type(p_symbol.a)) : nullptr;
+	});
+	_read_pointers(r, function->keyed_getters, [](const Symbol &p_symbol) -> Variant::ValidatedKeyedGetter {
+		return p_symbol.a < Variant::VARIANT_MAX ? Variant::get_member_validated_keyed_getter(Variant::Type(p_symbol.a)) : nullptr;
+	});
+	_read_pointers(r, function->indexed_setters, [](const Symbol &p_symbol) -> Variant::ValidatedIndexedSetter {
+		return p_symbol.a < Variant::VARIANT_MAX ? Variant::get_member_validated_indexed_setter(Variant::Type(p_symbol.a)) : nullptr;
+	});
+	_read_pointers(r, function->indexed_getters, [](const Symbol &p_symbol) -> Variant::ValidatedIndexedGetter {
+		return p_symbol.a < Variant::VARIANT_MAX ? Variant::get_member_validated_indexed_getter(Variant::Type(p_symbol.a)) : nullptr;
+	});
+	_read_pointers(r, function->builtin_methods, [](const Symbol &p_symbol) -> Variant::ValidatedBuiltInMethod {
+		return p_symbol.a < Variant::VARIANT_MAX ? Variant::get_validated_builtin_method(Variant::Type(p_symbol.a), p_symbol.name) : nullptr;
+	});
+	_read_pointers(r, function->constructors, [](const Symbol &p_symbol) -> Variant::ValidatedConstructor {
+		if (p_symbol.a >= Variant::VARIANT_MAX || p_symbol.b >= Variant::get_constructor_count(Variant::Type(p_symbol.a))) {
+			return nullptr;
+		}
+		return Variant::get_validated_constructor(Variant::Type(p_symbol.a), p_symbol.b);
+	});
+	_read_pointers(r, function->utilities, [](const Symbol &p_symbol) -> Variant::ValidatedUtilityFunction {
+		return Variant::get_validated_utility_function(p_symbol.name);
+	});
+	_read_pointers(r, function->gds_utilities, [](const Symbol &p_symbol) -> GDScriptUtilityFunctions::FunctionPtr {
+		return GDScriptUtilityFunctions::get_function(p_symbol.name);
+	});
+
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		function->methods.resize(count);
+		for (uint32_t i = 0; i < count && !r.failed; i++) {
+			function->methods.write[i] = _read_method(r);
+		}
+	}
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		for (uint32_t i = 0; i < count && !r.failed; i++) {
+			GDScriptFunction *lambda = _read_function(r, p_script);
+			if (lambda) {
+				// Owned by the function from here on, so it's freed with it.
+				function->lambdas.push_back(lambda);
+			}
+		}
+	}
+
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		for (uint32_t i = 0; i < count; i++) {
+			int slot = f->get_32();
+			uint32_t type = f->get_32();
+			if (type >= Variant::VARIANT_MAX) {
+				r.failed = true;
+				break;
+			}
+			function->temporary_slots[slot] = Variant::Type(type);
+		}
+	}
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		for (uint32_t i = 0; i < count; i++) {
+			GDScriptFunction::StackDebug stack_debug;
+			stack_debug.line = f->get_32();
+			stack_debug.pos = f->get_32();
+			stack_debug.added = f->get_8();
+			stack_debug.identifier = _read_name(r);
+			function->stack_debug.push_back(stack_debug);
+		}
+	}
+	int inline_cache_sites = f->get_32();
+
+#ifdef DEBUG_ENABLED
+	function->profile.signature = _read_name(r);
+#endif
+#ifdef TOOLS_ENABLED
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		function->arg_names.resize(count);
+		for (uint32_t i = 0; i < count; i++) {
+			function->arg_names.write[i] = _read_name(r);
+		}
+	}
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		function->default_arg_values.resize(count);
+		for (uint32_t i = 0; i < count && !r.failed; i++) {
+			function->default_arg_values.write[i] = _read_variant(r);
+		}
+	}
+#endif
+
+	if (r.failed || f->get_error() != OK || !_validate_code(function, p_script->member_indices.size(), inline_cache_sites)) {
+		r.failed = true;
+		memdelete(function);
+		return nullptr;
+	}
+
+	// Same as GDScriptByteCodeGenerator::write_end().
+	function->_constant_count = function->constants.size();
+	function->_constants_ptr = function->_constant_count ? function->constants.ptrw() : nullptr;
+	function->_global_names_count = function->global_names.size();
+	function->_global_names_ptr = function->_global_names_count ? function->global_names.ptr() : nullptr;
+	function->_code_size = function->code.size();
+	function->_code_ptr = function->_code_size ? function->code.ptr() : nullptr;
+	function->_default_arg_count = function->default_arguments.size() ? function->default_arguments.size() - 1 : 0;
+	function->_default_arg_ptr = function->default_arguments.size() ? function->default_arguments.ptr() : nullptr;
+	function->_operator_funcs_count = function->operator_funcs.size();
+	function->_operator_funcs_ptr = function->_operator_funcs_count ? function->operator_funcs.ptr() : nullptr;
+	function->_setters_count = function->setters.size();
+	function->_setters_ptr = function->_setters_count ? function->setters.ptr() : nullptr;
+	function->_getters_count = function->getters.size();
+	function->_getters_ptr = function->_getters_count ? function->getters.ptr() : nullptr;
+	function->_keyed_setters_count = function->keyed_setters.size();
+	function->_keyed_setters_ptr = function->_keyed_setters_count ? function->keyed_setters.ptr() : nullptr;
+	function->_keyed_getters_count = function->keyed_getters.size();
+	function->_keyed_getters_ptr = function->_keyed_getters_count ? function->keyed_getters.ptr() : nullptr;
+	function->_indexed_setters_count = function->indexed_setters.size();
+	function->_indexed_setters_ptr = function->_indexed_setters_count ? function->indexed_setters.ptr() : nullptr;
+	function->_indexed_getters_count = function->indexed_getters.size();
+	function->_indexed_getters_ptr = function->_indexed_getters_count ? function->indexed_getters.ptr() : nullptr;
+	function->_builtin_methods_count = function->builtin_methods.size();
+	function->_builtin_methods_ptr = function->_builtin_methods_count ? function->builtin_methods.ptr() : nullptr;
+	function->_constructors_count = function->constructors.size();
+	function->_constructors_ptr = function->_constructors_count ? function->constructors.ptr() : nullptr;
+	function->_utilities_count = function->utilities.size();
+	function->_utilities_ptr = function->_utilities_count ? function->utilities.ptr() : nullptr;
+	function->_gds_utilities_count = function->gds_utilities.size();
+	function->_gds_utilities_ptr = function->_gds_utilities_count ? function->gds_utilities.ptr() : nullptr;
+	function->_methods_count = function->methods.size();
+	function->_methods_ptr = function->_methods_count ? function->methods.ptrw() : nullptr;
+	function->_lambdas_count = function->lambdas.size();
+	function->_lambdas_ptr = function->_lambdas_count ? function->lambdas.ptrw() : nullptr;
+
+	if (inline_cache_sites > 0) {
+		function->inline_cache = memnew(GDScriptInlineCache(inline_cache_sites));
+	}
+	function->threaded_code = GDScriptThreadedCode::create(function);
+
+	return function;
+}
+
+void GDScriptBytecodeCache::_write_tree(Writer &w, const GDScript *p_script) {
+	w.file->store_32(p_script->subclasses.size());
+	for (const KeyValue<StringName, Ref<GDScript>> &E : p_script->subclasses) {
+		w.file->store_pascal_string(E.key);
+		_write_tree(w, E.value.ptr());
+	}
+}
+
+void GDScriptBytecodeCache::_read_tree(Reader &r, GDScript *p_script) {
+	// Same as GDScriptCompiler::_make_scripts().
+	p_script->subclasses.clear();
+
+	uint32_t count = r.file->get_32();
+	if (!_check_count(r, count)) {
+		return;
+	}
+	for (uint32_t i = 0; i < count && !r.failed; i++) {
+		StringName name = _read_name(r);
+		String fully_qualified_name = p_script->fully_qualified_name + "::" + name;
+
+		Ref<GDScript> subclass = GDScriptLanguage::get_singleton()->get_orphan_subclass(fully_qualified_name);
+		if (subclass.is_null()) {
+			subclass.instantiate();
+		}
+		subclass->_owner = p_script;
+		subclass->fully_qualified_name = fully_qualified_name;
+		p_script->subclasses.insert(name, subclass);
+
+		_read_tree(r, subclass.ptr());
+	}
+}
+
+void GDScriptBytecodeCache::_write_class(Writer &w, const GDScript *p_script) {
+	Ref<FileAccess> f = w.file;
+
+	f->store_8(p_script->tool);
+	f->store_pascal_string(p_script->name);
+	f->store_pascal_string(p_script->native.is_valid() ? String(p_script->native->get_name()) : String());
+	_write_script_ref(w, p_script->base.ptr());
+
+	f->store_32(p_script->members.size());
+	for (const StringName &E : p_script->members) {
+		f->store_pascal_string(E);
+	}
+	f->store_32(p_script->member_indices.size());
+	for (const KeyValue<StringName, GDScript::MemberInfo> &E : p_script->member_indices) {
+		f->store_pascal_string(E.key);
+		f->store_32(E.value.index);
+		f->store_pascal_string(E.value.setter);
+		f->store_pascal_string(E.value.getter);
+		_write_data_type(w, E.value.data_type);
+	}
+	f->store_32(p_script->member_info.size());
+	for (const KeyValue<StringName, PropertyInfo> &E : p_script->member_info) {
+		f->store_pascal_string(E.key);
+		f->store_32(E.value.type);
+		f->store_pascal_string(E.value.name);
+		f->store_pascal_string(E.value.class_name);
+		f->store_32(E.value.hint);
+		f->store_pascal_string(E.value.hint_string);
+		f->store_32(E.value.usage);
+	}
+	f->store_32(p_script->constants.size());
+	for (const KeyValue<StringName, Variant> &E : p_script->constants) {
+		f->store_pascal_string(E.key);
+		_write_variant(w, E.value);
+	}
+	f->store_32(p_script->_signals.size());
+	for (const KeyValue<StringName, Vector<StringName>> &E : p_script->_signals) {
+		f->store_pascal_string(E.key);
+		f->store_32(E.value.size());
+		for (int i = 0; i < E.value.size(); i++) {
+			f->store_pascal_string(E.value[i]);
+		}
+	}
+	if (w.failed) {
+		return;
+	}
+
+	f->store_32(p_script->member_functions.size());
+	for (const KeyValue<StringName, GDScriptFunction *> &E : p_script->member_functions) {
+		f->store_pascal_string(E.key);
+		_write_function(w, E.value);
+	}
+	f->store_8(p_script->implicit_initializer != nullptr);
+	if (p_script->implicit_initializer) {
+		_write_function(w, p_script->implicit_initializer);
+	}
+	f->store_8(p_script->implicit_ready != nullptr);
+	if (p_script->implicit_ready) {
+		_write_function(w, p_script->implicit_ready);
+	}
+
+#ifdef TOOLS_ENABLED
+	f->store_32(p_script->member_lines.size());
+	for (const KeyValue<StringName, int> &E : p_script->member_lines) {
+		f->store_pascal_string(E.key);
+		f->store_32(E.value);
+	}
+	f->store_32(p_script->member_default_values.size());
+	for (const KeyValue<StringName, Variant> &E : p_script->member_default_values) {
+		f->store_pascal_string(E.key);
+		_write_variant(w, E.value);
+	}
+#endif
+
+	for (const KeyValue<StringName, Ref<GDScript>> &E : p_script->subclasses) {
+		if (w.failed) {
+			return;
+		}
+		_write_class(w, E.value.ptr());
+	}
+}
+
+void GDScriptBytecodeCache::_read_class(Reader &r, GDScript *p_script) {
+	Ref<FileAccess> f = r.file;
+	_clear_class(p_script);
+
+	p_script->tool = f->get_8();
+	p_script->name = f->get_pascal_string();
+
+	String native_name = f->get_pascal_string();
+	if (!native_name.is_empty()) {
+		const int *native_index = GDScriptLanguage::get_singleton()->get_global_map().getptr(native_name);
+		if (native_index) {
+			p_script->native = GDScriptLanguage::get_singleton()->get_global_array()[*native_index];
+		}
+		if (p_script->native.is_null()) {
+			r.failed = true;
+			return;
+		}
+	}
+	Ref<GDScript> base = _read_script_ref(r, true);
+	p_script->base = base;
+	p_script->_base = base.ptr();
+
+	uint32_t count = f->get_32();
+	if (_check_count(r, count)) {
+		for (uint32_t i = 0; i < count; i++) {
+			p_script->members.insert(_read_name(r));
+		}
+	}
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		for (uint32_t i = 0; i < count && !r.failed; i++) {
+			StringName name = _read_name(r);
+			GDScript::MemberInfo minfo;
+			minfo.index = f->get_32();
+			minfo.setter = _read_name(r);
+			minfo.getter = _read_name(r);
+			_read_data_type(r, minfo.data_type);
+			p_script->member_indices[name] = minfo;
+		}
+		// Instances have exactly one slot per member, and bytecode is checked against that.
+		for (const KeyValue<StringName, GDScript::MemberInfo> &E : p_script->member_indices) {
+			if (E.value.index < 0 || E.value.index >= p_script->member_indices.size()) {
+				r.failed = true;
+			}
+		}
+	}
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		for (uint32_t i = 0; i < count; i++) {
+			StringName name = _read_name(r);
+			PropertyInfo prop_info;
+			prop_info.type = Variant::Type(f->get_32());
+			prop_info.name = f->get_pascal_string();
+			prop_info.class_name = _read_name(r);
+			prop_info.hint = PropertyHint(f->get_32());
+			prop_info.hint_string = f->get_pascal_string();
+			prop_info.usage = f->get_32();
+			if (prop_info.type >= Variant::VARIANT_MAX) {
+				r.failed = true;
+				break;
+			}
+			p_script->member_info[name] = prop_info;
+		}
+	}
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		for (uint32_t i = 0; i < count && !r.failed; i++) {
+			StringName name = _read_name(r);
+			p_script->constants.insert(name, _read_variant(r));
+		}
+	}
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		for (uint32_t i = 0; i < count && !r.failed; i++) {
+			StringName name = _read_name(r);
+			uint32_t parameter_count = f->get_32();
+			if (!_check_count(r, parameter_count)) {
+				break;
+			}
+			Vector<StringName> parameter_names;
+			parameter_names.resize(parameter_count);
+			for (uint32_t j = 0; j < parameter_count; j++) {
+				parameter_names.write[j] = _read_name(r);
+			}
+			p_script->_signals[name] = parameter_names;
+		}
+	}
+	if (r.failed) {
+		return;
+	}
+
+	// Functions are owned by the script as soon as they are read, so they are freed with it if something fails later.
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		for (uint32_t i = 0; i < count && !r.failed; i++) {
+			StringName name = _read_name(r);
+			GDScriptFunction *function = _read_function(r, p_script);
+			if (function) {
+				p_script->member_functions[name] = function;
+			}
+		}
+	}
+	if (!r.failed && f->get_8()) {
+		p_script->implicit_initializer = _read_function(r, p_script);
+	}
+	if (!r.failed && f->get_8()) {
+		p_script->implicit_ready = _read_function(r, p_script);
+	}
+	if (r.failed) {
+		return;
+	}
+	HashMap<StringName, GDScriptFunction *>::Iterator initializer = p_script->member_functions.find(GDScriptLanguage::get_singleton()->strings._init);
+	p_script->initializer = initializer ? initializer->value : nullptr;
+
+#ifdef TOOLS_ENABLED
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		for (uint32_t i = 0; i < count; i++) {
+			StringName name = _read_name(r);
+			p_script->member_lines[name] = f->get_32();
+		}
+	}
+	count = f->get_32();
+	if (_check_count(r, count)) {
+		for (uint32_t i = 0; i < count && !r.failed; i++) {
+			StringName name = _read_name(r);
+			p_script->member_default_values[name] = _read_variant(r);
+		}
+	}
+#endif
+
+	for (KeyValue<StringName, Ref<GDScript>> &E : p_script->subclasses) {
+		if (r.failed) {
+			return;
+		}
+		_read_class(r, E.value.ptr());
+	}
+
+	p_script->valid = !r.failed;
+}
+
+void GDScriptBytecodeCache::_clear_class(GDScript *p_script) {
+	// Same as GDScriptCompiler::_parse_class_level().
+	GDScriptInlineCache::invalidate(p_script);
+
+	p_script->native = Ref<GDScriptNativeClass>();
+	p_script->base = Ref<GDScript>();
+	p_script->_base = nullptr;
+	p_script->members.clear();
+	p_script->constants.clear();
+	for (const KeyValue<StringName, GDScriptFunction *> &E : p_script->member_functions) {
+		memdelete(E.value);
+	}
+	if (p_script->implicit_initializer) {
+		memdelete(p_script->implicit_initializer);
+	}
+	if (p_script->implicit_ready) {
+		memdelete(p_script->implicit_ready);
+	}
+	p_script->member_functions.clear();
+	p_script->member_indices.clear();
+	p_script->member_info.clear();
+	p_script->_signals.clear();
+	p_script->initializer = nullptr;
+	p_script->implicit_initializer = nullptr;
+	p_script->implicit_ready = nullptr;
+#ifdef TOOLS_ENABLED
+	p_script->member_lines.clear();
+	p_script->member_default_values.clear();
+#endif
+}
+
+bool GDScriptBytecodeCache::is_cacheable(const GDScript *p_script) {
+	if (!singleton) {
+		return false;
+	}
+	String path = p_script->get_path();
+	if (!path.begins_with("res://") || p_script->is_built_in()) {
+		return false;
+	}
+
+	MutexLock lock(singleton->lock);
+	singleton->_initialize();
+	return !singleton->cache_dir.is_empty();
+}
+
+bool GDScriptBytecodeCache::load(GDScript *p_script) {
+	if (!is_cacheable(p_script)) {
+		return false;
+	}
+	String path = p_script->get_path();
+
+	Ref<FileAccess> f = FileAccess::open(singleton->_get_cache_path(path), FileAccess::READ);
+	if (f.is_null()) {
+		return false;
+	}
+	Header header;
+	if (!_read_header(f, header)) {
+		return false;
+	}
+
+	{
+		MutexLock lock(singleton->lock);
+		if (header.environment_hash != singleton->_get_environment_hash() || header.source_hash != p_script->source.sha256_text()) {
+			return false;
+		}
+		for (int i = 0; i < header.closure.size(); i++) {
+			if (singleton->_get_source_hash(header.closure[i]) != header.closure_hashes[i]) {
+				return false;
+			}
+		}
+	}
+
+	Vector<Warning> warnings;
+	uint32_t warning_count = f->get_32();
+	if (warning_count > f->get_length()) {
+		return false;
+	}
+	warnings.resize(warning_count);
+	for (uint32_t i = 0; i < warning_count; i++) {
+		Warning &warning = warnings.write[i];
+		warning.line = f->get_32();
+		warning.name = f->get_pascal_string();
+		warning.message = f->get_pascal_string();
+	}
+
+	// Not holding our lock from here on, other scripts may be loaded while decoding.
+	Reader r;
+	r.file = f;
+	r.root = p_script;
+	r.owner = path;
+
+	p_script->fully_qualified_name = p_script->path;
+	p_script->_owner = nullptr;
+	_read_tree(r, p_script);
+	if (!r.failed) {
+		_read_class(r, p_script);
+	}
+	if (!r.failed) {
+		char footer[5] = { 0, 0, 0, 0, 0 };
+		f->get_buffer((uint8_t *)footer, 4);
+		r.failed = footer != String(bytecode_cache_header) || f->get_error() != OK || f->get_position() != f->get_length();
+	}
+	if (r.failed) {
+		// Leave it to the compiler, which rebuilds everything from scratch.
+		p_script->valid = false;
+		return false;
+	}
+
+	if (GDScriptCache::finish_compiling(path) != OK) {
+		p_script->valid = false;
+		return false;
+	}
+	{
+		// Only what was referenced at runtime got loaded, but anything seen by the analyzer counts for the dependents.
+		MutexLock cache_lock(GDScriptCache::singleton->lock);
+		HashSet<String> &depends = GDScriptCache::singleton->resolved_dependencies[path];
+		depends.clear();
+		for (int i = 0; i < header.dependencies.size(); i++) {
+			depends.insert(header.dependencies[i]);
+		}
+	}
+
+#ifdef DEBUG_ENABLED
+	if (EngineDebugger::is_active()) {
+		for (const Warning &warning : warnings) {
+			Vector<ScriptLanguage::StackInfo> si;
+			EngineDebugger::get_script_debugger()->send_error("", path, warning.line, warning.name, warning.message, false, ERR_HANDLER_WARNING, si);
+		}
+	}
+#endif
+
+	return true;
+}
+
+void GDScriptBytecodeCache::save(const GDScript *p_script, const GDScriptParser &p_parser) {
+	if (!is_cacheable(p_script)) {
+		return;
+	}
+	String path = p_script->get_path();
+
+	Vector<String> dependencies;
+	{
+		MutexLock cache_lock(GDScriptCache::singleton->lock);
+		const HashSet<String> *depends = GDScriptCache::singleton->resolved_dependencies.getptr(path);
+		if (!depends) {
+			return;
+		}
+		for (const String &E : *depends) {
+			if (E != path) {
+				dependencies.push_back(E);
+			}
+		}
+	}
+	Vector<String> closure;
+	if (!singleton->_get_dependency_closure(path, closure)) {
+		return;
+	}
+
+	MutexLock lock(singleton->lock);
+	singleton->_build_symbols();
+	singleton->_update_global_objects();
+
+	// Written aside and moved in place once complete, so a partial file is never picked up.
+	String cache_path = singleton->_get_cache_path(path);
+	String temp_path = cache_path + ".tmp";
+	Ref<FileAccess> f = FileAccess::open(temp_path, FileAccess::WRITE);
+	if (f.is_null()) {
+		return;
+	}
+
+	f->store_buffer((const uint8_t *)bytecode_cache_header, 4);
+	f->store_32(FORMAT_VERSION);
+	f->store_pascal_string(singleton->_get_environment_hash());
+	f->store_pascal_string(p_script->source.sha256_text());
+	f->store_32(dependencies.size());
+	for (int i = 0; i < dependencies.size(); i++) {
+		f->store_pascal_string(dependencies[i]);
+	}
+	f->store_32(closure.size());
+	for (int i = 0; i < closure.size(); i++) {
+		f->store_pascal_string(closure[i]);
+		f->store_pascal_string(singleton->_get_source_hash(closure[i]));
+	}
+
+#ifdef DEBUG_ENABLED
+	const List<GDScriptWarning> &warnings = p_parser.get_warnings();
+	f->store_32(warnings.size());
+	for (const GDScriptWarning &warning : warnings) {
+		f->store_32(warning.start_line);
+		f->store_pascal_string(warning.get_name());
+		f->store_pascal_string(warning.get_message());
+	}
+#else
+	f->store_32(0);
+#endif
+
+	Writer w;
+	w.file = f;
+	w.root = p_script;
+	singleton->_write_tree(w, p_script);
+	singleton->_write_class(w, p_script);
+	f->store_buffer((const uint8_t *)bytecode_cache_header, 4);
+
+	bool failed = w.failed || f->get_error() != OK;
+	f.unref(); // Close before moving it.
+
+	Ref<DirAccess> da = DirAccess::open(singleton->cache_dir);
+	if (da.is_null()) {
+		return;
+	}
+	if (failed) {
+		da->remove(temp_path);
+	} else {
+		da->rename(temp_path, cache_path);
+	}
+}
+
+Vector<String> GDScriptBytecodeCache::get_dependency_hint(const String &p_path) {
+	Vector<String> hint;
+	if (!singleton) {
+		return hint;
+	}
+
+	String cache_path;
+	{
+		MutexLock lock(singleton->lock);
+		singleton->_initialize();
+		if (singleton->cache_dir.is_empty()) {
+			return hint;
+		}
+		cache_path = singleton->_get_cache_path(p_path);
+	}
+
+	Ref<FileAccess> f = FileAccess::open(cache_path, FileAccess::READ);
+	Header header;
+	if (f.is_valid() && _read_header(f, header)) {
+		hint = header.closure;
+	}
+	return hint;
+}
+
+void GDScriptBytecodeCache::reset() {
+	if (!singleton) {
+		return;
+	}
+
+	MutexLock lock(singleton->lock);
+	singleton->initialized = false;
+	singleton->cache_dir = String();
+	singleton->source_hashes.clear();
+	singleton->environment_hash = String();
+	singleton->environment_globals = UINT32_MAX;
+	singleton->environment_global_classes = -1;
+	singleton->global_objects.clear();
+	singleton->global_objects_size = -1;
+}
+
+GDScriptBytecodeCache::GDScriptBytecodeCache() {
+	singleton = this;
+}
+
+GDScriptBytecodeCache::~GDScriptBytecodeCache() {
+	singleton = nullptr;
+}
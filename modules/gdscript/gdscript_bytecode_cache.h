@@ -0,0 +1,189 @@
+/*************************************************************************/
+/*  gdscript_bytecode_cache.h                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_BYTECODE_CACHE_H
+#define GDSCRIPT_BYTECODE_CACHE_H
+
+#include "core/io/file_access.h"
+#include "core/object/script_language.h"
+#include "core/os/mutex.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/rb_map.h"
+#include "core/variant/variant.h"
+#include "gdscript_utility_functions.h"
+
+class GDScript;
+class GDScriptDataType;
+class GDScriptFunction;
+class GDScriptParser;
+class MethodBind;
+
+// Stores the compiled form of file scripts under user://gdscript_cache, so
+// later runs can skip parsing, analysis and code generation for them.
+//
+// An entry is only used if the engine build, the global names and classes,
+// the script source and the sources of every script it depends on (directly
+// or not) are the same as when it was written. Anything that can't be
+// represented (e.g. constants holding objects other than scripts, global
+// singletons or resources with a path) makes the script not cacheable.
+class GDScriptBytecodeCache {
+	enum {
+		FORMAT_VERSION = 2,
+	};
+
+	enum VariantTag {
+		VARIANT_VALUE,
+		VARIANT_NULL_OBJECT,
+		VARIANT_ARRAY,
+		VARIANT_DICTIONARY,
+		VARIANT_GLOBAL,
+		VARIANT_SCRIPT,
+		VARIANT_RESOURCE,
+	};
+
+	enum ScriptTag {
+		SCRIPT_NONE,
+		SCRIPT_LOCAL, // Class in the script being cached.
+		SCRIPT_EXTERNAL, // Class in another GDScript file.
+		SCRIPT_RESOURCE, // Any other script, loaded by path.
+	};
+
+	// Names a validated function pointer in a way that survives a restart.
+	struct Symbol {
+		int32_t a = 0;
+		int32_t b = 0;
+		int32_t c = 0;
+		StringName name;
+	};
+
+	struct Writer {
+		Ref<FileAccess> file;
+		const GDScript *root = nullptr;
+		bool failed = false;
+	};
+
+	struct Reader {
+		Ref<FileAccess> file;
+		GDScript *root = nullptr;
+		String owner;
+		bool failed = false;
+	};
+
+	struct Header {
+		String environment_hash;
+		String source_hash;
+		Vector<String> dependencies;
+		Vector<String> closure;
+		Vector<String> closure_hashes;
+	};
+
+	struct Warning {
+		int line = 0;
+		String name;
+		String message;
+	};
+
+	static GDScriptBytecodeCache *singleton;
+
+	Mutex lock;
+	bool initialized = false;
+	String cache_dir;
+
+	HashMap<String, String> source_hashes;
+	String environment_hash;
+	uint32_t environment_globals = UINT32_MAX;
+	int environment_global_classes = -1;
+
+	HashMap<ObjectID, StringName> global_objects;
+	int global_objects_size = -1;
+
+	bool symbols_built = false;
+	RBMap<Variant::ValidatedOperatorEvaluator, Symbol> operator_symbols;
+	RBMap<Variant::ValidatedSetter, Symbol> setter_symbols;
+	RBMap<Variant::ValidatedGetter, Symbol> getter_symbols;
+	RBMap<Variant::ValidatedKeyedSetter, Symbol> keyed_setter_symbols;
+	RBMap<Variant::ValidatedKeyedGetter, Symbol> keyed_getter_symbols;
+	RBMap<Variant::ValidatedIndexedSetter, Symbol> indexed_setter_symbols;
+	RBMap<Variant::ValidatedIndexedGetter, Symbol> indexed_getter_symbols;
+	RBMap<Variant::ValidatedBuiltInMethod, Symbol> builtin_method_symbols;
+	RBMap<Variant::ValidatedConstructor, Symbol> constructor_symbols;
+	RBMap<Variant::ValidatedUtilityFunction, Symbol> utility_symbols;
+	RBMap<GDScriptUtilityFunctions::FunctionPtr, Symbol> gds_utility_symbols;
+
+	void _initialize();
+	String _get_cache_path(const String &p_path) const;
+	String _get_source_hash(const String &p_path);
+	String _get_environment_hash();
+	void _build_symbols();
+	void _update_global_objects();
+	bool _get_dependency_closure(const String &p_path, Vector<String> &r_closure);
+
+	static bool _read_header(Ref<FileAccess> &p_file, Header &r_header);
+	static bool _check_count(Reader &r, uint32_t p_count);
+	static StringName _read_name(Reader &r);
+
+	static void _write_symbol(Writer &w, const Symbol &p_symbol);
+	static Symbol _read_symbol(Reader &r);
+	template <class T>
+	static void _write_pointers(Writer &w, const Vector<T> &p_pointers, const RBMap<T, Symbol> &p_symbols);
+	template <class T, class F>
+	static void _read_pointers(Reader &r, Vector<T> &r_pointers, F p_resolve);
+	static void _write_method(Writer &w, MethodBind *p_method);
+	static MethodBind *_read_method(Reader &r);
+	static void _write_script_ref(Writer &w, const Script *p_script);
+	static Ref<Script> _read_script_ref(Reader &r, bool p_full = false);
+	static void _write_data_type(Writer &w, const GDScriptDataType &p_type);
+	static void _read_data_type(Reader &r, GDScriptDataType &r_type);
+	void _write_variant(Writer &w, const Variant &p_value);
+	static Variant _read_variant(Reader &r);
+	static bool _validate_address(const GDScriptFunction *p_function, int p_member_count, int p_address);
+	static bool _validate_code(const GDScriptFunction *p_function, int p_member_count, int p_inline_cache_sites);
+	void _write_function(Writer &w, const GDScriptFunction *p_function);
+	static GDScriptFunction *_read_function(Reader &r, GDScript *p_script);
+	static void _write_tree(Writer &w, const GDScript *p_script);
+	static void _read_tree(Reader &r, GDScript *p_script);
+	void _write_class(Writer &w, const GDScript *p_script);
+	static void _read_class(Reader &r, GDScript *p_script);
+	static void _clear_class(GDScript *p_script);
+
+public:
+	static bool is_cacheable(const GDScript *p_script);
+	static bool load(GDScript *p_script);
+	static void save(const GDScript *p_script, const GDScriptParser &p_parser);
+	// Scripts the last cached version of p_path depended on, even if the entry is outdated.
+	static Vector<String> get_dependency_hint(const String &p_path);
+	// Forgets the settings and source hashes seen so far, they may differ when the language is initialized again.
+	static void reset();
+
+	GDScriptBytecodeCache();
+	~GDScriptBytecodeCache();
+};
+
+#endif // GDSCRIPT_BYTECODE_CACHE_H
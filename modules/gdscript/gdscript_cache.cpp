@@ -31,9 +31,12 @@
 #include "gdscript_cache.h"
 
 #include "core/io/file_access.h"
+#include "core/os/parallel_for.h"
+#include "core/templates/local_vector.h"
 #include "core/templates/vector.h"
 #include "gdscript.h"
 #include "gdscript_analyzer.h"
+#include "gdscript_bytecode_cache.h"
 #include "gdscript_parser.h"
 
 bool GDScriptParserRef::is_valid() const {
@@ -103,7 +106,11 @@ GDScriptParserRef::~GDScriptParserRef() {
 		memdelete(analyzer);
 	}
 	MutexLock lock(GDScriptCache::singleton->lock);
-	GDScriptCache::singleton->parser_map.erase(path);
+	// Parsers discarded by parse_in_parallel() were never in the map, don't remove the one that is.
+	HashMap<String, GDScriptParserRef *>::Iterator E = GDScriptCache::singleton->parser_map.find(path);
+	if (E && E->value == this) {
+		GDScriptCache::singleton->parser_map.remove(E);
+	}
 }
 
 GDScriptCache *GDScriptCache::singleton = nullptr;
@@ -228,6 +235,7 @@ Error GDScriptCache::finish_compiling(const String &p_owner) {
 	singleton->shallow_gdscript_cache.erase(p_owner);
 
 	HashSet<String> depends = singleton->dependencies[p_owner];
+	singleton->resolved_dependencies[p_owner] = depends;
 
 	Error err = OK;
 	for (const String &E : depends) {
@@ -245,6 +253,97 @@ Error GDScriptCache::finish_compiling(const String &p_owner) {
 	return err;
 }
 
+Vector<Ref<GDScriptParserRef>> GDScriptCache::parse_in_parallel(const Vector<String> &p_paths) {
+	Vector<Ref<GDScriptParserRef>> refs;
+	LocalVector<Ref<GDScriptParserRef>> pending;
+
+	{
+		MutexLock lock(singleton->lock);
+		HashSet<String> seen;
+		for (const String &path : p_paths) {
+			if (seen.has(path)) {
+				continue;
+			}
+			seen.insert(path);
+
+			HashMap<String, GDScriptParserRef *>::Iterator E = singleton->parser_map.find(path);
+			if (E) {
+				refs.push_back(Ref<GDScriptParserRef>(E->value));
+				continue;
+			}
+			if (!FileAccess::exists(path)) {
+				continue;
+			}
+			Ref<GDScriptParserRef> ref;
+			ref.instantiate();
+			ref->parser = memnew(GDScriptParser);
+			ref->path = path;
+			pending.push_back(ref);
+		}
+	}
+
+	if (pending.is_empty()) {
+		return refs;
+	}
+
+	// The parser fills this table on first use, do it here rather than racing in the worker threads.
+	GDScriptParser::get_builtin_type(StringName());
+
+	// The parsers are not in the map yet, so nothing else can see them while this is running.
+	parallel_for(
+			0, pending.size(), [&pending](uint32_t p_begin, uint32_t p_end) {
+				for (uint32_t i = p_begin; i < p_end; i++) {
+					GDScriptParserRef *ref = pending[i].ptr();
+					ref->result = ref->parser->parse(get_source_code(ref->path), ref->path, false);
+				}
+			},
+			1, "GDScript parsing");
+
+	MutexLock lock(singleton->lock);
+	for (uint32_t i = 0; i < pending.size(); i++) {
+		Ref<GDScriptParserRef> &ref = pending[i];
+		ref->status = GDScriptParserRef::PARSED;
+
+		HashMap<String, GDScriptParserRef *>::Iterator E = singleton->parser_map.find(ref->path);
+		if (E) {
+			// Parsed by another thread meanwhile, keep that one.
+			refs.push_back(Ref<GDScriptParserRef>(E->value));
+			continue;
+		}
+		singleton->parser_map[ref->path] = ref.ptr();
+		refs.push_back(ref);
+	}
+
+	return refs;
+}
+
+Vector<Ref<GDScriptParserRef>> GDScriptCache::parse_dependencies(const String &p_path) {
+	// What the script depended on last time it was cached is the best guess.
+	Vector<String> paths = GDScriptBytecodeCache::get_dependency_hint(p_path);
+
+	if (paths.is_empty()) {
+		bool parse_global_classes = false;
+		{
+			MutexLock lock(singleton->lock);
+			parse_global_classes = !singleton->global_classes_parsed;
+			singleton->global_classes_parsed = true;
+		}
+		if (parse_global_classes) {
+			// Nothing is known yet (e.g. first run), most scripts end up depending on some of the global classes.
+			List<StringName> global_classes;
+			ScriptServer::get_global_class_list(&global_classes);
+			for (const StringName &E : global_classes) {
+				if (ScriptServer::get_global_class_language(E) == GDScriptLanguage::get_singleton()->get_name()) {
+					paths.push_back(ScriptServer::get_global_class_path(E));
+				}
+			}
+		}
+	}
+
+	paths.erase(p_path);
+	return parse_in_parallel(paths);
+}
+
 GDScriptCache::GDScriptCache() {
 	singleton = this;
 }
@@ -253,5 +352,6 @@ GDScriptCache::~GDScriptCache() {
 	parser_map.clear();
 	shallow_gdscript_cache.clear();
 	full_gdscript_cache.clear();
+	resolved_dependencies.clear();
 	singleton = nullptr;
 }
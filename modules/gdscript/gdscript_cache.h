@@ -75,9 +75,13 @@ class GDScriptCache {
 	HashMap<String, GDScript *> shallow_gdscript_cache;
 	HashMap<String, GDScript *> full_gdscript_cache;
 	HashMap<String, HashSet<String>> dependencies;
+	// Direct dependencies of scripts that finished compiling, kept after they are done.
+	HashMap<String, HashSet<String>> resolved_dependencies;
+	bool global_classes_parsed = false;
 
 	friend class GDScript;
 	friend class GDScriptParserRef;
+	friend class GDScriptBytecodeCache;
 
 	static GDScriptCache *singleton;
 
@@ -90,6 +94,8 @@ public:
 	static Ref<GDScript> get_shallow_script(const String &p_path, const String &p_owner = String());
 	static Ref<GDScript> get_full_script(const String &p_path, Error &r_error, const String &p_owner = String(), bool p_update_from_disk = false);
 	static Error finish_compiling(const String &p_owner);
+	static Vector<Ref<GDScriptParserRef>> parse_in_parallel(const Vector<String> &p_paths);
+	static Vector<Ref<GDScriptParserRef>> parse_dependencies(const String &p_path);
 
 	GDScriptCache();
 	~GDScriptCache();
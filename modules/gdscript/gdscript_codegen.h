@@ -72,6 +72,7 @@ public:
 	virtual uint32_t add_or_get_name(const StringName &p_name) = 0;
 	virtual uint32_t add_temporary(const GDScriptDataType &p_type) = 0;
 	virtual void pop_temporary() = 0;
+	virtual uint32_t add_buffer() = 0;
 
 	virtual void start_parameters() = 0;
 	virtual void end_parameters() = 0;
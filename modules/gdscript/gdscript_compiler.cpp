@@ -33,6 +33,7 @@
 #include "gdscript.h"
 #include "gdscript_byte_codegen.h"
 #include "gdscript_cache.h"
+#include "gdscript_inline_cache.h"
 #include "gdscript_utility_functions.h"
 
 #include "core/config/engine.h"
@@ -435,7 +436,13 @@ GDScriptCodeGenerator::Address GDScriptCompiler::_parse_expression(CodeGen &code
 
 			// Create the result temporary first since it's the last to be killed.
 			GDScriptDataType array_type = _gdtype_from_datatype(an->get_datatype());
-			GDScriptCodeGenerator::Address result = codegen.add_temporary(array_type);
+			GDScriptCodeGenerator::Address result;
+			if (an->is_non_escaping && !array_type.has_container_element_type()) {
+				// Nothing keeps the array after it's used, so the same one is refilled on every run.
+				result = codegen.add_buffer(array_type);
+			} else {
+				result = codegen.add_temporary(array_type);
+			}
 
 			for (int i = 0; i < an->elements.size(); i++) {
 				GDScriptCodeGenerator::Address val = _parse_expression(codegen, r_error, an->elements[i]);
@@ -468,7 +475,7 @@ GDScriptCodeGenerator::Address GDScriptCompiler::_parse_expression(CodeGen &code
 			dict_type.has_type = true;
 			dict_type.kind = GDScriptDataType::BUILTIN;
 			dict_type.builtin_type = Variant::DICTIONARY;
-			GDScriptCodeGenerator::Address result = codegen.add_temporary(dict_type);
+			GDScriptCodeGenerator::Address result = dn->is_non_escaping ? codegen.add_buffer(dict_type) : codegen.add_temporary(dict_type);
 
 			for (int i = 0; i < dn->elements.size(); i++) {
 				// Key.
@@ -2230,6 +2237,9 @@ Error GDScriptCompiler::_parse_class_level(GDScript *p_script, const GDScriptPar
 	}
 #endif
 
+	// Cached accesses may refer to the members and functions about to be replaced.
+	GDScriptInlineCache::invalidate(p_script);
+
 	p_script->native = Ref<GDScriptNativeClass>();
 	p_script->base = Ref<GDScript>();
 	p_script->_base = nullptr;
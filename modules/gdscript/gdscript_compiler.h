@@ -70,6 +70,11 @@ class GDScriptCompiler {
 			return GDScriptCodeGenerator::Address(GDScriptCodeGenerator::Address::TEMPORARY, addr, p_type);
 		}
 
+		GDScriptCodeGenerator::Address add_buffer(const GDScriptDataType &p_type) {
+			uint32_t addr = generator->add_buffer();
+			return GDScriptCodeGenerator::Address(GDScriptCodeGenerator::Address::TEMPORARY, addr, p_type);
+		}
+
 		GDScriptCodeGenerator::Address add_constant(const Variant &p_constant) {
 			GDScriptDataType type;
 			type.has_type = true;
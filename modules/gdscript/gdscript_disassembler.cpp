@@ -134,6 +134,24 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 
 				incr += 5;
 			} break;
+			case OPCODE_OPERATOR_INT:
+			case OPCODE_OPERATOR_FLOAT:
+			case OPCODE_OPERATOR_VECTOR2:
+			case OPCODE_OPERATOR_VECTOR3: {
+				int operation = _code_ptr[ip + 4];
+
+				text += "typed operator ";
+
+				text += DADDR(3);
+				text += " = ";
+				text += DADDR(1);
+				text += " ";
+				text += Variant::get_operator_name(Variant::Operator(operation));
+				text += " ";
+				text += DADDR(2);
+
+				incr += 5;
+			} break;
 			case OPCODE_EXTENDS_TEST: {
 				text += "is object ";
 				text += DADDR(3);
@@ -225,7 +243,7 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 				text += "\"] = ";
 				text += DADDR(2);
 
-				incr += 4;
+				incr += 5;
 			} break;
 			case OPCODE_SET_NAMED_VALIDATED: {
 				text += "set_named validated ";
@@ -246,7 +264,7 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 				text += _global_names_ptr[_code_ptr[ip + 3]];
 				text += "\"]";
 
-				incr += 4;
+				incr += 5;
 			} break;
 			case OPCODE_GET_NAMED_VALIDATED: {
 				text += "get_named validated ";
@@ -408,9 +426,10 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 
 				incr = 3 + instr_var_args;
 			} break;
-			case OPCODE_CONSTRUCT_ARRAY: {
+			case OPCODE_CONSTRUCT_ARRAY:
+			case OPCODE_CONSTRUCT_ARRAY_REUSE: {
 				int argc = _code_ptr[ip + 1 + instr_var_args];
-				text += " make_array ";
+				text += opcode == OPCODE_CONSTRUCT_ARRAY_REUSE ? " refill_array " : " make_array ";
 				text += DADDR(1 + argc);
 				text += " = [";
 
@@ -459,9 +478,10 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 
 				incr += 3 + argc;
 			} break;
-			case OPCODE_CONSTRUCT_DICTIONARY: {
+			case OPCODE_CONSTRUCT_DICTIONARY:
+			case OPCODE_CONSTRUCT_DICTIONARY_REUSE: {
 				int argc = _code_ptr[ip + 1 + instr_var_args];
-				text += "make_dict ";
+				text += opcode == OPCODE_CONSTRUCT_DICTIONARY_REUSE ? "refill_dict " : "make_dict ";
 				text += DADDR(1 + argc * 2);
 				text += " = {";
 
@@ -509,7 +529,7 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 				}
 				text += ")";
 
-				incr = 5 + argc;
+				incr = 6 + argc;
 			} break;
 			case OPCODE_CALL_METHOD_BIND:
 			case OPCODE_CALL_METHOD_BIND_RET: {
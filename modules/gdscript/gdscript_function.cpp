@@ -31,6 +31,8 @@
 #include "gdscript_function.h"
 
 #include "gdscript.h"
+#include "gdscript_inline_cache.h"
+#include "gdscript_threaded_code.h"
 
 const int *GDScriptFunction::get_code() const {
 	return _code_ptr;
@@ -153,6 +155,14 @@ GDScriptFunction::~GDScriptFunction() {
 		memdelete(lambdas[i]);
 	}
 
+	if (threaded_code) {
+		memdelete(threaded_code);
+	}
+
+	if (inline_cache) {
+		memdelete(inline_cache);
+	}
+
 #ifdef DEBUG_ENABLED
 
 	MutexLock lock(GDScriptLanguage::get_singleton()->mutex);
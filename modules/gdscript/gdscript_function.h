@@ -42,6 +42,8 @@
 
 class GDScriptInstance;
 class GDScript;
+class GDScriptInlineCache;
+class GDScriptThreadedCode;
 
 class GDScriptDataType {
 private:
@@ -219,6 +221,11 @@ public:
 	enum Opcode {
 		OPCODE_OPERATOR,
 		OPCODE_OPERATOR_VALIDATED,
+		// Operators on two values of the same type, see GDScriptTypedOperator.
+		OPCODE_OPERATOR_INT,
+		OPCODE_OPERATOR_FLOAT,
+		OPCODE_OPERATOR_VECTOR2,
+		OPCODE_OPERATOR_VECTOR3,
 		OPCODE_EXTENDS_TEST,
 		OPCODE_IS_BUILTIN,
 		OPCODE_SET_KEYED,
@@ -246,8 +253,10 @@ public:
 		OPCODE_CONSTRUCT, // Only for basic types!
 		OPCODE_CONSTRUCT_VALIDATED, // Only for basic types!
 		OPCODE_CONSTRUCT_ARRAY,
+		OPCODE_CONSTRUCT_ARRAY_REUSE,
 		OPCODE_CONSTRUCT_TYPED_ARRAY,
 		OPCODE_CONSTRUCT_DICTIONARY,
+		OPCODE_CONSTRUCT_DICTIONARY_REUSE,
 		OPCODE_CALL,
 		OPCODE_CALL_RETURN,
 		OPCODE_CALL_ASYNC,
@@ -432,6 +441,8 @@ public:
 private:
 	friend class GDScriptCompiler;
 	friend class GDScriptByteCodeGenerator;
+	friend class GDScriptThreadedCode;
+	friend class GDScriptBytecodeCache;
 
 	StringName source;
 
@@ -504,6 +515,9 @@ private:
 
 	HashMap<int, Variant::Type> temporary_slots;
 
+	GDScriptThreadedCode *threaded_code = nullptr;
+	GDScriptInlineCache *inline_cache = nullptr;
+
 #ifdef TOOLS_ENABLED
 	Vector<StringName> arg_names;
 	Vector<Variant> default_arg_values;
@@ -534,6 +548,9 @@ private:
 		uint64_t last_frame_call_count = 0;
 		uint64_t last_frame_self_time = 0;
 		uint64_t last_frame_total_time = 0;
+		uint64_t alloc_count = 0; // Arrays and dictionaries allocated by the function's literals.
+		uint64_t frame_alloc_count = 0;
+		uint64_t last_frame_alloc_count = 0;
 	} profile;
 
 #endif
@@ -573,6 +590,7 @@ public:
 	void debug_get_stack_member_state(int p_line, List<Pair<StringName, int>> *r_stackvars) const;
 
 	_FORCE_INLINE_ bool is_empty() const { return _code_size == 0; }
+	_FORCE_INLINE_ bool has_threaded_code() const { return threaded_code != nullptr; }
 
 	int get_argument_count() const { return _argument_count; }
 	StringName get_argument_name(int p_idx) const {
@@ -0,0 +1,386 @@
+/*************************************************************************/
+/*  gdscript_inline_cache.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_inline_cache.h"
+
+#include "core/core_string_names.h"
+#include "core/object/class_db.h"
+#include "core/object/method_bind.h"
+#include "gdscript.h"
+
+SafeNumeric<uint32_t> GDScriptInlineCache::version;
+
+static _FORCE_INLINE_ bool _get_receiver(const Variant *p_base, Object *&r_object, GDScriptInstance *&r_instance) {
+	if (p_base->get_type() != Variant::OBJECT) {
+		return false;
+	}
+
+	r_object = p_base->get_validated_object();
+	if (!r_object) {
+		return false; // Null or freed, let the regular path report it.
+	}
+
+	ScriptInstance *script_instance = r_object->get_script_instance();
+	if (!script_instance) {
+		r_instance = nullptr;
+		return true;
+	}
+
+	// Other languages and placeholders resolve names in their own way.
+	if (script_instance->is_placeholder() || script_instance->get_language() != GDScriptLanguage::get_singleton()) {
+		return false;
+	}
+
+	r_instance = static_cast<GDScriptInstance *>(script_instance);
+	return true;
+}
+
+static const ClassDB::PropertySetGet *_find_native_property(const StringName &p_native_class, const StringName &p_name, bool p_for_get) {
+	const ClassDB::ClassInfo *type = ClassDB::classes.getptr(p_native_class);
+	if (!type || type->native_extension) {
+		return nullptr; // Extensions may override access to any property.
+	}
+
+	// Same lookup order as ClassDB::get_property() and ClassDB::set_property().
+	const ClassDB::ClassInfo *check = type;
+	while (check) {
+		const ClassDB::PropertySetGet *psg = check->property_setget.getptr(p_name);
+		if (psg) {
+			return psg;
+		}
+
+		if (p_for_get && (check->constant_map.has(p_name) || check->method_map.has(p_name) || check->signal_map.has(p_name))) {
+			return nullptr;
+		}
+
+		check = check->inherits_ptr;
+	}
+
+	return nullptr;
+}
+
+void GDScriptInlineCache::_resolve_get(const GDScript *p_script, const StringName &p_native_class, const StringName &p_name, Entry &r_entry) {
+	if (p_script) {
+		HashMap<StringName, GDScript::MemberInfo>::ConstIterator E = p_script->member_indices.find(p_name);
+		if (E) {
+			if (E->value.getter == StringName()) {
+				r_entry.kind = KIND_SCRIPT_MEMBER;
+				r_entry.member_index = E->value.index;
+			}
+			return;
+		}
+
+		// Constants, signals, methods and _get() are resolved by the script instance.
+		const GDScript *sptr = p_script;
+		while (sptr) {
+			if (sptr->constants.has(p_name) || sptr->_signals.has(p_name) || sptr->member_functions.has(p_name) || sptr->member_functions.has(GDScriptLanguage::get_singleton()->strings._get)) {
+				return;
+			}
+			sptr = sptr->_base;
+		}
+	}
+
+	const ClassDB::PropertySetGet *psg = _find_native_property(p_native_class, p_name, true);
+	if (psg && psg->getter != StringName() && psg->_getptr && psg->index < 0) {
+		r_entry.kind = KIND_NATIVE_PROPERTY;
+		r_entry.method = psg->_getptr;
+	}
+}
+
+void GDScriptInlineCache::_resolve_set(const GDScript *p_script, const StringName &p_native_class, const StringName &p_name, Entry &r_entry) {
+	if (p_script) {
+		HashMap<StringName, GDScript::MemberInfo>::ConstIterator E = p_script->member_indices.find(p_name);
+		if (E) {
+			const GDScript::MemberInfo &member = E->value;
+			if (member.setter != StringName()) {
+				return;
+			}
+			if (member.data_type.has_type) {
+				// Only builtin types can be checked without going through GDScriptDataType::is_type().
+				if (member.data_type.kind != GDScriptDataType::BUILTIN || member.data_type.builtin_type == Variant::NIL || member.data_type.has_container_element_type()) {
+					return;
+				}
+				r_entry.member_type = member.data_type.builtin_type;
+			}
+			r_entry.kind = KIND_SCRIPT_MEMBER;
+			r_entry.member_index = member.index;
+			return;
+		}
+
+		const GDScript *sptr = p_script;
+		while (sptr) {
+			if (sptr->member_functions.has(GDScriptLanguage::get_singleton()->strings._set)) {
+				return;
+			}
+			sptr = sptr->_base;
+		}
+	}
+
+	const ClassDB::PropertySetGet *psg = _find_native_property(p_native_class, p_name, false);
+	if (psg && psg->setter != StringName() && psg->_setptr && psg->index < 0) {
+		r_entry.kind = KIND_NATIVE_PROPERTY;
+		r_entry.method = psg->_setptr;
+	}
+}
+
+void GDScriptInlineCache::_resolve_call(const GDScript *p_script, const StringName &p_native_class, const StringName &p_name, Entry &r_entry) {
+	if (p_name == CoreStringNames::get_singleton()->_free) {
+		return; // Handled by Object::callp() before anything else.
+	}
+
+	if (p_script) {
+		if (p_name == SNAME("_ready")) {
+			return; // Also runs the implicit ready functions.
+		}
+
+		const GDScript *sptr = p_script;
+		while (sptr) {
+			HashMap<StringName, GDScriptFunction *>::ConstIterator E = sptr->member_functions.find(p_name);
+			if (E) {
+				r_entry.kind = KIND_SCRIPT_METHOD;
+				r_entry.function = E->value;
+				return;
+			}
+			sptr = sptr->_base;
+		}
+	}
+
+	// These override Object::callp() and resolve names of their own first (e.g. static functions).
+	if (p_native_class == GDScriptNativeClass::get_class_static() || ClassDB::is_parent_class(p_native_class, SNAME("Script")) || p_native_class == SNAME("JNISingleton") || p_native_class == SNAME("JavaClass") || p_native_class == SNAME("JavaObject")) {
+		return;
+	}
+
+	MethodBind *method = ClassDB::get_method(p_native_class, p_name);
+	if (method) {
+		r_entry.kind = KIND_NATIVE_METHOD;
+		r_entry.method = method;
+	}
+}
+
+void GDScriptInlineCache::invalidate(GDScript *p_script) {
+	// Scripts that were never looked up, like those being compiled for the first time, can't be
+	// in any entry. Entries are keyed by ID, so freed scripts don't need to be forgotten either.
+	if (p_script->inline_cached.is_set()) {
+		p_script->inline_cached.clear();
+		version.increment();
+	}
+}
+
+const GDScriptInlineCache::Entry *GDScriptInlineCache::_lookup(int p_site, Access p_access, Object *p_object, const GDScript *p_script, const StringName &p_name) {
+	ERR_FAIL_INDEX_V(p_site, site_count, nullptr);
+
+	Site &site = sites[p_site];
+	const StringName &native_class = p_object->get_class_name();
+	ObjectID script_id = p_script ? p_script->get_instance_id() : ObjectID();
+	uint32_t current_version = version.get();
+
+	int free_slot = -1;
+	for (int i = 0; i < MAX_SITE_ENTRIES; i++) {
+		const Entry *entry = site.entries[i].get();
+		if (!entry) {
+			if (free_slot == -1) {
+				free_slot = i;
+			}
+			break;
+		}
+		if (entry->version != current_version) {
+			if (free_slot == -1) {
+				free_slot = i;
+			}
+			continue;
+		}
+		if (entry->script_id == script_id && entry->native_class == native_class) {
+			return entry;
+		}
+	}
+
+	if (free_slot == -1) {
+		return nullptr; // Megamorphic.
+	}
+
+	// Published entries stay alive until the function is freed, since other threads may be reading them.
+	MutexLock lock(mutex);
+	if (site.allocations >= MAX_SITE_ALLOCATIONS) {
+		return nullptr; // Invalidated too many times.
+	}
+	site.allocations++;
+
+	// Members and functions may come from any script in the hierarchy.
+	const GDScript *sptr = p_script;
+	while (sptr) {
+		sptr->inline_cached.set();
+		sptr = sptr->_base;
+	}
+
+	Entry *entry = memnew(Entry);
+	entry->version = current_version;
+	entry->script_id = script_id;
+	entry->native_class = native_class;
+
+	switch (p_access) {
+		case ACCESS_GET: {
+			_resolve_get(p_script, native_class, p_name, *entry);
+		} break;
+		case ACCESS_SET: {
+			_resolve_set(p_script, native_class, p_name, *entry);
+		} break;
+		case ACCESS_CALL: {
+			_resolve_call(p_script, native_class, p_name, *entry);
+		} break;
+	}
+
+	entries.push_back(entry);
+	const Entry *replaced = site.entries[free_slot].get();
+	if (!replaced || replaced->version != current_version) {
+		site.entries[free_slot].set(entry); // Otherwise another thread took the slot, the entry is only used once.
+	}
+
+	return entry;
+}
+
+bool GDScriptInlineCache::get_named(int p_site, const Variant *p_base, const StringName &p_name, Variant &r_ret) {
+	Object *object = nullptr;
+	GDScriptInstance *instance = nullptr;
+	if (!_get_receiver(p_base, object, instance)) {
+		return false;
+	}
+
+	const Entry *entry = _lookup(p_site, ACCESS_GET, object, instance ? instance->script.ptr() : nullptr, p_name);
+	if (!entry) {
+		return false;
+	}
+
+	switch (entry->kind) {
+		case KIND_SCRIPT_MEMBER: {
+			ERR_FAIL_INDEX_V(entry->member_index, instance->members.size(), false);
+			r_ret = instance->members[entry->member_index];
+			return true;
+		}
+		case KIND_NATIVE_PROPERTY: {
+			Callable::CallError ce;
+			r_ret = entry->method->call(object, nullptr, 0, ce);
+			return true;
+		}
+		default: {
+			return false;
+		}
+	}
+}
+
+bool GDScriptInlineCache::set_named(int p_site, Variant *p_base, const StringName &p_name, const Variant &p_value, bool &r_valid) {
+	Object *object = nullptr;
+	GDScriptInstance *instance = nullptr;
+	if (!_get_receiver(p_base, object, instance)) {
+		return false;
+	}
+
+#ifdef TOOLS_ENABLED
+	if (!object->is_edited()) {
+		return false; // Let Object::set() flag it.
+	}
+#endif
+
+	const Entry *entry = _lookup(p_site, ACCESS_SET, object, instance ? instance->script.ptr() : nullptr, p_name);
+	if (!entry) {
+		return false;
+	}
+
+	switch (entry->kind) {
+		case KIND_SCRIPT_MEMBER: {
+			if (entry->member_type != Variant::NIL && p_value.get_type() != entry->member_type) {
+				return false; // Needs a conversion.
+			}
+			ERR_FAIL_INDEX_V(entry->member_index, instance->members.size(), false);
+			instance->members.write[entry->member_index] = p_value;
+			r_valid = true;
+			return true;
+		}
+		case KIND_NATIVE_PROPERTY: {
+			const Variant *args[1] = { &p_value };
+			Callable::CallError ce;
+			entry->method->call(object, args, 1, ce);
+			r_valid = ce.error == Callable::CallError::CALL_OK;
+			return true;
+		}
+		default: {
+			return false;
+		}
+	}
+}
+
+bool GDScriptInlineCache::call(int p_site, Variant *p_base, const StringName &p_method, const Variant **p_args, int p_argcount, Variant &r_ret, Callable::CallError &r_error) {
+	Object *object = nullptr;
+	GDScriptInstance *instance = nullptr;
+	if (!_get_receiver(p_base, object, instance)) {
+		return false;
+	}
+
+	const Entry *entry = _lookup(p_site, ACCESS_CALL, object, instance ? instance->script.ptr() : nullptr, p_method);
+	if (!entry) {
+		return false;
+	}
+
+	// The result is only assigned once the object is unlocked, as it may be the base itself.
+	Variant ret;
+	switch (entry->kind) {
+		case KIND_SCRIPT_METHOD: {
+#ifdef DEBUG_ENABLED
+			_ObjectDebugLock debug_lock(object);
+#endif
+			r_error.error = Callable::CallError::CALL_OK;
+			ret = entry->function->call(instance, p_args, p_argcount, r_error);
+		} break;
+		case KIND_NATIVE_METHOD: {
+#ifdef DEBUG_ENABLED
+			_ObjectDebugLock debug_lock(object);
+#endif
+			r_error.error = Callable::CallError::CALL_OK;
+			ret = entry->method->call(object, p_args, p_argcount, r_error);
+		} break;
+		default: {
+			return false;
+		}
+	}
+
+	r_ret = ret;
+	return true;
+}
+
+GDScriptInlineCache::GDScriptInlineCache(int p_site_count) {
+	site_count = p_site_count;
+	sites = memnew_arr(Site, site_count);
+}
+
+GDScriptInlineCache::~GDScriptInlineCache() {
+	memdelete_arr(sites);
+	for (uint32_t i = 0; i < entries.size(); i++) {
+		memdelete(entries[i]);
+	}
+}
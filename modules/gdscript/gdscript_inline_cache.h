@@ -0,0 +1,119 @@
+/*************************************************************************/
+/*  gdscript_inline_cache.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_INLINE_CACHE_H
+#define GDSCRIPT_INLINE_CACHE_H
+
+#include "core/os/mutex.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/safe_refcount.h"
+#include "core/variant/variant.h"
+
+class GDScript;
+class GDScriptFunction;
+class MethodBind;
+
+// Per-function caches for named property access and method calls on receivers whose
+// type is not known at compile time. Each GET_NAMED, SET_NAMED and CALL instruction owns
+// a site, which remembers how the name was resolved for the last few receiver types
+// (keyed by the ID of the GDScript and the native class of the object), so the next access with
+// the same type skips the lookups through the script and ClassDB hierarchies.
+// Anything the cache can't resolve to a plain member, native accessor or method is
+// recorded as such and always takes the regular path, which is also used for receivers
+// which aren't objects.
+class GDScriptInlineCache {
+public:
+	enum {
+		MAX_SITE_ENTRIES = 4, // When all are in use, the site is megamorphic and new types aren't cached.
+		MAX_SITE_ALLOCATIONS = 16, // Stale entries can't be freed while the function lives, past this the site stops caching.
+	};
+
+	enum Kind {
+		KIND_SLOW_PATH,
+		KIND_SCRIPT_MEMBER,
+		KIND_NATIVE_PROPERTY,
+		KIND_SCRIPT_METHOD,
+		KIND_NATIVE_METHOD,
+	};
+
+	struct Entry {
+		uint32_t version = 0;
+		ObjectID script_id;
+		StringName native_class;
+		Kind kind = KIND_SLOW_PATH;
+		int member_index = -1;
+		Variant::Type member_type = Variant::NIL; // Type a value must have to be stored directly, NIL if untyped.
+		GDScriptFunction *function = nullptr;
+		MethodBind *method = nullptr;
+	};
+
+private:
+	struct Site {
+		SafeNumeric<Entry *> entries[MAX_SITE_ENTRIES];
+		uint32_t allocations = 0; // Guarded by the mutex.
+	};
+
+	enum Access {
+		ACCESS_GET,
+		ACCESS_SET,
+		ACCESS_CALL,
+	};
+
+	static SafeNumeric<uint32_t> version;
+
+	Site *sites = nullptr;
+	int site_count = 0;
+
+	BinaryMutex mutex;
+	LocalVector<Entry *> entries;
+
+	static void _resolve_get(const GDScript *p_script, const StringName &p_native_class, const StringName &p_name, Entry &r_entry);
+	static void _resolve_set(const GDScript *p_script, const StringName &p_native_class, const StringName &p_name, Entry &r_entry);
+	static void _resolve_call(const GDScript *p_script, const StringName &p_native_class, const StringName &p_name, Entry &r_entry);
+
+	const Entry *_lookup(int p_site, Access p_access, Object *p_object, const GDScript *p_script, const StringName &p_name);
+
+public:
+	// Called before the members and functions of p_script are replaced. Makes all cached
+	// entries stale, if any could refer to that script.
+	static void invalidate(GDScript *p_script);
+
+	int get_site_count() const { return site_count; }
+
+	// These return false when the access must be done through the regular Variant path.
+	bool get_named(int p_site, const Variant *p_base, const StringName &p_name, Variant &r_ret);
+	bool set_named(int p_site, Variant *p_base, const StringName &p_name, const Variant &p_value, bool &r_valid);
+	bool call(int p_site, Variant *p_base, const StringName &p_method, const Variant **p_args, int p_argcount, Variant &r_ret, Callable::CallError &r_error);
+
+	GDScriptInlineCache(int p_site_count);
+	~GDScriptInlineCache();
+};
+
+#endif // GDSCRIPT_INLINE_CACHE_H
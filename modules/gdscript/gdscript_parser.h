@@ -336,6 +336,7 @@ public:
 
 	struct ArrayNode : public ExpressionNode {
 		Vector<ExpressionNode *> elements;
+		bool is_non_escaping = false; // Only read by the expression using it, so the container can be reused.
 
 		ArrayNode() {
 			type = ARRAY;
@@ -725,6 +726,7 @@ public:
 			PYTHON_DICT,
 		};
 		Style style = PYTHON_DICT;
+		bool is_non_escaping = false; // Only read by the expression using it, so the container can be reused.
 
 		DictionaryNode() {
 			type = DICTIONARY;
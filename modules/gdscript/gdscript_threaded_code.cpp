@@ -0,0 +1,814 @@
+/*************************************************************************/
+/*  gdscript_threaded_code.cpp                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_threaded_code.h"
+
+#include "core/object/method_bind.h"
+#include "core/variant/variant_internal.h"
+#include "gdscript_function.h"
+#include "gdscript_typed_operators.h"
+
+typedef GDScriptThreadedCode::Frame Frame;
+typedef GDScriptThreadedCode::Instruction Instruction;
+
+static _FORCE_INLINE_ Variant *_get_operand(const Instruction *p_instr, const Frame &p_frame, int p_idx) {
+	const GDScriptThreadedCode::Operand &operand = p_instr->operands[p_idx];
+	return p_frame.bases[operand.base] + operand.index;
+}
+
+static _FORCE_INLINE_ const Variant **_get_arguments(const Instruction *p_instr, Frame &p_frame) {
+	for (int i = 0; i < p_instr->argc; i++) {
+		p_frame.instruction_args[i] = _get_operand(p_instr, p_frame, i);
+	}
+	return (const Variant **)p_frame.instruction_args;
+}
+
+static _FORCE_INLINE_ const Instruction *_deopt(const Instruction *p_instr, Frame &p_frame) {
+	p_frame.deopt_ip = p_instr->ip;
+	return nullptr;
+}
+
+static const Instruction *_operator_validated(const Instruction *p_instr, Frame &p_frame) {
+	p_instr->operator_func(_get_operand(p_instr, p_frame, 0), _get_operand(p_instr, p_frame, 1), _get_operand(p_instr, p_frame, 2));
+	return p_instr + 1;
+}
+
+template <class T, Variant::Operator t_operator>
+static const Instruction *_operator_typed(const Instruction *p_instr, Frame &p_frame) {
+	GDScriptTypedOperator::evaluate<T, t_operator>(_get_operand(p_instr, p_frame, 0), _get_operand(p_instr, p_frame, 1), _get_operand(p_instr, p_frame, 2));
+	return p_instr + 1;
+}
+
+template <class T>
+static GDScriptThreadedCode::Handler _get_operator_typed_handler(Variant::Operator p_operator) {
+	switch (p_operator) {
+		case Variant::OP_ADD:
+			return _operator_typed<T, Variant::OP_ADD>;
+		case Variant::OP_SUBTRACT:
+			return _operator_typed<T, Variant::OP_SUBTRACT>;
+		case Variant::OP_MULTIPLY:
+			return _operator_typed<T, Variant::OP_MULTIPLY>;
+		case Variant::OP_DIVIDE:
+			return _operator_typed<T, Variant::OP_DIVIDE>;
+		case Variant::OP_EQUAL:
+			return _operator_typed<T, Variant::OP_EQUAL>;
+		case Variant::OP_NOT_EQUAL:
+			return _operator_typed<T, Variant::OP_NOT_EQUAL>;
+		case Variant::OP_LESS:
+			return _operator_typed<T, Variant::OP_LESS>;
+		case Variant::OP_LESS_EQUAL:
+			return _operator_typed<T, Variant::OP_LESS_EQUAL>;
+		case Variant::OP_GREATER:
+			return _operator_typed<T, Variant::OP_GREATER>;
+		case Variant::OP_GREATER_EQUAL:
+			return _operator_typed<T, Variant::OP_GREATER_EQUAL>;
+		default:
+			return nullptr;
+	}
+}
+
+static const Instruction *_set_keyed_validated(const Instruction *p_instr, Frame &p_frame) {
+	bool valid;
+	p_instr->keyed_setter(_get_operand(p_instr, p_frame, 0), _get_operand(p_instr, p_frame, 1), _get_operand(p_instr, p_frame, 2), &valid);
+#ifdef DEBUG_ENABLED
+	if (unlikely(!valid)) {
+		return _deopt(p_instr, p_frame);
+	}
+#endif
+	return p_instr + 1;
+}
+
+static const Instruction *_set_indexed_validated(const Instruction *p_instr, Frame &p_frame) {
+	int64_t index = *VariantInternal::get_int(_get_operand(p_instr, p_frame, 1));
+	bool oob;
+	p_instr->indexed_setter(_get_operand(p_instr, p_frame, 0), index, _get_operand(p_instr, p_frame, 2), &oob);
+#ifdef DEBUG_ENABLED
+	if (unlikely(oob)) {
+		return _deopt(p_instr, p_frame);
+	}
+#endif
+	return p_instr + 1;
+}
+
+static const Instruction *_get_keyed_validated(const Instruction *p_instr, Frame &p_frame) {
+	bool valid;
+#ifdef DEBUG_ENABLED
+	// Like the interpreter, don't touch the destination if the key is invalid.
+	Variant ret;
+	p_instr->keyed_getter(_get_operand(p_instr, p_frame, 0), _get_operand(p_instr, p_frame, 1), &ret, &valid);
+	if (unlikely(!valid)) {
+		return _deopt(p_instr, p_frame);
+	}
+	*_get_operand(p_instr, p_frame, 2) = ret;
+#else
+	p_instr->keyed_getter(_get_operand(p_instr, p_frame, 0), _get_operand(p_instr, p_frame, 1), _get_operand(p_instr, p_frame, 2), &valid);
+#endif
+	return p_instr + 1;
+}
+
+static const Instruction *_get_indexed_validated(const Instruction *p_instr, Frame &p_frame) {
+	int64_t index = *VariantInternal::get_int(_get_operand(p_instr, p_frame, 1));
+	bool oob;
+	p_instr->indexed_getter(_get_operand(p_instr, p_frame, 0), index, _get_operand(p_instr, p_frame, 2), &oob);
+#ifdef DEBUG_ENABLED
+	if (unlikely(oob)) {
+		return _deopt(p_instr, p_frame);
+	}
+#endif
+	return p_instr + 1;
+}
+
+static const Instruction *_set_named_validated(const Instruction *p_instr, Frame &p_frame) {
+	p_instr->setter(_get_operand(p_instr, p_frame, 0), _get_operand(p_instr, p_frame, 1));
+	return p_instr + 1;
+}
+
+static const Instruction *_get_named_validated(const Instruction *p_instr, Frame &p_frame) {
+	p_instr->getter(_get_operand(p_instr, p_frame, 0), _get_operand(p_instr, p_frame, 1));
+	return p_instr + 1;
+}
+
+static const Instruction *_assign(const Instruction *p_instr, Frame &p_frame) {
+	*_get_operand(p_instr, p_frame, 0) = *_get_operand(p_instr, p_frame, 1);
+	return p_instr + 1;
+}
+
+static const Instruction *_assign_true(const Instruction *p_instr, Frame &p_frame) {
+	*_get_operand(p_instr, p_frame, 0) = true;
+	return p_instr + 1;
+}
+
+static const Instruction *_assign_false(const Instruction *p_instr, Frame &p_frame) {
+	*_get_operand(p_instr, p_frame, 0) = false;
+	return p_instr + 1;
+}
+
+static const Instruction *_assign_typed_builtin(const Instruction *p_instr, Frame &p_frame) {
+	Variant *dst = _get_operand(p_instr, p_frame, 0);
+	Variant *src = _get_operand(p_instr, p_frame, 1);
+	Variant::Type var_type = (Variant::Type)p_instr->value;
+
+	if (likely(src->get_type() == var_type)) {
+		*dst = *src;
+		return p_instr + 1;
+	}
+#ifdef DEBUG_ENABLED
+	if (!Variant::can_convert_strict(src->get_type(), var_type)) {
+		return _deopt(p_instr, p_frame);
+	}
+#endif
+	Callable::CallError ce;
+	Variant::construct(var_type, *dst, const_cast<const Variant **>(&src), 1, ce);
+	return p_instr + 1;
+}
+
+static const Instruction *_construct_validated(const Instruction *p_instr, Frame &p_frame) {
+	const Variant **args = _get_arguments(p_instr, p_frame);
+	p_instr->constructor(_get_operand(p_instr, p_frame, p_instr->argc), args);
+	return p_instr + 1;
+}
+
+static _FORCE_INLINE_ Object *_get_ptrcall_base(const Instruction *p_instr, Frame &p_frame) {
+	const void **argptrs = p_frame.call_args;
+	for (int i = 0; i < p_instr->argc; i++) {
+		argptrs[i] = VariantInternal::get_opaque_pointer((const Variant *)_get_operand(p_instr, p_frame, i));
+	}
+
+	Variant *base = _get_operand(p_instr, p_frame, p_instr->argc);
+#ifdef DEBUG_ENABLED
+	bool freed = false;
+	return base->get_validated_object_with_check(freed);
+#else
+	return *VariantInternal::get_object(base);
+#endif
+}
+
+template <class T, Variant::Type t_type>
+static const Instruction *_call_ptrcall(const Instruction *p_instr, Frame &p_frame) {
+	Object *base_obj = _get_ptrcall_base(p_instr, p_frame);
+#ifdef DEBUG_ENABLED
+	if (unlikely(!base_obj)) {
+		return _deopt(p_instr, p_frame);
+	}
+#endif
+	Variant *ret = _get_operand(p_instr, p_frame, p_instr->argc + 1);
+	VariantInternal::initialize(ret, t_type);
+	p_instr->method->ptrcall(base_obj, p_frame.call_args, VariantGetInternalPtr<T>::get_ptr(ret));
+	return p_instr + 1;
+}
+
+static const Instruction *_call_ptrcall_object(const Instruction *p_instr, Frame &p_frame) {
+	Object *base_obj = _get_ptrcall_base(p_instr, p_frame);
+#ifdef DEBUG_ENABLED
+	if (unlikely(!base_obj)) {
+		return _deopt(p_instr, p_frame);
+	}
+#endif
+	Variant *ret = _get_operand(p_instr, p_frame, p_instr->argc + 1);
+	VariantInternal::initialize(ret, Variant::OBJECT);
+	p_instr->method->ptrcall(base_obj, p_frame.call_args, VariantInternal::get_object(ret));
+	VariantInternal::update_object_id(ret);
+	return p_instr + 1;
+}
+
+static const Instruction *_call_ptrcall_no_return(const Instruction *p_instr, Frame &p_frame) {
+	Object *base_obj = _get_ptrcall_base(p_instr, p_frame);
+#ifdef DEBUG_ENABLED
+	if (unlikely(!base_obj)) {
+		return _deopt(p_instr, p_frame);
+	}
+#endif
+	VariantInternal::initialize(_get_operand(p_instr, p_frame, p_instr->argc + 1), Variant::NIL);
+	p_instr->method->ptrcall(base_obj, p_frame.call_args, nullptr);
+	return p_instr + 1;
+}
+
+static const Instruction *_call_builtin_type_validated(const Instruction *p_instr, Frame &p_frame) {
+	const Variant **args = _get_arguments(p_instr, p_frame);
+	p_instr->builtin_method(_get_operand(p_instr, p_frame, p_instr->argc), args, p_instr->argc, _get_operand(p_instr, p_frame, p_instr->argc + 1));
+	return p_instr + 1;
+}
+
+static const Instruction *_call_utility_validated(const Instruction *p_instr, Frame &p_frame) {
+	const Variant **args = _get_arguments(p_instr, p_frame);
+	p_instr->utility(_get_operand(p_instr, p_frame, p_instr->argc), args, p_instr->argc);
+	return p_instr + 1;
+}
+
+static const Instruction *_jump(const Instruction *p_instr, Frame &p_frame) {
+	return p_instr->target;
+}
+
+static const Instruction *_jump_if(const Instruction *p_instr, Frame &p_frame) {
+	return _get_operand(p_instr, p_frame, 0)->booleanize() ? p_instr->target : p_instr + 1;
+}
+
+static const Instruction *_jump_if_not(const Instruction *p_instr, Frame &p_frame) {
+	return _get_operand(p_instr, p_frame, 0)->booleanize() ? p_instr + 1 : p_instr->target;
+}
+
+static const Instruction *_jump_if_shared(const Instruction *p_instr, Frame &p_frame) {
+	return _get_operand(p_instr, p_frame, 0)->is_shared() ? p_instr->target : p_instr + 1;
+}
+
+static const Instruction *_jump_to_def_argument(const Instruction *p_instr, Frame &p_frame) {
+	return p_instr->default_arg_targets[p_frame.defarg];
+}
+
+static const Instruction *_return(const Instruction *p_instr, Frame &p_frame) {
+	*p_frame.retvalue = *_get_operand(p_instr, p_frame, 0);
+	return nullptr;
+}
+
+static const Instruction *_return_typed_builtin(const Instruction *p_instr, Frame &p_frame) {
+	Variant *r = _get_operand(p_instr, p_frame, 0);
+	Variant::Type ret_type = (Variant::Type)p_instr->value;
+
+	if (likely(r->get_type() == ret_type)) {
+		*p_frame.retvalue = *r;
+		return nullptr;
+	}
+	if (!Variant::can_convert_strict(r->get_type(), ret_type)) {
+		// Leave the error (and the fallback value) to the interpreter.
+		return _deopt(p_instr, p_frame);
+	}
+	Callable::CallError ce;
+	Variant::construct(ret_type, *p_frame.retvalue, const_cast<const Variant **>(&r), 1, ce);
+	return nullptr;
+}
+
+static const Instruction *_iterate_begin_int(const Instruction *p_instr, Frame &p_frame) {
+	Variant *counter = _get_operand(p_instr, p_frame, 0);
+	int64_t size = *VariantInternal::get_int(_get_operand(p_instr, p_frame, 1));
+
+	VariantInternal::initialize(counter, Variant::INT);
+	*VariantInternal::get_int(counter) = 0;
+
+	if (size <= 0) {
+		return p_instr->target;
+	}
+
+	Variant *iterator = _get_operand(p_instr, p_frame, 2);
+	VariantInternal::initialize(iterator, Variant::INT);
+	*VariantInternal::get_int(iterator) = 0;
+	return p_instr + 1;
+}
+
+static const Instruction *_iterate_int(const Instruction *p_instr, Frame &p_frame) {
+	int64_t size = *VariantInternal::get_int(_get_operand(p_instr, p_frame, 1));
+	int64_t *count = VariantInternal::get_int(_get_operand(p_instr, p_frame, 0));
+
+	(*count)++;
+	if (*count >= size) {
+		return p_instr->target;
+	}
+
+	*VariantInternal::get_int(_get_operand(p_instr, p_frame, 2)) = *count;
+	return p_instr + 1;
+}
+
+template <class T>
+static const Instruction *_type_adjust(const Instruction *p_instr, Frame &p_frame) {
+	VariantTypeAdjust<T>::adjust(_get_operand(p_instr, p_frame, 0));
+	return p_instr + 1;
+}
+
+static const Instruction *_assert(const Instruction *p_instr, Frame &p_frame) {
+#ifdef DEBUG_ENABLED
+	if (!_get_operand(p_instr, p_frame, 0)->booleanize()) {
+		return _deopt(p_instr, p_frame);
+	}
+#endif
+	return p_instr + 1;
+}
+
+static const Instruction *_line(const Instruction *p_instr, Frame &p_frame) {
+	p_frame.line = p_instr->value;
+	return p_instr + 1;
+}
+
+static const Instruction *_skip(const Instruction *p_instr, Frame &p_frame) {
+	return p_instr + 1;
+}
+
+static const Instruction *_end(const Instruction *p_instr, Frame &p_frame) {
+	return nullptr;
+}
+
+bool GDScriptThreadedCode::_add_operand(const GDScriptFunction *p_function, int p_address) {
+	Operand operand;
+	operand.base = (p_address & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS;
+	operand.index = p_address & GDScriptFunction::ADDR_MASK;
+
+	switch (operand.base) {
+		case GDScriptFunction::ADDR_TYPE_STACK: {
+			ERR_FAIL_COND_V((int)operand.index >= p_function->_stack_size, false);
+		} break;
+		case GDScriptFunction::ADDR_TYPE_CONSTANT: {
+			ERR_FAIL_COND_V((int)operand.index >= p_function->_constant_count, false);
+		} break;
+		case GDScriptFunction::ADDR_TYPE_MEMBER: {
+			member_count = MAX(member_count, (int)operand.index + 1);
+		} break;
+		default: {
+			ERR_FAIL_V_MSG(false, "Bad code! (unknown addressing mode).");
+		}
+	}
+
+	operands.push_back(operand);
+	return true;
+}
+
+bool GDScriptThreadedCode::_translate(const GDScriptFunction *p_function) {
+	const int *code = p_function->_code_ptr;
+	const int code_size = p_function->_code_size;
+
+	// Maps each bytecode address to the instruction starting there, or -1.
+	LocalVector<int> instruction_at;
+	instruction_at.resize(code_size);
+	for (int i = 0; i < code_size; i++) {
+		instruction_at[i] = -1;
+	}
+
+	LocalVector<uint32_t> operand_offsets;
+	LocalVector<int> jump_addresses;
+
+	int ip = 0;
+	while (ip < code_size) {
+		const int opcode = code[ip] & GDScriptFunction::INSTR_MASK;
+		const int arg_count = (code[ip] & GDScriptFunction::INSTR_ARGS_MASK) >> GDScriptFunction::INSTR_BITS;
+		if (ip + 1 + arg_count > code_size) {
+			return false;
+		}
+
+		Instruction instr;
+		instr.ip = ip;
+		operand_offsets.push_back(operands.size());
+		for (int i = 0; i < arg_count; i++) {
+			if (!_add_operand(p_function, code[ip + 1 + i])) {
+				return false;
+			}
+		}
+
+		// Words stored after the operands, and how many of them the opcode uses.
+		const int *extra = code + ip + 1 + arg_count;
+		int extra_count = 0;
+		int jump_to = -1;
+
+#define CHECK_EXTRA(m_count)                            \
+	extra_count = m_count;                              \
+	if (ip + 1 + arg_count + extra_count > code_size) { \
+		return false;                                   \
+	}
+#define CHECK_INDEX(m_idx, m_count)            \
+	if ((m_idx) < 0 || (m_idx) >= (m_count)) { \
+		return false;                          \
+	}
+// Calls store their argument count and callee index after the operands.
+#define SETUP_CALL(m_extra_operands)                                      \
+	CHECK_EXTRA(2);                                                       \
+	instr.argc = extra[0];                                                \
+	if (instr.argc < 0 || instr.argc + (m_extra_operands) != arg_count) { \
+		return false;                                                     \
+	}
+
+		switch (opcode) {
+			case GDScriptFunction::OPCODE_OPERATOR_VALIDATED: {
+				CHECK_EXTRA(1);
+				CHECK_INDEX(extra[0], p_function->_operator_funcs_count);
+				instr.handler = _operator_validated;
+				instr.operator_func = p_function->_operator_funcs_ptr[extra[0]];
+			} break;
+			case GDScriptFunction::OPCODE_OPERATOR_INT: {
+				CHECK_EXTRA(1);
+				instr.handler = _get_operator_typed_handler<int64_t>((Variant::Operator)extra[0]);
+			} break;
+			case GDScriptFunction::OPCODE_OPERATOR_FLOAT: {
+				CHECK_EXTRA(1);
+				instr.handler = _get_operator_typed_handler<double>((Variant::Operator)extra[0]);
+			} break;
+			case GDScriptFunction::OPCODE_OPERATOR_VECTOR2: {
+				CHECK_EXTRA(1);
+				instr.handler = _get_operator_typed_handler<Vector2>((Variant::Operator)extra[0]);
+			} break;
+			case GDScriptFunction::OPCODE_OPERATOR_VECTOR3: {
+				CHECK_EXTRA(1);
+				instr.handler = _get_operator_typed_handler<Vector3>((Variant::Operator)extra[0]);
+			} break;
+			case GDScriptFunction::OPCODE_SET_KEYED_VALIDATED: {
+				CHECK_EXTRA(1);
+				CHECK_INDEX(extra[0], p_function->_keyed_setters_count);
+				instr.handler = _set_keyed_validated;
+				instr.keyed_setter = p_function->_keyed_setters_ptr[extra[0]];
+			} break;
+			case GDScriptFunction::OPCODE_SET_INDEXED_VALIDATED: {
+				CHECK_EXTRA(1);
+				CHECK_INDEX(extra[0], p_function->_indexed_setters_count);
+				instr.handler = _set_indexed_validated;
+				instr.indexed_setter = p_function->_indexed_setters_ptr[extra[0]];
+			} break;
+			case GDScriptFunction::OPCODE_GET_KEYED_VALIDATED: {
+				CHECK_EXTRA(1);
+				CHECK_INDEX(extra[0], p_function->_keyed_getters_count);
+				instr.handler = _get_keyed_validated;
+				instr.keyed_getter = p_function->_keyed_getters_ptr[extra[0]];
+			} break;
+			case GDScriptFunction::OPCODE_GET_INDEXED_VALIDATED: {
+				CHECK_EXTRA(1);
+				CHECK_INDEX(extra[0], p_function->_indexed_getters_count);
+				instr.handler = _get_indexed_validated;
+				instr.indexed_getter = p_function->_indexed_getters_ptr[extra[0]];
+			} break;
+			case GDScriptFunction::OPCODE_SET_NAMED_VALIDATED: {
+				CHECK_EXTRA(1);
+				CHECK_INDEX(extra[0], p_function->_setters_count);
+				instr.handler = _set_named_validated;
+				instr.setter = p_function->_setters_ptr[extra[0]];
+			} break;
+			case GDScriptFunction::OPCODE_GET_NAMED_VALIDATED: {
+				CHECK_EXTRA(1);
+				CHECK_INDEX(extra[0], p_function->_getters_count);
+				instr.handler = _get_named_validated;
+				instr.getter = p_function->_getters_ptr[extra[0]];
+			} break;
+			case GDScriptFunction::OPCODE_ASSIGN: {
+				instr.handler = _assign;
+			} break;
+			case GDScriptFunction::OPCODE_ASSIGN_TRUE: {
+				instr.handler = _assign_true;
+			} break;
+			case GDScriptFunction::OPCODE_ASSIGN_FALSE: {
+				instr.handler = _assign_false;
+			} break;
+			case GDScriptFunction::OPCODE_ASSIGN_TYPED_BUILTIN: {
+				CHECK_EXTRA(1);
+				CHECK_INDEX(extra[0], Variant::VARIANT_MAX);
+				instr.handler = _assign_typed_builtin;
+				instr.value = extra[0];
+			} break;
+			case GDScriptFunction::OPCODE_CONSTRUCT_VALIDATED: {
+				SETUP_CALL(1);
+				CHECK_INDEX(extra[1], p_function->_constructors_count);
+				instr.handler = _construct_validated;
+				instr.constructor = p_function->_constructors_ptr[extra[1]];
+			} break;
+			case GDScriptFunction::OPCODE_CALL_BUILTIN_TYPE_VALIDATED: {
+				SETUP_CALL(2);
+				CHECK_INDEX(extra[1], p_function->_builtin_methods_count);
+				instr.handler = _call_builtin_type_validated;
+				instr.builtin_method = p_function->_builtin_methods_ptr[extra[1]];
+			} break;
+			case GDScriptFunction::OPCODE_CALL_UTILITY_VALIDATED: {
+				SETUP_CALL(1);
+				CHECK_INDEX(extra[1], p_function->_utilities_count);
+				instr.handler = _call_utility_validated;
+				instr.utility = p_function->_utilities_ptr[extra[1]];
+			} break;
+
+#define CASE_PTRCALL(m_type, m_c_type)                            \
+	case GDScriptFunction::OPCODE_CALL_PTRCALL_##m_type: {        \
+		instr.handler = _call_ptrcall<m_c_type, Variant::m_type>; \
+	} break
+
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_NO_RETURN:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_BOOL:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_INT:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_FLOAT:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_STRING:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_VECTOR2:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_VECTOR2I:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_RECT2:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_RECT2I:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_VECTOR3:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_VECTOR3I:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_TRANSFORM2D:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_VECTOR4:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_VECTOR4I:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_PLANE:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_QUATERNION:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_AABB:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_BASIS:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_TRANSFORM3D:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_PROJECTION:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_COLOR:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_STRING_NAME:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_NODE_PATH:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_RID:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_OBJECT:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_CALLABLE:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_SIGNAL:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_DICTIONARY:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_ARRAY:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_PACKED_BYTE_ARRAY:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_PACKED_INT32_ARRAY:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_PACKED_INT64_ARRAY:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_PACKED_FLOAT32_ARRAY:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_PACKED_FLOAT64_ARRAY:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_PACKED_STRING_ARRAY:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_PACKED_VECTOR2_ARRAY:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_PACKED_VECTOR3_ARRAY:
+			case GDScriptFunction::OPCODE_CALL_PTRCALL_PACKED_COLOR_ARRAY: {
+				SETUP_CALL(2);
+				CHECK_INDEX(extra[1], p_function->_methods_count);
+				instr.method = p_function->_methods_ptr[extra[1]];
+				switch (opcode) {
+					case GDScriptFunction::OPCODE_CALL_PTRCALL_NO_RETURN: {
+						instr.handler = _call_ptrcall_no_return;
+					} break;
+					case GDScriptFunction::OPCODE_CALL_PTRCALL_OBJECT: {
+						instr.handler = _call_ptrcall_object;
+					} break;
+					CASE_PTRCALL(BOOL, bool);
+					CASE_PTRCALL(INT, int64_t);
+					CASE_PTRCALL(FLOAT, double);
+					CASE_PTRCALL(STRING, String);
+					CASE_PTRCALL(VECTOR2, Vector2);
+					CASE_PTRCALL(VECTOR2I, Vector2i);
+					CASE_PTRCALL(RECT2, Rect2);
+					CASE_PTRCALL(RECT2I, Rect2i);
+					CASE_PTRCALL(VECTOR3, Vector3);
+					CASE_PTRCALL(VECTOR3I, Vector3i);
+					CASE_PTRCALL(TRANSFORM2D, Transform2D);
+					CASE_PTRCALL(VECTOR4, Vector4);
+					CASE_PTRCALL(VECTOR4I, Vector4i);
+					CASE_PTRCALL(PLANE, Plane);
+					CASE_PTRCALL(QUATERNION, Quaternion);
+					CASE_PTRCALL(AABB, AABB);
+					CASE_PTRCALL(BASIS, Basis);
+					CASE_PTRCALL(TRANSFORM3D, Transform3D);
+					CASE_PTRCALL(PROJECTION, Projection);
+					CASE_PTRCALL(COLOR, Color);
+					CASE_PTRCALL(STRING_NAME, StringName);
+					CASE_PTRCALL(NODE_PATH, NodePath);
+					CASE_PTRCALL(RID, RID);
+					CASE_PTRCALL(CALLABLE, Callable);
+					CASE_PTRCALL(SIGNAL, Signal);
+					CASE_PTRCALL(DICTIONARY, Dictionary);
+					CASE_PTRCALL(ARRAY, Array);
+					CASE_PTRCALL(PACKED_BYTE_ARRAY, PackedByteArray);
+					CASE_PTRCALL(PACKED_INT32_ARRAY, PackedInt32Array);
+					CASE_PTRCALL(PACKED_INT64_ARRAY, PackedInt64Array);
+					CASE_PTRCALL(PACKED_FLOAT32_ARRAY, PackedFloat32Array);
+					CASE_PTRCALL(PACKED_FLOAT64_ARRAY, PackedFloat64Array);
+					CASE_PTRCALL(PACKED_STRING_ARRAY, PackedStringArray);
+					CASE_PTRCALL(PACKED_VECTOR2_ARRAY, PackedVector2Array);
+					CASE_PTRCALL(PACKED_VECTOR3_ARRAY, PackedVector3Array);
+					CASE_PTRCALL(PACKED_COLOR_ARRAY, PackedColorArray);
+					default: {
+						return false;
+					}
+				}
+			} break;
+#undef CASE_PTRCALL
+
+			case GDScriptFunction::OPCODE_JUMP: {
+				CHECK_EXTRA(1);
+				instr.handler = _jump;
+				jump_to = extra[0];
+			} break;
+			case GDScriptFunction::OPCODE_JUMP_IF: {
+				CHECK_EXTRA(1);
+				instr.handler = _jump_if;
+				jump_to = extra[0];
+			} break;
+			case GDScriptFunction::OPCODE_JUMP_IF_NOT: {
+				CHECK_EXTRA(1);
+				instr.handler = _jump_if_not;
+				jump_to = extra[0];
+			} break;
+			case GDScriptFunction::OPCODE_JUMP_IF_SHARED: {
+				CHECK_EXTRA(1);
+				instr.handler = _jump_if_shared;
+				jump_to = extra[0];
+			} break;
+			case GDScriptFunction::OPCODE_JUMP_TO_DEF_ARGUMENT: {
+				instr.handler = _jump_to_def_argument;
+			} break;
+			case GDScriptFunction::OPCODE_RETURN: {
+				instr.handler = _return;
+			} break;
+			case GDScriptFunction::OPCODE_RETURN_TYPED_BUILTIN: {
+				CHECK_EXTRA(1);
+				CHECK_INDEX(extra[0], Variant::VARIANT_MAX);
+				instr.handler = _return_typed_builtin;
+				instr.value = extra[0];
+			} break;
+			case GDScriptFunction::OPCODE_ITERATE_BEGIN_INT: {
+				CHECK_EXTRA(1);
+				instr.handler = _iterate_begin_int;
+				jump_to = extra[0];
+			} break;
+			case GDScriptFunction::OPCODE_ITERATE_INT: {
+				CHECK_EXTRA(1);
+				instr.handler = _iterate_int;
+				jump_to = extra[0];
+			} break;
+
+#define CASE_TYPE_ADJUST(m_v_type, m_c_type)                \
+	case GDScriptFunction::OPCODE_TYPE_ADJUST_##m_v_type: { \
+		instr.handler = _type_adjust<m_c_type>;             \
+	} break
+
+			CASE_TYPE_ADJUST(BOOL, bool);
+			CASE_TYPE_ADJUST(INT, int64_t);
+			CASE_TYPE_ADJUST(FLOAT, double);
+			CASE_TYPE_ADJUST(STRING, String);
+			CASE_TYPE_ADJUST(VECTOR2, Vector2);
+			CASE_TYPE_ADJUST(VECTOR2I, Vector2i);
+			CASE_TYPE_ADJUST(RECT2, Rect2);
+			CASE_TYPE_ADJUST(RECT2I, Rect2i);
+			CASE_TYPE_ADJUST(VECTOR3, Vector3);
+			CASE_TYPE_ADJUST(VECTOR3I, Vector3i);
+			CASE_TYPE_ADJUST(TRANSFORM2D, Transform2D);
+			CASE_TYPE_ADJUST(VECTOR4, Vector4);
+			CASE_TYPE_ADJUST(VECTOR4I, Vector4i);
+			CASE_TYPE_ADJUST(PLANE, Plane);
+			CASE_TYPE_ADJUST(QUATERNION, Quaternion);
+			CASE_TYPE_ADJUST(AABB, AABB);
+			CASE_TYPE_ADJUST(BASIS, Basis);
+			CASE_TYPE_ADJUST(TRANSFORM3D, Transform3D);
+			CASE_TYPE_ADJUST(PROJECTION, Projection);
+			CASE_TYPE_ADJUST(COLOR, Color);
+			CASE_TYPE_ADJUST(STRING_NAME, StringName);
+			CASE_TYPE_ADJUST(NODE_PATH, NodePath);
+			CASE_TYPE_ADJUST(RID, RID);
+			CASE_TYPE_ADJUST(OBJECT, Object *);
+			CASE_TYPE_ADJUST(CALLABLE, Callable);
+			CASE_TYPE_ADJUST(SIGNAL, Signal);
+			CASE_TYPE_ADJUST(DICTIONARY, Dictionary);
+			CASE_TYPE_ADJUST(ARRAY, Array);
+			CASE_TYPE_ADJUST(PACKED_BYTE_ARRAY, PackedByteArray);
+			CASE_TYPE_ADJUST(PACKED_INT32_ARRAY, PackedInt32Array);
+			CASE_TYPE_ADJUST(PACKED_INT64_ARRAY, PackedInt64Array);
+			CASE_TYPE_ADJUST(PACKED_FLOAT32_ARRAY, PackedFloat32Array);
+			CASE_TYPE_ADJUST(PACKED_FLOAT64_ARRAY, PackedFloat64Array);
+			CASE_TYPE_ADJUST(PACKED_STRING_ARRAY, PackedStringArray);
+			CASE_TYPE_ADJUST(PACKED_VECTOR2_ARRAY, PackedVector2Array);
+			CASE_TYPE_ADJUST(PACKED_VECTOR3_ARRAY, PackedVector3Array);
+			CASE_TYPE_ADJUST(PACKED_COLOR_ARRAY, PackedColorArray);
+#undef CASE_TYPE_ADJUST
+
+			case GDScriptFunction::OPCODE_ASSERT: {
+				if (arg_count < 1) {
+					return false;
+				}
+				instr.handler = _assert;
+			} break;
+			case GDScriptFunction::OPCODE_BREAKPOINT: {
+				// Debugger sessions always run in the interpreter.
+				instr.handler = _skip;
+			} break;
+			case GDScriptFunction::OPCODE_LINE: {
+				CHECK_EXTRA(1);
+				instr.handler = _line;
+				instr.value = extra[0];
+			} break;
+			case GDScriptFunction::OPCODE_END: {
+				instr.handler = _end;
+			} break;
+			default: {
+				// Untyped or suspending code, only the interpreter runs it.
+				return false;
+			}
+		}
+		if (!instr.handler) {
+			return false;
+		}
+
+#undef SETUP_CALL
+#undef CHECK_INDEX
+#undef CHECK_EXTRA
+
+		instruction_at[ip] = instructions.size();
+		instructions.push_back(instr);
+		jump_addresses.push_back(jump_to);
+		ip += 1 + arg_count + extra_count;
+	}
+
+	// The instruction list doesn't grow anymore, so pointers into it can be resolved.
+	for (uint32_t i = 0; i < instructions.size(); i++) {
+		Instruction &instr = instructions[i];
+		instr.operands = operands.ptr() + operand_offsets[i];
+		if (jump_addresses[i] >= 0) {
+			if (jump_addresses[i] >= code_size || instruction_at[jump_addresses[i]] < 0) {
+				return false;
+			}
+			instr.target = &instructions[instruction_at[jump_addresses[i]]];
+		}
+	}
+
+	default_arg_targets.resize(p_function->default_arguments.size());
+	for (int i = 0; i < p_function->default_arguments.size(); i++) {
+		int address = p_function->default_arguments[i];
+		if (address < 0 || address >= code_size || instruction_at[address] < 0) {
+			return false;
+		}
+		default_arg_targets[i] = &instructions[instruction_at[address]];
+	}
+	for (uint32_t i = 0; i < instructions.size(); i++) {
+		if (instructions[i].handler == _jump_to_def_argument) {
+			instructions[i].default_arg_targets = default_arg_targets.ptr();
+		}
+	}
+
+	return !instructions.is_empty() && instructions[instructions.size() - 1].handler == _end;
+}
+
+GDScriptThreadedCode *GDScriptThreadedCode::create(const GDScriptFunction *p_function) {
+	if (!p_function->_code_ptr) {
+		return nullptr;
+	}
+
+	GDScriptThreadedCode *threaded_code = memnew(GDScriptThreadedCode);
+	if (!threaded_code->_translate(p_function)) {
+		memdelete(threaded_code);
+		return nullptr;
+	}
+	return threaded_code;
+}
+
+bool GDScriptThreadedCode::execute(Frame &p_frame, int &r_ip) const {
+	if (unlikely(p_frame.member_count < member_count)) {
+		// No instance to read members from, let the interpreter report it.
+		r_ip = 0;
+		return false;
+	}
+
+	const Instruction *instr = instructions.ptr();
+	while (instr) {
+		instr = instr->handler(instr, p_frame);
+	}
+
+	if (p_frame.deopt_ip >= 0) {
+		r_ip = p_frame.deopt_ip;
+		return false;
+	}
+	return true;
+}
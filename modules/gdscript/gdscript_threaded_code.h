@@ -0,0 +1,112 @@
+/*************************************************************************/
+/*  gdscript_threaded_code.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_THREADED_CODE_H
+#define GDSCRIPT_THREADED_CODE_H
+
+#include "core/templates/local_vector.h"
+#include "core/variant/variant.h"
+
+class GDScriptFunction;
+class MethodBind;
+
+// Faster execution tier for fully typed functions. The bytecode is decoded once into
+// a list of instructions, each pointing to a native handler with its operands and
+// callees already resolved, so running it skips the opcode dispatch and operand
+// decoding of the interpreter. Functions using any opcode without a handler are not
+// translated. When a handler hits a runtime error, it stops and the interpreter
+// resumes at the same bytecode address, so errors are reported exactly as before.
+class GDScriptThreadedCode {
+public:
+	struct Frame {
+		Variant *bases[3] = {}; // Indexed by GDScriptFunction::ADDR_TYPE_*.
+		int member_count = 0;
+		Variant **instruction_args = nullptr;
+		const void **call_args = nullptr;
+		Variant *retvalue = nullptr;
+		int defarg = 0;
+		int line = 0;
+		int deopt_ip = -1;
+	};
+
+	struct Operand {
+		uint32_t base = 0;
+		uint32_t index = 0;
+	};
+
+	struct Instruction;
+	typedef const Instruction *(*Handler)(const Instruction *p_instr, Frame &p_frame);
+
+	struct Instruction {
+		Handler handler = nullptr;
+		int ip = 0; // Bytecode address, where the interpreter resumes.
+		int argc = 0;
+		int value = 0; // Variant type or line, depending on the handler.
+		const Operand *operands = nullptr;
+		const Instruction *target = nullptr;
+		union {
+			Variant::ValidatedOperatorEvaluator operator_func = nullptr;
+			Variant::ValidatedSetter setter;
+			Variant::ValidatedGetter getter;
+			Variant::ValidatedKeyedSetter keyed_setter;
+			Variant::ValidatedKeyedGetter keyed_getter;
+			Variant::ValidatedIndexedSetter indexed_setter;
+			Variant::ValidatedIndexedGetter indexed_getter;
+			Variant::ValidatedConstructor constructor;
+			Variant::ValidatedBuiltInMethod builtin_method;
+			Variant::ValidatedUtilityFunction utility;
+			MethodBind *method;
+			const Instruction *const *default_arg_targets;
+		};
+	};
+
+private:
+	LocalVector<Instruction> instructions;
+	LocalVector<Operand> operands;
+	LocalVector<const Instruction *> default_arg_targets;
+	int member_count = 0;
+
+	bool _add_operand(const GDScriptFunction *p_function, int p_address);
+	bool _translate(const GDScriptFunction *p_function);
+
+	GDScriptThreadedCode() {}
+
+public:
+	// Returns nullptr if the function can't be translated.
+	static GDScriptThreadedCode *create(const GDScriptFunction *p_function);
+
+	// Returns false if execution stopped early. In that case the interpreter
+	// must continue from r_ip, with the line stored in the frame.
+	bool execute(Frame &p_frame, int &r_ip) const;
+
+	int get_instruction_count() const { return instructions.size(); }
+};
+
+#endif // GDSCRIPT_THREADED_CODE_H
@@ -0,0 +1,152 @@
+/*************************************************************************/
+/*  gdscript_typed_operators.h                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_TYPED_OPERATORS_H
+#define GDSCRIPT_TYPED_OPERATORS_H
+
+#include "core/variant/variant.h"
+#include "core/variant/variant_internal.h"
+
+// Operators on two values of the same numeric type, run by the OPCODE_OPERATOR_<TYPE>
+// instructions. They read and write the raw storage of the Variants without going
+// through a validated evaluator. Like validated evaluators, they expect the result
+// to already hold the result type.
+struct GDScriptTypedOperator {
+	static bool is_supported(Variant::Operator p_operator, Variant::Type p_type) {
+		switch (p_type) {
+			case Variant::INT:
+			case Variant::FLOAT:
+			case Variant::VECTOR2:
+			case Variant::VECTOR3:
+				break;
+			default:
+				return false;
+		}
+
+		switch (p_operator) {
+			case Variant::OP_ADD:
+			case Variant::OP_SUBTRACT:
+			case Variant::OP_MULTIPLY:
+			case Variant::OP_EQUAL:
+			case Variant::OP_NOT_EQUAL:
+			case Variant::OP_LESS:
+			case Variant::OP_LESS_EQUAL:
+			case Variant::OP_GREATER:
+			case Variant::OP_GREATER_EQUAL:
+				return true;
+			case Variant::OP_DIVIDE:
+				// Integer division needs the division by zero check.
+				return p_type != Variant::INT;
+			default:
+				return false;
+		}
+	}
+
+	template <class T, Variant::Operator t_operator>
+	static _FORCE_INLINE_ void evaluate(const Variant *p_left, const Variant *p_right, Variant *r_ret) {
+		const T &a = *VariantGetInternalPtr<T>::get_ptr(p_left);
+		const T &b = *VariantGetInternalPtr<T>::get_ptr(p_right);
+
+		switch (t_operator) {
+			case Variant::OP_ADD:
+				*VariantGetInternalPtr<T>::get_ptr(r_ret) = a + b;
+				break;
+			case Variant::OP_SUBTRACT:
+				*VariantGetInternalPtr<T>::get_ptr(r_ret) = a - b;
+				break;
+			case Variant::OP_MULTIPLY:
+				*VariantGetInternalPtr<T>::get_ptr(r_ret) = a * b;
+				break;
+			case Variant::OP_DIVIDE:
+				*VariantGetInternalPtr<T>::get_ptr(r_ret) = a / b;
+				break;
+			case Variant::OP_EQUAL:
+				*VariantInternal::get_bool(r_ret) = a == b;
+				break;
+			case Variant::OP_NOT_EQUAL:
+				*VariantInternal::get_bool(r_ret) = a != b;
+				break;
+			case Variant::OP_LESS:
+				*VariantInternal::get_bool(r_ret) = a < b;
+				break;
+			case Variant::OP_LESS_EQUAL:
+				*VariantInternal::get_bool(r_ret) = a <= b;
+				break;
+			case Variant::OP_GREATER:
+				*VariantInternal::get_bool(r_ret) = a > b;
+				break;
+			case Variant::OP_GREATER_EQUAL:
+				*VariantInternal::get_bool(r_ret) = a >= b;
+				break;
+			default:
+				break;
+		}
+	}
+
+	template <class T>
+	static _FORCE_INLINE_ void evaluate(Variant::Operator p_operator, const Variant *p_left, const Variant *p_right, Variant *r_ret) {
+		switch (p_operator) {
+			case Variant::OP_ADD:
+				evaluate<T, Variant::OP_ADD>(p_left, p_right, r_ret);
+				break;
+			case Variant::OP_SUBTRACT:
+				evaluate<T, Variant::OP_SUBTRACT>(p_left, p_right, r_ret);
+				break;
+			case Variant::OP_MULTIPLY:
+				evaluate<T, Variant::OP_MULTIPLY>(p_left, p_right, r_ret);
+				break;
+			case Variant::OP_DIVIDE:
+				evaluate<T, Variant::OP_DIVIDE>(p_left, p_right, r_ret);
+				break;
+			case Variant::OP_EQUAL:
+				evaluate<T, Variant::OP_EQUAL>(p_left, p_right, r_ret);
+				break;
+			case Variant::OP_NOT_EQUAL:
+				evaluate<T, Variant::OP_NOT_EQUAL>(p_left, p_right, r_ret);
+				break;
+			case Variant::OP_LESS:
+				evaluate<T, Variant::OP_LESS>(p_left, p_right, r_ret);
+				break;
+			case Variant::OP_LESS_EQUAL:
+				evaluate<T, Variant::OP_LESS_EQUAL>(p_left, p_right, r_ret);
+				break;
+			case Variant::OP_GREATER:
+				evaluate<T, Variant::OP_GREATER>(p_left, p_right, r_ret);
+				break;
+			case Variant::OP_GREATER_EQUAL:
+				evaluate<T, Variant::OP_GREATER_EQUAL>(p_left, p_right, r_ret);
+				break;
+			default:
+				break;
+		}
+	}
+};
+
+#endif // GDSCRIPT_TYPED_OPERATORS_H
@@ -33,7 +33,10 @@
 #include "core/core_string_names.h"
 #include "core/os/os.h"
 #include "gdscript.h"
+#include "gdscript_inline_cache.h"
 #include "gdscript_lambda_callable.h"
+#include "gdscript_threaded_code.h"
+#include "gdscript_typed_operators.h"
 
 Variant *GDScriptFunction::_get_variant(int p_address, GDScriptInstance *p_instance, Variant *p_stack, String &r_error) const {
 	int address = p_address & ADDR_MASK;
@@ -232,6 +235,10 @@ void (*type_init_function_table[])(Variant *) = {
 	static const void *switch_table_ops[] = {        \
 		&&OPCODE_OPERATOR,                           \
 		&&OPCODE_OPERATOR_VALIDATED,                 \
+		&&OPCODE_OPERATOR_INT,                       \
+		&&OPCODE_OPERATOR_FLOAT,                     \
+		&&OPCODE_OPERATOR_VECTOR2,                   \
+		&&OPCODE_OPERATOR_VECTOR3,                   \
 		&&OPCODE_EXTENDS_TEST,                       \
 		&&OPCODE_IS_BUILTIN,                         \
 		&&OPCODE_SET_KEYED,                          \
@@ -259,8 +266,10 @@ void (*type_init_function_table[])(Variant *) = {
 		&&OPCODE_CONSTRUCT,                          \
 		&&OPCODE_CONSTRUCT_VALIDATED,                \
 		&&OPCODE_CONSTRUCT_ARRAY,                    \
+		&&OPCODE_CONSTRUCT_ARRAY_REUSE,              \
 		&&OPCODE_CONSTRUCT_TYPED_ARRAY,              \
 		&&OPCODE_CONSTRUCT_DICTIONARY,               \
+		&&OPCODE_CONSTRUCT_DICTIONARY_REUSE,         \
 		&&OPCODE_CALL,                               \
 		&&OPCODE_CALL_RETURN,                        \
 		&&OPCODE_CALL_ASYNC,                         \
@@ -622,6 +631,16 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 #endif
 
+#ifdef DEBUG_ENABLED
+#define PROFILE_CONTAINER_ALLOCATION()                  \
+	if (GDScriptLanguage::get_singleton()->profiling) { \
+		profile.alloc_count++;                          \
+		profile.frame_alloc_count++;                    \
+	}
+#else
+#define PROFILE_CONTAINER_ALLOCATION()
+#endif
+
 #define GET_INSTRUCTION_ARG(m_v, m_idx) \
 	Variant *m_v = instruction_args[m_idx]
 
@@ -640,6 +659,37 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 	bool awaited = false;
 #endif
 
+	if (threaded_code && !p_state) {
+		bool use_threaded_code = true;
+#ifdef DEBUG_ENABLED
+		// The threaded code has no hooks for the debugger or the profiler.
+		use_threaded_code = !EngineDebugger::is_active() && !GDScriptLanguage::get_singleton()->profiling;
+#endif
+		if (use_threaded_code) {
+			GDScriptThreadedCode::Frame frame;
+			frame.bases[ADDR_TYPE_STACK] = stack;
+			frame.bases[ADDR_TYPE_CONSTANT] = _constants_ptr;
+			if (p_instance) {
+				frame.bases[ADDR_TYPE_MEMBER] = p_instance->members.ptrw();
+				frame.member_count = p_instance->members.size();
+			}
+			frame.instruction_args = instruction_args;
+			frame.call_args = call_args_ptr;
+			frame.retvalue = &retvalue;
+			frame.defarg = defarg;
+			frame.line = line;
+
+			if (threaded_code->execute(frame, ip)) {
+#ifdef DEBUG_ENABLED
+				exit_ok = true;
+#endif
+				goto threaded_code_done;
+			}
+			// Stopped on a runtime error, the interpreter takes over from that instruction.
+			line = frame.line;
+		}
+	}
+
 #ifdef DEBUG_ENABLED
 	OPCODE_WHILE(ip < _code_size) {
 		int last_opcode = _code_ptr[ip] & INSTR_MASK;
@@ -706,6 +756,22 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+#define OPCODE_OPERATOR_TYPED(m_type, m_c_type)                                                     \
+	OPCODE(OPCODE_OPERATOR_##m_type) {                                                              \
+		CHECK_SPACE(5);                                                                             \
+		GET_INSTRUCTION_ARG(a, 0);                                                                  \
+		GET_INSTRUCTION_ARG(b, 1);                                                                  \
+		GET_INSTRUCTION_ARG(dst, 2);                                                                \
+		GDScriptTypedOperator::evaluate<m_c_type>((Variant::Operator)_code_ptr[ip + 4], a, b, dst); \
+		ip += 5;                                                                                    \
+	}                                                                                               \
+	DISPATCH_OPCODE
+
+			OPCODE_OPERATOR_TYPED(INT, int64_t);
+			OPCODE_OPERATOR_TYPED(FLOAT, double);
+			OPCODE_OPERATOR_TYPED(VECTOR2, Vector2);
+			OPCODE_OPERATOR_TYPED(VECTOR3, Vector3);
+
 			OPCODE(OPCODE_EXTENDS_TEST) {
 				CHECK_SPACE(4);
 
@@ -984,7 +1050,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_SET_NAMED) {
-				CHECK_SPACE(3);
+				CHECK_SPACE(4);
 
 				GET_INSTRUCTION_ARG(dst, 0);
 				GET_INSTRUCTION_ARG(value, 1);
@@ -995,7 +1061,9 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				const StringName *index = &_global_names_ptr[indexname];
 
 				bool valid;
-				dst->set_named(*index, *value, valid);
+				if (!inline_cache->set_named(_code_ptr[ip + 4], dst, *index, *value, valid)) {
+					dst->set_named(*index, *value, valid);
+				}
 
 #ifdef DEBUG_ENABLED
 				if (!valid) {
@@ -1004,7 +1072,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					OPCODE_BREAK;
 				}
 #endif
-				ip += 4;
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
@@ -1034,22 +1102,20 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
-				bool valid;
-#ifdef DEBUG_ENABLED
-				//allow better error message in cases where src and dst are the same stack position
-				Variant ret = src->get_named(*index, valid);
-
-#else
-				*dst = src->get_named(*index, valid);
-#endif
+				// Always read into a temporary, src and dst may be the same stack position.
+				bool valid = true;
+				Variant ret;
+				if (!inline_cache->get_named(_code_ptr[ip + 4], src, *index, ret)) {
+					ret = src->get_named(*index, valid);
+				}
 #ifdef DEBUG_ENABLED
 				if (!valid) {
 					err_text = "Invalid get index '" + index->operator String() + "' (on base: '" + _get_var_type(src) + "').";
 					OPCODE_BREAK;
 				}
-				*dst = ret;
 #endif
-				ip += 4;
+				*dst = ret;
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
@@ -1445,6 +1511,31 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				*dst = Variant(); // Clear potential previous typed array.
 
 				*dst = array;
+				PROFILE_CONTAINER_ALLOCATION();
+
+				ip += 2;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_CONSTRUCT_ARRAY_REUSE) {
+				CHECK_SPACE(1 + instr_arg_count);
+				ip += instr_arg_count;
+
+				int argc = _code_ptr[ip + 1];
+				GET_INSTRUCTION_ARG(dst, argc);
+
+				// Only this instruction writes to the buffer, so after the first run it holds an
+				// untyped array nothing else uses anymore.
+				if (dst->get_type() != Variant::ARRAY) {
+					*dst = Array();
+					PROFILE_CONTAINER_ALLOCATION();
+				}
+				Array *array = VariantInternal::get_array(dst);
+				array->resize(argc);
+
+				for (int i = 0; i < argc; i++) {
+					(*array)[i] = *(instruction_args[i]);
+				}
 
 				ip += 2;
 			}
@@ -1474,6 +1565,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				*dst = Variant(); // Clear potential previous typed array.
 
 				*dst = array;
+				PROFILE_CONTAINER_ALLOCATION();
 
 				ip += 4;
 			}
@@ -1496,6 +1588,33 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GET_INSTRUCTION_ARG(dst, argc * 2);
 
 				*dst = dict;
+				PROFILE_CONTAINER_ALLOCATION();
+
+				ip += 2;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_CONSTRUCT_DICTIONARY_REUSE) {
+				CHECK_SPACE(2 + instr_arg_count);
+
+				ip += instr_arg_count;
+
+				int argc = _code_ptr[ip + 1];
+				GET_INSTRUCTION_ARG(dst, argc * 2);
+
+				// Same as arrays, the buffer can be refilled in place. Clearing keeps the hash table.
+				if (dst->get_type() != Variant::DICTIONARY) {
+					*dst = Dictionary();
+					PROFILE_CONTAINER_ALLOCATION();
+				}
+				Dictionary *dict = VariantInternal::get_dictionary(dst);
+				dict->clear();
+
+				for (int i = 0; i < argc; i++) {
+					GET_INSTRUCTION_ARG(k, i * 2 + 0);
+					GET_INSTRUCTION_ARG(v, i * 2 + 1);
+					(*dict)[*k] = *v;
+				}
 
 				ip += 2;
 			}
@@ -1504,7 +1623,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			OPCODE(OPCODE_CALL_ASYNC)
 			OPCODE(OPCODE_CALL_RETURN)
 			OPCODE(OPCODE_CALL) {
-				CHECK_SPACE(3 + instr_arg_count);
+				CHECK_SPACE(4 + instr_arg_count);
 				bool call_ret = (_code_ptr[ip] & INSTR_MASK) != OPCODE_CALL;
 #ifdef DEBUG_ENABLED
 				bool call_async = (_code_ptr[ip] & INSTR_MASK) == OPCODE_CALL_ASYNC;
@@ -1533,7 +1652,9 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				Callable::CallError err;
 				if (call_ret) {
 					GET_INSTRUCTION_ARG(ret, argc + 1);
-					base->callp(*methodname, (const Variant **)argptrs, argc, *ret, err);
+					if (!inline_cache->call(_code_ptr[ip + 3], base, *methodname, (const Variant **)argptrs, argc, *ret, err)) {
+						base->callp(*methodname, (const Variant **)argptrs, argc, *ret, err);
+					}
 #ifdef DEBUG_ENABLED
 					if (!call_async && ret->get_type() == Variant::OBJECT) {
 						// Check if getting a function state without await.
@@ -1552,7 +1673,9 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 #endif
 				} else {
 					Variant ret;
-					base->callp(*methodname, (const Variant **)argptrs, argc, ret, err);
+					if (!inline_cache->call(_code_ptr[ip + 3], base, *methodname, (const Variant **)argptrs, argc, ret, err)) {
+						base->callp(*methodname, (const Variant **)argptrs, argc, ret, err);
+					}
 				}
 #ifdef DEBUG_ENABLED
 				if (GDScriptLanguage::get_singleton()->profiling) {
@@ -1597,7 +1720,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 #endif
 
-				ip += 3;
+				ip += 4;
 			}
 			DISPATCH_OPCODE;
 
@@ -3472,6 +3595,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 		OPCODE_OUT;
 	}
 
+threaded_code_done:
 	OPCODES_OUT
 #ifdef DEBUG_ENABLED
 	if (GDScriptLanguage::get_singleton()->profiling) {
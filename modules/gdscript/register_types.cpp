@@ -36,6 +36,7 @@
 #include "core/io/resource_loader.h"
 #include "gdscript.h"
 #include "gdscript_analyzer.h"
+#include "gdscript_bytecode_cache.h"
 #include "gdscript_cache.h"
 #include "gdscript_tokenizer.h"
 #include "gdscript_utility_functions.h"
@@ -49,6 +50,7 @@ GDScriptLanguage *script_language_gd = nullptr;
 Ref<ResourceFormatLoaderGDScript> resource_loader_gd;
 Ref<ResourceFormatSaverGDScript> resource_saver_gd;
 GDScriptCache *gdscript_cache = nullptr;
+GDScriptBytecodeCache *gdscript_bytecode_cache = nullptr;
 
 #ifdef TOOLS_ENABLED
 
@@ -127,6 +129,7 @@ void initialize_gdscript_module(ModuleInitializationLevel p_level) {
 		ResourceSaver::add_resource_format_saver(resource_saver_gd);
 
 		gdscript_cache = memnew(GDScriptCache);
+		gdscript_bytecode_cache = memnew(GDScriptBytecodeCache);
 
 		GDScriptUtilityFunctions::register_functions();
 	}
@@ -145,6 +148,10 @@ void uninitialize_gdscript_module(ModuleInitializationLevel p_level) {
 	if (p_level == MODULE_INITIALIZATION_LEVEL_SERVERS) {
 		ScriptServer::unregister_language(script_language_gd);
 
+		if (gdscript_bytecode_cache) {
+			memdelete(gdscript_bytecode_cache);
+		}
+
 		if (gdscript_cache) {
 			memdelete(gdscript_cache);
 		}
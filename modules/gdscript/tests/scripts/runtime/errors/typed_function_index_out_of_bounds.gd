@@ -0,0 +1,7 @@
+#debug-only
+func get_at(array: Array, index: int) -> int:
+	return array[index]
+
+func test():
+	var array: Array = [1, 2]
+	get_at(array, 2)
@@ -0,0 +1,94 @@
+# Property accesses and calls on untyped values are cached per call site. The same
+# sites are used with several receiver types, which must all keep resolving correctly.
+
+class Point:
+	var x = 1
+	var y: int = 2
+	var doubled: int:
+		get:
+			return y * 2
+
+	func sum():
+		return x + y
+
+	func get_name():
+		return "point"
+
+
+class Point3D extends Point:
+	var z = 3
+
+	func sum():
+		return x + y + z
+
+
+class Other:
+	var x = "other"
+
+
+class WithGetter:
+	var x:
+		get:
+			return "getter"
+
+
+class WithGet:
+	func _get(property):
+		if property == &"x":
+			return "dynamic"
+		return null
+
+
+class NamedResource extends Resource:
+	pass
+
+
+class StaticName:
+	static func get_name():
+		return "static"
+
+
+func read(target):
+	return target.x
+
+
+func write(target, value):
+	target.y = value
+
+
+@warning_ignore(unsafe_method_access)
+func total(target):
+	return target.sum()
+
+
+@warning_ignore(unsafe_method_access)
+func name_of(target):
+	return target.get_name()
+
+
+func test():
+	var points = [Point.new(), Point3D.new()]
+	for i in 3:
+		for point in points:
+			write(point, i)
+			print(read(point), " ", point.y, " ", point.doubled, " ", total(point))
+
+	# Needs a conversion to the member type.
+	write(points[0], 2.7)
+	print(points[0].y)
+
+	# More receiver types than a site keeps, including non-objects.
+	var receivers = [Point.new(), Point3D.new(), Other.new(), WithGetter.new(), WithGet.new(), Vector2(1.5, 0)]
+	for i in 2:
+		for receiver in receivers:
+			print(read(receiver))
+
+	var resources = [Resource.new(), NamedResource.new()]
+	for resource in resources:
+		resource.resource_name = "res"
+		print(resource.resource_name, " ", name_of(resource))
+	print(name_of(points[0]))
+
+	# Scripts resolve their static functions before the native methods.
+	for i in 2:
+		print(name_of(StaticName))
@@ -0,0 +1,48 @@
+# Literals which are only iterated, searched or indexed reuse their container
+# between runs. Every run must still see its own values.
+
+func collect(a, b):
+	var result := []
+	for x in [a, b, a + b]:
+		result.append(x)
+	return result
+
+func count_leaves(n):
+	if n <= 1:
+		return 1
+	var total = 0
+	for m in [n - 1, n - 2]:
+		total += count_leaves(m)
+	return total
+
+@warning_ignore(unsafe_method_access)
+func nested_literals():
+	# Nested literals are new containers on every run.
+	for i in 2:
+		for inner in [[i]]:
+			inner.append(0)
+			print(inner)
+
+func test():
+	for i in 3:
+		print(collect(i, 10))
+
+	var outer := []
+	for i in 2:
+		for x in [i, i * 2]:
+			outer.append(x)
+	print(outer)
+
+	print(count_leaves(4))
+
+	var values := [3, 7]
+	for v in values:
+		print(v in [1, 3, 5], " ", v in {3: true, 7: false}, " ", [v, v + 1][1], " ", {"key": v}["key"])
+
+	nested_literals()
+
+	# Constant literals are built once, the loop only reads them.
+	for i in 2:
+		for x in [1, 2]:
+			x += 1
+			print(x)
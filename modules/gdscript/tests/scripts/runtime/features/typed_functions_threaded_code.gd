@@ -0,0 +1,27 @@
+# Fully typed functions run on the threaded code tier, these should behave exactly
+# as they do in the interpreter.
+
+func sum_to(n: int) -> int:
+	var total: int = 0
+	for i in n:
+		total += i
+	return total
+
+func scale(v: Vector2, factor: float = 2.0) -> Vector2:
+	return v * factor
+
+func int_to_float(value: int) -> float:
+	return value
+
+func count_children(node: Node) -> int:
+	return node.get_child_count()
+
+func test():
+	print(sum_to(10))
+	print(scale(Vector2(1, 2)))
+	print(scale(Vector2(1, 2), 0.5))
+	print(int_to_float(3))
+	var node := Node.new()
+	node.add_child(Node.new())
+	print(count_children(node))
+	node.free()
@@ -0,0 +1,29 @@
+# Operators between two values of the same numeric type use dedicated opcodes.
+
+func test():
+	var a: int = 7
+	var b: int = 3
+	print(a + b, " ", a - b, " ", a * b)
+	print(a == b, " ", a != b, " ", a < b, " ", a <= b, " ", a > b, " ", a >= b)
+
+	var x: float = 1.5
+	var y: float = 0.5
+	print(x + y, " ", x - y, " ", x * y, " ", x / y)
+	print(x == y, " ", x < y, " ", x >= y)
+
+	var v: Vector2 = Vector2(1, 2)
+	var w: Vector2 = Vector2(3, 4)
+	print(v + w, " ", v - w, " ", v * w, " ", w / v)
+	print(v == w, " ", v != w, " ", v < w)
+
+	var p: Vector3 = Vector3(1, 2, 3)
+	var q: Vector3 = Vector3(2, 2, 2)
+	print(p + q, " ", p - q, " ", p * q, " ", p / q)
+	print(p == q, " ", p > q)
+
+	var total: int = 0
+	var i: int = 0
+	while i < 10:
+		total += i
+		i += 1
+	print(total)
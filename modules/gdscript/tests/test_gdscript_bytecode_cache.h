@@ -0,0 +1,118 @@
+/*************************************************************************/
+/*  test_gdscript_bytecode_cache.h                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_GDSCRIPT_BYTECODE_CACHE_H
+#define TEST_GDSCRIPT_BYTECODE_CACHE_H
+
+#include "../gdscript.h"
+#include "../gdscript_bytecode_cache.h"
+#include "../gdscript_cache.h"
+#include "gdscript_test_runner.h"
+
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/resource_loader.h"
+#include "core/os/os.h"
+#include "tests/test_macros.h"
+
+namespace GDScriptTests {
+
+static void write_bytecode_cache_test_file(const String &p_path, const String &p_contents) {
+	Ref<FileAccess> f = FileAccess::open(p_path, FileAccess::WRITE);
+	REQUIRE(f.is_valid());
+	f->store_string(p_contents);
+}
+
+static int get_bytecode_cache_test_value() {
+	Ref<GDScript> script = ResourceLoader::load("res://main.gd", "", ResourceFormatLoader::CACHE_MODE_IGNORE);
+	REQUIRE(script.is_valid());
+	REQUIRE(script->is_valid());
+	Ref<RefCounted> ref_counted = memnew(RefCounted);
+	ref_counted->set_script(script);
+	return ref_counted->call("get_value");
+}
+
+TEST_CASE("[Modules][GDScript] Bytecode cache") {
+	// A project of its own, the cache only applies to scripts under res://.
+	const String dir = OS::get_singleton()->get_cache_path().path_join("gdscript_bytecode_cache");
+	DirAccess::make_dir_recursive_absolute(dir);
+	write_bytecode_cache_test_file(dir.path_join("project.godot"), "config_version=5\n");
+	write_bytecode_cache_test_file(dir.path_join("dependency.gd"), "const VALUE = 4\n");
+	write_bytecode_cache_test_file(dir.path_join("main.gd"), R"(extends RefCounted
+
+const Dependency = preload("res://dependency.gd")
+
+func get_value():
+	return Dependency.VALUE * 10
+)");
+
+	init_language(dir);
+	DirAccess::make_dir_recursive_absolute(OS::get_singleton()->get_user_data_dir());
+	const String entry_path = String("user://gdscript_cache").path_join(String("res://main.gd").md5_text() + ".gdbc");
+	DirAccess::remove_absolute(entry_path);
+
+	SUBCASE("Save and load") {
+		CHECK(get_bytecode_cache_test_value() == 40);
+		REQUIRE_MESSAGE(FileAccess::exists(entry_path), "Compiling the script should have cached it.");
+
+		Ref<GDScript> script = GDScriptCache::get_shallow_script("res://main.gd");
+		CHECK_MESSAGE(GDScriptBytecodeCache::load(script.ptr()), "The cached script should be used as is.");
+		CHECK(script->reload() == OK);
+		CHECK(script->has_method("get_value"));
+		CHECK(script->get_constants().has("Dependency"));
+
+		Ref<RefCounted> ref_counted = memnew(RefCounted);
+		ref_counted->set_script(script);
+		CHECK(int(ref_counted->call("get_value")) == 40);
+	}
+
+	SUBCASE("Outdated dependency") {
+		CHECK(get_bytecode_cache_test_value() == 40);
+		REQUIRE(FileAccess::exists(entry_path));
+
+		// The constant is folded into the cached code of the dependent script.
+		finish_language();
+		write_bytecode_cache_test_file(dir.path_join("dependency.gd"), "const VALUE = 5\n");
+		init_language(dir);
+
+		{
+			Ref<GDScript> script = GDScriptCache::get_shallow_script("res://main.gd");
+			CHECK_FALSE_MESSAGE(GDScriptBytecodeCache::load(script.ptr()), "A change in a dependency should invalidate the cached script.");
+		}
+		CHECK(get_bytecode_cache_test_value() == 50);
+	}
+
+	finish_language();
+	DirAccess::remove_absolute(entry_path);
+}
+
+} // namespace GDScriptTests
+
+#endif // TEST_GDSCRIPT_BYTECODE_CACHE_H
@@ -562,6 +562,11 @@ bool SceneMultiplayer::is_object_decoding_allowed() const {
 	return allow_object_decoding;
 }
 
+bool SceneMultiplayer::is_compact_variant_encoding_enabled() const {
+	// Selected per peer, so it can be matched with the other end of the connection.
+	return multiplayer_peer.is_valid() && multiplayer_peer->is_compact_variant_encoding_enabled();
+}
+
 String SceneMultiplayer::get_rpc_md5(const Object *p_obj) {
 	return rpc->get_rpc_md5(p_obj);
 }
@@ -157,6 +157,7 @@ public:
 
 	void set_allow_object_decoding(bool p_enable);
 	bool is_object_decoding_allowed() const;
+	bool is_compact_variant_encoding_enabled() const;
 
 	void set_server_relay_enabled(bool p_enabled);
 	bool is_server_relay_enabled() const;
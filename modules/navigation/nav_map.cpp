@@ -30,7 +30,9 @@
 
 #include "nav_map.h"
 
+#include "core/debugger/frame_profiler.h"
 #include "core/object/worker_thread_pool.h"
+#include "core/os/parallel_for.h"
 #include "nav_link.h"
 #include "nav_region.h"
 #include "rvo_agent.h"
@@ -535,6 +537,8 @@ void NavMap::remove_agent_as_controlled(RvoAgent *agent) {
 }
 
 void NavMap::sync() {
+	FRAME_PROFILE_ZONE("NavMap::sync");
+
 	// Check if we need to update the links.
 	if (regenerate_polygons) {
 		for (uint32_t r = 0; r < regions.size(); r++) {
@@ -826,8 +830,14 @@ void NavMap::compute_single_step(uint32_t index, RvoAgent **agent) {
 void NavMap::step(real_t p_deltatime) {
 	deltatime = p_deltatime;
 	if (controlled_agents.size() > 0) {
-		WorkerThreadPool::GroupID group_task = WorkerThreadPool::get_singleton()->add_template_group_task(this, &NavMap::compute_single_step, controlled_agents.ptr(), controlled_agents.size(), -1, true, SNAME("NavigationMapAgents"));
-		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_task);
+		RvoAgent **agents = controlled_agents.ptr();
+		parallel_for(
+				0, controlled_agents.size(), [&](uint32_t p_from, uint32_t p_to) {
+					for (uint32_t i = p_from; i < p_to; i++) {
+						compute_single_step(i, agents);
+					}
+				},
+				0, SNAME("NavigationMapAgents"));
 	}
 }
 
@@ -69,7 +69,12 @@ Ref<MultiplayerAPI> MultiplayerAPI::create_default_interface() {
 #define ENCODE_16 1 << 6
 #define ENCODE_32 2 << 6
 #define ENCODE_64 3 << 6
-Error MultiplayerAPI::encode_and_compress_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bool p_allow_object_decoding) {
+Error MultiplayerAPI::encode_and_compress_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bool p_allow_object_decoding, bool p_compact) {
+	if (p_compact) {
+		// The compact marshalling already packs booleans and integers, and uses its own type tags.
+		return encode_variant_compact(p_variant, r_buffer, r_len, p_allow_object_decoding);
+	}
+
 	// Unreachable because `VARIANT_MAX` == 38 and `ENCODE_VARIANT_MASK` == 77
 	CRASH_COND(p_variant.get_type() > VARIANT_META_TYPE_MASK);
 
@@ -144,7 +149,11 @@ Error MultiplayerAPI::encode_and_compress_variant(const Variant &p_variant, uint
 	return OK;
 }
 
-Error MultiplayerAPI::decode_and_decompress_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len, bool p_allow_object_decoding) {
+Error MultiplayerAPI::decode_and_decompress_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len, bool p_allow_object_decoding, bool p_compact) {
+	if (p_compact) {
+		return decode_variant_compact(r_variant, p_buffer, p_len, r_len, p_allow_object_decoding);
+	}
+
 	const uint8_t *buf = p_buffer;
 	int len = p_len;
 
@@ -212,7 +221,7 @@ Error MultiplayerAPI::decode_and_decompress_variant(Variant &r_variant, const ui
 	return OK;
 }
 
-Error MultiplayerAPI::encode_and_compress_variants(const Variant **p_variants, int p_count, uint8_t *p_buffer, int &r_len, bool *r_raw, bool p_allow_object_decoding) {
+Error MultiplayerAPI::encode_and_compress_variants(const Variant **p_variants, int p_count, uint8_t *p_buffer, int &r_len, bool *r_raw, bool p_allow_object_decoding, bool p_compact) {
 	r_len = 0;
 	int size = 0;
 
@@ -235,7 +244,7 @@ Error MultiplayerAPI::encode_and_compress_variants(const Variant **p_variants, i
 			}
 			r_len += pba.size();
 		} else {
-			encode_and_compress_variant(v, p_buffer, size, p_allow_object_decoding);
+			encode_and_compress_variant(v, p_buffer, size, p_allow_object_decoding, p_compact);
 			r_len += size;
 		}
 		return OK;
@@ -244,13 +253,13 @@ Error MultiplayerAPI::encode_and_compress_variants(const Variant **p_variants, i
 	// Regular encoding.
 	for (int i = 0; i < p_count; i++) {
 		const Variant &v = *(p_variants[i]);
-		encode_and_compress_variant(v, p_buffer ? p_buffer + r_len : nullptr, size, p_allow_object_decoding);
+		encode_and_compress_variant(v, p_buffer ? p_buffer + r_len : nullptr, size, p_allow_object_decoding, p_compact);
 		r_len += size;
 	}
 	return OK;
 }
 
-Error MultiplayerAPI::decode_and_decompress_variants(Vector<Variant> &r_variants, const uint8_t *p_buffer, int p_len, int &r_len, bool p_raw, bool p_allow_object_decoding) {
+Error MultiplayerAPI::decode_and_decompress_variants(Vector<Variant> &r_variants, const uint8_t *p_buffer, int p_len, int &r_len, bool p_raw, bool p_allow_object_decoding, bool p_compact) {
 	r_len = 0;
 	int argc = r_variants.size();
 	if (argc == 0 && p_raw) {
@@ -274,7 +283,7 @@ Error MultiplayerAPI::decode_and_decompress_variants(Vector<Variant> &r_variants
 		ERR_FAIL_COND_V_MSG(r_len >= p_len, ERR_INVALID_DATA, "Invalid packet received. Size too small.");
 
 		int vlen;
-		Error err = MultiplayerAPI::decode_and_decompress_variant(r_variants.write[i], &p_buffer[r_len], p_len - r_len, &vlen, p_allow_object_decoding);
+		Error err = MultiplayerAPI::decode_and_decompress_variant(r_variants.write[i], &p_buffer[r_len], p_len - r_len, &vlen, p_allow_object_decoding, p_compact);
 		ERR_FAIL_COND_V_MSG(err != OK, err, "Invalid packet received. Unable to decode state variable.");
 		r_len += vlen;
 	}
@@ -32,6 +32,7 @@
 
 #include "core/config/project_settings.h"
 #include "core/debugger/engine_debugger.h"
+#include "core/debugger/frame_profiler.h"
 #include "core/input/input.h"
 #include "core/io/dir_access.h"
 #include "core/io/image_loader.h"
@@ -412,6 +413,8 @@ void SceneTree::initialize() {
 }
 
 bool SceneTree::physics_process(double p_time) {
+	FRAME_PROFILE_ZONE("SceneTree::physics_process");
+
 	root_lock++;
 
 	current_frame++;
@@ -443,6 +446,8 @@ bool SceneTree::physics_process(double p_time) {
 }
 
 bool SceneTree::process(double p_time) {
+	FRAME_PROFILE_ZONE("SceneTree::process");
+
 	root_lock++;
 
 	MainLoop::process(p_time);
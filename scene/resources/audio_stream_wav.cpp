@@ -488,6 +488,10 @@ bool AudioStreamWAV::is_monophonic() const {
 	return false;
 }
 
+uint64_t AudioStreamWAV::get_memory_usage() const {
+	return data_bytes;
+}
+
 void AudioStreamWAV::set_data(const Vector<uint8_t> &p_data) {
 	AudioServer::get_singleton()->lock();
 	if (data) {
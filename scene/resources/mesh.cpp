@@ -1806,6 +1806,23 @@ RID ArrayMesh::get_rid() const {
 	return mesh;
 }
 
+uint64_t ArrayMesh::get_memory_usage() const {
+	const RenderingServer *rs = RenderingServer::get_singleton();
+	if (!rs) {
+		return 0;
+	}
+
+	uint64_t memory = 0;
+	for (int i = 0; i < surfaces.size(); i++) {
+		const Surface &s = surfaces[i];
+		uint32_t stride = rs->mesh_surface_get_format_vertex_stride(s.format, s.array_length) + rs->mesh_surface_get_format_attribute_stride(s.format, s.array_length) + rs->mesh_surface_get_format_skin_stride(s.format, s.array_length);
+		memory += uint64_t(stride) * s.array_length;
+		// Indices are 16-bit unless there are too many vertices to address.
+		memory += uint64_t(s.index_array_length) * (s.array_length < (1 << 16) ? 2 : 4);
+	}
+	return memory;
+}
+
 AABB ArrayMesh::get_aabb() const {
 	return aabb;
 }
@@ -34,6 +34,7 @@
 #include "core/io/dir_access.h"
 #include "core/io/missing_resource.h"
 #include "core/io/resource_format_binary.h"
+#include "core/os/parallel_for.h"
 #include "core/version.h"
 
 // Version 2: changed names for Basis, AABB, Vectors, etc.
@@ -42,6 +43,9 @@
 
 #define BINARY_FORMAT_VERSION 4
 
+// Below this many bytes of [sub_resource] properties, parsing them on threads isn't worth it.
+#define PARALLEL_SUB_RESOURCES_MIN_SIZE 16384
+
 #include "core/io/dir_access.h"
 #include "core/version.h"
 
@@ -190,6 +194,431 @@ Error ResourceLoaderText::_parse_ext_resource(VariantParser::Stream *p_stream, R
 	return OK;
 }
 
+void ResourceLoaderText::_read_stream() {
+	uint64_t length = f->get_length() - f->get_position();
+	const uint8_t *view = f->get_buffer_view(length);
+	if (view) {
+		// Stays valid as long as the file is kept open.
+		stream.set_view(view, length);
+		return;
+	}
+
+	Vector<uint8_t> data;
+	data.resize(length);
+	uint64_t read = f->get_buffer(data.ptrw(), length);
+	data.resize(read);
+	stream.set_data(data);
+}
+
+Error ResourceLoaderText::_create_sub_resource(const VariantParser::Tag &p_tag, Ref<Resource> &r_res, bool &r_do_assign, MissingResource *&r_missing_resource) {
+	if (!p_tag.fields.has("type")) {
+		error = ERR_FILE_CORRUPT;
+		error_text = "Missing 'type' in external resource tag";
+		_printerr();
+		return error;
+	}
+
+	if (!p_tag.fields.has("id")) {
+		error = ERR_FILE_CORRUPT;
+		error_text = "Missing 'id' in external resource tag";
+		_printerr();
+		return error;
+	}
+
+	String type = p_tag.fields["type"];
+	String id = p_tag.fields["id"];
+
+	String path = local_path + "::" + id;
+
+	r_res = Ref<Resource>();
+	r_do_assign = false;
+	r_missing_resource = nullptr;
+
+	if (cache_mode == ResourceFormatLoader::CACHE_MODE_REPLACE && ResourceCache::has(path)) {
+		//reuse existing
+		Ref<Resource> cache = ResourceCache::get_ref(path);
+		if (cache.is_valid() && cache->get_class() == type) {
+			r_res = cache;
+			r_res->reset_state();
+			r_do_assign = true;
+		}
+	}
+
+	if (r_res.is_null()) { //not reuse
+		Ref<Resource> cache = ResourceCache::get_ref(path);
+		if (cache_mode != ResourceFormatLoader::CACHE_MODE_IGNORE && cache.is_valid()) { //only if it doesn't exist
+			//cached, do not assign
+			r_res = cache;
+		} else {
+			//create
+
+			Object *obj = ClassDB::instantiate(type);
+			if (!obj) {
+				if (ResourceLoader::is_creating_missing_resources_if_class_unavailable_enabled()) {
+					r_missing_resource = memnew(MissingResource);
+					r_missing_resource->set_original_class(type);
+					r_missing_resource->set_recording_properties(true);
+					obj = r_missing_resource;
+				} else {
+					error_text += "Can't create sub resource of type: " + type;
+					_printerr();
+					error = ERR_FILE_CORRUPT;
+					return error;
+				}
+			}
+
+			Resource *r = Object::cast_to<Resource>(obj);
+			if (!r) {
+				error_text += "Can't create sub resource of type, because not a resource: " + type;
+				_printerr();
+				error = ERR_FILE_CORRUPT;
+				return error;
+			}
+
+			r_res = Ref<Resource>(r);
+			r_do_assign = true;
+		}
+	}
+
+	int_resources[id] = r_res; //always assign int resources
+	if (r_do_assign && cache_mode != ResourceFormatLoader::CACHE_MODE_IGNORE) {
+		r_res->set_path(path, cache_mode == ResourceFormatLoader::CACHE_MODE_REPLACE);
+		r_res->set_scene_unique_id(id);
+	}
+
+	return OK;
+}
+
+void ResourceLoaderText::_set_sub_resource_property(Resource *p_res, MissingResource *p_missing_resource, const String &p_name, const Variant &p_value, Dictionary &r_missing_resource_properties) {
+	if (p_value.get_type() == Variant::OBJECT && p_missing_resource != nullptr) {
+		// If the property being set is a missing resource (and the parent is not),
+		// then setting it will most likely not work.
+		// Instead, save it as metadata.
+
+		Ref<MissingResource> mr = p_value;
+		if (mr.is_valid()) {
+			r_missing_resource_properties[p_name] = mr;
+			return;
+		}
+	}
+
+	p_res->set(p_name, p_value);
+}
+
+Error ResourceLoaderText::_parse_block_sub_resources(void *p_block, VariantParser::Stream *p_stream, Ref<Resource> &r_res, int &line, String &r_err_str) {
+	// All sub-resources are created before the blocks are parsed, so this is a read-only lookup.
+	SubResourceBlock *block = static_cast<SubResourceBlock *>(p_block);
+
+	VariantParser::Token token;
+	VariantParser::get_token(p_stream, token, line, r_err_str);
+	if (token.type != VariantParser::TK_NUMBER && token.type != VariantParser::TK_STRING) {
+		r_err_str = "Expected number (old style sub-resource index) or string";
+		return ERR_PARSE_ERROR;
+	}
+
+	String id = token.value;
+	const Ref<Resource> *res = block->loader->int_resources.getptr(id);
+	// Sub-resources defined later in the file don't exist yet when parsing sequentially.
+	const uint32_t *defined_in = block->block_ids->getptr(id);
+	ERR_FAIL_COND_V(!res || (defined_in && *defined_in > block->index), ERR_INVALID_PARAMETER);
+	r_res = *res;
+
+	VariantParser::get_token(p_stream, token, line, r_err_str);
+	if (token.type != VariantParser::TK_PARENTHESIS_CLOSE) {
+		r_err_str = "Expected ')'";
+		return ERR_PARSE_ERROR;
+	}
+
+	return OK;
+}
+
+Error ResourceLoaderText::_parse_block_ext_resources(void *p_block, VariantParser::Stream *p_stream, Ref<Resource> &r_res, int &line, String &r_err_str) {
+	// Like _parse_ext_resource(), but without touching the loader state. Threaded loads are
+	// already resolved at this point, missing ones are reported back once the block is done.
+	SubResourceBlock *block = static_cast<SubResourceBlock *>(p_block);
+	const ResourceLoaderText *loader = block->loader;
+
+	VariantParser::Token token;
+	VariantParser::get_token(p_stream, token, line, r_err_str);
+	if (token.type != VariantParser::TK_NUMBER && token.type != VariantParser::TK_STRING) {
+		r_err_str = "Expected number (old style sub-resource index) or String (ext-resource ID)";
+		return ERR_PARSE_ERROR;
+	}
+
+	String id = token.value;
+	const ExtResource *er = loader->ext_resources.getptr(id);
+	if (!er) {
+		r_err_str = "Can't load cached ext-resource id: " + id;
+		return ERR_PARSE_ERROR;
+	}
+
+	if (er->cache.is_valid()) {
+		r_res = er->cache;
+	} else if (loader->use_sub_threads && !ResourceLoader::get_abort_on_missing_resources()) {
+		block->missing_ext_resources.push_back(id);
+		r_res = Ref<Resource>();
+	} else {
+		r_err_str = (loader->use_sub_threads ? "[ext_resource] referenced nonexistent resource at: " : "[ext_resource] referenced non-loaded resource at: ") + er->path;
+		return ERR_FILE_MISSING_DEPENDENCIES;
+	}
+
+	VariantParser::get_token(p_stream, token, line, r_err_str);
+	if (token.type != VariantParser::TK_PARENTHESIS_CLOSE) {
+		r_err_str = "Expected ')'";
+		return ERR_PARSE_ERROR;
+	}
+
+	return OK;
+}
+
+uint64_t ResourceLoaderText::_find_next_tag(const uint8_t *p_data, uint64_t p_from, uint64_t p_to, int &r_lines) {
+	// A tag is a '[' starting a line outside of any value, which can span lines.
+	// Strings and comments are skipped, as they may contain anything.
+	int depth = 0;
+	bool line_start = true;
+	uint64_t i = p_from;
+	while (i < p_to) {
+		uint8_t c = p_data[i];
+		switch (c) {
+			case '\n': {
+				r_lines++;
+				line_start = true;
+				i++;
+				continue;
+			}
+			case ' ':
+			case '\t':
+			case '\r': {
+				i++;
+				continue;
+			}
+			case '"': {
+				i++;
+				while (i < p_to && p_data[i] != '"') {
+					if (p_data[i] == '\\') {
+						i++;
+						if (i == p_to) {
+							break;
+						}
+					}
+					if (p_data[i] == '\n') {
+						r_lines++;
+					}
+					i++;
+				}
+			} break;
+			case ';': {
+				// Comments are allowed anywhere outside strings, including inside values.
+				while (i < p_to && p_data[i] != '\n') {
+					i++;
+				}
+				continue;
+			}
+			case '[': {
+				if (depth == 0 && line_start) {
+					return i;
+				}
+				depth++;
+			} break;
+			case '(':
+			case '{': {
+				depth++;
+			} break;
+			case ']':
+			case ')':
+			case '}': {
+				depth = MAX(depth - 1, 0);
+			} break;
+			default: {
+			}
+		}
+		line_start = false;
+		i++;
+	}
+	return p_to;
+}
+
+void ResourceLoaderText::_parse_sub_resource_block(SubResourceBlock &p_block) {
+	VariantParser::StreamBuffer block_stream;
+	block_stream.set_view(stream.get_data() + p_block.from, p_block.to - p_block.from);
+
+	VariantParser::ResourceParser block_rp;
+	block_rp.ext_func = _parse_block_ext_resources;
+	block_rp.sub_func = _parse_block_sub_resources;
+	block_rp.userdata = &p_block;
+
+	int line = p_block.line;
+	while (true) {
+		String assign;
+		Variant value;
+		VariantParser::Tag tag;
+		String err_str;
+
+		Error err = VariantParser::parse_tag_assign_eof(&block_stream, line, err_str, tag, assign, value, &block_rp);
+		if (err == ERR_FILE_EOF) {
+			break; // Reached the next tag.
+		}
+		if (err == OK && assign.is_empty()) {
+			err = ERR_FILE_CORRUPT;
+			err_str = "Unexpected tag while parsing [sub_resource]";
+		}
+		if (err) {
+			p_block.error = err;
+			p_block.error_text = err_str;
+			p_block.error_line = line;
+			break;
+		}
+
+		p_block.properties.push_back(Pair<String, Variant>(assign, value));
+	}
+}
+
+Error ResourceLoaderText::_load_sub_resources_parallel() {
+	// Find where each [sub_resource] body starts and ends, parsing only the tags. Anything
+	// unusual falls back to the regular path, which will report errors the usual way.
+	const uint8_t *data = stream.get_data();
+	const uint64_t length = stream.get_length();
+	const uint64_t first_from = stream.get_position();
+	const int first_line = lines;
+	const VariantParser::Tag first_tag = next_tag;
+
+	LocalVector<SubResourceBlock> blocks;
+	HashMap<String, uint32_t> block_ids;
+	uint64_t body_size = 0;
+	bool ok = true;
+
+	while (true) {
+		// Missing and repeated ids are reported or resolved in file order by the regular path.
+		const Variant *id = next_tag.fields.getptr("id");
+		if (!id || block_ids.has(*id)) {
+			ok = false;
+			break;
+		}
+
+		SubResourceBlock block;
+		block.loader = this;
+		block.block_ids = &block_ids;
+		block.index = blocks.size();
+		block_ids[*id] = block.index;
+		block.tag = next_tag;
+		block.from = stream.get_position();
+		block.line = lines;
+
+		int tag_line = lines;
+		block.to = _find_next_tag(data, block.from, length, tag_line);
+		body_size += block.to - block.from;
+		blocks.push_back(block);
+
+		if (block.to == length) {
+			ok = false; // Premature end of file.
+			break;
+		}
+
+		stream.seek(block.to);
+		lines = tag_line;
+		if (VariantParser::parse_tag(&stream, lines, error_text, next_tag, &rp) != OK) {
+			ok = false;
+			break;
+		}
+
+		if (next_tag.name != "sub_resource") {
+			break;
+		}
+	}
+
+	if (!ok || blocks.size() < 2 || body_size < PARALLEL_SUB_RESOURCES_MIN_SIZE) {
+		stream.seek(first_from);
+		lines = first_line;
+		next_tag = first_tag;
+		return OK;
+	}
+
+	// The tag following the last block was already parsed, keep its state for the next stage.
+	const uint64_t next_tag_end = stream.get_position();
+	const int next_tag_lines = lines;
+	const VariantParser::Tag last_tag = next_tag;
+
+	// Resources must exist before parsing, as the blocks are parsed out of order.
+	LocalVector<Ref<Resource>> resources;
+	LocalVector<bool> do_assign;
+	LocalVector<MissingResource *> missing_resources;
+	resources.resize(blocks.size());
+	do_assign.resize(blocks.size());
+	missing_resources.resize(blocks.size());
+
+	for (uint32_t i = 0; i < blocks.size(); i++) {
+		lines = blocks[i].line;
+		bool assign = false;
+		error = _create_sub_resource(blocks[i].tag, resources[i], assign, missing_resources[i]);
+		if (error) {
+			return error;
+		}
+		do_assign[i] = assign;
+	}
+
+	if (use_sub_threads) {
+		// Waiting can't happen on worker threads, so wait for all dependencies here.
+		for (KeyValue<String, ExtResource> &E : ext_resources) {
+			if (E.value.cache.is_null()) {
+				E.value.cache = ResourceLoader::load_threaded_get(E.value.path);
+			}
+		}
+	}
+
+	parallel_for(
+			0, blocks.size(), [&](uint32_t p_begin, uint32_t p_end) {
+				for (uint32_t i = p_begin; i < p_end; i++) {
+					_parse_sub_resource_block(blocks[i]);
+				}
+			},
+			1, "Parse sub-resources: " + local_path);
+
+	// Apply in file order, so the result is the same as parsing sequentially.
+	for (uint32_t i = 0; i < blocks.size(); i++) {
+		SubResourceBlock &block = blocks[i];
+
+		for (uint32_t j = 0; j < block.missing_ext_resources.size(); j++) {
+			const ExtResource &er = ext_resources[block.missing_ext_resources[j]];
+			ResourceLoader::notify_dependency_error(local_path, er.path, er.type);
+		}
+
+		if (block.error) {
+			error = block.error;
+			error_text = block.error_text;
+			lines = block.error_line;
+			_printerr();
+			return error;
+		}
+
+		resource_current++;
+
+		if (do_assign[i]) {
+			Dictionary missing_resource_properties;
+			for (uint32_t j = 0; j < block.properties.size(); j++) {
+				_set_sub_resource_property(resources[i].ptr(), missing_resources[i], block.properties[j].first, block.properties[j].second, missing_resource_properties);
+			}
+
+			if (!missing_resource_properties.is_empty()) {
+				resources[i]->set_meta(META_MISSING_RESOURCES, missing_resource_properties);
+			}
+		}
+
+		if (missing_resources[i]) {
+			missing_resources[i]->set_recording_properties(false);
+		}
+
+		if (progress && resources_total > 0) {
+			*progress = resource_current / float(resources_total);
+		}
+	}
+
+	stream.seek(next_tag_end);
+	lines = next_tag_lines;
+	next_tag = last_tag;
+	error = OK;
+	return OK;
+}
+
 Ref<PackedScene> ResourceLoaderText::_parse_node_tag(VariantParser::ResourceParser &parser) {
 	Ref<PackedScene> packed_scene;
 	packed_scene.instantiate();
@@ -520,91 +949,29 @@ Error ResourceLoaderText::load() {
 	resources_total -= resource_current;
 	resource_current = 0;
 
-	while (true) {
-		if (next_tag.name != "sub_resource") {
-			break;
-		}
-
-		if (!next_tag.fields.has("type")) {
-			error = ERR_FILE_CORRUPT;
-			error_text = "Missing 'type' in external resource tag";
-			_printerr();
+	if (next_tag.name == "sub_resource") {
+		error = _load_sub_resources_parallel();
+		if (error) {
 			return error;
 		}
+	}
 
-		if (!next_tag.fields.has("id")) {
-			error = ERR_FILE_CORRUPT;
-			error_text = "Missing 'id' in external resource tag";
-			_printerr();
-			return error;
+	while (true) {
+		if (next_tag.name != "sub_resource") {
+			break;
 		}
 
-		String type = next_tag.fields["type"];
-		String id = next_tag.fields["id"];
-
-		String path = local_path + "::" + id;
-
-		//bool exists=ResourceCache::has(path);
-
 		Ref<Resource> res;
 		bool do_assign = false;
-
-		if (cache_mode == ResourceFormatLoader::CACHE_MODE_REPLACE && ResourceCache::has(path)) {
-			//reuse existing
-			Ref<Resource> cache = ResourceCache::get_ref(path);
-			if (cache.is_valid() && cache->get_class() == type) {
-				res = cache;
-				res->reset_state();
-				do_assign = true;
-			}
-		}
-
 		MissingResource *missing_resource = nullptr;
 
-		if (res.is_null()) { //not reuse
-			Ref<Resource> cache = ResourceCache::get_ref(path);
-			if (cache_mode != ResourceFormatLoader::CACHE_MODE_IGNORE && cache.is_valid()) { //only if it doesn't exist
-				//cached, do not assign
-				res = cache;
-			} else {
-				//create
-
-				Object *obj = ClassDB::instantiate(type);
-				if (!obj) {
-					if (ResourceLoader::is_creating_missing_resources_if_class_unavailable_enabled()) {
-						missing_resource = memnew(MissingResource);
-						missing_resource->set_original_class(type);
-						missing_resource->set_recording_properties(true);
-						obj = missing_resource;
-					} else {
-						error_text += "Can't create sub resource of type: " + type;
-						_printerr();
-						error = ERR_FILE_CORRUPT;
-						return error;
-					}
-				}
-
-				Resource *r = Object::cast_to<Resource>(obj);
-				if (!r) {
-					error_text += "Can't create sub resource of type, because not a resource: " + type;
-					_printerr();
-					error = ERR_FILE_CORRUPT;
-					return error;
-				}
-
-				res = Ref<Resource>(r);
-				do_assign = true;
-			}
+		error = _create_sub_resource(next_tag, res, do_assign, missing_resource);
+		if (error) {
+			return error;
 		}
 
 		resource_current++;
 
-		int_resources[id] = res; //always assign int resources
-		if (do_assign && cache_mode != ResourceFormatLoader::CACHE_MODE_IGNORE) {
-			res->set_path(path, cache_mode == ResourceFormatLoader::CACHE_MODE_REPLACE);
-			res->set_scene_unique_id(id);
-		}
-
 		Dictionary missing_resource_properties;
 
 		while (true) {
@@ -620,23 +987,7 @@ Error ResourceLoaderText::load() {
 
 			if (!assign.is_empty()) {
 				if (do_assign) {
-					bool set_valid = true;
-
-					if (value.get_type() == Variant::OBJECT && missing_resource != nullptr) {
-						// If the property being set is a missing resource (and the parent is not),
-						// then setting it will most likely not work.
-						// Instead, save it as metadata.
-
-						Ref<MissingResource> mr = value;
-						if (mr.is_valid()) {
-							missing_resource_properties[assign] = mr;
-							set_valid = false;
-						}
-					}
-
-					if (set_valid) {
-						res->set(assign, value);
-					}
+					_set_sub_resource_property(res.ptr(), missing_resource, assign, value, missing_resource_properties);
 				}
 				//it's assignment
 			} else if (!next_tag.name.is_empty()) {
@@ -898,7 +1249,7 @@ Error ResourceLoaderText::rename_dependencies(Ref<FileAccess> p_f, const String
 
 	String base_path = local_path.get_base_dir();
 
-	uint64_t tag_end = f->get_position();
+	uint64_t tag_end = stream.get_position();
 
 	while (true) {
 		Error err = VariantParser::parse_tag(&stream, lines, error_text, next_tag, &rp);
@@ -968,22 +1319,16 @@ Error ResourceLoaderText::rename_dependencies(Ref<FileAccess> p_f, const String
 			s += " path=\"" + path + "\" id=\"" + id + "\"]";
 			fw->store_line(s); // Bundled.
 
-			tag_end = f->get_position();
+			tag_end = stream.get_position();
 		}
 	}
 
-	f->seek(tag_end);
-
-	uint8_t c = f->get_8();
-	if (c == '\n' && !f->eof_reached()) {
+	if (tag_end < stream.get_length() && stream.get_data()[tag_end] == '\n') {
 		// Skip first newline character since we added one
-		c = f->get_8();
+		tag_end++;
 	}
 
-	while (!f->eof_reached()) {
-		fw->store_8(c);
-		c = f->get_8();
-	}
+	fw->store_buffer(stream.get_data() + tag_end, stream.get_length() - tag_end);
 
 	bool all_ok = fw->get_error() == OK;
 
@@ -1000,7 +1345,7 @@ void ResourceLoaderText::open(Ref<FileAccess> p_f, bool p_skip_first_tag) {
 	lines = 1;
 	f = p_f;
 
-	stream.f = f;
+	_read_stream();
 	is_scene = false;
 	ignore_resource_parsing = false;
 	resource_current = 0;
@@ -1105,10 +1450,13 @@ Error ResourceLoaderText::save_as_binary(const String &p_path) {
 	bs_save_unicode_string(wf, is_scene ? "PackedScene" : resource_type);
 	wf->store_64(0); //offset to import metadata, this is no longer used
 
-	wf->store_32(ResourceFormatSaverBinaryInstance::FORMAT_FLAG_NAMED_SCENE_IDS | ResourceFormatSaverBinaryInstance::FORMAT_FLAG_UIDS);
+	wf->store_32(ResourceFormatSaverBinaryInstance::FORMAT_FLAG_NAMED_SCENE_IDS | ResourceFormatSaverBinaryInstance::FORMAT_FLAG_UIDS | ResourceFormatSaverBinaryInstance::FORMAT_FLAG_DEPENDENCY_TABLE);
 
 	wf->store_64(res_uid);
 
+	uint64_t dependency_table_ofs_pos = wf->get_position();
+	wf->store_64(0); // Offset to the dependency table, written at the end.
+
 	for (int i = 0; i < ResourceFormatSaverBinaryInstance::RESERVED_FIELDS; i++) {
 		wf->store_32(0); // reserved
 	}
@@ -1189,6 +1537,7 @@ Error ResourceLoaderText::save_as_binary(const String &p_path) {
 	String temp_file = p_path + ".temp";
 	Vector<uint64_t> local_offsets;
 	Vector<uint64_t> local_pointers_pos;
+	Vector<HashSet<int>> dependencies;
 	{
 		Ref<FileAccess> wf2 = FileAccess::open(temp_file, FileAccess::WRITE);
 		if (wf2.is_null()) {
@@ -1236,6 +1585,7 @@ Error ResourceLoaderText::save_as_binary(const String &p_path) {
 			}
 
 			local_offsets.push_back(wf2->get_position());
+			dependencies.push_back(HashSet<int>());
 
 			bs_save_unicode_string(wf, "local://" + id);
 			local_pointers_pos.push_back(wf->get_position());
@@ -1267,6 +1617,7 @@ Error ResourceLoaderText::save_as_binary(const String &p_path) {
 					HashMap<StringName, int> empty_string_map; //unused
 					bs_save_unicode_string(wf2, assign, true);
 					ResourceFormatSaverBinaryInstance::write_variant(wf2, value, dummy_read.resource_index_map, dummy_read.external_resources, empty_string_map);
+					ResourceFormatSaverBinaryInstance::find_dependencies(value, dummy_read.resource_index_map, dependencies.write[dependencies.size() - 1]);
 					prop_count++;
 
 				} else if (!next_tag.name.is_empty()) {
@@ -1312,6 +1663,7 @@ Error ResourceLoaderText::save_as_binary(const String &p_path) {
 			wf->store_64(0); //temp local offset
 
 			local_offsets.push_back(wf2->get_position());
+			dependencies.push_back(HashSet<int>());
 			bs_save_unicode_string(wf2, "PackedScene");
 			uint64_t propcount_ofs = wf2->get_position();
 			wf2->store_32(0);
@@ -1329,6 +1681,7 @@ Error ResourceLoaderText::save_as_binary(const String &p_path) {
 				HashMap<StringName, int> empty_string_map; //unused
 				bs_save_unicode_string(wf2, name, true);
 				ResourceFormatSaverBinaryInstance::write_variant(wf2, value, dummy_read.resource_index_map, dummy_read.external_resources, empty_string_map);
+				ResourceFormatSaverBinaryInstance::find_dependencies(value, dummy_read.resource_index_map, dependencies.write[dependencies.size() - 1]);
 				prop_count++;
 			}
 
@@ -1356,6 +1709,8 @@ Error ResourceLoaderText::save_as_binary(const String &p_path) {
 		dar->remove(temp_file);
 	}
 
+	ResourceFormatSaverBinaryInstance::write_dependency_table(wf, dependency_table_ofs_pos, dependencies);
+
 	wf->store_buffer((const uint8_t *)"RSRC", 4); //magic at end
 
 	return OK;
@@ -1487,12 +1842,14 @@ String ResourceLoaderText::recognize(Ref<FileAccess> p_f) {
 	lines = 1;
 	f = p_f;
 
-	stream.f = f;
+	// Only the first tag is needed, no point in reading the whole file.
+	VariantParser::StreamFile stream_file;
+	stream_file.f = f;
 
 	ignore_resource_parsing = true;
 
 	VariantParser::Tag tag;
-	Error err = VariantParser::parse_tag(&stream, lines, error_text, tag);
+	Error err = VariantParser::parse_tag(&stream_file, lines, error_text, tag);
 
 	if (err) {
 		_printerr();
@@ -1531,12 +1888,14 @@ ResourceUID::ID ResourceLoaderText::get_uid(Ref<FileAccess> p_f) {
 	lines = 1;
 	f = p_f;
 
-	stream.f = f;
+	// Only the first tag is needed, no point in reading the whole file.
+	VariantParser::StreamFile stream_file;
+	stream_file.f = f;
 
 	ignore_resource_parsing = true;
 
 	VariantParser::Tag tag;
-	Error err = VariantParser::parse_tag(&stream, lines, error_text, tag);
+	Error err = VariantParser::parse_tag(&stream_file, lines, error_text, tag);
 
 	if (err) {
 		_printerr();
@@ -34,9 +34,13 @@
 #include "core/io/file_access.h"
 #include "core/io/resource_loader.h"
 #include "core/io/resource_saver.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/pair.h"
 #include "core/variant/variant_parser.h"
 #include "scene/resources/packed_scene.h"
 
+class MissingResource;
+
 class ResourceLoaderText {
 	bool translation_remapped = false;
 	String local_path;
@@ -45,7 +49,8 @@ class ResourceLoaderText {
 
 	Ref<FileAccess> f;
 
-	VariantParser::StreamFile stream;
+	// The whole file is parsed from memory, so independent blocks can be parsed in parallel.
+	VariantParser::StreamBuffer stream;
 
 	struct ExtResource {
 		Ref<Resource> cache;
@@ -84,6 +89,33 @@ class ResourceLoaderText {
 	Error _parse_sub_resource(VariantParser::Stream *p_stream, Ref<Resource> &r_res, int &line, String &r_err_str);
 	Error _parse_ext_resource(VariantParser::Stream *p_stream, Ref<Resource> &r_res, int &line, String &r_err_str);
 
+	void _read_stream();
+	Error _create_sub_resource(const VariantParser::Tag &p_tag, Ref<Resource> &r_res, bool &r_do_assign, MissingResource *&r_missing_resource);
+	void _set_sub_resource_property(Resource *p_res, MissingResource *p_missing_resource, const String &p_name, const Variant &p_value, Dictionary &r_missing_resource_properties);
+
+	// A [sub_resource] whose properties are parsed on a worker thread.
+	struct SubResourceBlock {
+		ResourceLoaderText *loader = nullptr;
+		const HashMap<String, uint32_t> *block_ids = nullptr; // Index of the block defining each id.
+		uint32_t index = 0;
+		VariantParser::Tag tag;
+		uint64_t from = 0; // Right after the tag.
+		uint64_t to = 0; // Start of the next tag.
+		int line = 0;
+
+		LocalVector<Pair<String, Variant>> properties;
+		LocalVector<String> missing_ext_resources;
+		Error error = OK;
+		String error_text;
+		int error_line = 0;
+	};
+
+	static Error _parse_block_sub_resources(void *p_block, VariantParser::Stream *p_stream, Ref<Resource> &r_res, int &line, String &r_err_str);
+	static Error _parse_block_ext_resources(void *p_block, VariantParser::Stream *p_stream, Ref<Resource> &r_res, int &line, String &r_err_str);
+	static uint64_t _find_next_tag(const uint8_t *p_data, uint64_t p_from, uint64_t p_to, int &r_lines);
+	void _parse_sub_resource_block(SubResourceBlock &p_block);
+	Error _load_sub_resources_parallel();
+
 	// for converter
 	class DummyResource : public Resource {
 	public:
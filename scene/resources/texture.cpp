@@ -237,6 +237,13 @@ RID ImageTexture::get_rid() const {
 	return texture;
 }
 
+uint64_t ImageTexture::get_memory_usage() const {
+	if (w == 0 || h == 0) {
+		return 0;
+	}
+	return Image::get_image_data_size(w, h, format, mipmaps);
+}
+
 bool ImageTexture::has_alpha() const {
 	return (format == Image::FORMAT_LA8 || format == Image::FORMAT_RGBA8);
 }
@@ -669,20 +676,33 @@ Ref<Image> CompressedTexture2D::load_image_from_file(Ref<FileAccess> f, int p_si
 				continue;
 			}
 
-			Vector<uint8_t> pv;
-			pv.resize(size);
-			{
-				uint8_t *wr = pv.ptrw();
-				f->get_buffer(wr, size);
-			}
-
 			Ref<Image> img;
-			if (data_format == DATA_FORMAT_BASIS_UNIVERSAL && Image::basis_universal_unpacker) {
-				img = Image::basis_universal_unpacker(pv);
-			} else if (data_format == DATA_FORMAT_PNG && Image::png_unpacker) {
-				img = Image::png_unpacker(pv);
-			} else if (data_format == DATA_FORMAT_WEBP && Image::webp_unpacker) {
-				img = Image::webp_unpacker(pv);
+
+			// Decode in place when the file is mapped in memory (e.g. from a PCK).
+			const uint8_t *view = f->get_buffer_view(size);
+			if (view) {
+				if (data_format == DATA_FORMAT_BASIS_UNIVERSAL && Image::basis_universal_unpacker_ptr) {
+					img = Image::basis_universal_unpacker_ptr(view, size);
+				} else if (data_format == DATA_FORMAT_PNG && Image::png_unpacker_ptr) {
+					img = Image::png_unpacker_ptr(view, size);
+				} else if (data_format == DATA_FORMAT_WEBP && Image::webp_unpacker_ptr) {
+					img = Image::webp_unpacker_ptr(view, size);
+				}
+			} else {
+				Vector<uint8_t> pv;
+				pv.resize(size);
+				{
+					uint8_t *wr = pv.ptrw();
+					f->get_buffer(wr, size);
+				}
+
+				if (data_format == DATA_FORMAT_BASIS_UNIVERSAL && Image::basis_universal_unpacker) {
+					img = Image::basis_universal_unpacker(pv);
+				} else if (data_format == DATA_FORMAT_PNG && Image::png_unpacker) {
+					img = Image::png_unpacker(pv);
+				} else if (data_format == DATA_FORMAT_WEBP && Image::webp_unpacker) {
+					img = Image::webp_unpacker(pv);
+				}
 			}
 
 			if (img.is_null() || img->is_empty()) {
@@ -969,6 +989,14 @@ void CompressedTexture2D::draw_rect_region(RID p_canvas_item, const Rect2 &p_rec
 	RenderingServer::get_singleton()->canvas_item_add_texture_rect_region(p_canvas_item, p_rect, texture, p_src_rect, p_modulate, p_transpose, p_clip_uv);
 }
 
+uint64_t CompressedTexture2D::get_memory_usage() const {
+	if (w == 0 || h == 0) {
+		return 0;
+	}
+	// Whether mipmaps were imported is not kept around, count the base level only.
+	return Image::get_image_data_size(w, h, format, false);
+}
+
 bool CompressedTexture2D::has_alpha() const {
 	return false;
 }
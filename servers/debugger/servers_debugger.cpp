@@ -106,12 +106,13 @@ Array ServersDebugger::ServersProfilerFrame::serialize() {
 		}
 	}
 
-	arr.push_back(script_functions.size() * 4);
+	arr.push_back(script_functions.size() * 5);
 	for (int i = 0; i < script_functions.size(); i++) {
 		arr.push_back(script_functions[i].sig_id);
 		arr.push_back(script_functions[i].call_count);
 		arr.push_back(script_functions[i].self_time);
 		arr.push_back(script_functions[i].total_time);
+		arr.push_back(script_functions[i].alloc_count);
 	}
 	return arr;
 }
@@ -147,14 +148,15 @@ bool ServersDebugger::ServersProfilerFrame::deserialize(const Array &p_arr) {
 	int func_size = p_arr[idx];
 	idx += 1;
 	CHECK_SIZE(p_arr, idx + func_size, "ServersProfilerFrame");
-	for (int i = 0; i < func_size / 4; i++) {
+	for (int i = 0; i < func_size / 5; i++) {
 		ScriptFunctionInfo fi;
 		fi.sig_id = p_arr[idx];
 		fi.call_count = p_arr[idx + 1];
 		fi.self_time = p_arr[idx + 2];
 		fi.total_time = p_arr[idx + 3];
+		fi.alloc_count = p_arr[idx + 4];
 		script_functions.push_back(fi);
-		idx += 4;
+		idx += 5;
 	}
 	CHECK_END(p_arr, idx, "ServersProfilerFrame");
 	return true;
@@ -198,6 +200,7 @@ class ServersDebugger::ScriptsProfiler : public EngineProfiler {
 		}
 	};
 	Vector<ScriptLanguage::ProfilingInfo> info;
+	Vector<uint64_t> alloc_counts; // Same order as info.
 	Vector<ScriptLanguage::ProfilingInfo *> ptrs;
 	HashMap<StringName, int> sig_map;
 	int max_frame_functions = 16;
@@ -223,9 +226,9 @@ public:
 		int ofs = 0;
 		for (int i = 0; i < ScriptServer::get_language_count(); i++) {
 			if (p_accumulated) {
-				ofs += ScriptServer::get_language(i)->profiling_get_accumulated_data(&info.write[ofs], info.size() - ofs);
+				ofs += ScriptServer::get_language(i)->profiling_get_accumulated_data_and_allocs(&info.write[ofs], &alloc_counts.write[ofs], info.size() - ofs);
 			} else {
-				ofs += ScriptServer::get_language(i)->profiling_get_frame_data(&info.write[ofs], info.size() - ofs);
+				ofs += ScriptServer::get_language(i)->profiling_get_frame_data_and_allocs(&info.write[ofs], &alloc_counts.write[ofs], info.size() - ofs);
 			}
 		}
 
@@ -263,11 +266,13 @@ public:
 			w[i].call_count = ptrs[i]->call_count;
 			w[i].total_time = ptrs[i]->total_time / 1000000.0;
 			w[i].self_time = ptrs[i]->self_time / 1000000.0;
+			w[i].alloc_count = alloc_counts[ptrs[i] - info.ptr()];
 		}
 	}
 
 	ScriptsProfiler() {
 		info.resize(GLOBAL_GET("debug/settings/profiler/max_functions"));
+		alloc_counts.resize(info.size());
 		ptrs.resize(info.size());
 	}
 };
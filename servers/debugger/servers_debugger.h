@@ -69,6 +69,7 @@ public:
 		int call_count = 0;
 		double self_time = 0;
 		double total_time = 0;
+		int alloc_count = 0;
 	};
 
 	// Servers profiler
@@ -72,6 +72,10 @@ public:
 
 	};
 
+	enum {
+		INTERSECTION_QUERY_MAX = 2048
+	};
+
 private:
 	uint64_t elapsed_time[ELAPSED_TIME_MAX] = {};
 
@@ -100,10 +104,6 @@ private:
 	real_t contact_max_allowed_penetration = 0.0;
 	real_t contact_bias = 0.0;
 
-	enum {
-		INTERSECTION_QUERY_MAX = 2048
-	};
-
 	GodotCollisionObject3D *intersection_query_results[INTERSECTION_QUERY_MAX];
 	int intersection_query_subindex_results[INTERSECTION_QUERY_MAX];
 
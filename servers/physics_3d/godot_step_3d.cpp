@@ -32,6 +32,7 @@
 
 #include "godot_joint_3d.h"
 
+#include "core/debugger/frame_profiler.h"
 #include "core/os/os.h"
 
 #define BODY_ISLAND_COUNT_RESERVE 128
@@ -182,6 +183,8 @@ void GodotStep3D::_check_suspend(const LocalVector<GodotBody3D *> &p_body_island
 }
 
 void GodotStep3D::step(GodotSpace3D *p_space, real_t p_delta) {
+	FRAME_PROFILE_ZONE("GodotStep3D::step");
+
 	p_space->lock(); // can't access space during this
 
 	p_space->setup(); //update inertias, etc
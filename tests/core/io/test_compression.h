@@ -0,0 +1,209 @@
+/*************************************************************************/
+/*  test_compression.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_COMPRESSION_H
+#define TEST_COMPRESSION_H
+
+#include "core/io/compression.h"
+#include "core/io/stream_peer_zstd.h"
+#include "core/math/random_pcg.h"
+
+#include "tests/test_macros.h"
+
+namespace TestCompression {
+
+// Like network messages or save files: small, and much alike.
+static Vector<uint8_t> make_message(int p_index) {
+	const String text = vformat("{\"type\":\"player_state\",\"id\":%d,\"position\":[%d,%d],\"health\":%d,\"inventory\":[\"sword\",\"shield\",\"potion\"]}", p_index, p_index * 13 % 1000, p_index * 7 % 500, 100 - p_index % 100);
+	const CharString utf8 = text.utf8();
+	Vector<uint8_t> data;
+	data.resize(utf8.length());
+	memcpy(data.ptrw(), utf8.get_data(), utf8.length());
+	return data;
+}
+
+static Vector<uint8_t> compress(const Vector<uint8_t> &p_data, const CompressionDictionary *p_dictionary = nullptr) {
+	Vector<uint8_t> compressed;
+	compressed.resize(Compression::get_max_compressed_buffer_size(p_data.size(), Compression::MODE_ZSTD));
+	int size = Compression::compress(compressed.ptrw(), p_data.ptr(), p_data.size(), Compression::MODE_ZSTD, p_dictionary);
+	compressed.resize(MAX(size, 0));
+	return compressed;
+}
+
+static Vector<uint8_t> decompress(const Vector<uint8_t> &p_compressed, int p_size, const CompressionDictionary *p_dictionary = nullptr) {
+	Vector<uint8_t> data;
+	data.resize(p_size);
+	int size = Compression::decompress(data.ptrw(), p_size, p_compressed.ptr(), p_compressed.size(), Compression::MODE_ZSTD, p_dictionary);
+	data.resize(MAX(size, 0));
+	return data;
+}
+
+TEST_CASE("[Compression] Many small ZSTD payloads") {
+	// Contexts are reused between calls, each call must still start from a clean state.
+	bool all_equal = true;
+	for (int i = 0; i < 1000; i++) {
+		const Vector<uint8_t> message = make_message(i);
+		if (decompress(compress(message), message.size()) != message) {
+			all_equal = false;
+		}
+	}
+	CHECK(all_equal);
+}
+
+TEST_CASE("[Compression] Large ZSTD payloads are compressed in parallel frames") {
+	Vector<uint8_t> data;
+	data.resize(5 * 1024 * 1024 + 1234);
+	RandomPCG rng(7);
+	for (int i = 0; i < data.size(); i++) {
+		// Compressible, but not trivially.
+		data.write[i] = (i % 97) + (rng.rand() % 4);
+	}
+
+	const bool multithreaded = Compression::zstd_multithreaded;
+
+	Compression::zstd_multithreaded = false;
+	const Vector<uint8_t> single = compress(data);
+	REQUIRE(single.size() > 0);
+	CHECK(decompress(single, data.size()) == data);
+
+	Compression::zstd_multithreaded = true;
+	const Vector<uint8_t> split = compress(data);
+	REQUIRE(split.size() > 0);
+	CHECK(split != single);
+	CHECK(decompress(split, data.size()) == data);
+
+	// Either way, the data is regular ZSTD and decodes the same when the setting changes.
+	Compression::zstd_multithreaded = false;
+	CHECK(decompress(split, data.size()) == data);
+
+	// Too small a buffer fails cleanly.
+	ERR_PRINT_OFF;
+	Vector<uint8_t> small;
+	small.resize(data.size() - 1);
+	CHECK(Compression::decompress(small.ptrw(), small.size(), split.ptr(), split.size(), Compression::MODE_ZSTD) == -1);
+	ERR_PRINT_ON;
+
+	Compression::zstd_multithreaded = multithreaded;
+}
+
+TEST_CASE("[CompressionDictionary] Small similar payloads compress better with a dictionary") {
+	Vector<Vector<uint8_t>> samples;
+	for (int i = 0; i < 200; i++) {
+		samples.push_back(make_message(i));
+	}
+	Ref<CompressionDictionary> dictionary = CompressionDictionary::create_from_samples(samples, 4096);
+	REQUIRE(dictionary.is_valid());
+
+	int plain_size = 0;
+	int dictionary_size = 0;
+	bool all_equal = true;
+	for (int i = 1000; i < 1100; i++) {
+		const Vector<uint8_t> message = make_message(i);
+		plain_size += compress(message).size();
+		const Vector<uint8_t> compressed = dictionary->compress(message);
+		dictionary_size += compressed.size();
+		if (dictionary->decompress(compressed, message.size()) != message) {
+			all_equal = false;
+		}
+	}
+	CHECK(all_equal);
+	CHECK(dictionary_size * 2 < plain_size);
+
+	// Unrelated samples have nothing to share.
+	Vector<Vector<uint8_t>> unrelated;
+	unrelated.push_back(make_message(0));
+	CHECK(CompressionDictionary::create_from_samples(unrelated).is_null());
+}
+
+TEST_CASE("[CompressionDictionary] Data can't change once the dictionary was used") {
+	Vector<Vector<uint8_t>> samples;
+	for (int i = 0; i < 200; i++) {
+		samples.push_back(make_message(i));
+	}
+	Ref<CompressionDictionary> built = CompressionDictionary::create_from_samples(samples, 4096);
+	REQUIRE(built.is_valid());
+
+	// Restoring stored data on a new dictionary works until it's used.
+	Ref<CompressionDictionary> dictionary;
+	dictionary.instantiate();
+	dictionary->set_data(Vector<uint8_t>());
+	dictionary->set_data(built->get_data());
+	const Vector<uint8_t> message = make_message(1000);
+	const Vector<uint8_t> compressed = dictionary->compress(message);
+
+	ERR_PRINT_OFF;
+	dictionary->set_data(Vector<uint8_t>());
+	ERR_PRINT_ON;
+	CHECK(dictionary->get_data() == built->get_data());
+	CHECK(dictionary->decompress(compressed, message.size()) == message);
+	CHECK(built->decompress(compressed, message.size()) == message);
+}
+
+TEST_CASE("[StreamPeerZSTD] Stream round trip with a dictionary") {
+	Vector<Vector<uint8_t>> samples;
+	for (int i = 0; i < 200; i++) {
+		samples.push_back(make_message(i));
+	}
+	Ref<CompressionDictionary> dictionary = CompressionDictionary::create_from_samples(samples, 4096);
+	REQUIRE(dictionary.is_valid());
+
+	Vector<uint8_t> data;
+	for (int i = 0; i < 500; i++) {
+		data.append_array(make_message(i));
+	}
+
+	Ref<StreamPeerZSTD> compressor;
+	compressor.instantiate();
+	compressor->set_dictionary(dictionary);
+	REQUIRE(compressor->start_compression(1 << 20) == OK);
+	for (int ofs = 0; ofs < data.size(); ofs += 1000) {
+		CHECK(compressor->put_data(data.ptr() + ofs, MIN(1000, data.size() - ofs)) == OK);
+	}
+	CHECK(compressor->finish() == OK);
+	Vector<uint8_t> compressed;
+	compressed.resize(compressor->get_available_bytes());
+	CHECK(compressor->get_data(compressed.ptrw(), compressed.size()) == OK);
+	CHECK(compressed.size() < data.size() / 4);
+
+	Ref<StreamPeerZSTD> decompressor;
+	decompressor.instantiate();
+	decompressor->set_dictionary(dictionary);
+	REQUIRE(decompressor->start_decompression(1 << 20) == OK);
+	for (int ofs = 0; ofs < compressed.size(); ofs += 100) {
+		CHECK(decompressor->put_data(compressed.ptr() + ofs, MIN(100, compressed.size() - ofs)) == OK);
+	}
+	Vector<uint8_t> decompressed;
+	decompressed.resize(decompressor->get_available_bytes());
+	CHECK(decompressor->get_data(decompressed.ptrw(), decompressed.size()) == OK);
+	CHECK(decompressed == data);
+}
+} // namespace TestCompression
+
+#endif // TEST_COMPRESSION_H
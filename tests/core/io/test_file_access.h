@@ -32,6 +32,11 @@
 #define TEST_FILE_ACCESS_H
 
 #include "core/io/file_access.h"
+#include "core/io/file_access_compressed.h"
+#include "core/io/file_access_memory.h"
+#include "core/io/file_access_pack.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
 #include "tests/test_macros.h"
 #include "tests/test_utils.h"
 
@@ -101,6 +106,232 @@ TEST_CASE("[FileAccess] Get as UTF-8 String") {
 	CHECK(s_cr == "Hello darkness\rMy old friend\rI've come to talk\rWith you again\r");
 	CHECK(s_cr_nocr == "Hello darknessMy old friendI've come to talkWith you again");
 }
+
+TEST_CASE("[FileAccess] Mapping and buffer views") {
+	Ref<FileAccess> f = FileAccess::open(TestUtils::get_data_path("translations.csv"), FileAccess::READ);
+	REQUIRE(f.is_valid());
+	Vector<uint8_t> contents = f->_get_buffer(f->get_length());
+
+	uint64_t length = 0;
+	const uint8_t *mapped = f->map_contents(length);
+#ifdef UNIX_ENABLED
+	REQUIRE(mapped != nullptr);
+#endif
+	if (mapped) {
+		CHECK(length == (uint64_t)contents.size());
+		CHECK(memcmp(mapped, contents.ptr(), length) == 0);
+	}
+
+	Ref<FileAccessMemory> memory;
+	memory.instantiate();
+	memory->open_custom(contents.ptr(), contents.size());
+	memory->seek(4);
+	const uint8_t *view = memory->get_buffer_view(8);
+	CHECK(view == contents.ptr() + 4);
+	CHECK(memory->get_position() == 12);
+	CHECK(memory->get_buffer_view(contents.size()) == nullptr);
+}
+
+TEST_CASE("[FileAccess] Mapped pack files read like regular ones") {
+	const String path = OS::get_singleton()->get_cache_path().path_join("file_access_pack_mapping.bin");
+	Vector<uint8_t> contents;
+	for (int i = 0; i < 256; i++) {
+		contents.push_back(i);
+	}
+	{
+		Ref<FileAccess> f = FileAccess::open(path, FileAccess::WRITE);
+		REQUIRE(f.is_valid());
+		f->store_buffer(contents.ptr(), contents.size());
+	}
+
+	PackedData::PackedFile pf;
+	pf.pack = path;
+	pf.offset = 16;
+	pf.size = 100;
+	pf.encrypted = false;
+
+	Ref<FileAccessMemory> pack;
+	pack.instantiate();
+	pack->open_custom(contents.ptr(), contents.size());
+
+	Ref<FileAccess> regular = memnew(FileAccessPack(path, pf));
+	Ref<FileAccess> mapped = memnew(FileAccessPack(path, pf, pack, contents.ptr() + pf.offset));
+
+	CHECK(regular->get_32() == mapped->get_32());
+	regular->seek(50);
+	mapped->seek(50);
+	uint8_t a[10];
+	uint8_t b[10];
+	CHECK(regular->get_buffer(a, 10) == 10);
+	CHECK(mapped->get_buffer(b, 10) == 10);
+	CHECK(memcmp(a, b, 10) == 0);
+
+	// Only the mapped file can hand out views.
+	CHECK(regular->get_buffer_view(10) == nullptr);
+	CHECK(mapped->get_buffer_view(10) == contents.ptr() + pf.offset + 60);
+	CHECK(mapped->get_position() == 70);
+	CHECK(mapped->get_buffer_view(40) == nullptr);
+
+	regular->seek(95);
+	mapped->seek(95);
+	CHECK(regular->get_buffer(a, 10) == 5);
+	CHECK(mapped->get_buffer(b, 10) == 5);
+	CHECK(memcmp(a, b, 5) == 0);
+	CHECK(regular->eof_reached());
+	CHECK(mapped->eof_reached());
+}
+
+TEST_CASE("[FileAccess] Asynchronous reads") {
+	const String path = OS::get_singleton()->get_cache_path().path_join("file_access_async_reads.bin");
+	Vector<uint8_t> contents;
+	contents.resize(100000);
+	for (int i = 0; i < contents.size(); i++) {
+		contents.write[i] = (i * 7) & 0xFF;
+	}
+	{
+		Ref<FileAccess> f = FileAccess::open(path, FileAccess::WRITE);
+		REQUIRE(f.is_valid());
+		f->store_buffer(contents.ptr(), contents.size());
+	}
+
+	Ref<FileAccessMemory> memory;
+	memory.instantiate();
+	memory->open_custom(contents.ptr(), contents.size());
+
+	PackedData::PackedFile pf;
+	pf.pack = path;
+	pf.offset = 1000;
+	pf.size = 50000;
+	pf.encrypted = false;
+
+	Ref<FileAccess> files[3] = { FileAccess::open(path, FileAccess::READ), memory, memnew(FileAccessPack(path, pf)) };
+	const uint64_t bases[3] = { 0, 0, pf.offset };
+	const uint64_t lengths[3] = { (uint64_t)contents.size(), (uint64_t)contents.size(), pf.size };
+
+	for (int i = 0; i < 3; i++) {
+		Ref<FileAccess> f = files[i];
+		REQUIRE(f.is_valid());
+		f->seek(123);
+
+		// Many reads in flight at once, including one crossing the end.
+		const int count = 16;
+		const uint64_t chunk = 4096;
+		Vector<uint8_t> buffer;
+		buffer.resize(count * chunk);
+		FileAccess::AsyncReadID ids[count];
+		for (int j = 0; j < count; j++) {
+			ids[j] = f->read_async(j * 3333, buffer.ptrw() + j * chunk, chunk);
+			REQUIRE(ids[j] != FileAccess::INVALID_ASYNC_READ_ID);
+		}
+		FileAccess::AsyncReadID past_end = f->read_async(lengths[i] - 10, buffer.ptrw(), chunk);
+
+		for (int j = count - 1; j >= 0; j--) {
+			Error err = FAILED;
+			CHECK(f->wait_async_read(ids[j], &err) == chunk);
+			CHECK(err == OK);
+			CHECK(memcmp(buffer.ptr() + j * chunk, contents.ptr() + bases[i] + j * 3333, chunk) == 0);
+		}
+		CHECK(f->wait_async_read(past_end) == 10);
+
+		// The cursor is left alone.
+		CHECK(f->get_position() == 123);
+
+		ERR_PRINT_OFF;
+		Error err = OK;
+		CHECK(f->wait_async_read(ids[0], &err) == 0);
+		CHECK(err == ERR_INVALID_PARAMETER);
+		ERR_PRINT_ON;
+	}
+
+	// Reads still in flight are finished before closing.
+	Ref<FileAccess> f = FileAccess::open(path, FileAccess::READ);
+	uint8_t byte = 0;
+	f->read_async(7, &byte, 1);
+	f.unref();
+	CHECK(byte == contents[7]);
+}
+
+TEST_CASE("[FileAccess] Compressed files seek and read blocks on demand") {
+	const String path = OS::get_singleton()->get_cache_path().path_join("file_access_compressed.bin");
+	// Many similar records, like text resources.
+	String text;
+	for (int i = 0; i < 2000; i++) {
+		text += vformat("[node name=\"Sprite%d\" type=\"Sprite2D\" parent=\".\"]\nposition = Vector2(%d, %d)\n\n", i, i * 3, i * 7);
+	}
+	const CharString utf8 = text.utf8();
+	Vector<uint8_t> contents;
+	contents.resize(utf8.length());
+	memcpy(contents.ptrw(), utf8.get_data(), utf8.length());
+
+	Vector<Vector<uint8_t>> samples;
+	for (int i = 0; i < 20; i++) {
+		samples.push_back(contents.slice(i * 1000, i * 1000 + 500));
+	}
+	Ref<CompressionDictionary> dictionary = CompressionDictionary::create_from_samples(samples, 4096);
+	REQUIRE(dictionary.is_valid());
+	CHECK(dictionary->get_data().size() > 0);
+	CHECK(dictionary->get_data().size() <= 4096);
+
+	uint64_t compressed_sizes[2] = {};
+	for (int pass = 0; pass < 2; pass++) {
+		const Ref<CompressionDictionary> used = pass == 1 ? dictionary : Ref<CompressionDictionary>();
+		{
+			Ref<FileAccessCompressed> fac;
+			fac.instantiate();
+			fac->configure("GCMP", Compression::MODE_ZSTD, 1024);
+			fac->set_dictionary(used);
+			REQUIRE(fac->open_internal(path, FileAccess::WRITE) == OK);
+			fac->store_buffer(contents.ptr(), 5000);
+			for (int i = 5000; i < 5100; i++) {
+				fac->store_8(contents[i]);
+			}
+			fac->store_buffer(contents.ptr() + 5100, contents.size() - 5100);
+		}
+		compressed_sizes[pass] = FileAccess::open(path, FileAccess::READ)->get_length();
+
+		Ref<FileAccessCompressed> fac;
+		fac.instantiate();
+		fac->configure("GCMP");
+		fac->set_dictionary(used);
+		REQUIRE(fac->open_internal(path, FileAccess::READ) == OK);
+		CHECK(fac->get_length() == (uint64_t)contents.size());
+
+		// Whole blocks are read at once, partial ones through the cached block.
+		Vector<uint8_t> whole;
+		whole.resize(contents.size());
+		CHECK(fac->get_buffer(whole.ptrw(), whole.size()) == (uint64_t)contents.size());
+		CHECK(whole == contents);
+		CHECK_FALSE(fac->eof_reached());
+
+		RandomPCG rng(pass + 1);
+		bool all_equal = true;
+		for (int i = 0; i < 200; i++) {
+			const uint64_t from = rng.rand() % contents.size();
+			const uint64_t length = MIN((uint64_t)rng.rand() % 5000, contents.size() - from);
+			fac->seek(from);
+			uint8_t buffer[5000];
+			if (fac->get_buffer(buffer, length) != length || memcmp(buffer, contents.ptr() + from, length) != 0) {
+				all_equal = false;
+			}
+			if (length > 0 && fac->get_8() != (from + length < (uint64_t)contents.size() ? contents[from + length] : 0)) {
+				all_equal = false;
+			}
+		}
+		CHECK(all_equal);
+
+		fac->seek(contents.size() - 5);
+		uint8_t tail[10];
+		CHECK(fac->get_buffer(tail, 10) == 5);
+		CHECK(memcmp(tail, contents.ptr() + contents.size() - 5, 5) == 0);
+		CHECK(fac->eof_reached());
+		fac->seek(0);
+		CHECK_FALSE(fac->eof_reached());
+		CHECK(fac->get_8() == contents[0]);
+	}
+
+	// Every block benefits from the content shared with the others.
+	CHECK(compressed_sizes[1] < compressed_sizes[0]);
+}
 } // namespace TestFileAccess
 
 #endif // TEST_FILE_ACCESS_H
@@ -0,0 +1,339 @@
+/*************************************************************************/
+/*  test_json_stream.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_JSON_STREAM_H
+#define TEST_JSON_STREAM_H
+
+#include "core/io/file_access_memory.h"
+#include "core/io/json.h"
+#include "core/io/json_stream.h"
+#include "core/os/os.h"
+
+#include "tests/test_macros.h"
+
+namespace TestJSONStream {
+
+class EventRecorder : public JSONStreamHandler {
+public:
+	String events;
+	const uint8_t *buffer_begin = nullptr;
+	const uint8_t *buffer_end = nullptr;
+	int in_place_strings = 0;
+
+	virtual Error on_null() override {
+		events += "null ";
+		return OK;
+	}
+	virtual Error on_bool(bool p_value) override {
+		events += p_value ? "true " : "false ";
+		return OK;
+	}
+	virtual Error on_int(int64_t p_value) override {
+		events += "i:" + itos(p_value) + " ";
+		return OK;
+	}
+	virtual Error on_float(double p_value) override {
+		events += "f:" + rtos(p_value) + " ";
+		return OK;
+	}
+	virtual Error on_string(const char *p_utf8, int p_length) override {
+		if ((const uint8_t *)p_utf8 >= buffer_begin && (const uint8_t *)p_utf8 < buffer_end) {
+			in_place_strings++;
+		}
+		events += "s:" + String::utf8(p_utf8, p_length) + " ";
+		return OK;
+	}
+	virtual Error on_key(const char *p_utf8, int p_length) override {
+		events += "k:" + String::utf8(p_utf8, p_length) + " ";
+		return OK;
+	}
+	virtual Error on_array_begin() override {
+		events += "[ ";
+		return OK;
+	}
+	virtual Error on_array_end() override {
+		events += "] ";
+		return OK;
+	}
+	virtual Error on_object_begin() override {
+		events += "{ ";
+		return OK;
+	}
+	virtual Error on_object_end() override {
+		events += "} ";
+		return OK;
+	}
+};
+
+static Error parse_utf8(JSONReader &p_reader, const String &p_json, JSONStreamHandler *p_handler) {
+	CharString utf8 = p_json.utf8();
+	return p_reader.parse((const uint8_t *)utf8.get_data(), utf8.length(), p_handler);
+}
+
+TEST_CASE("[JSONStream] Reader events") {
+	JSONReader reader;
+	EventRecorder recorder;
+	CharString json = String(R"({"a": [1, -2.5, true, false, null, "x"], "b": {}, "c": []})").utf8();
+	recorder.buffer_begin = (const uint8_t *)json.get_data();
+	recorder.buffer_end = recorder.buffer_begin + json.length();
+
+	CHECK(reader.parse((const uint8_t *)json.get_data(), json.length(), &recorder) == OK);
+	CHECK(recorder.events == "{ k:a [ i:1 f:-2.5 true false null s:x ] k:b { } k:c [ ] } ");
+	// Strings without escapes are handed out without copying.
+	CHECK(recorder.in_place_strings == 1);
+}
+
+TEST_CASE("[JSONStream] Reader strings and numbers") {
+	JSONReader reader;
+	EventRecorder recorder;
+	CHECK(parse_utf8(reader, R"(["tab\tquote\"slash\\", "\u00e9\u4e2d\ud83d\ude00", "ünïcödé"])", &recorder) == OK);
+	CHECK(recorder.events == String::utf8("[ s:tab\tquote\"slash\\ s:é中😀 s:ünïcödé ] "));
+
+	// Integers beyond the exact range of doubles are reported exactly.
+	recorder.events = "";
+	CHECK(parse_utf8(reader, "[9007199254740993, -123456789012345678, 1e3, 0.25]", &recorder) == OK);
+	CHECK(recorder.events == "[ i:9007199254740993 i:-123456789012345678 f:1000 f:0.25 ] ");
+
+	// Too large for 64 bits, falls back to a float.
+	Variant big;
+	CHECK(reader.parse_variant((const uint8_t *)"12345678901234567890", 20, big) == OK);
+	CHECK(big.get_type() == Variant::FLOAT);
+	CHECK(Math::is_equal_approx(double(big), 12345678901234567890.0));
+}
+
+TEST_CASE("[JSONStream] Reader matches JSON::parse()") {
+	const char *documents[] = {
+		"null",
+		"  123456  ",
+		"\"hello\"",
+		R"(["Hello", "world.", "This is",["a","json","array.",[]], "Empty arrays ahoy:", [[["Gotcha!"]]]])",
+		R"({"name": "Godot Engine", "is_free": true, "bugs": null, "apples": {"red": 500, "green": 0, "blue": -20}, "empty_object": {}})",
+		"[1, 2, 3,]",
+		"{\n\t\"multi\": [\n\t\t0.5,\n\t\t\"line\"\n\t]\n}\n",
+	};
+
+	for (const char *document : documents) {
+		JSON json;
+		CHECK(json.parse(String::utf8(document)) == OK);
+
+		JSONReader reader;
+		Variant streamed;
+		CHECK(reader.parse_variant((const uint8_t *)document, strlen(document), streamed) == OK);
+		CHECK(streamed.hash() == json.get_data().hash());
+	}
+}
+
+TEST_CASE("[JSONStream] Reader errors match JSON::parse()") {
+	const char *documents[] = {
+		"",
+		"[1, 2",
+		"{\"a\" 1}",
+		"{\"a\": 1\n\"b\": 2}",
+		"[\n\n\"unterminated",
+		"[nope]",
+		"[1] 2",
+		"{1: 2}",
+		"[\"\\ud800\"]",
+	};
+
+	ERR_PRINT_OFF
+	for (const char *document : documents) {
+		JSON json;
+		Error json_err = json.parse(String::utf8(document));
+
+		JSONReader reader;
+		Variant streamed;
+		Error stream_err = reader.parse_variant((const uint8_t *)document, strlen(document), streamed);
+		CHECK_MESSAGE(stream_err == json_err, document);
+		CHECK_MESSAGE(reader.get_error_line() == json.get_error_line(), document);
+		CHECK(streamed == Variant());
+	}
+	ERR_PRINT_ON
+}
+
+TEST_CASE("[JSONStream] Reader rejects malformed numbers") {
+	const char *valid[] = { "0", "-0", "10", "-1.5", "0.25e-3", "1E+2", "2e10" };
+	for (const char *document : valid) {
+		JSONReader reader;
+		Variant value;
+		CHECK_MESSAGE(reader.parse_variant((const uint8_t *)document, strlen(document), value) == OK, document);
+	}
+
+	const char *malformed[] = { "1-2", "1e", "1e+", "-", "--1", "01", "-01", "1.", ".5", "1.e3", "1..2", "1e2.5", "+1", "[1, 2-]" };
+	ERR_PRINT_OFF
+	for (const char *document : malformed) {
+		JSONReader reader;
+		Variant value;
+		CHECK_MESSAGE(reader.parse_variant((const uint8_t *)document, strlen(document), value) == ERR_PARSE_ERROR, document);
+		CHECK(value == Variant());
+	}
+	ERR_PRINT_ON
+}
+
+TEST_CASE("[JSONStream] Reader streams from a FileAccess") {
+	// Build a document much larger than one chunk, with strings and escapes
+	// straddling chunk boundaries.
+	Array array;
+	for (int i = 0; i < 20000; i++) {
+		Dictionary entry;
+		entry["id"] = i;
+		entry["name"] = "entry \"" + itos(i) + "\"\n" + String::chr(0x4e2d);
+		entry["values"] = varray(i * 0.5, i % 2 == 0, Variant());
+		array.push_back(entry);
+	}
+	CharString json = JSON::stringify(array, "\t").utf8();
+	REQUIRE(json.length() > JSONReader::CHUNK_SIZE * 4);
+
+	Ref<FileAccessMemory> file;
+	file.instantiate();
+	file->open_custom((const uint8_t *)json.get_data(), json.length());
+
+	JSONReader reader;
+	Variant from_file;
+	CHECK(reader.parse_variant(file, from_file) == OK);
+
+	Variant from_memory;
+	CHECK(reader.parse_variant((const uint8_t *)json.get_data(), json.length(), from_memory) == OK);
+	CHECK(from_file.hash() == from_memory.hash());
+	CHECK(from_file.hash() == JSON::parse_string(String::utf8(json.get_data())).hash());
+}
+
+TEST_CASE("[JSONStream] Writer matches JSON::stringify()") {
+	Dictionary nested;
+	nested["quote"] = "say \"hi\"\n\ttab";
+	nested["unicode"] = String::utf8("ünïcödé 中 😀");
+	nested["empty_array"] = Array();
+	nested["empty_object"] = Dictionary();
+	PackedInt32Array ints;
+	ints.push_back(1);
+	ints.push_back(-2);
+	ints.push_back(3);
+	nested["ints"] = ints;
+
+	Dictionary root;
+	root["b"] = 42;
+	root["a"] = varray(1.5, true, Variant(), "x", nested);
+	root["c"] = 0.001;
+
+	const char *indents[] = { "", "\t", "  " };
+	for (const char *indent : indents) {
+		for (int sort = 0; sort < 2; sort++) {
+			Ref<StreamPeerBuffer> peer;
+			peer.instantiate();
+			{
+				JSONWriter writer(Ref<StreamPeer>(peer), indent);
+				writer.write_variant(root, sort);
+				CHECK(writer.flush() == OK);
+			}
+			Vector<uint8_t> data = peer->get_data_array();
+			String written = String::utf8((const char *)data.ptr(), data.size());
+			CHECK(written == JSON::stringify(root, indent, sort));
+		}
+	}
+}
+
+TEST_CASE("[JSONStream] Writer API round trip") {
+	Ref<StreamPeerBuffer> peer;
+	peer.instantiate();
+	{
+		JSONWriter writer((Ref<StreamPeer>(peer)));
+		writer.begin_object();
+		writer.write_key("id");
+		writer.write_int(-1234567890123);
+		writer.write_key("tags");
+		writer.begin_array();
+		writer.write_string("a\\b");
+		writer.write_string("raw\"utf8", 8);
+		writer.write_bool(false);
+		writer.write_null();
+		writer.end_array();
+		writer.end_object();
+	}
+
+	Vector<uint8_t> data = peer->get_data_array();
+	CHECK(String::utf8((const char *)data.ptr(), data.size()) == R"({"id":-1234567890123,"tags":["a\\b","raw\"utf8",false,null]})");
+
+	JSONReader reader;
+	EventRecorder recorder;
+	CHECK(reader.parse(data.ptr(), data.size(), &recorder) == OK);
+	CHECK(recorder.events == "{ k:id i:-1234567890123 k:tags [ s:a\\b s:raw\"utf8 false null ] } ");
+}
+
+TEST_CASE_BENCHMARK("[JSONStream][Benchmark] Multi-megabyte payloads") {
+	Array array;
+	for (int i = 0; i < 100000; i++) {
+		Dictionary entry;
+		entry["id"] = i;
+		entry["name"] = "player_" + itos(i);
+		entry["position"] = varray(i * 0.25, i * 0.5, -i * 0.75);
+		entry["online"] = i % 3 == 0;
+		array.push_back(entry);
+	}
+	CharString json = JSON::stringify(array).utf8();
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	JSON parser;
+	parser.parse(String::utf8(json.get_data(), json.length()));
+	uint64_t json_time = OS::get_singleton()->get_ticks_usec() - begin;
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	JSONReader reader;
+	Variant streamed;
+	reader.parse_variant((const uint8_t *)json.get_data(), json.length(), streamed);
+	uint64_t reader_time = OS::get_singleton()->get_ticks_usec() - begin;
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	JSONStreamHandler null_handler;
+	reader.parse((const uint8_t *)json.get_data(), json.length(), &null_handler);
+	uint64_t sax_time = OS::get_singleton()->get_ticks_usec() - begin;
+
+	print_line(vformat("Parsing %d bytes: JSON %d usec, JSONReader (Variant) %d usec, JSONReader (events only) %d usec", json.length(), json_time, reader_time, sax_time));
+	CHECK(streamed.hash() == parser.get_data().hash());
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	CharString stringified = JSON::stringify(array).utf8();
+	uint64_t stringify_time = OS::get_singleton()->get_ticks_usec() - begin;
+
+	Ref<StreamPeerBuffer> peer;
+	peer.instantiate();
+	begin = OS::get_singleton()->get_ticks_usec();
+	{
+		JSONWriter writer((Ref<StreamPeer>(peer)));
+		writer.write_variant(array);
+	}
+	uint64_t writer_time = OS::get_singleton()->get_ticks_usec() - begin;
+
+	print_line(vformat("Writing %d bytes: JSON::stringify %d usec, JSONWriter %d usec", stringified.length(), stringify_time, writer_time));
+	CHECK(peer->get_data_array().size() == stringified.length());
+}
+
+} // namespace TestJSONStream
+
+#endif // TEST_JSON_STREAM_H
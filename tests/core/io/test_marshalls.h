@@ -32,6 +32,8 @@
 #define TEST_MARSHALLS_H
 
 #include "core/io/marshalls.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
 
 #include "tests/test_macros.h"
 
@@ -326,6 +328,280 @@ TEST_CASE("[Marshalls] FLOAT double precision Variant decoding") {
 	CHECK(r_len == 12);
 	CHECK(variant == Variant(0.33333333333333333));
 }
+
+TEST_CASE("[Marshalls] Varint and ZigZag encoding") {
+	uint8_t buffer[10];
+
+	CHECK(encode_varint(0, buffer) == 1);
+	CHECK(buffer[0] == 0x00);
+	CHECK(encode_varint(127, buffer) == 1);
+	CHECK(buffer[0] == 0x7f);
+	CHECK(encode_varint(300, buffer) == 2);
+	CHECK(buffer[0] == 0xac);
+	CHECK(buffer[1] == 0x02);
+	CHECK_MESSAGE(encode_varint(300, nullptr) == 2, "Length can be computed without a buffer.");
+	CHECK(encode_varint(UINT64_MAX, buffer) == 10);
+
+	uint64_t value = 0;
+	CHECK(decode_varint(buffer, 10, value) == 10);
+	CHECK(value == UINT64_MAX);
+	CHECK_MESSAGE(decode_varint(buffer, 9, value) == 0, "Truncated varint is rejected.");
+
+	CHECK(encode_zigzag(0) == 0);
+	CHECK(encode_zigzag(-1) == 1);
+	CHECK(encode_zigzag(1) == 2);
+	CHECK(encode_zigzag(INT64_MIN) == UINT64_MAX);
+	CHECK(decode_zigzag(encode_zigzag(INT64_MIN)) == INT64_MIN);
+	CHECK(decode_zigzag(encode_zigzag(INT64_MAX)) == INT64_MAX);
+}
+
+TEST_CASE("[Marshalls] Compact Variant encoding") {
+	int r_len;
+	uint8_t buffer[16];
+
+	CHECK(encode_variant_compact(Variant(), buffer, r_len) == OK);
+	CHECK_MESSAGE(r_len == 1, "Length == 1 byte for the tag");
+	CHECK(buffer[0] == 0x00);
+
+	CHECK(encode_variant_compact(true, buffer, r_len) == OK);
+	CHECK_MESSAGE(r_len == 1, "Booleans are stored in the tag");
+	CHECK(buffer[0] == (0x40 | Variant::BOOL));
+
+	CHECK(encode_variant_compact(-3, buffer, r_len) == OK);
+	CHECK_MESSAGE(r_len == 1, "Small integers are stored in the tag");
+	CHECK(buffer[0] == (0x80 | (-3 + 64)));
+
+	CHECK(encode_variant_compact(0x12345678, buffer, r_len) == OK);
+	CHECK_MESSAGE(r_len == 6, "Length == 1 byte for the tag + 5 bytes for the ZigZag varint");
+	CHECK(buffer[0] == Variant::INT);
+
+	CHECK(encode_variant_compact(0.15625f, buffer, r_len) == OK);
+	CHECK_MESSAGE(r_len == 5, "Length == 1 byte for the tag + 4 bytes for float");
+	CHECK(buffer[0] == Variant::FLOAT);
+
+	CHECK(encode_variant_compact(0.33333333333333333, buffer, r_len) == OK);
+	CHECK_MESSAGE(r_len == 9, "Length == 1 byte for the tag + 8 bytes for double");
+	CHECK(buffer[0] == (0x40 | Variant::FLOAT));
+
+	CHECK(encode_variant_compact("Godot", buffer, r_len) == OK);
+	CHECK_MESSAGE(r_len == 7, "Length == 1 byte for the tag + 1 byte for the length + 5 bytes for UTF-8");
+
+	Array homogeneous;
+	for (int i = 0; i < 4; i++) {
+		homogeneous.push_back(1000 * i);
+	}
+	CHECK(encode_variant_compact(homogeneous, buffer, r_len) == OK);
+	CHECK_MESSAGE(r_len == 3 + 1 + 2 * 3, "Array elements share a single tag");
+	CHECK(buffer[0] == (0x40 | Variant::ARRAY));
+	CHECK(buffer[2] == Variant::INT);
+}
+
+TEST_CASE("[Marshalls] Compact Variant round trip") {
+	Dictionary dict;
+	dict["key"] = Vector3i(1, -2, 3);
+	dict[7] = StringName("name");
+	Array nested;
+	nested.push_back(Array());
+	nested.push_back(dict);
+
+	PackedInt64Array ints;
+	ints.push_back(INT64_MIN);
+	ints.push_back(0);
+	ints.push_back(INT64_MAX);
+	PackedFloat64Array doubles;
+	doubles.push_back(0.5);
+	doubles.push_back(0.1);
+	PackedStringArray strings;
+	strings.push_back("");
+	strings.push_back(U"Ünicode");
+
+	const Variant values[] = {
+		Variant(),
+		false,
+		true,
+		-64,
+		63,
+		64,
+		INT64_MIN,
+		INT64_MAX,
+		0.5,
+		0.1,
+		String(),
+		U"Ünicode",
+		StringName("name"),
+		NodePath("/root/node:property"),
+		Vector2(1.5, -2),
+		Vector2i(-100000, 7),
+		Rect2(1, 2, 3, 4),
+		Rect2i(-1, -2, 3, 4),
+		Vector3(0.1, 0.2, 0.3),
+		Vector4(1, 2, 3, 4),
+		Vector4i(1, 2, 3, 4),
+		Transform2D(0.5, Vector2(1, 2)),
+		Plane(0, 1, 0, 5),
+		Quaternion(0, 0, 0, 1),
+		AABB(Vector3(1, 2, 3), Vector3(4, 5, 6)),
+		Basis(Vector3(0, 1, 0), 0.5),
+		Transform3D(Basis(), Vector3(1, 2, 3)),
+		Projection(),
+		Color(0.25, 0.5, 0.75, 1),
+		RID::from_uint64(0x123456789),
+		dict,
+		nested,
+		PackedByteArray(),
+		ints,
+		doubles,
+		strings,
+		PackedVector2Array({ Vector2(1, 2), Vector2(3, 4) }),
+		PackedVector3Array({ Vector3(1, 2, 3) }),
+		PackedColorArray({ Color(1, 0, 0) }),
+	};
+
+	for (const Variant &value : values) {
+		int len = 0;
+		REQUIRE(encode_variant_compact(value, nullptr, len) == OK);
+		Vector<uint8_t> buffer;
+		buffer.resize(len);
+		int written = 0;
+		REQUIRE(encode_variant_compact(value, buffer.ptrw(), written) == OK);
+		CHECK(written == len);
+
+		Variant decoded;
+		int read = 0;
+		CHECK_MESSAGE(decode_variant_compact(decoded, buffer.ptr(), len, &read) == OK, Variant::get_type_name(value.get_type()));
+		CHECK(read == len);
+		CHECK_MESSAGE(decoded.get_type() == value.get_type(), Variant::get_type_name(value.get_type()));
+		CHECK_MESSAGE(decoded == value, Variant::get_type_name(value.get_type()));
+	}
+}
+
+static Variant _make_random_variant(RandomPCG &p_rng, int p_depth) {
+	switch (p_rng.rand(p_depth < 3 ? 12 : 9)) {
+		case 0:
+			return Variant();
+		case 1:
+			return p_rng.rand(2) == 1;
+		case 2:
+			// Spread the magnitudes, so every varint length gets exercised.
+			return int64_t((uint64_t(p_rng.rand()) << 32) | p_rng.rand()) >> p_rng.rand(64);
+		case 3:
+			return p_rng.rand(2) ? p_rng.randd() : double(p_rng.randf());
+		case 4:
+			return itos(p_rng.rand());
+		case 5:
+			return Vector2(p_rng.randf(), p_rng.rand(1000));
+		case 6:
+			return Vector3i(p_rng.rand(), -int(p_rng.rand(100)), 0);
+		case 7:
+			return Color(p_rng.randf(), p_rng.randf(), p_rng.randf());
+		case 8: {
+			PackedInt32Array arr;
+			for (uint32_t i = 0; i < p_rng.rand(16); i++) {
+				arr.push_back(p_rng.rand() >> p_rng.rand(32));
+			}
+			return arr;
+		}
+		case 9: {
+			Array arr;
+			uint32_t size = p_rng.rand(8);
+			bool homogeneous = p_rng.rand(2);
+			for (uint32_t i = 0; i < size; i++) {
+				arr.push_back(homogeneous ? Variant(int(p_rng.rand())) : _make_random_variant(p_rng, p_depth + 1));
+			}
+			return arr;
+		}
+		case 10: {
+			Dictionary dict;
+			for (uint32_t i = 0; i < p_rng.rand(6); i++) {
+				dict[itos(i)] = _make_random_variant(p_rng, p_depth + 1);
+			}
+			return dict;
+		}
+		default: {
+			PackedVector3Array arr;
+			for (uint32_t i = 0; i < p_rng.rand(8); i++) {
+				arr.push_back(Vector3(p_rng.randf(), p_rng.randf(), p_rng.randf()));
+			}
+			return arr;
+		}
+	}
+}
+
+TEST_CASE("[Marshalls] Compact Variant encoding fuzzing") {
+	RandomPCG rng(1234);
+	int compact_size = 0;
+	int regular_size = 0;
+
+	for (int i = 0; i < 2000; i++) {
+		const Variant value = _make_random_variant(rng, 0);
+
+		int len = 0;
+		REQUIRE(encode_variant_compact(value, nullptr, len) == OK);
+		Vector<uint8_t> buffer;
+		buffer.resize(len);
+		REQUIRE(encode_variant_compact(value, buffer.ptrw(), len) == OK);
+
+		Variant decoded;
+		int read = 0;
+		REQUIRE(decode_variant_compact(decoded, buffer.ptr(), len, &read) == OK);
+		CHECK(read == len);
+		CHECK(decoded == value);
+
+		// Truncated and corrupted data must fail cleanly instead of reading out of bounds.
+		ERR_PRINT_OFF;
+		if (len > 1) {
+			CHECK(decode_variant_compact(decoded, buffer.ptr(), rng.rand(len), &read) != OK);
+		}
+		buffer.write[rng.rand(len)] = rng.rand(256);
+		decode_variant_compact(decoded, buffer.ptr(), len, &read);
+		ERR_PRINT_ON;
+
+		int regular_len = 0;
+		REQUIRE(encode_variant(value, nullptr, regular_len) == OK);
+		compact_size += len;
+		regular_size += regular_len;
+	}
+
+	CHECK_MESSAGE(compact_size * 3 < regular_size * 2, "Compact encoding should be at least a third smaller than the regular one.");
+}
+
+TEST_CASE_BENCHMARK("[Marshalls][Benchmark] Compact and regular Variant encoding") {
+	// Typical replication state: transforms, small integers and flags.
+	Array state;
+	for (int i = 0; i < 64; i++) {
+		Array entity;
+		entity.push_back(i);
+		entity.push_back(Vector3(i * 0.5, 1, -i));
+		entity.push_back(Quaternion());
+		entity.push_back(i % 3 == 0);
+		entity.push_back(100 - i);
+		state.push_back(entity);
+	}
+
+	const int iterations = 2000;
+	for (int compact = 0; compact < 2; compact++) {
+		int len = 0;
+		Vector<uint8_t> buffer;
+		Variant decoded;
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < iterations; i++) {
+			Error err = compact ? encode_variant_compact(state, nullptr, len) : encode_variant(state, nullptr, len);
+			buffer.resize(len);
+			err = compact ? encode_variant_compact(state, buffer.ptrw(), len) : encode_variant(state, buffer.ptrw(), len);
+			CHECK(err == OK);
+		}
+		uint64_t encoded = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < iterations; i++) {
+			Error err = compact ? decode_variant_compact(decoded, buffer.ptr(), len) : decode_variant(decoded, buffer.ptr(), len);
+			CHECK(err == OK);
+		}
+		uint64_t end = OS::get_singleton()->get_ticks_usec();
+
+		CHECK(decoded == Variant(state));
+		print_line(vformat("%s: %d bytes, encode %d usec, decode %d usec", compact ? "Compact" : "Regular", len, encoded - begin, end - encoded));
+	}
+}
 } // namespace TestMarshalls
 
 #endif // TEST_MARSHALLS_H
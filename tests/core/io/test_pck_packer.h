@@ -117,6 +117,268 @@ TEST_CASE("[PCKPacker] Pack a PCK file with some files and directories") {
 			f->get_length() <= 35000,
 			"The generated non-empty PCK file shouldn't be too large.");
 }
+
+TEST_CASE("[PCKPacker] Packs with unknown versions or flags are rejected") {
+	PCKPacker pck_packer;
+	const String output_pck_path = OS::get_singleton()->get_cache_path().path_join("output_flags.pck");
+	REQUIRE(pck_packer.pck_start(output_pck_path) == OK);
+	REQUIRE(pck_packer.flush() == OK);
+
+	Ref<FileAccess> f = FileAccess::open(output_pck_path, FileAccess::READ_WRITE);
+	REQUIRE(f.is_valid());
+	f->seek(4);
+	CHECK(f->get_32() == PACK_FORMAT_VERSION);
+
+	ERR_PRINT_OFF;
+	f->seek(4);
+	f->store_32(PACK_FORMAT_VERSION + 1);
+	f->flush();
+	CHECK(PackedData::get_singleton()->add_pack(output_pck_path, false, 0) != OK);
+
+	f->seek(4);
+	f->store_32(PACK_FORMAT_VERSION);
+	f->seek(20); // Pack flags.
+	f->store_32(1 << 31);
+	f->flush();
+	CHECK(PackedData::get_singleton()->add_pack(output_pck_path, false, 0) != OK);
+	CHECK(pck_packer.pck_update(output_pck_path) != OK);
+	ERR_PRINT_ON;
+}
+
+TEST_CASE("[PCKPacker] Compressed files are read back from the pack") {
+	PCKPacker pck_packer;
+	const String output_pck_path = OS::get_singleton()->get_cache_path().path_join("output_compressed.pck");
+	REQUIRE(pck_packer.pck_start(output_pck_path) == OK);
+	pck_packer.set_compression_block_size(4096);
+
+	Vector<Vector<uint8_t>> contents;
+	uint64_t total_size = 0;
+	for (int i = 0; i < 10; i++) {
+		String text;
+		for (int j = 0; j < 100 * (i + 1); j++) {
+			text += vformat("[sub_resource type=\"RectangleShape2D\" id=\"RectangleShape2D_%d\"]\nsize = Vector2(%d, %d)\n\n", j, i, j);
+		}
+		const CharString utf8 = text.utf8();
+		Vector<uint8_t> data;
+		data.resize(utf8.length());
+		memcpy(data.ptrw(), utf8.get_data(), utf8.length());
+		contents.push_back(data);
+		total_size += data.size();
+
+		const String src_path = OS::get_singleton()->get_cache_path().path_join(vformat("pck_compressed_%d.tscn", i));
+		Ref<FileAccess> f = FileAccess::open(src_path, FileAccess::WRITE);
+		REQUIRE(f.is_valid());
+		f->store_buffer(data.ptr(), data.size());
+		f.unref();
+
+		// Compressed files can also be encrypted.
+		CHECK(pck_packer.add_file(vformat("res://pck_packer_compressed/%d.tscn", i), src_path, i == 3, true) == OK);
+	}
+	REQUIRE(pck_packer.flush() == OK);
+
+	CHECK(FileAccess::open(output_pck_path, FileAccess::READ)->get_length() < total_size / 4);
+
+	REQUIRE(PackedData::get_singleton()->add_pack(output_pck_path, true, 0) == OK);
+	for (int i = 0; i < contents.size(); i++) {
+		Ref<FileAccess> f = PackedData::get_singleton()->try_open_path(vformat("res://pck_packer_compressed/%d.tscn", i));
+		REQUIRE(f.is_valid());
+		CHECK(f->get_length() == (uint64_t)contents[i].size());
+		CHECK(f->_get_buffer(f->get_length()) == contents[i]);
+
+		const uint64_t middle = contents[i].size() / 2;
+		f->seek(middle);
+		CHECK(f->get_8() == contents[i][middle]);
+	}
+}
+
+TEST_CASE("[PCKPacker] Encrypted files are read asynchronously from the pack") {
+	const String cache_path = OS::get_singleton()->get_cache_path();
+	const String output_pck_path = cache_path.path_join("output_encrypted_async.pck");
+	const String src_path = cache_path.path_join("pck_encrypted_async.bin");
+
+	Vector<uint8_t> contents;
+	contents.resize(20000);
+	for (int i = 0; i < contents.size(); i++) {
+		contents.write[i] = (i * 7) % 251;
+	}
+	{
+		Ref<FileAccess> f = FileAccess::open(src_path, FileAccess::WRITE);
+		REQUIRE(f.is_valid());
+		f->store_buffer(contents.ptr(), contents.size());
+	}
+
+	// A plain file first, so the encrypted one doesn't start at the beginning of the data.
+	PCKPacker pck_packer;
+	REQUIRE(pck_packer.pck_start(output_pck_path) == OK);
+	CHECK(pck_packer.add_file("res://pck_packer_async/plain.bin", src_path) == OK);
+	CHECK(pck_packer.add_file("res://pck_packer_async/encrypted.bin", src_path, true) == OK);
+	REQUIRE(pck_packer.flush() == OK);
+
+	REQUIRE(PackedData::get_singleton()->add_pack(output_pck_path, true, 0) == OK);
+	Ref<FileAccess> f = PackedData::get_singleton()->try_open_path("res://pck_packer_async/encrypted.bin");
+	REQUIRE(f.is_valid());
+	REQUIRE(f->get_length() == (uint64_t)contents.size());
+
+	Vector<uint8_t> buffer;
+	buffer.resize(1000);
+	FileAccess::AsyncReadID id = f->read_async(5000, buffer.ptrw(), buffer.size());
+	REQUIRE(id != FileAccess::INVALID_ASYNC_READ_ID);
+	Error err = FAILED;
+	CHECK(f->wait_async_read(id, &err) == (uint64_t)buffer.size());
+	CHECK(err == OK);
+	CHECK(memcmp(buffer.ptr(), contents.ptr() + 5000, buffer.size()) == 0);
+
+	// Reads are clamped to the file.
+	id = f->read_async(contents.size() - 10, buffer.ptrw(), buffer.size());
+	CHECK(f->wait_async_read(id) == 10);
+	CHECK(memcmp(buffer.ptr(), contents.ptr() + contents.size() - 10, 10) == 0);
+}
+
+TEST_CASE("[PCKPacker] Updating a pack only writes changed files") {
+	const String cache_path = OS::get_singleton()->get_cache_path();
+	const String output_pck_path = cache_path.path_join("output_updated.pck");
+
+	HashMap<String, Vector<uint8_t>> contents;
+	auto write_source = [&](const String &p_name, int p_seed) {
+		String text;
+		for (int j = 0; j < 200; j++) {
+			text += vformat("[ext_resource type=\"Texture2D\" path=\"res://%s_%d.png\" id=\"%d\"]\n", p_name, p_seed, j);
+		}
+		const CharString utf8 = text.utf8();
+		Vector<uint8_t> data;
+		data.resize(utf8.length());
+		memcpy(data.ptrw(), utf8.get_data(), utf8.length());
+		contents["res://pck_packer_update/" + p_name] = data;
+
+		Ref<FileAccess> f = FileAccess::open(cache_path.path_join("pck_update_" + p_name), FileAccess::WRITE);
+		f->store_buffer(data.ptr(), data.size());
+	};
+
+	PCKPacker pck_packer;
+	REQUIRE(pck_packer.pck_start(output_pck_path) == OK);
+	for (int i = 0; i < 4; i++) {
+		const String name = vformat("%d.tscn", i);
+		write_source(name, 0);
+		CHECK(pck_packer.add_file("res://pck_packer_update/" + name, cache_path.path_join("pck_update_" + name), i == 1, i >= 2) == OK);
+	}
+	REQUIRE(pck_packer.flush() == OK);
+	const uint64_t initial_size = FileAccess::open(output_pck_path, FileAccess::READ)->get_length();
+
+	// Change one file and add many more, so the directory outgrows its space and existing files have to move.
+	write_source("0.tscn", 1);
+	REQUIRE(pck_packer.pck_update(output_pck_path) == OK);
+	for (int i = 0; i < 4; i++) {
+		const String name = vformat("%d.tscn", i);
+		CHECK(pck_packer.add_file("res://pck_packer_update/" + name, cache_path.path_join("pck_update_" + name), i == 1, i >= 2) == OK);
+	}
+	for (int i = 4; i < 40; i++) {
+		const String name = vformat("%d.tscn", i);
+		write_source(name, 0);
+		CHECK(pck_packer.add_file("res://pck_packer_update/" + name, cache_path.path_join("pck_update_" + name), false, true) == OK);
+	}
+	REQUIRE(pck_packer.flush() == OK);
+
+	REQUIRE(PackedData::get_singleton()->add_pack(output_pck_path, true, 0) == OK);
+	for (const KeyValue<String, Vector<uint8_t>> &E : contents) {
+		Ref<FileAccess> f = PackedData::get_singleton()->try_open_path(E.key);
+		REQUIRE_MESSAGE(f.is_valid(), "Every file should be in the updated pack.");
+		CHECK_MESSAGE(
+				f->_get_buffer(f->get_length()) == E.value,
+				"Files should have their latest contents, whether they were reused, moved or written again.");
+	}
+
+	// Unchanged files are kept as is, updating again with the same files writes nothing new.
+	const uint64_t updated_size = FileAccess::open(output_pck_path, FileAccess::READ)->get_length();
+	CHECK(updated_size > initial_size);
+	REQUIRE(pck_packer.pck_update(output_pck_path) == OK);
+	for (int i = 0; i < 40; i++) {
+		const String name = vformat("%d.tscn", i);
+		CHECK(pck_packer.add_file("res://pck_packer_update/" + name, cache_path.path_join("pck_update_" + name), i == 1, i >= 2) == OK);
+	}
+	REQUIRE(pck_packer.flush() == OK);
+	CHECK_MESSAGE(
+			FileAccess::open(output_pck_path, FileAccess::READ)->get_length() == updated_size,
+			"Updating a pack without changes shouldn't write any file.");
+}
+
+TEST_CASE("[PCKPacker] Updating a pack removes the data no longer used") {
+	const String cache_path = OS::get_singleton()->get_cache_path();
+	const String output_pck_path = cache_path.path_join("output_compacted.pck");
+
+	auto write_source = [&](int p_index, int p_seed) -> Vector<uint8_t> {
+		String text;
+		for (int j = 0; j < 200; j++) {
+			text += vformat("[ext_resource type=\"Texture2D\" path=\"res://%d_%d.png\" id=\"%d\"]\n", p_index, p_seed, j);
+		}
+		const CharString utf8 = text.utf8();
+		Vector<uint8_t> data;
+		data.resize(utf8.length());
+		memcpy(data.ptrw(), utf8.get_data(), utf8.length());
+
+		Ref<FileAccess> f = FileAccess::open(cache_path.path_join(vformat("pck_compact_%d.tscn", p_index)), FileAccess::WRITE);
+		f->store_buffer(data.ptr(), data.size());
+		return data;
+	};
+
+	PCKPacker pck_packer;
+	REQUIRE(pck_packer.pck_start(output_pck_path) == OK);
+	for (int i = 0; i < 8; i++) {
+		write_source(i, 0);
+		CHECK(pck_packer.add_file(vformat("res://pck_packer_compact/%d.tscn", i), cache_path.path_join(vformat("pck_compact_%d.tscn", i)), i == 1, i >= 4) == OK);
+	}
+	REQUIRE(pck_packer.flush() == OK);
+	const uint64_t initial_size = FileAccess::open(output_pck_path, FileAccess::READ)->get_length();
+
+	// Change a few files each time, the pack doesn't keep growing with their old contents.
+	Vector<Vector<uint8_t>> contents;
+	contents.resize(8);
+	for (int update = 1; update <= 10; update++) {
+		REQUIRE(pck_packer.pck_update(output_pck_path) == OK);
+		for (int i = 0; i < 8; i++) {
+			if (i % 4 == update % 4 || contents[i].is_empty()) {
+				contents.write[i] = write_source(i, update);
+			}
+			CHECK(pck_packer.add_file(vformat("res://pck_packer_compact/%d.tscn", i), cache_path.path_join(vformat("pck_compact_%d.tscn", i)), i == 1, i >= 4) == OK);
+		}
+		REQUIRE(pck_packer.flush() == OK);
+		CHECK(FileAccess::open(output_pck_path, FileAccess::READ)->get_length() < initial_size * 3);
+	}
+	CHECK_FALSE(FileAccess::exists(output_pck_path + ".tmp"));
+
+	REQUIRE(PackedData::get_singleton()->add_pack(output_pck_path, true, 0) == OK);
+	for (int i = 0; i < 8; i++) {
+		Ref<FileAccess> f = PackedData::get_singleton()->try_open_path(vformat("res://pck_packer_compact/%d.tscn", i));
+		REQUIRE(f.is_valid());
+		CHECK(f->_get_buffer(f->get_length()) == contents[i]);
+	}
+}
+
+TEST_CASE("[PCKPacker] Updating a pack requires the key its files were encrypted with") {
+	const String cache_path = OS::get_singleton()->get_cache_path();
+	const String output_pck_path = cache_path.path_join("output_update_key.pck");
+	const String key = "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef";
+	const String other_key = "fedcba9876543210fedcba9876543210fedcba9876543210fedcba9876543210";
+
+	const String src_path = cache_path.path_join("pck_update_key.txt");
+	{
+		Ref<FileAccess> f = FileAccess::open(src_path, FileAccess::WRITE);
+		REQUIRE(f.is_valid());
+		f->store_string("Encrypted contents.");
+	}
+
+	// The directory isn't encrypted, so only the encrypted file can tell the key is wrong.
+	PCKPacker pck_packer;
+	REQUIRE(pck_packer.pck_start(output_pck_path, 32, key) == OK);
+	CHECK(pck_packer.add_file("res://pck_packer_key/plain.txt", src_path) == OK);
+	CHECK(pck_packer.add_file("res://pck_packer_key/encrypted.txt", src_path, true) == OK);
+	REQUIRE(pck_packer.flush() == OK);
+
+	ERR_PRINT_OFF;
+	CHECK(pck_packer.pck_update(output_pck_path, 32, other_key) != OK);
+	ERR_PRINT_ON;
+	CHECK(pck_packer.pck_update(output_pck_path, 32, key) == OK);
+	CHECK(pck_packer.flush() == OK);
+}
 } // namespace TestPCKPacker
 
 #endif // TEST_PCK_PACKER_H
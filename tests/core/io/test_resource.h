@@ -31,12 +31,17 @@
 #ifndef TEST_RESOURCE_H
 #define TEST_RESOURCE_H
 
+#include "core/config/project_settings.h"
+#include "core/io/dir_access.h"
+#include "core/io/marshalls.h"
 #include "core/io/resource.h"
+#include "core/io/resource_format_binary.h"
 #include "core/io/resource_loader.h"
 #include "core/io/resource_saver.h"
 #include "core/os/os.h"
+#include "scene/resources/audio_stream_wav.h"
 
-#include "thirdparty/doctest/doctest.h"
+#include "tests/test_macros.h"
 
 namespace TestResource {
 
@@ -109,6 +114,419 @@ TEST_CASE("[Resource] Saving and loading") {
 			loaded_child_resource_text->get_name() == "I'm a child resource",
 			"The loaded child resource name should be equal to the expected value.");
 }
+
+TEST_CASE("[Resource] Loading text resources with many sub-resources") {
+	// Enough data for the sub-resources to be parsed in parallel.
+	const int count = 64;
+	Ref<Resource> resource = memnew(Resource);
+	Array children;
+	for (int i = 0; i < count; i++) {
+		Ref<Resource> child = memnew(Resource);
+		child->set_name(vformat("child %d", i));
+		PackedByteArray payload;
+		payload.resize(512);
+		payload.fill(i);
+		child->set_meta("payload", payload);
+		// Looks like a tag once written, as line breaks in strings are kept as-is.
+		child->set_meta("text", vformat("\n[sub_resource type=\"Resource\" id=\"%d\"]\n;", i));
+		if (i > 0) {
+			child->set_meta("previous", children[i - 1]);
+		}
+		children.push_back(child);
+	}
+	resource->set_meta("children", children);
+
+	const String save_path = OS::get_singleton()->get_cache_path().path_join("sub_resources.tres");
+	REQUIRE(ResourceSaver::save(resource, save_path) == OK);
+
+	Ref<Resource> loaded = ResourceLoader::load(save_path, "", ResourceFormatLoader::CACHE_MODE_IGNORE);
+	REQUIRE(loaded.is_valid());
+	Array loaded_children = loaded->get_meta("children");
+	REQUIRE(loaded_children.size() == count);
+	for (int i = 0; i < count; i++) {
+		Ref<Resource> child = loaded_children[i];
+		REQUIRE(child.is_valid());
+		CHECK(child->get_name() == vformat("child %d", i));
+		PackedByteArray payload = child->get_meta("payload");
+		CHECK(payload.size() == 512);
+		CHECK(payload[511] == i);
+		CHECK(String(child->get_meta("text")) == vformat("\n[sub_resource type=\"Resource\" id=\"%d\"]\n;", i));
+		if (i > 0) {
+			CHECK_MESSAGE(
+					Ref<Resource>(child->get_meta("previous")) == Ref<Resource>(loaded_children[i - 1]),
+					"Sub-resources should reference each other like in the saved resource.");
+		}
+	}
+}
+
+TEST_CASE("[Resource] Loading binary resources with shared sub-resources") {
+	Ref<Resource> resource = memnew(Resource);
+	Ref<Resource> shared = memnew(Resource);
+	shared->set_name("shared");
+	Ref<Resource> left = memnew(Resource);
+	left->set_name("left");
+	left->set_meta("dependency", shared);
+	Ref<Resource> right = memnew(Resource);
+	right->set_name("right");
+	Array right_dependencies;
+	right_dependencies.push_back(shared);
+	right->set_meta("dependencies", right_dependencies);
+	Array children;
+	children.push_back(left);
+	children.push_back(right);
+	resource->set_meta("children", children);
+
+	const String save_path = OS::get_singleton()->get_cache_path().path_join("shared_sub_resources.res");
+	REQUIRE(ResourceSaver::save(resource, save_path) == OK);
+
+	Ref<Resource> loaded = ResourceLoader::load(save_path, "", ResourceFormatLoader::CACHE_MODE_IGNORE);
+	REQUIRE(loaded.is_valid());
+	Array loaded_children = loaded->get_meta("children");
+	REQUIRE(loaded_children.size() == 2);
+	Ref<Resource> loaded_left = loaded_children[0];
+	Ref<Resource> loaded_right = loaded_children[1];
+	REQUIRE(loaded_left.is_valid());
+	REQUIRE(loaded_right.is_valid());
+	CHECK(loaded_left->get_name() == "left");
+	CHECK(loaded_right->get_name() == "right");
+
+	Ref<Resource> loaded_shared = loaded_left->get_meta("dependency");
+	REQUIRE(loaded_shared.is_valid());
+	CHECK(loaded_shared->get_name() == "shared");
+	Array loaded_right_dependencies = loaded_right->get_meta("dependencies");
+	CHECK_MESSAGE(
+			Ref<Resource>(loaded_right_dependencies[0]) == loaded_shared,
+			"Sub-resources referenced from several places should be loaded once.");
+}
+
+TEST_CASE("[Resource] Retaining unused resources in the cache") {
+	const uint64_t evictions = ResourceCache::get_eviction_count();
+	ResourceCache::set_retained_budget(1000);
+
+	Vector<uint8_t> samples;
+	samples.resize(400);
+	samples.fill(0);
+
+	Vector<Ref<AudioStreamWAV>> streams;
+	for (int i = 0; i < 3; i++) {
+		Ref<AudioStreamWAV> stream;
+		stream.instantiate();
+		stream->set_data(samples);
+		stream->set_path("res://retained_" + itos(i) + ".wav");
+		ResourceCache::retain(stream);
+		streams.push_back(stream);
+	}
+
+	CHECK_MESSAGE(
+			ResourceCache::get_retained_count() == 3,
+			"Resources still in use should never be evicted, even over budget.");
+	CHECK(ResourceCache::get_retained_memory(ResourceCache::MEMORY_CATEGORY_AUDIO) == 1200);
+
+	streams.clear();
+	CHECK_MESSAGE(
+			ResourceCache::has("res://retained_0.wav"),
+			"Retained resources should stay cached after their last user releases them.");
+
+	Ref<AudioStreamWAV> stream;
+	stream.instantiate();
+	stream->set_data(samples);
+	stream->set_path("res://retained_3.wav");
+	ResourceCache::retain(stream);
+
+	CHECK_MESSAGE(
+			ResourceCache::get_eviction_count() - evictions == 2,
+			"The least recently used resources should be evicted until the cache fits in the budget.");
+	CHECK(ResourceCache::get_retained_count() == 2);
+	CHECK(ResourceCache::get_retained_memory(ResourceCache::MEMORY_CATEGORY_AUDIO) == 800);
+	CHECK_FALSE(ResourceCache::has("res://retained_0.wav"));
+	CHECK_FALSE(ResourceCache::has("res://retained_1.wav"));
+	CHECK(ResourceCache::has("res://retained_2.wav"));
+
+	const String save_path = OS::get_singleton()->get_cache_path().path_join("retained.res");
+	Ref<Resource> resource = memnew(Resource);
+	resource->set_name("Kept around");
+	ResourceSaver::save(resource, save_path);
+	resource.unref();
+
+	ResourceLoader::load(save_path);
+	CHECK_MESSAGE(
+			ResourceCache::has(save_path),
+			"Loaded resources should be retained when a budget is set.");
+	CHECK(ResourceCache::get_retained_count() == 3);
+
+	ResourceCache::set_retained_budget(0);
+	CHECK(ResourceCache::get_retained_count() == 0);
+	CHECK(ResourceCache::get_retained_memory(ResourceCache::MEMORY_CATEGORY_AUDIO) == 0);
+	CHECK_FALSE(ResourceCache::has("res://retained_2.wav"));
+	CHECK_FALSE(ResourceCache::has(save_path));
+	CHECK(ResourceCache::has("res://retained_3.wav"));
+}
+
+TEST_CASE("[Resource] Loading text resources with comments inside values") {
+	// Enough data for the sub-resources to be parsed in parallel. The comments contain what would
+	// otherwise start a string or nest a value, and must not hide the following tags.
+	const int count = 64;
+	String text = "[gd_resource type=\"Resource\" format=3]\n\n";
+	const String padding = String("x").repeat(512);
+	for (int i = 0; i < count; i++) {
+		text += vformat("[sub_resource type=\"Resource\" id=\"Resource_%d\"]\n", i);
+		text += vformat("metadata/values = [%d, ; \" [ {\n%d]\n", i, i + 1);
+		text += "metadata/padding = \"" + padding + "\"\n\n";
+	}
+	text += "[resource]\nmetadata/children = [";
+	for (int i = 0; i < count; i++) {
+		text += vformat("%sSubResource(\"Resource_%d\")", i > 0 ? ", " : "", i);
+	}
+	text += "]\n";
+
+	const String save_path = OS::get_singleton()->get_cache_path().path_join("sub_resources_comments.tres");
+	{
+		Ref<FileAccess> f = FileAccess::open(save_path, FileAccess::WRITE);
+		REQUIRE(f.is_valid());
+		f->store_string(text);
+	}
+
+	Ref<Resource> loaded = ResourceLoader::load(save_path, "", ResourceFormatLoader::CACHE_MODE_IGNORE);
+	REQUIRE(loaded.is_valid());
+	Array loaded_children = loaded->get_meta("children");
+	REQUIRE(loaded_children.size() == count);
+	for (int i = 0; i < count; i++) {
+		Ref<Resource> child = loaded_children[i];
+		REQUIRE(child.is_valid());
+		Array values = child->get_meta("values");
+		REQUIRE(values.size() == 2);
+		CHECK(int(values[0]) == i);
+		CHECK(int(values[1]) == i + 1);
+		CHECK(String(child->get_meta("padding")) == padding);
+	}
+}
+
+TEST_CASE("[Resource] Loading text resources with forward sub-resource references") {
+	// Sub-resources can only reference those defined before them, whether or not
+	// there is enough data for them to be parsed in parallel.
+	const int count = 64;
+	for (int padding_size : { 0, 512 }) {
+		String text = "[gd_resource type=\"Resource\" format=3]\n\n";
+		const String padding = String("x").repeat(padding_size);
+		for (int i = 0; i < count; i++) {
+			text += vformat("[sub_resource type=\"Resource\" id=\"Resource_%d\"]\n", i);
+			if (i == count / 2) {
+				text += vformat("metadata/next = SubResource(\"Resource_%d\")\n", i + 1);
+			} else if (i > 0) {
+				text += vformat("metadata/previous = SubResource(\"Resource_%d\")\n", i - 1);
+			}
+			text += "metadata/padding = \"" + padding + "\"\n\n";
+		}
+		text += vformat("[resource]\nmetadata/last = SubResource(\"Resource_%d\")\n", count - 1);
+
+		const String save_path = OS::get_singleton()->get_cache_path().path_join("sub_resources_forward.tres");
+		{
+			Ref<FileAccess> f = FileAccess::open(save_path, FileAccess::WRITE);
+			REQUIRE(f.is_valid());
+			f->store_string(text);
+		}
+
+		ERR_PRINT_OFF;
+		Ref<Resource> loaded = ResourceLoader::load(save_path, "", ResourceFormatLoader::CACHE_MODE_IGNORE);
+		ERR_PRINT_ON;
+		CHECK_MESSAGE(loaded.is_null(), vformat("Padding size: %d", padding_size));
+
+		// Without the forward reference, both paths load the file.
+		text = text.replace(vformat("metadata/next = SubResource(\"Resource_%d\")", count / 2 + 1), vformat("metadata/previous = SubResource(\"Resource_%d\")", count / 2 - 1));
+		{
+			Ref<FileAccess> f = FileAccess::open(save_path, FileAccess::WRITE);
+			REQUIRE(f.is_valid());
+			f->store_string(text);
+		}
+
+		loaded = ResourceLoader::load(save_path, "", ResourceFormatLoader::CACHE_MODE_IGNORE);
+		REQUIRE(loaded.is_valid());
+		Ref<Resource> child = loaded->get_meta("last");
+		int depth = 0;
+		while (child.is_valid() && child->has_meta("previous")) {
+			child = child->get_meta("previous");
+			depth++;
+		}
+		CHECK(depth == count - 1);
+	}
+}
+
+TEST_CASE("[Resource] Loading binary resources skips what only cached sub-resources use") {
+	Ref<Resource> resource = memnew(Resource);
+	Ref<Resource> holder = memnew(Resource);
+	Ref<Resource> exclusive = memnew(Resource);
+	const String marker = "Only used by the holder sub-resource";
+	exclusive->set_meta("marker", marker);
+	holder->set_meta("exclusive", exclusive);
+	resource->set_meta("holder", holder);
+	exclusive.unref();
+	holder.unref();
+
+	const String save_path = OS::get_singleton()->get_cache_path().path_join("exclusive_sub_resources.res");
+	REQUIRE(ResourceSaver::save(resource, save_path) == OK);
+	resource.unref();
+
+	// Keep the holder in the cache, but not what it references.
+	ResourceFormatLoaderBinary loader;
+	Ref<Resource> loaded = loader.load(save_path, "", nullptr, false, nullptr, ResourceFormatLoader::CACHE_MODE_REUSE);
+	REQUIRE(loaded.is_valid());
+	Ref<Resource> cached_holder = loaded->get_meta("holder");
+	REQUIRE(cached_holder.is_valid());
+	cached_holder->remove_meta("exclusive");
+	loaded.unref();
+
+	// Break the exclusive sub-resource, so loading fails if it's read.
+	{
+		Vector<uint8_t> data = FileAccess::get_file_as_array(save_path);
+		const CharString utf8 = marker.utf8();
+		int marker_pos = -1;
+		for (int i = 0; i + utf8.length() <= data.size() && marker_pos == -1; i++) {
+			if (memcmp(data.ptr() + i, utf8.get_data(), utf8.length()) == 0) {
+				marker_pos = i;
+			}
+		}
+		REQUIRE(marker_pos >= 8);
+		encode_uint32(0xFFFF, data.ptrw() + marker_pos - 8); // Variant type of the string, before its length.
+		Ref<FileAccess> f = FileAccess::open(save_path, FileAccess::WRITE);
+		REQUIRE(f.is_valid());
+		f->store_buffer(data.ptr(), data.size());
+	}
+	ERR_PRINT_OFF;
+	CHECK(loader.load(save_path, "", nullptr, false, nullptr, ResourceFormatLoader::CACHE_MODE_IGNORE).is_null());
+	ERR_PRINT_ON;
+
+	loaded = loader.load(save_path, "", nullptr, false, nullptr, ResourceFormatLoader::CACHE_MODE_REUSE);
+	REQUIRE_MESSAGE(loaded.is_valid(), "Sub-resources only used by cached ones shouldn't be read.");
+	CHECK(Ref<Resource>(loaded->get_meta("holder")) == cached_holder);
+	CHECK_FALSE(cached_holder->has_meta("exclusive"));
+}
+
+TEST_CASE("[Resource] Threaded loading with dependencies") {
+	// A diamond: "top" uses "left" and "right", which both use "bottom".
+	const String dir = OS::get_singleton()->get_cache_path().path_join("threaded_dependencies");
+	DirAccess::make_dir_recursive_absolute(dir);
+	const String names[] = { "bottom", "left", "right", "top" };
+	{
+		Ref<Resource> resources[4];
+		for (int i = 0; i < 4; i++) {
+			resources[i].instantiate();
+			resources[i]->set_name(names[i]);
+		}
+		resources[1]->set_meta("dependency", resources[0]);
+		resources[2]->set_meta("dependency", resources[0]);
+		resources[3]->set_meta("left", resources[1]);
+		resources[3]->set_meta("right", resources[2]);
+		for (int i = 0; i < 4; i++) {
+			REQUIRE(ResourceSaver::save(resources[i], dir.path_join(names[i] + ".res"), ResourceSaver::FLAG_CHANGE_PATH) == OK);
+		}
+	}
+
+	const String top_path = dir.path_join("top.res");
+	REQUIRE(ResourceLoader::load_threaded_request(top_path, "", true) == OK);
+	Error err = FAILED;
+	Ref<Resource> top = ResourceLoader::load_threaded_get(top_path, &err);
+	CHECK(err == OK);
+	REQUIRE(top.is_valid());
+	CHECK(top->get_name() == "top");
+
+	Ref<Resource> left = top->get_meta("left");
+	Ref<Resource> right = top->get_meta("right");
+	REQUIRE(left.is_valid());
+	REQUIRE(right.is_valid());
+	CHECK(left->get_name() == "left");
+	CHECK(right->get_name() == "right");
+	Ref<Resource> bottom = left->get_meta("dependency");
+	REQUIRE(bottom.is_valid());
+	CHECK_MESSAGE(
+			bottom == Ref<Resource>(right->get_meta("dependency")),
+			"Both branches should share the single loaded dependency.");
+	CHECK(bottom->get_path() == ProjectSettings::get_singleton()->localize_path(dir.path_join("bottom.res")));
+
+	// Nothing is left behind once the requested resource was retrieved.
+	for (int i = 0; i < 4; i++) {
+		CHECK(ResourceLoader::load_threaded_get_status(dir.path_join(names[i] + ".res")) == ResourceLoader::THREAD_LOAD_INVALID_RESOURCE);
+	}
+}
+
+TEST_CASE("[Resource] Threaded loading of a long dependency chain") {
+	// Deep enough to overflow the stack if the graph was requested recursively.
+	const int count = 10000;
+	const String dir = OS::get_singleton()->get_cache_path().path_join("dependency_chain");
+	DirAccess::make_dir_recursive_absolute(dir);
+	{
+		Vector<Ref<Resource>> resources;
+		resources.resize(count);
+		for (int i = 0; i < count; i++) {
+			Ref<Resource> resource;
+			resource.instantiate();
+			resource->set_name(itos(i));
+			if (i > 0) {
+				resource->set_meta("previous", resources[i - 1]);
+			}
+			REQUIRE(ResourceSaver::save(resource, dir.path_join(itos(i) + ".res"), ResourceSaver::FLAG_CHANGE_PATH) == OK);
+			resources.write[i] = resource;
+		}
+		// Released from the last one down, so the chain isn't freed recursively.
+		for (int i = count - 1; i >= 0; i--) {
+			resources.write[i].unref();
+		}
+	}
+
+	const String last_path = dir.path_join(itos(count - 1) + ".res");
+	REQUIRE(ResourceLoader::load_threaded_request(last_path, "", true) == OK);
+	Error err = FAILED;
+	Ref<Resource> resource = ResourceLoader::load_threaded_get(last_path, &err);
+	CHECK(err == OK);
+
+	// Kept from the last one down, so they are released in that order too.
+	Vector<Ref<Resource>> chain;
+	while (resource.is_valid()) {
+		chain.push_back(resource);
+		resource = resource->get_meta("previous", Ref<Resource>());
+	}
+	REQUIRE(chain.size() == count);
+	CHECK(chain[0]->get_name() == itos(count - 1));
+	CHECK(chain[count - 1]->get_name() == "0");
+}
+
+TEST_CASE_BENCHMARK("[Resource][Benchmark] Loading a graph of interdependent resources") {
+	const int count = 10000;
+	const String dir = OS::get_singleton()->get_cache_path().path_join("resource_graph_benchmark");
+	DirAccess::make_dir_recursive_absolute(dir);
+	{
+		Vector<Ref<Resource>> resources;
+		resources.resize(count);
+		for (int i = 0; i < count; i++) {
+			Ref<Resource> resource;
+			resource.instantiate();
+			PackedByteArray payload;
+			payload.resize(4096);
+			payload.fill(i & 0xFF);
+			resource->set_meta("payload", payload);
+			if (i > 0) {
+				resource->set_meta("previous", resources[i - 1]);
+				resource->set_meta("half", resources[i / 2]);
+				resource->set_meta("third", resources[i / 3]);
+			}
+			ResourceSaver::save(resource, dir.path_join(itos(i) + ".res"), ResourceSaver::FLAG_CHANGE_PATH);
+			resources.write[i] = resource;
+		}
+	}
+
+	const String root_path = dir.path_join(itos(count - 1) + ".res");
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	Ref<Resource> root = ResourceLoader::load(root_path);
+	CHECK(root.is_valid());
+	print_line(vformat("serial load: %d usec", OS::get_singleton()->get_ticks_usec() - begin));
+	root.unref(); // Frees the whole graph, so the next load doesn't come from the cache.
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	ResourceLoader::load_threaded_request(root_path, "", true);
+	root = ResourceLoader::load_threaded_get(root_path);
+	CHECK(root.is_valid());
+	print_line(vformat("threaded load: %d usec", OS::get_singleton()->get_ticks_usec() - begin));
+}
 } // namespace TestResource
 
 #endif // TEST_RESOURCE_H
@@ -852,6 +852,25 @@ TEST_SUITE("[ClassDB]") {
 			}
 		}
 	}
+
+	TEST_CASE("[ClassDB] Methods are listed in registration order") {
+		List<MethodInfo> method_list;
+		ClassDB::get_method_list("Object", &method_list, true);
+
+		Vector<String> names;
+		for (const MethodInfo &E : method_list) {
+			if (!(E.flags & METHOD_FLAG_VIRTUAL)) {
+				names.push_back(E.name);
+			}
+		}
+
+		// Same order as in Object::_bind_methods().
+		const String expected[] = { "get_class", "is_class", "set", "get", "set_indexed", "get_indexed" };
+		REQUIRE(names.size() >= 6);
+		for (int i = 0; i < 6; i++) {
+			CHECK(names[i] == expected[i]);
+		}
+	}
 }
 } // namespace TestClassDB
 
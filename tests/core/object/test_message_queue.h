@@ -0,0 +1,187 @@
+/*************************************************************************/
+/*  test_message_queue.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_MESSAGE_QUEUE_H
+#define TEST_MESSAGE_QUEUE_H
+
+#include "core/object/message_queue.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/templates/local_vector.h"
+
+#include "tests/test_macros.h"
+
+namespace TestMessageQueue {
+
+static const int MAX_PRODUCERS = 16;
+static LocalVector<int> received[MAX_PRODUCERS];
+static SafeNumeric<uint32_t> received_count;
+
+static void static_receive(int p_producer, int p_value) {
+	received[p_producer].push_back(p_value);
+}
+
+static void static_count() {
+	received_count.increment();
+}
+
+static void static_push_again(int p_value) {
+	received[0].push_back(p_value);
+	if (p_value < 3) {
+		MessageQueue::get_singleton()->push_callable(callable_mp_static(static_push_again), p_value + 1);
+	}
+}
+
+struct ProducerData {
+	int producer = 0;
+	int count = 0;
+	bool counting = false;
+};
+
+static void static_producer(void *p_userdata) {
+	ProducerData *data = (ProducerData *)p_userdata;
+	for (int i = 0; i < data->count; i++) {
+		if (data->counting) {
+			MessageQueue::get_singleton()->push_callable(callable_mp_static(static_count));
+		} else {
+			MessageQueue::get_singleton()->push_callable(callable_mp_static(static_receive), data->producer, i);
+		}
+	}
+}
+
+static void clear_received() {
+	for (int i = 0; i < MAX_PRODUCERS; i++) {
+		received[i].clear();
+	}
+	received_count.set(0);
+}
+
+TEST_CASE("[MessageQueue] Calls run in push order, beyond the size of a single page") {
+	clear_received();
+	const int count = 40000;
+	for (int i = 0; i < count; i++) {
+		MessageQueue::get_singleton()->push_callable(callable_mp_static(static_receive), 0, i);
+	}
+	MessageQueue::get_singleton()->flush();
+
+	REQUIRE(received[0].size() == count);
+	bool in_order = true;
+	for (int i = 0; i < count; i++) {
+		in_order = in_order && received[0][i] == i;
+	}
+	CHECK(in_order);
+}
+
+TEST_CASE("[MessageQueue] Calls pushed while flushing run in the same flush") {
+	clear_received();
+	MessageQueue::get_singleton()->push_callable(callable_mp_static(static_push_again), 0);
+	MessageQueue::get_singleton()->flush();
+
+	REQUIRE(received[0].size() == 4);
+	CHECK(received[0][3] == 3);
+}
+
+TEST_CASE("[MessageQueue] Calls from multiple threads keep per thread order") {
+	clear_received();
+	const int producers = 8;
+	const int count = 5000;
+	Thread threads[producers];
+	ProducerData data[producers];
+	for (int i = 0; i < producers; i++) {
+		data[i].producer = i;
+		data[i].count = count;
+		threads[i].start(static_producer, &data[i]);
+	}
+	for (int i = 0; i < producers; i++) {
+		threads[i].wait_to_finish();
+	}
+	MessageQueue::get_singleton()->flush();
+
+	for (int i = 0; i < producers; i++) {
+		REQUIRE(received[i].size() == count);
+		bool in_order = true;
+		for (int j = 0; j < count; j++) {
+			in_order = in_order && received[i][j] == j;
+		}
+		CHECK(in_order);
+	}
+}
+
+TEST_CASE("[MessageQueue] Pushing past the size threshold keeps growing the queue") {
+	clear_received();
+	// Well past the default 'memory/limits/message_queue/max_size_kb', which only prints a warning.
+	const int count = 250000;
+	bool all_pushed = true;
+	ERR_PRINT_OFF;
+	for (int i = 0; i < count; i++) {
+		all_pushed = all_pushed && MessageQueue::get_singleton()->push_callable(callable_mp_static(static_receive), 0, i) == OK;
+	}
+	ERR_PRINT_ON;
+	CHECK(all_pushed);
+
+	MessageQueue::get_singleton()->flush();
+	REQUIRE(received[0].size() == count);
+	bool in_order = true;
+	for (int i = 0; i < count; i++) {
+		in_order = in_order && received[0][i] == i;
+	}
+	CHECK(in_order);
+}
+
+TEST_CASE_BENCHMARK("[MessageQueue][Benchmark] Deferred calls per second from multiple threads") {
+	const int count = 200000;
+	for (int producers = 1; producers <= MAX_PRODUCERS; producers *= 2) {
+		clear_received();
+		Thread threads[MAX_PRODUCERS];
+		ProducerData data[MAX_PRODUCERS];
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < producers; i++) {
+			data[i].count = count / producers;
+			data[i].counting = true;
+			threads[i].start(static_producer, &data[i]);
+		}
+		for (int i = 0; i < producers; i++) {
+			threads[i].wait_to_finish();
+		}
+		uint64_t pushed = OS::get_singleton()->get_ticks_usec();
+		MessageQueue::get_singleton()->flush();
+		uint64_t flushed = OS::get_singleton()->get_ticks_usec();
+
+		uint64_t total = uint64_t(count / producers) * producers;
+		print_line(vformat("%d producers: %d pushes/s, %d calls flushed/s", producers,
+				total * 1000000 / MAX(pushed - begin, (uint64_t)1), total * 1000000 / MAX(flushed - pushed, (uint64_t)1)));
+		CHECK(received_count.get() == total);
+	}
+}
+
+} // namespace TestMessageQueue
+
+#endif // TEST_MESSAGE_QUEUE_H
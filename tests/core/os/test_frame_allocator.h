@@ -0,0 +1,212 @@
+/*************************************************************************/
+/*  test_frame_allocator.h                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_FRAME_ALLOCATOR_H
+#define TEST_FRAME_ALLOCATOR_H
+
+#include "core/os/frame_allocator.h"
+
+#include "tests/test_macros.h"
+
+namespace TestFrameAllocator {
+
+TEST_CASE("[FrameAllocator] Allocations are aligned and do not overlap") {
+	FrameAllocator::Scope scope;
+
+	uint8_t *a = (uint8_t *)FrameAllocator::alloc(3);
+	uint8_t *b = (uint8_t *)FrameAllocator::alloc(100);
+	uint8_t *c = (uint8_t *)FrameAllocator::alloc(1);
+
+	CHECK(((uintptr_t)a % 16) == 0);
+	CHECK(((uintptr_t)b % 16) == 0);
+	CHECK(((uintptr_t)c % 16) == 0);
+	CHECK(b >= a + 3);
+	CHECK(c >= b + 100);
+}
+
+TEST_CASE("[FrameAllocator] Scopes rewind the arena") {
+	FrameAllocator::Scope scope;
+
+	void *outer = FrameAllocator::alloc(64);
+	void *first = nullptr;
+	{
+		FrameAllocator::Scope inner_scope;
+		first = FrameAllocator::alloc(64);
+		CHECK(first != outer);
+	}
+	{
+		FrameAllocator::Scope inner_scope;
+		CHECK_MESSAGE(FrameAllocator::alloc(64) == first, "Memory released by a scope should be reused.");
+	}
+}
+
+TEST_CASE("[FrameAllocator] Realloc grows the last allocation in place") {
+	FrameAllocator::Scope scope;
+
+	uint32_t *a = (uint32_t *)FrameAllocator::alloc(sizeof(uint32_t) * 4);
+	for (uint32_t i = 0; i < 4; i++) {
+		a[i] = i;
+	}
+	CHECK(FrameAllocator::realloc(a, sizeof(uint32_t) * 4, sizeof(uint32_t) * 64) == a);
+
+	void *b = FrameAllocator::alloc(16);
+	uint32_t *moved = (uint32_t *)FrameAllocator::realloc(a, sizeof(uint32_t) * 64, sizeof(uint32_t) * 128);
+	CHECK_MESSAGE(moved != a, "An allocation that is not the last one should be moved.");
+	CHECK((void *)moved != b);
+	for (uint32_t i = 0; i < 4; i++) {
+		CHECK(moved[i] == i);
+	}
+}
+
+TEST_CASE("[FrameAllocator] Memory from outside a scope is not grown inside of it") {
+	FrameAllocator::Scope scope;
+
+	uint32_t *outer = (uint32_t *)FrameAllocator::alloc(sizeof(uint32_t) * 4);
+	for (int i = 0; i < 4; i++) {
+		outer[i] = i;
+	}
+	uint32_t *grown_outer = nullptr;
+	{
+		FrameAllocator::Scope inner_scope;
+		CHECK_MESSAGE(FrameAllocator::realloc(outer, sizeof(uint32_t) * 4, sizeof(uint32_t) * 2) == outer, "Shrinking is always allowed.");
+
+		// Taken from the heap instead.
+		grown_outer = (uint32_t *)FrameAllocator::realloc(outer, sizeof(uint32_t) * 4, sizeof(uint32_t) * 64);
+		REQUIRE(grown_outer != nullptr);
+		grown_outer = (uint32_t *)FrameAllocator::realloc(grown_outer, sizeof(uint32_t) * 64, sizeof(uint32_t) * 1024);
+		REQUIRE(grown_outer != nullptr);
+		grown_outer[1023] = 1023;
+
+		void *inner = FrameAllocator::alloc(16);
+		void *grown = FrameAllocator::realloc(inner, 16, 4096);
+		CHECK_MESSAGE(grown != nullptr, "Memory of the scope itself can still grow.");
+	}
+
+	// The scope is closed, its memory must be handed out again without overlapping the outer allocations.
+	uint8_t *after = (uint8_t *)FrameAllocator::alloc(4096 * 4);
+	CHECK((after >= (uint8_t *)(outer + 4) || after + 4096 * 4 <= (uint8_t *)outer));
+	CHECK((after >= (uint8_t *)(grown_outer + 1024) || after + 4096 * 4 <= (uint8_t *)grown_outer));
+	memset(after, 0xFF, 4096 * 4);
+	CHECK(grown_outer[0] == 0);
+	CHECK(grown_outer[3] == 3);
+	CHECK(grown_outer[1023] == 1023);
+}
+
+TEST_CASE("[FrameAllocator] Frame local containers from outside a scope grow inside of it") {
+	FrameAllocator::Scope scope;
+
+	FrameLocalVector<int> vector;
+	vector.push_back(0);
+	{
+		FrameAllocator::Scope inner_scope;
+		for (int i = 1; i < 10000; i++) {
+			vector.push_back(i);
+		}
+		PagedArrayPool<int> pool(16);
+		FramePagedArray<int> paged;
+		paged.set_page_pool(&pool);
+		for (int i = 0; i < 100; i++) {
+			paged.push_back(i);
+		}
+		{
+			FrameAllocator::Scope innermost_scope;
+			for (int i = 100; i < 1000; i++) {
+				paged.push_back(i);
+			}
+		}
+		CHECK(paged[999] == 999);
+		paged.reset();
+	}
+	REQUIRE(vector.size() == 10000);
+	bool valid = true;
+	for (int i = 0; i < 10000; i++) {
+		valid = valid && vector[i] == i;
+	}
+	CHECK(valid);
+}
+
+TEST_CASE("[FrameAllocator] Allocations larger than a block") {
+	FrameAllocator::Scope scope;
+
+	const size_t size = 1024 * 1024;
+	uint8_t *big = (uint8_t *)FrameAllocator::alloc(size);
+	memset(big, 0xAB, size);
+	uint8_t *small = (uint8_t *)FrameAllocator::alloc(16);
+	CHECK((small >= big + size || small + 16 <= big));
+	CHECK(FrameAllocator::get_thread_capacity() >= size);
+}
+
+TEST_CASE("[FrameAllocator] Frame local containers") {
+	FrameAllocator::Scope scope;
+
+	FrameLocalVector<int> vector;
+	for (int i = 0; i < 10000; i++) {
+		vector.push_back(i);
+	}
+	CHECK(vector.size() == 10000);
+	bool valid = true;
+	for (int i = 0; i < 10000; i++) {
+		valid = valid && vector[i] == i;
+	}
+	CHECK(valid);
+
+	FrameLocalVector<String> strings;
+	strings.push_back("frame");
+	strings.push_back("allocator");
+	strings.resize(1);
+	CHECK(strings[0] == "frame");
+
+	PagedArrayPool<int> pool(16);
+	FramePagedArray<int> paged;
+	paged.set_page_pool(&pool);
+	for (int i = 0; i < 1000; i++) {
+		paged.push_back(i);
+	}
+	CHECK(paged.size() == 1000);
+	CHECK(paged[999] == 999);
+	paged.reset();
+}
+
+TEST_CASE("[FrameAllocator] Unscoped memory is reclaimed after the frame ends") {
+	FrameAllocator::end_frame();
+	void *a = FrameAllocator::alloc(32);
+	FrameAllocator::end_frame();
+	void *b = FrameAllocator::alloc(32);
+	CHECK_MESSAGE(a == b, "The arena should be reset on the first allocation of a new frame.");
+
+	FrameAllocator::Scope scope;
+	void *c = FrameAllocator::alloc(32);
+	FrameAllocator::end_frame();
+	CHECK_MESSAGE(FrameAllocator::alloc(32) != c, "The arena must not be reset while a scope is open.");
+}
+
+} // namespace TestFrameAllocator
+
+#endif // TEST_FRAME_ALLOCATOR_H
@@ -31,6 +31,7 @@
 #ifndef TEST_STRING_H
 #define TEST_STRING_H
 
+#include "core/os/os.h"
 #include "core/string/ustring.h"
 
 #include "tests/test_macros.h"
@@ -211,6 +212,64 @@ TEST_CASE("[String] Invalid UTF16 (non-standard)") {
 	ERR_PRINT_ON
 }
 
+TEST_CASE("[String] UTF8 and UTF16 around long ASCII runs") {
+	// Long runs are converted in blocks, so place other characters at every
+	// offset of a block and check both directions against the scalar result.
+	const String run = "The quick brown fox jumps over the lazy dog, 0123456789.";
+	static const char32_t specials[] = { 0xE9, 0x4E2D, 0x1F600, 0xFFFD };
+
+	for (int offset = 0; offset < 40; offset++) {
+		for (const char32_t special : specials) {
+			String s = run.substr(0, offset) + String::chr(special) + run;
+
+			CharString cs = s.utf8();
+			String from_utf8;
+			CHECK(from_utf8.parse_utf8(cs.get_data(), cs.length()) == OK);
+			CHECK(from_utf8 == s);
+
+			Char16String c16 = s.utf16();
+			CHECK(c16.length() == s.length() + (special > 0xFFFF ? 1 : 0));
+			String from_utf16;
+			CHECK(from_utf16.parse_utf16(c16.get_data(), c16.length()) == OK);
+			CHECK(from_utf16 == s);
+		}
+	}
+
+	String long_ascii = run.repeat(10);
+	CHECK(long_ascii.utf8().length() == long_ascii.length());
+	CHECK(String::utf8(long_ascii.utf8().get_data()) == long_ascii);
+	CHECK(String::utf16(long_ascii.utf16().get_data()) == long_ascii);
+}
+
+TEST_CASE("[String] UTF8 stops at NUL inside long ASCII runs") {
+	CharString cs = String("0123456789abcdef0123456789abcdef").utf8();
+	cs.set(20, 0);
+	String s;
+	CHECK(s.parse_utf8(cs.get_data(), cs.length()) == OK);
+	CHECK(s == "0123456789abcdef0123");
+}
+
+TEST_CASE("[String] UTF8 with CR in long ASCII runs") {
+	const String line = "a line that is long enough to span several blocks\r\n";
+	const String base = line.repeat(8);
+
+	String no_cr;
+	CHECK(no_cr.parse_utf8(base.utf8().get_data(), -1, true) == OK);
+	CHECK(no_cr == base.replace("\r", ""));
+}
+
+TEST_CASE("[String] Invalid UTF8 after a long ASCII run") {
+	ERR_PRINT_OFF
+	String prefix = String("abcdefghijklmnop").repeat(3);
+	CharString cs = (prefix + "#z").utf8();
+	cs.set(prefix.length(), (char)0x80); // Stray continuation byte.
+
+	String s;
+	CHECK(s.parse_utf8(cs.get_data()) == ERR_INVALID_DATA);
+	CHECK(s == prefix + " z");
+	ERR_PRINT_ON
+}
+
 TEST_CASE("[String] ASCII") {
 	String s = U"Primero Leche";
 	String t = s.ascii(false).get_data();
@@ -383,6 +442,34 @@ TEST_CASE("[String] Find and replace") {
 	CHECK(s == "Wappy Halloween, Anna!");
 }
 
+TEST_CASE("[String] Replace all occurrences") {
+	String s = "a,b,,c,";
+	CHECK(s.replace(",", ", ") == "a, b, , c, ");
+	CHECK(s.replace(String(","), String("")) == "abc");
+	CHECK(s.replace(",,", ";") == "a,b;c,");
+	CHECK(s.replace("x", "y") == s);
+	CHECK(s.replace("", "y") == s);
+	CHECK(String("aaaa").replace("aa", "b") == "bb");
+	CHECK(String("aaa").replace("aa", "b") == "ba");
+	CHECK(String("abab").replace(String("ab"), String("")).is_empty());
+
+	// Replacing must not modify the original, even when the buffer is shared.
+	String copy = s;
+	String replaced = copy.replace(",", "");
+	CHECK(copy == "a,b,,c,");
+	CHECK(replaced == "abc");
+}
+
+TEST_CASE("[String] Appending to a shared string") {
+	String a = "shared";
+	String b = a;
+	b += " and grown";
+	CHECK(a == "shared");
+	CHECK(b == "shared and grown");
+	CHECK(a + "!" == "shared!");
+	CHECK(a == "shared");
+}
+
 TEST_CASE("[String] Insertion") {
 	String s = "Who is Frederic?";
 	s = s.insert(s.find("?"), " Chopin");
@@ -1762,6 +1849,99 @@ TEST_CASE("[Stress][String] Empty via `is_empty()`") {
 		}
 	}
 }
+
+TEST_CASE_BENCHMARK("[String][Benchmark] Common operations") {
+	const int iterations = 20000;
+	String csv;
+	for (int i = 0; i < 64; i++) {
+		csv += itos(i * 37) + ",";
+	}
+	const String text = csv.repeat(4);
+	const String numbers[] = { "0", "42", "-123456", "9223372036854775807", "3.14159", "1e10" };
+	Array format_values;
+	format_values.push_back("world");
+	format_values.push_back(42);
+	format_values.push_back(3.5);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	int pieces = 0;
+	for (int i = 0; i < iterations; i++) {
+		pieces += csv.split(",").size();
+	}
+	print_line(vformat("split: %d usec", OS::get_singleton()->get_ticks_usec() - begin));
+	CHECK(pieces == iterations * 65);
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	int replaced_length = 0;
+	for (int i = 0; i < iterations; i++) {
+		replaced_length += text.replace(",", ", ").length();
+	}
+	print_line(vformat("replace: %d usec", OS::get_singleton()->get_ticks_usec() - begin));
+	CHECK(replaced_length == iterations * (text.length() + 256));
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	int formatted_length = 0;
+	for (int i = 0; i < iterations; i++) {
+		formatted_length += String("Hello {0}, the answer is {1} and not {2}.").format(format_values).length();
+	}
+	print_line(vformat("format: %d usec", OS::get_singleton()->get_ticks_usec() - begin));
+	CHECK(formatted_length > 0);
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	int64_t sum = 0;
+	for (int i = 0; i < iterations * 10; i++) {
+		sum += numbers[i % 6].to_int() & 0xFFFF;
+	}
+	print_line(vformat("to_int: %d usec", OS::get_singleton()->get_ticks_usec() - begin));
+	CHECK(sum > 0);
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	int utf8_length = 0;
+	for (int i = 0; i < iterations; i++) {
+		utf8_length += text.utf8().length();
+	}
+	print_line(vformat("utf8: %d usec", OS::get_singleton()->get_ticks_usec() - begin));
+	CHECK(utf8_length == iterations * text.length());
+}
+
+TEST_CASE_BENCHMARK("[String][Benchmark] UTF8 and UTF16 transcoding throughput") {
+	const int size = 4 * 1024 * 1024;
+	const String chunk = U"Godot Engine – 自由でオープンソースのゲームエンジン. ";
+	String ascii;
+	String mixed;
+	ascii.resize(size + 1);
+	mixed.resize(size + 1);
+	for (int i = 0; i < size; i++) {
+		ascii[i] = 'a' + i % 26;
+		mixed[i] = (i % 256 < 192) ? char32_t('a' + i % 26) : chunk[i % chunk.length()];
+	}
+	ascii[size] = 0;
+	mixed[size] = 0;
+
+	const String *inputs[] = { &ascii, &mixed };
+	const char *names[] = { "ASCII", "mixed" };
+	for (int i = 0; i < 2; i++) {
+		const String &s = *inputs[i];
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		CharString cs = s.utf8();
+		uint64_t encoded = OS::get_singleton()->get_ticks_usec();
+		String decoded;
+		decoded.parse_utf8(cs.get_data(), cs.length());
+		uint64_t end = OS::get_singleton()->get_ticks_usec();
+		print_line(vformat("%s UTF-8: encode %d MB/s, decode %d MB/s", names[i], cs.length() / MAX(encoded - begin, (uint64_t)1), cs.length() / MAX(end - encoded, (uint64_t)1)));
+		CHECK(decoded == s);
+
+		begin = OS::get_singleton()->get_ticks_usec();
+		Char16String c16 = s.utf16();
+		encoded = OS::get_singleton()->get_ticks_usec();
+		decoded.parse_utf16(c16.get_data(), c16.length());
+		end = OS::get_singleton()->get_ticks_usec();
+		const int bytes = c16.length() * sizeof(char16_t);
+		print_line(vformat("%s UTF-16: encode %d MB/s, decode %d MB/s", names[i], bytes / MAX(encoded - begin, (uint64_t)1), bytes / MAX(end - encoded, (uint64_t)1)));
+		CHECK(decoded == s);
+	}
+}
 } // namespace TestString
 
 #endif // TEST_STRING_H
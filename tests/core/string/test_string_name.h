@@ -0,0 +1,168 @@
+/*************************************************************************/
+/*  test_string_name.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_STRING_NAME_H
+#define TEST_STRING_NAME_H
+
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/string/string_name.h"
+#include "core/templates/local_vector.h"
+
+#include "tests/test_macros.h"
+
+namespace TestStringName {
+
+TEST_CASE("[StringName] Creation from different sources is unique") {
+	const String name = "test_string_name_unique";
+	StringName from_string(name);
+	StringName from_cstr("test_string_name_unique");
+	StringName from_static = SNAME("test_string_name_unique");
+
+	CHECK(from_string == from_cstr);
+	CHECK(from_string == from_static);
+	CHECK(from_string.data_unique_pointer() == from_cstr.data_unique_pointer());
+	CHECK(from_string == name);
+	CHECK(from_static == "test_string_name_unique");
+	CHECK(StringName::search(name) == from_string);
+	CHECK(StringName::search(U"test_string_name_unique") == from_string);
+}
+
+TEST_CASE("[StringName] Search") {
+	CHECK(StringName::search("test_string_name_never_created") == StringName());
+
+	StringName created("test_string_name_searched");
+	CHECK(StringName::search("test_string_name_searched") == created);
+}
+
+TEST_CASE("[StringName] Release and recreate") {
+	const String name = "test_string_name_recreated";
+	{
+		StringName temporary(name);
+		CHECK(StringName::search(name) == temporary);
+	}
+	CHECK_MESSAGE(StringName::search(name) == StringName(), "The name should be removed once unreferenced.");
+
+	StringName recreated(name);
+	CHECK(recreated == name);
+}
+
+struct ThreadData {
+	int offset = 0;
+	int iterations = 0;
+	bool valid = true;
+};
+
+static void create_names(void *p_userdata) {
+	ThreadData *data = static_cast<ThreadData *>(p_userdata);
+	for (int i = 0; i < data->iterations; i++) {
+		// Overlapping ranges, so threads share names that are constantly created and released.
+		String name = "test_string_name_thread_" + itos((i + data->offset) % 500);
+		StringName a(name);
+		StringName b(name);
+		StringName c = StringName::search(name);
+		data->valid = data->valid && a == b && a == c && String(a) == name;
+	}
+}
+
+TEST_CASE("[StringName] Creation and release from multiple threads") {
+	const int thread_count = 8;
+	Thread threads[thread_count];
+	ThreadData data[thread_count];
+
+	for (int i = 0; i < thread_count; i++) {
+		data[i].offset = i * 37;
+		data[i].iterations = 20000;
+		threads[i].start(create_names, &data[i]);
+	}
+
+	bool valid = true;
+	for (int i = 0; i < thread_count; i++) {
+		threads[i].wait_to_finish();
+		valid = valid && data[i].valid;
+	}
+	CHECK(valid);
+}
+
+struct BenchmarkData {
+	const Vector<String> *names = nullptr;
+	const LocalVector<StringName> *cached = nullptr;
+	int passes = 0;
+	uint32_t found = 0;
+};
+
+static void benchmark_lookup(void *p_userdata) {
+	BenchmarkData *data = static_cast<BenchmarkData *>(p_userdata);
+	for (int pass = 0; pass < data->passes; pass++) {
+		for (int i = 0; i < data->names->size(); i++) {
+			// Names exist, so this only measures lookups.
+			StringName name((*data->names)[i]);
+			data->found += name == (*data->cached)[i];
+		}
+	}
+}
+
+TEST_CASE_BENCHMARK("[StringName][Benchmark] Creation throughput from multiple threads") {
+	const int count = 10000;
+	const int passes = 20;
+	Vector<String> names;
+	LocalVector<StringName> cached;
+	for (int i = 0; i < count; i++) {
+		names.push_back("benchmark_string_name_" + itos(i));
+		cached.push_back(names[i]);
+	}
+
+	for (int thread_count = 1; thread_count <= 16; thread_count *= 2) {
+		Thread threads[16];
+		BenchmarkData data[16];
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < thread_count; i++) {
+			data[i].names = &names;
+			data[i].cached = &cached;
+			data[i].passes = passes;
+			threads[i].start(benchmark_lookup, &data[i]);
+		}
+		uint32_t found = 0;
+		for (int i = 0; i < thread_count; i++) {
+			threads[i].wait_to_finish();
+			found += data[i].found;
+		}
+		uint64_t elapsed = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+
+		uint64_t total = uint64_t(count) * passes * thread_count;
+		print_line(vformat("%d threads: %d StringNames created per second", thread_count, total * 1000000 / elapsed));
+		CHECK(found == total);
+	}
+}
+
+} // namespace TestStringName
+
+#endif // TEST_STRING_NAME_H
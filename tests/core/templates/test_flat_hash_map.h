@@ -0,0 +1,307 @@
+/*************************************************************************/
+/*  test_flat_hash_map.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_FLAT_HASH_MAP_H
+#define TEST_FLAT_HASH_MAP_H
+
+#include "core/math/random_number_generator.h"
+#include "core/os/os.h"
+#include "core/templates/flat_hash_map.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/oa_hash_map.h"
+#include "core/templates/rb_map.h"
+
+#include "tests/test_macros.h"
+
+namespace TestFlatHashMap {
+
+TEST_CASE("[FlatHashMap] Insert element") {
+	FlatHashMap<int, int> map;
+	FlatHashMap<int, int>::Iterator e = map.insert(42, 84);
+
+	CHECK(e);
+	CHECK(e->key == 42);
+	CHECK(e->value == 84);
+	CHECK(map[42] == 84);
+	CHECK(map.has(42));
+	CHECK(map.find(42));
+}
+
+TEST_CASE("[FlatHashMap] Overwrite element") {
+	FlatHashMap<int, int> map;
+	map.insert(42, 84);
+	map.insert(42, 1234);
+
+	CHECK(map[42] == 1234);
+	CHECK(map.size() == 1);
+}
+
+TEST_CASE("[FlatHashMap] Erase via element") {
+	FlatHashMap<int, int> map;
+	FlatHashMap<int, int>::Iterator e = map.insert(42, 84);
+	map.remove(e);
+	CHECK(!map.has(42));
+	CHECK(!map.find(42));
+}
+
+TEST_CASE("[FlatHashMap] Erase via key") {
+	FlatHashMap<int, int> map;
+	map.insert(42, 84);
+	CHECK(map.erase(42));
+	CHECK(!map.erase(42));
+	CHECK(!map.has(42));
+	CHECK(!map.find(42));
+}
+
+TEST_CASE("[FlatHashMap] Size") {
+	FlatHashMap<int, int> map;
+	map.insert(42, 84);
+	map.insert(123, 84);
+	map.insert(123, 84);
+	map.insert(0, 84);
+	map.insert(123485, 84);
+
+	CHECK(map.size() == 4);
+}
+
+TEST_CASE("[FlatHashMap] Iteration") {
+	FlatHashMap<int, int> map;
+	map.insert(42, 84);
+	map.insert(123, 12385);
+	map.insert(0, 12934);
+	map.insert(123485, 1238888);
+	map.insert(123, 111111);
+
+	const FlatHashMap<int, int> const_map = map;
+
+	// Iteration order is unspecified, only check that every element is visited once.
+	HashMap<int, int> expected;
+	expected.insert(42, 84);
+	expected.insert(123, 111111);
+	expected.insert(0, 12934);
+	expected.insert(123485, 1238888);
+
+	int count = 0;
+	for (const KeyValue<int, int> &E : const_map) {
+		CHECK(expected.has(E.key));
+		CHECK(expected[E.key] == E.value);
+		expected.erase(E.key);
+		count++;
+	}
+	CHECK(count == 4);
+	CHECK(expected.is_empty());
+}
+
+TEST_CASE("[FlatHashMap] Erase while iterating") {
+	FlatHashMap<int, int> map;
+	for (int i = 0; i < 100; i++) {
+		map.insert(i, i);
+	}
+
+	for (FlatHashMap<int, int>::Iterator E = map.begin(); E != map.end(); ++E) {
+		if (E->key % 2) {
+			map.remove(E);
+		}
+	}
+
+	CHECK(map.size() == 50);
+	for (int i = 0; i < 100; i++) {
+		CHECK(map.has(i) == (i % 2 == 0));
+	}
+}
+
+TEST_CASE("[FlatHashMap] Matches HashMap under random operations") {
+	RandomNumberGenerator rng;
+	rng.set_seed(12345);
+
+	FlatHashMap<int, int> map;
+	HashMap<int, int> reference;
+	bool valid = true;
+
+	for (int i = 0; i < 100000 && valid; i++) {
+		int key = rng.randi_range(0, 5000);
+		switch (rng.randi_range(0, 3)) {
+			case 0:
+			case 1: {
+				map.insert(key, i);
+				reference.insert(key, i);
+			} break;
+			case 2: {
+				valid = map.erase(key) == reference.erase(key);
+			} break;
+			case 3: {
+				const int *value = map.getptr(key);
+				const int *expected = reference.getptr(key);
+				valid = (value == nullptr) == (expected == nullptr) && (value == nullptr || *value == *expected);
+			} break;
+		}
+		valid = valid && map.size() == reference.size();
+	}
+	CHECK(valid);
+
+	for (const KeyValue<int, int> &E : reference) {
+		valid = valid && map.has(E.key) && map[E.key] == E.value;
+	}
+	CHECK(valid);
+
+	map.clear();
+	CHECK(map.is_empty());
+	CHECK(!map.has(0));
+}
+
+TEST_CASE("[FlatHashMap] String keys") {
+	FlatHashMap<String, String> map;
+	for (int i = 0; i < 1000; i++) {
+		map[itos(i)] = "value " + itos(i);
+	}
+	for (int i = 0; i < 1000; i += 2) {
+		map.erase(itos(i));
+	}
+
+	CHECK(map.size() == 500);
+	CHECK(map["1"] == "value 1");
+	CHECK(!map.has("2"));
+
+	FlatHashMap<String, String> copy;
+	copy = map;
+	CHECK(copy.size() == 500);
+	CHECK(copy["999"] == "value 999");
+}
+
+// Benchmarks.
+
+template <class M, class K>
+static bool map_has(const M &p_map, const K &p_key) {
+	return p_map.has(p_key);
+}
+
+template <class K>
+static bool map_has(const OAHashMap<K, int> &p_map, const K &p_key) {
+	int value;
+	return p_map.lookup(p_key, value);
+}
+
+template <class M, class K>
+static void map_erase(M &p_map, const K &p_key) {
+	p_map.erase(p_key);
+}
+
+template <class K>
+static void map_erase(OAHashMap<K, int> &p_map, const K &p_key) {
+	p_map.remove(p_key);
+}
+
+template <class M>
+static void benchmark_map(const char *p_name, const Vector<String> &p_keys, const Vector<String> &p_missing) {
+	M map;
+	const int count = p_keys.size();
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < count; i++) {
+		map.insert(p_keys[i], i);
+	}
+	uint64_t inserted = OS::get_singleton()->get_ticks_usec();
+
+	int found = 0;
+	for (int pass = 0; pass < 4; pass++) {
+		for (int i = 0; i < count; i++) {
+			found += map_has(map, p_keys[i]);
+		}
+	}
+	uint64_t hits = OS::get_singleton()->get_ticks_usec();
+
+	for (int pass = 0; pass < 4; pass++) {
+		for (int i = 0; i < count; i++) {
+			found -= map_has(map, p_missing[i]);
+		}
+	}
+	uint64_t misses = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < count; i++) {
+		map_erase(map, p_keys[i]);
+	}
+	uint64_t erased = OS::get_singleton()->get_ticks_usec();
+
+	print_line(vformat("%s: insert %d usec, 4x hit %d usec, 4x miss %d usec, erase %d usec", p_name,
+			inserted - begin, hits - inserted, misses - hits, erased - misses));
+	CHECK(found == count * 4);
+}
+
+TEST_CASE_BENCHMARK("[FlatHashMap][Benchmark] String keys against other maps") {
+	for (int count = 1000; count <= 1000000; count *= 10) {
+		Vector<String> keys;
+		Vector<String> missing;
+		keys.resize(count);
+		missing.resize(count);
+		for (int i = 0; i < count; i++) {
+			keys.write[i] = "key_" + itos(i);
+			missing.write[i] = "missing_" + itos(i);
+		}
+
+		print_line(vformat("%d elements:", count));
+		benchmark_map<FlatHashMap<String, int>>("  FlatHashMap", keys, missing);
+		benchmark_map<HashMap<String, int>>("  HashMap", keys, missing);
+		benchmark_map<OAHashMap<String, int>>("  OAHashMap", keys, missing);
+		benchmark_map<RBMap<String, int>>("  RBMap", keys, missing);
+	}
+}
+
+template <class M>
+static uint64_t benchmark_int_lookups(int p_count) {
+	M map;
+	for (int i = 0; i < p_count; i++) {
+		map.insert(i * 7919, i);
+	}
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	int64_t sum = 0;
+	for (int pass = 0; pass < 8; pass++) {
+		for (int i = 0; i < p_count * 2; i++) {
+			sum += map_has(map, i * 7919);
+		}
+	}
+	uint64_t end = OS::get_singleton()->get_ticks_usec();
+	CHECK(sum == int64_t(p_count) * 8);
+	return end - begin;
+}
+
+TEST_CASE_BENCHMARK("[FlatHashMap][Benchmark] Integer lookups against other maps") {
+	for (int count = 1000; count <= 1000000; count *= 10) {
+		print_line(vformat("%d elements, 50%% hits: FlatHashMap %d usec, HashMap %d usec, OAHashMap %d usec, RBMap %d usec", count,
+				benchmark_int_lookups<FlatHashMap<int, int>>(count),
+				benchmark_int_lookups<HashMap<int, int>>(count),
+				benchmark_int_lookups<OAHashMap<int, int>>(count),
+				benchmark_int_lookups<RBMap<int, int>>(count)));
+	}
+}
+
+} // namespace TestFlatHashMap
+
+#endif // TEST_FLAT_HASH_MAP_H
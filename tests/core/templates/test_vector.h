@@ -31,6 +31,7 @@
 #ifndef TEST_VECTOR_H
 #define TEST_VECTOR_H
 
+#include "core/os/thread.h"
 #include "core/templates/vector.h"
 
 #include "tests/test_macros.h"
@@ -532,6 +533,38 @@ TEST_CASE("[Vector] Operators") {
 	CHECK(vector != vector_other);
 }
 
+static void release_vector(void *p_userdata) {
+	static_cast<Vector<int> *>(p_userdata)->clear();
+}
+
+TEST_CASE("[Vector] Resize while another owner releases the buffer") {
+	// The other owner may drop its reference at any point during the resize,
+	// which must still end up with a buffer large enough for the new size.
+	bool valid = true;
+	for (int i = 0; i < 200; i++) {
+		Vector<int> vector;
+		vector.resize(8);
+		for (int j = 0; j < 8; j++) {
+			vector.write[j] = j;
+		}
+		Vector<int> *other = memnew(Vector<int>(vector));
+
+		Thread thread;
+		thread.start(release_vector, other);
+		vector.resize(4096);
+		for (int j = 8; j < 4096; j++) {
+			vector.write[j] = j;
+		}
+		thread.wait_to_finish();
+		memdelete(other);
+
+		for (int j = 0; j < 4096; j++) {
+			valid = valid && vector[j] == j;
+		}
+	}
+	CHECK(valid);
+}
+
 } // namespace TestVector
 
 #endif // TEST_VECTOR_H
@@ -0,0 +1,116 @@
+/*************************************************************************/
+/*  test_parallel_for.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_PARALLEL_FOR_H
+#define TEST_PARALLEL_FOR_H
+
+#include "core/os/parallel_for.h"
+
+#include "tests/test_macros.h"
+
+namespace TestParallelFor {
+
+TEST_CASE("[ParallelFor] Every element is visited exactly once") {
+	const uint32_t count = 10000;
+	LocalVector<uint32_t> visits;
+	visits.resize(count);
+	for (uint32_t i = 0; i < count; i++) {
+		visits[i] = 0;
+	}
+
+	parallel_for(0, count, [&](uint32_t p_from, uint32_t p_to) {
+		for (uint32_t i = p_from; i < p_to; i++) {
+			visits[i]++;
+		}
+	});
+
+	bool all_once = true;
+	for (uint32_t i = 0; i < count; i++) {
+		all_once = all_once && visits[i] == 1;
+	}
+	CHECK(all_once);
+}
+
+TEST_CASE("[ParallelFor] Offset, empty and explicit grain ranges") {
+	SafeNumeric<uint32_t> visited;
+	parallel_for(
+			100, 1100, [&](uint32_t p_from, uint32_t p_to) {
+				CHECK(p_from >= 100);
+				CHECK(p_to <= 1100);
+				CHECK(p_to - p_from <= 7);
+				visited.add(p_to - p_from);
+			},
+			7);
+	CHECK(visited.get() == 1000);
+
+	parallel_for(5, 5, [&](uint32_t p_from, uint32_t p_to) {
+		visited.add(p_to - p_from + 1);
+	});
+	CHECK(visited.get() == 1000);
+}
+
+TEST_CASE("[ParallelFor] Nested loops") {
+	SafeNumeric<uint32_t> visited;
+	parallel_for(0, 64, [&](uint32_t p_from, uint32_t p_to) {
+		for (uint32_t i = p_from; i < p_to; i++) {
+			parallel_for(0, 64, [&](uint32_t p_inner_from, uint32_t p_inner_to) {
+				visited.add(p_inner_to - p_inner_from);
+			});
+		}
+	});
+	CHECK(visited.get() == 64 * 64);
+}
+
+TEST_CASE("[ParallelFor] Reduction") {
+	const uint32_t count = 100000;
+	uint64_t sum = parallel_reduce(
+			0, count, uint64_t(0), [](uint32_t p_from, uint32_t p_to, uint64_t &r_accum) {
+				for (uint32_t i = p_from; i < p_to; i++) {
+					r_accum += i;
+				}
+			},
+			[](uint64_t p_a, uint64_t p_b) { return p_a + p_b; });
+	CHECK(sum == uint64_t(count) * (count - 1) / 2);
+
+	uint32_t max = parallel_reduce(
+			0, count, uint32_t(0), [](uint32_t p_from, uint32_t p_to, uint32_t &r_accum) {
+				r_accum = MAX(r_accum, (p_to - 1) * 7 % count);
+			},
+			[](uint32_t p_a, uint32_t p_b) { return MAX(p_a, p_b); }, 1);
+	CHECK(max == count - 1);
+
+	CHECK(parallel_reduce(
+				  3, 3, 42, [](uint32_t p_from, uint32_t p_to, int &r_accum) { r_accum++; },
+				  [](int p_a, int p_b) { return p_a + p_b; }) == 42);
+}
+
+} // namespace TestParallelFor
+
+#endif // TEST_PARALLEL_FOR_H
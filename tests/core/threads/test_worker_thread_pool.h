@@ -153,6 +153,108 @@ TEST_CASE("[WorkerThreadPool] Process 256 elements on native task group low prio
 	CHECK(callable_group_counter.get() == count - 1);
 }
 
+struct DependencyTestData {
+	SafeNumeric<uint32_t> counter;
+	uint32_t order[3] = {};
+};
+
+static void static_dependency_test(void *p_arg) {
+	DependencyTestData *data = (DependencyTestData *)p_arg;
+	uint32_t index = data->counter.postincrement();
+	if (index < 3) {
+		data->order[index] = index;
+	}
+}
+
+static void static_dependency_first_test(void *p_arg) {
+	DependencyTestData *data = (DependencyTestData *)p_arg;
+	OS::get_singleton()->delay_usec(1000);
+	data->order[0] = data->counter.postincrement();
+}
+
+static void static_dependency_second_test(void *p_arg) {
+	DependencyTestData *data = (DependencyTestData *)p_arg;
+	data->order[1] = data->counter.postincrement();
+}
+
+TEST_CASE("[WorkerThreadPool] Dependent task runs after its dependency") {
+	DependencyTestData data;
+	WorkerThreadPool::TaskID first = WorkerThreadPool::get_singleton()->add_native_task(static_dependency_first_test, &data, true);
+	Vector<WorkerThreadPool::TaskID> dependencies;
+	dependencies.push_back(first);
+	WorkerThreadPool::TaskID second = WorkerThreadPool::get_singleton()->add_native_dependent_task(static_dependency_second_test, &data, dependencies, true);
+
+	WorkerThreadPool::get_singleton()->wait_for_task_completion(second);
+	CHECK(data.order[0] == 0);
+	CHECK(data.order[1] == 1);
+	WorkerThreadPool::get_singleton()->wait_for_task_completion(first);
+}
+
+TEST_CASE("[WorkerThreadPool] Dependent task with many and completed dependencies") {
+	const int count = 64;
+	DependencyTestData data;
+	Vector<WorkerThreadPool::TaskID> dependencies;
+	for (int i = 0; i < count; i++) {
+		dependencies.push_back(WorkerThreadPool::get_singleton()->add_native_task(static_dependency_test, &data, true));
+	}
+	// Dependencies already waited for count as completed.
+	WorkerThreadPool::get_singleton()->wait_for_task_completion(dependencies[0]);
+
+	WorkerThreadPool::TaskID last = WorkerThreadPool::get_singleton()->add_native_dependent_task(static_test, &data.counter, dependencies, true);
+	WorkerThreadPool::get_singleton()->wait_for_task_completion(last);
+	CHECK(data.counter.get() == count + 1);
+
+	for (int i = 1; i < count; i++) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(dependencies[i]);
+	}
+}
+
+struct BenchmarkTask {
+	uint64_t posted_usec = 0;
+	uint64_t started_usec = 0;
+};
+
+static void static_benchmark_task(void *p_arg) {
+	BenchmarkTask *task = (BenchmarkTask *)p_arg;
+	task->started_usec = OS::get_singleton()->get_ticks_usec();
+}
+
+TEST_CASE_BENCHMARK("[WorkerThreadPool][Benchmark] Task throughput and latency") {
+	const int count = 100000;
+	LocalVector<BenchmarkTask> bench_tasks;
+	LocalVector<WorkerThreadPool::TaskID> task_ids;
+	LocalVector<uint64_t> latencies;
+	bench_tasks.resize(count);
+	task_ids.resize(count);
+	latencies.resize(count);
+
+	for (int thread_count = 1; thread_count <= 64; thread_count *= 2) {
+		WorkerThreadPool *pool = memnew(WorkerThreadPool);
+		pool->init(thread_count, false);
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < count; i++) {
+			bench_tasks[i].posted_usec = OS::get_singleton()->get_ticks_usec();
+			task_ids[i] = pool->add_native_task(static_benchmark_task, &bench_tasks[i], true);
+		}
+		for (int i = 0; i < count; i++) {
+			pool->wait_for_task_completion(task_ids[i]);
+		}
+		uint64_t elapsed = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+
+		memdelete(pool);
+
+		for (int i = 0; i < count; i++) {
+			latencies[i] = bench_tasks[i].started_usec - bench_tasks[i].posted_usec;
+		}
+		latencies.sort();
+
+		print_line(vformat("%d threads: %d tasks/s, latency p50 %d usec, p99 %d usec, max %d usec",
+				thread_count, uint64_t(count) * 1000000 / elapsed, latencies[count / 2], latencies[count * 99 / 100], latencies[count - 1]));
+		CHECK(latencies[count - 1] < elapsed);
+	}
+}
+
 } // namespace TestWorkerThreadPool
 
 #endif // TEST_WORKER_THREAD_POOL_H
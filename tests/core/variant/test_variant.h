@@ -789,6 +789,48 @@ TEST_CASE("[Variant] Writer and parser dictionary") {
 	CHECK_MESSAGE(d_parsed == Variant(d), "Should parse back.");
 }
 
+TEST_CASE("[Variant] Parser streams") {
+	// Longer than the readahead buffer, so it gets refilled while parsing.
+	Array a;
+	for (int i = 0; i < 1000; i++) {
+		a.push_back(vformat("item %d \u00e9\u4e2d", i));
+	}
+	String a_str;
+	VariantWriter::write_to_string(a, a_str);
+	CharString a_utf8 = a_str.utf8();
+
+	String errs;
+	int line = 1;
+	Variant a_parsed;
+
+	VariantParser::StreamString ss;
+	ss.s = a_str;
+	CHECK(VariantParser::parse(&ss, a_parsed, errs, line) == OK);
+	CHECK_MESSAGE(a_parsed == Variant(a), "Should parse back from a string.");
+
+	VariantParser::StreamBuffer sb;
+	sb.set_view((const uint8_t *)a_utf8.get_data(), a_utf8.length());
+	CHECK(VariantParser::parse(&sb, a_parsed, errs, line) == OK);
+	CHECK_MESSAGE(a_parsed == Variant(a), "Should parse back from UTF-8 in memory.");
+	CHECK(sb.get_position() == (uint64_t)a_utf8.length());
+
+	// Escaped characters are decoded along with the UTF-8 around them.
+	const char *escaped = "\"\\u00e9 \xc3\xa9 \\ud83d\\ude00\" 12 ";
+	sb.set_view((const uint8_t *)escaped, strlen(escaped));
+	CHECK(VariantParser::parse(&sb, a_parsed, errs, line) == OK);
+	CHECK(a_parsed == Variant(String::utf8("\xc3\xa9 \xc3\xa9 \xf0\x9f\x98\x80")));
+	uint64_t position = sb.get_position();
+	CHECK(VariantParser::parse(&sb, a_parsed, errs, line) == OK);
+	CHECK(a_parsed == Variant(12));
+	CHECK(VariantParser::parse(&sb, a_parsed, errs, line) == ERR_FILE_EOF);
+	CHECK(sb.is_eof());
+
+	sb.seek(position);
+	CHECK_FALSE(sb.is_eof());
+	CHECK(VariantParser::parse(&sb, a_parsed, errs, line) == OK);
+	CHECK(a_parsed == Variant(12));
+}
+
 TEST_CASE("[Variant] Writer recursive dictionary") {
 	// There is no way to accurately represent a recursive dictionary,
 	// the only thing we can do is make sure the writer doesn't blow up